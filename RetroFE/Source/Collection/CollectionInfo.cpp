@@ -15,6 +15,7 @@
  */
 #include "CollectionInfo.h"
 #include "Item.h"
+#include "FavoritesWriter.h"
 #include "../Database/Configuration.h"
 #include "../Utility/Utils.h"
 #include "../Utility/Log.h"
@@ -73,80 +74,31 @@ CollectionInfo::~CollectionInfo()
     }
 }
 
+// Hands the favorites to the FavoritesWriter, which writes them in the
+// background
 bool CollectionInfo::Save() 
 {
-    bool retval = true;
     if(saveRequest)
     {
-        std::string dir  = Utils::combinePath(Configuration::absolutePath, "collections", name, "playlists");
-        std::string file = Utils::combinePath(Configuration::absolutePath, "collections", name, "playlists/favorites.txt");
-        Logger::write(Logger::ZONE_INFO, "Collection", "Saving " + file);
-
-        Utils::rootfsWritable();
-
-        std::ofstream filestream;
-        try
+        std::stringstream ss;
+        std::vector<Item *> *saveitems = playlists["favorites"];
+        for(std::vector<Item *>::iterator it = saveitems->begin(); it != saveitems->end(); it++)
         {
-            // Create playlists directory if it does not exist yet.
-            struct stat info;
-            if ( stat( dir.c_str(), &info ) != 0 )
+            if ((*it)->collectionInfo->name == name)
             {
-#if defined(_WIN32) && !defined(__GNUC__)
-                if(!CreateDirectory(dir.c_str(), NULL))
-                {
-                    if(ERROR_ALREADY_EXISTS != GetLastError())
-                    {
-                        Logger::write(Logger::ZONE_WARNING, "Collection", "Could not create directory " + dir);
-                        Utils::rootfsReadOnly();
-                        return false;
-                    }
-                }
-#else 
-#if defined(__MINGW32__)
-                if(mkdir(dir.c_str()) == -1)
-#else
-                if(mkdir(dir.c_str(), 0755) == -1)
-#endif        
-                {
-                    Logger::write(Logger::ZONE_WARNING, "Collection", "Could not create directory " + dir);
-                    Utils::rootfsReadOnly();
-                    return false;
-                }
-#endif
+                ss << (*it)->name << std::endl;
             }
-            else if ( !(info.st_mode & S_IFDIR) )
+            else
             {
-                Logger::write(Logger::ZONE_WARNING, "Collection", dir + " exists, but is not a directory.");
-                Utils::rootfsReadOnly();
-                return false;
+                ss << "_" << (*it)->collectionInfo->name << ":" << (*it)->name << std::endl;
             }
-
-            filestream.open(file.c_str());
-            std::vector<Item *> *saveitems = playlists["favorites"];
-            for(std::vector<Item *>::iterator it = saveitems->begin(); it != saveitems->end(); it++)
-            {
-                if ((*it)->collectionInfo->name == name)
-                {
-                    filestream << (*it)->name << std::endl;
-                }
-                else
-                {
-                    filestream << "_" << (*it)->collectionInfo->name << ":" << (*it)->name << std::endl;
-                }
-            }
-
-            filestream.close();
-        }
-        catch(std::exception &)
-        {
-            Logger::write(Logger::ZONE_ERROR, "Collection", "Save failed: " + file);
-            retval = false;
         }
 
-        Utils::rootfsReadOnly();
+        FavoritesWriter::getInstance().save(name, ss.str());
+        saveRequest = false;
     }
     
-    return retval;
+    return true;
 }
 
 std::string CollectionInfo::settingsPath() const
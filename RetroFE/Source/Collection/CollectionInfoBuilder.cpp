@@ -16,6 +16,7 @@
 #include "CollectionInfoBuilder.h"
 #include "CollectionInfo.h"
 #include "Item.h"
+#include "FavoritesWriter.h"
 #include "../Database/Configuration.h"
 #include "../Database/MetadataDatabase.h"
 #include "../Database/DB.h"
@@ -380,68 +381,52 @@ void CollectionInfoBuilder::addPlaylists(CollectionInfo *info)
     struct dirent **dirp;
     int n;
     std::string path = Utils::combinePath(Configuration::absolutePath, "collections", info->name, "playlists");
-    dp = opendir(path.c_str());
 
-    if(dp == NULL)
+    // Favorites not written yet would be missing from the file
+    FavoritesWriter &favoritesWriter = FavoritesWriter::getInstance();
+    if(favoritesWriter.isPending(info->name))
     {
-        info->playlists["favorites"] = new std::vector<Item *>();
-        return;
+        favoritesWriter.flush();
     }
 
-    n = scandir(path.c_str(), &dirp, NULL, alphasort);
+    dp = opendir(path.c_str());
 
-    while(n-- > 0)
+    if(dp != NULL)
     {
-        std::string file = dirp[n]->d_name;
+        n = scandir(path.c_str(), &dirp, NULL, alphasort);
 
-        size_t position = file.find_last_of(".");
-        std::string basename = (std::string::npos == position)? file : file.substr(0, position);
-
-        std::string comparator = ".txt";
-        int start = file.length() - comparator.length();
-
-        if(start >= 0)
+        while(n-- > 0)
         {
-            if(file.compare(start, comparator.length(), comparator) == 0)
-            {
-                Logger::write(Logger::ZONE_INFO, "RetroFE", "Loading playlist: " + basename);
+            std::string file = dirp[n]->d_name;
 
-                std::map<std::string, Item *> playlistFilter;
-                std::string playlistFile = Utils::combinePath(Configuration::absolutePath, "collections", info->name, "playlists", file);
-                ImportBasicList(info, playlistFile, playlistFilter);
+            size_t position = file.find_last_of(".");
+            std::string basename = (std::string::npos == position)? file : file.substr(0, position);
 
-                info->playlists[basename] = new std::vector<Item *>();
+            std::string comparator = ".txt";
+            int start = file.length() - comparator.length();
 
-                // add the playlist list 
-                for(std::map<std::string, Item *>::iterator it = playlistFilter.begin(); it != playlistFilter.end(); it++)
+            if(start >= 0)
+            {
+                if(file.compare(start, comparator.length(), comparator) == 0)
                 {
-                    std::string collectionName = info->name;
-                    std::string itemName       = it->first;
-                    if (itemName.at(0) == '_') // name consists of _<collectionName>:<itemName>
-                    {
-                         itemName.erase(0, 1); // Remove _
-                         size_t position = itemName.find(":");
-                         if (position != std::string::npos )
-                         {
-                             collectionName = itemName.substr(0, position);
-                             itemName       = itemName.erase(0, position+1);
-                         }
-                    }
-
-                    for(std::vector<Item *>::iterator it = info->items.begin(); it != info->items.end(); it++)
-                    {
-                        if ( (*it)->name == itemName && (*it)->collectionInfo->name == collectionName)
-                        {
-                            info->playlists[basename]->push_back((*it));
-                        }
-                    }
+                    addPlaylist(info, basename, Utils::combinePath(path, file));
                 }
-
             }
         }
+
+        closedir(dp);
     }
 
-    closedir(dp);
+    // Favorites saved outside of the collection take precedence
+    std::string favoritesFile = favoritesWriter.getPath(info->name);
+    if(favoritesFile != Utils::combinePath(path, "favorites.txt"))
+    {
+        std::ifstream f(favoritesFile.c_str());
+        if(f.good())
+        {
+            addPlaylist(info, "favorites", favoritesFile);
+        }
+    }
 
     if(info->playlists["favorites"] == NULL)
     {
@@ -452,6 +437,46 @@ void CollectionInfoBuilder::addPlaylists(CollectionInfo *info)
 }
 
 
+void CollectionInfoBuilder::addPlaylist(CollectionInfo *info, std::string basename, std::string playlistFile)
+{
+    Logger::write(Logger::ZONE_INFO, "RetroFE", "Loading playlist: " + basename);
+
+    std::map<std::string, Item *> playlistFilter;
+    ImportBasicList(info, playlistFile, playlistFilter);
+
+    if(info->playlists[basename] != NULL)
+    {
+        delete info->playlists[basename];
+    }
+    info->playlists[basename] = new std::vector<Item *>();
+
+    // add the playlist list 
+    for(std::map<std::string, Item *>::iterator it = playlistFilter.begin(); it != playlistFilter.end(); it++)
+    {
+        std::string collectionName = info->name;
+        std::string itemName       = it->first;
+        if (itemName.at(0) == '_') // name consists of _<collectionName>:<itemName>
+        {
+             itemName.erase(0, 1); // Remove _
+             size_t position = itemName.find(":");
+             if (position != std::string::npos )
+             {
+                 collectionName = itemName.substr(0, position);
+                 itemName       = itemName.erase(0, position+1);
+             }
+        }
+
+        for(std::vector<Item *>::iterator it = info->items.begin(); it != info->items.end(); it++)
+        {
+            if ( (*it)->name == itemName && (*it)->collectionInfo->name == collectionName)
+            {
+                info->playlists[basename]->push_back((*it));
+            }
+        }
+    }
+}
+
+
 void CollectionInfoBuilder::ImportRomDirectory(std::string path, CollectionInfo *info, std::map<std::string, Item *> includeFilter, std::map<std::string, Item *> excludeFilter, bool romHierarchy, bool truRIP)
 {
 
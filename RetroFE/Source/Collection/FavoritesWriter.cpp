@@ -0,0 +1,271 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "FavoritesWriter.h"
+#include "../Database/Configuration.h"
+#include "../Utility/Log.h"
+#include "../Utility/Utils.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#define FAVORITES_DEFAULT_DELAY_MS  3000
+
+
+FavoritesWriter::FavoritesWriter()
+    : stopping_(false)
+    , remount_(true)
+    , delay_(std::chrono::milliseconds(FAVORITES_DEFAULT_DELAY_MS))
+{
+}
+
+
+FavoritesWriter::~FavoritesWriter()
+{
+    stop();
+}
+
+
+FavoritesWriter &FavoritesWriter::getInstance()
+{
+    static FavoritesWriter instance;
+    static std::once_flag started;
+    std::call_once(started, [] { instance.start(); });
+    return instance;
+}
+
+
+void FavoritesWriter::start()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if(thread_.joinable()) return;
+    stopping_ = false;
+    thread_ = std::thread(&FavoritesWriter::threadLoop, this);
+}
+
+
+// Stops the thread and writes whatever is still pending
+void FavoritesWriter::stop()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    condition_.notify_all();
+
+    if(thread_.joinable())
+    {
+        thread_.join();
+    }
+
+    flush();
+}
+
+
+void FavoritesWriter::setDirectory(std::string directory, bool remount)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    directory_ = directory;
+    remount_   = remount;
+}
+
+
+void FavoritesWriter::setDelay(float seconds)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    delay_ = std::chrono::milliseconds(seconds > 0 ? static_cast<long>(seconds * 1000) : 0);
+}
+
+
+std::string FavoritesWriter::getPath(std::string collection)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if(directory_ == "")
+    {
+        return Utils::combinePath(Configuration::absolutePath, "collections", collection, "playlists", "favorites.txt");
+    }
+
+    return Utils::combinePath(directory_, collection, "favorites.txt");
+}
+
+
+// Never blocks on the disk, a later save of the same collection replaces
+// the contents that were not written yet
+void FavoritesWriter::save(std::string collection, std::string contents)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if(pending_.empty())
+    {
+        deadline_ = std::chrono::steady_clock::now() + delay_;
+    }
+    pending_[collection] = contents;
+
+    condition_.notify_one();
+}
+
+
+// Also true while the playlist is being written, its file is not complete yet
+bool FavoritesWriter::isPending(std::string collection)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    return pending_.find(collection) != pending_.end() || writing_.find(collection) != writing_.end();
+}
+
+
+// Writes all pending playlists now, with a single remount for all of them
+bool FavoritesWriter::flush()
+{
+    std::unique_lock<std::mutex> flushLock(flushMutex_);
+
+    std::map<std::string, std::string> pending;
+    bool remount;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        pending.swap(pending_);
+        remount = remount_;
+        for(std::map<std::string, std::string>::iterator it = pending.begin(); it != pending.end(); it++)
+        {
+            writing_.insert(it->first);
+        }
+    }
+
+    if(pending.empty()) return true;
+
+    if(remount)
+    {
+        Utils::rootfsWritable();
+    }
+
+    bool retVal = true;
+    for(std::map<std::string, std::string>::iterator it = pending.begin(); it != pending.end(); it++)
+    {
+        std::string file = getPath(it->first);
+        Logger::write(Logger::ZONE_INFO, "Collection", "Saving " + file);
+
+        std::string directory = file.substr(0, file.find_last_of("/"));
+        if(!Utils::createDirectories(directory) || !writeFile(file, it->second))
+        {
+            Logger::write(Logger::ZONE_ERROR, "Collection", "Save failed: " + file);
+            retVal = false;
+
+            // Try again later, unless the playlist changed meanwhile
+            std::unique_lock<std::mutex> lock(mutex_);
+            if(pending_.empty())
+            {
+                deadline_ = std::chrono::steady_clock::now() + std::max(delay_, std::chrono::steady_clock::duration(std::chrono::seconds(1)));
+            }
+            pending_.insert(*it);
+        }
+    }
+
+    if(remount)
+    {
+        Utils::rootfsReadOnly();
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        writing_.clear();
+    }
+
+    return retVal;
+}
+
+
+// Writes a temporary file next to the destination, syncs it and renames it
+// over the destination, then syncs the directory so the rename is on disk
+bool FavoritesWriter::writeFile(std::string file, std::string contents)
+{
+    std::string tmpFile = file + ".tmp";
+
+    int fd = open(tmpFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0)
+    {
+        Logger::write(Logger::ZONE_WARNING, "Collection", "Could not create " + tmpFile + ": " + strerror(errno));
+        return false;
+    }
+
+    const char *data = contents.c_str();
+    size_t left = contents.size();
+    while(left > 0)
+    {
+        ssize_t written = write(fd, data, left);
+        if(written < 0 && errno == EINTR) continue;
+        if(written <= 0)
+        {
+            Logger::write(Logger::ZONE_WARNING, "Collection", "Could not write " + tmpFile + ": " + strerror(errno));
+            close(fd);
+            unlink(tmpFile.c_str());
+            return false;
+        }
+        data += written;
+        left -= written;
+    }
+
+    if(fsync(fd) != 0 || close(fd) != 0)
+    {
+        Logger::write(Logger::ZONE_WARNING, "Collection", "Could not sync " + tmpFile + ": " + strerror(errno));
+        unlink(tmpFile.c_str());
+        return false;
+    }
+
+    if(rename(tmpFile.c_str(), file.c_str()) != 0)
+    {
+        Logger::write(Logger::ZONE_WARNING, "Collection", "Could not rename " + tmpFile + ": " + strerror(errno));
+        unlink(tmpFile.c_str());
+        return false;
+    }
+
+    std::string directory = file.substr(0, file.find_last_of("/"));
+    int dirFd = open(directory.c_str(), O_RDONLY);
+    if(dirFd >= 0)
+    {
+        fsync(dirFd);
+        close(dirFd);
+    }
+
+    return true;
+}
+
+
+void FavoritesWriter::threadLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while(!stopping_)
+    {
+        if(pending_.empty())
+        {
+            condition_.wait(lock);
+        }
+        else if(std::chrono::steady_clock::now() < deadline_)
+        {
+            condition_.wait_until(lock, deadline_);
+        }
+        else
+        {
+            lock.unlock();
+            flush();
+            lock.lock();
+        }
+    }
+}
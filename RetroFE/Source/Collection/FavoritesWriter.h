@@ -0,0 +1,66 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+// Writes the favorites playlists behind the UI. save() only records the new
+// contents, and a background thread writes everything that changed once the
+// delay has passed since the first unsaved change. Each file is replaced
+// atomically, so a crash leaves either the old or the new playlist.
+//
+// The files go to collections/<name>/playlists/favorites.txt unless a
+// directory is set, in which case they go to <directory>/<name>/favorites.txt.
+// The root filesystem is only remounted read-write when remount is set.
+class FavoritesWriter
+{
+public:
+    FavoritesWriter();
+    virtual ~FavoritesWriter();
+    static FavoritesWriter &getInstance();
+
+    void start();
+    void stop();
+    void setDirectory(std::string directory, bool remount);
+    void setDelay(float seconds);
+    std::string getPath(std::string collection);
+    void save(std::string collection, std::string contents);
+    bool isPending(std::string collection);
+    bool flush();
+
+    static bool writeFile(std::string file, std::string contents);
+
+private:
+    void threadLoop();
+
+    std::mutex                            mutex_;
+    std::mutex                            flushMutex_;     // held while files are written
+    std::condition_variable               condition_;
+    std::thread                           thread_;
+    bool                                  stopping_;
+    std::string                           directory_;
+    bool                                  remount_;
+    std::chrono::steady_clock::duration   delay_;
+    std::chrono::steady_clock::time_point deadline_;
+    std::map<std::string, std::string>    pending_;        // contents by collection
+    std::set<std::string>                 writing_;        // collections flush() is writing
+};
@@ -459,6 +459,15 @@ bool UserInput::newKeyPressed(KeyCode_E code)
     return currentKeyState_[code] && !lastKeyState_[code];
 }
 
+bool UserInput::anyKeyPressed()
+{
+    for ( unsigned int i = 0; i < KeyCodeMax; ++i )
+    {
+        if ( currentKeyState_[i] ) return true;
+    }
+    return false;
+}
+
 /*
 void UserInput::clearJoysticks( )
 {
@@ -67,6 +67,7 @@ public:
     bool update(SDL_Event &e);
     bool keystate(KeyCode_E);
     bool newKeyPressed(KeyCode_E code);
+    bool anyKeyPressed();
     void clearJoysticks( );
 
 private:
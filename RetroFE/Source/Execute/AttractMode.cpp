@@ -67,4 +67,21 @@ void AttractMode::update(float dt, Page &page)
 bool AttractMode::isActive()
 {
     return isActive_;
-}
\ No newline at end of file
+}
+
+
+// Time in seconds before attract mode needs to run, negative if disabled
+float AttractMode::getNextUpdateTime()
+{
+    if(isActive_)
+    {
+        return 0;
+    }
+
+    if(idleTime > 0)
+    {
+        return (elapsedTime_ < idleTime) ? idleTime - elapsedTime_ : 0;
+    }
+
+    return -1;
+}
\ No newline at end of file
@@ -25,6 +25,7 @@ public:
     void update(float dt, Page &page);
     float idleTime;
     bool  isActive();
+    float getNextUpdateTime();
 
 private:
     bool isActive_;
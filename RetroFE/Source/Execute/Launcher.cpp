@@ -19,6 +19,8 @@
 #include "../Utility/Log.h"
 #include "../Database/Configuration.h"
 #include "../Utility/Utils.h"
+#include "../Utility/HelperExecutor.h"
+#include "../Sound/AmpController.h"
 #include "../RetroFE.h"
 #include "../SDL.h"
 #include <cstdlib>
@@ -125,10 +127,12 @@ bool Launcher::run(std::string collection, Item *collectionItem)
     cmd += " '" + selectedItemsPath + "'";
     Logger::write(Logger::ZONE_INFO, "Launcher", "Applying keymap rom: \"" + selectedItemsPath + "\"");
     printf("Applying keymap rom cmd: \"%s\"\n", cmd.c_str());
-    system(cmd.c_str());
+    HelperExecutor &helpers = HelperExecutor::getInstance();
+    helpers.run(cmd);
 
-    /* Restart audio amp */
-    system(SHELL_CMD_AUDIO_AMP_ON);
+    /* Restart audio amp, after any amp command still queued by the sounds */
+    AmpController::getInstance().reset();
+    RetroFE::runHelper(SHELL_CMD_AUDIO_AMP_ON);
 
     /* Execute game */
     if(!execute(executablePath, args, currentDirectory))
@@ -138,12 +142,12 @@ bool Launcher::run(std::string collection, Item *collectionItem)
     }
 
     /* Stop audio amp */
-    system(SHELL_CMD_AUDIO_AMP_OFF);
+    helpers.run(SHELL_CMD_AUDIO_AMP_OFF);
 
     /* Restore default keymap */
     Logger::write(Logger::ZONE_INFO, "Launcher", "Applying keymap default");
     printf("Applying keymap default cmd: \"%s\"\n", SHELL_CMD_MAPPING_DEFAULT);
-    system(SHELL_CMD_MAPPING_DEFAULT);
+    RetroFE::runHelper(SHELL_CMD_MAPPING_DEFAULT);
 
     /* Restore retrofe PID */
     char shellCmd[20];
@@ -219,7 +223,7 @@ bool Launcher::execute(std::string executable, std::string args, std::string cur
         std::string applicationName = executable.substr(last_slash_idx + 1);
         executionString = "cd \"" + currentDirectory + "\" && exec \"./" + applicationName + "\" " + args;
     }
-    if(system(executionString.c_str()) != 0)
+    if(RetroFE::runProcess(executionString) != 0)
 #endif
     {
         Logger::write(Logger::ZONE_ERROR, "Launcher", "Failed to run: " + executable);
@@ -0,0 +1,344 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "AlphaBlit.h"
+#include "PixelBlend.h"
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define ALPHABLIT_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ALPHABLIT_NEON
+#endif
+
+// x / 255 rounded to nearest, exact for x up to 255 * 255
+static inline unsigned int div255(unsigned int x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+#if defined(ALPHABLIT_SSE2)
+static inline __m128i div255(__m128i x)
+{
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+#elif defined(ALPHABLIT_NEON)
+static inline uint8x8_t div255(uint16x8_t x)
+{
+    x = vaddq_u16(x, vdupq_n_u16(128));
+    return vshrn_n_u16(vsraq_n_u16(x, x, 8), 8);
+}
+#endif
+
+
+// Opaque when every pixel has full alpha, binary when the others have none
+AlphaBlit::AlphaClass AlphaBlit::classify(const uint32_t *pixels, int width, int height, int pitch, int aShift)
+{
+    bool transparent = false;
+
+    for(int y = 0; y < height; ++y)
+    {
+        const uint32_t *row = reinterpret_cast<const uint32_t *>(reinterpret_cast<const uint8_t *>(pixels) + y * pitch);
+        for(int x = 0; x < width; ++x)
+        {
+            unsigned int a = (row[x] >> aShift) & 0xff;
+            if(a == 0)
+            {
+                transparent = true;
+            }
+            else if(a != 255)
+            {
+                return ALPHA_TRANSLUCENT;
+            }
+        }
+    }
+
+    return transparent ? ALPHA_BINARY : ALPHA_OPAQUE;
+}
+
+
+// Multiplies the colors by their alpha, moving the channels from one
+// layout to the other on the way
+void AlphaBlit::premultiply(const uint32_t *src, const Layout &from, uint32_t *dst, const Layout &to, int count)
+{
+    for(int i = 0; i < count; ++i)
+    {
+        uint32_t p = src[i];
+        unsigned int a = (p >> from.aShift) & 0xff;
+        unsigned int r = div255(((p >> from.rShift) & 0xff) * a);
+        unsigned int g = div255(((p >> from.gShift) & 0xff) * a);
+        unsigned int b = div255(((p >> from.bShift) & 0xff) * a);
+
+        dst[i] = (r << to.rShift) | (g << to.gShift) | (b << to.bShift) | (a << to.aShift);
+    }
+}
+
+
+// Writes the key over the transparent pixels of a binary alpha texture,
+// alphaPixels being the texture and pixels its opaque conversion. Nothing
+// is written, and false returned, when a visible pixel has the key color.
+bool AlphaBlit::applyColorKey(const uint32_t *alphaPixels, int alphaPitch, int aShift,
+                              void *pixels, int pitch, int bytesPerPixel, int width, int height,
+                              uint32_t key, uint32_t keyMask)
+{
+    for(int pass = 0; pass < 2; ++pass)
+    {
+        for(int y = 0; y < height; ++y)
+        {
+            const uint32_t *alpha = reinterpret_cast<const uint32_t *>(reinterpret_cast<const uint8_t *>(alphaPixels) + y * alphaPitch);
+            uint8_t *row = static_cast<uint8_t *>(pixels) + y * pitch;
+
+            for(int x = 0; x < width; ++x)
+            {
+                bool visible = ((alpha[x] >> aShift) & 0xff) != 0;
+                if(pass == 0)
+                {
+                    uint32_t p = bytesPerPixel == 2 ? reinterpret_cast<uint16_t *>(row)[x] : reinterpret_cast<uint32_t *>(row)[x];
+                    if(visible && (p & keyMask) == key)
+                    {
+                        return false;
+                    }
+                }
+                else if(!visible)
+                {
+                    if(bytesPerPixel == 2)
+                    {
+                        reinterpret_cast<uint16_t *>(row)[x] = static_cast<uint16_t>(key);
+                    }
+                    else
+                    {
+                        reinterpret_cast<uint32_t *>(row)[x] = key;
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+
+// Reference implementation of the constant alpha blend of an opaque source
+void AlphaBlit::blendConstantScalar(uint32_t *dst, const uint32_t *src, int count, uint8_t globalAlpha)
+{
+    unsigned int inv = 255 - globalAlpha;
+
+    for(int i = 0; i < count; ++i)
+    {
+        uint32_t s = src[i];
+        uint32_t d = dst[i];
+        uint32_t out = 0;
+        for(int shift = 0; shift < 32; shift += 8)
+        {
+            out |= div255(((s >> shift) & 0xff) * globalAlpha + ((d >> shift) & 0xff) * inv) << shift;
+        }
+        dst[i] = out;
+    }
+}
+
+
+void AlphaBlit::blendConstant(uint32_t *dst, const uint32_t *src, int count, uint8_t globalAlpha)
+{
+    if(globalAlpha == 255)
+    {
+        memcpy(dst, src, count * sizeof(uint32_t));
+        return;
+    }
+    if(globalAlpha == 0)
+    {
+        return;
+    }
+
+    int i = 0;
+
+#if defined(ALPHABLIT_SSE2)
+    const __m128i global = _mm_set1_epi16(globalAlpha);
+    const __m128i inv    = _mm_set1_epi16(255 - globalAlpha);
+    const __m128i zero   = _mm_setzero_si128();
+
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), global),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inv));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), global),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inv));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(div255(lo), div255(hi)));
+    }
+#elif defined(ALPHABLIT_NEON)
+    const uint8x8_t global = vdup_n_u8(globalAlpha);
+    const uint8x8_t inv    = vdup_n_u8(255 - globalAlpha);
+
+    for(; i + 8 <= count; i += 8)
+    {
+        uint8x8x4_t s = vld4_u8(reinterpret_cast<const uint8_t *>(src + i));
+        uint8x8x4_t d = vld4_u8(reinterpret_cast<const uint8_t *>(dst + i));
+
+        for(int c = 0; c < 4; ++c)
+        {
+            d.val[c] = div255(vmlal_u8(vmull_u8(s.val[c], global), d.val[c], inv));
+        }
+
+        vst4_u8(reinterpret_cast<uint8_t *>(dst + i), d);
+    }
+#endif
+
+    blendConstantScalar(dst + i, src + i, count - i, globalAlpha);
+}
+
+
+// Copies or blends the runs of pixels that are not the key, a 16-bit
+// source being RGB565
+void AlphaBlit::blendKeyed(void *dst, const void *src, int count, int bytesPerPixel,
+                           uint32_t key, uint32_t keyMask, uint8_t globalAlpha)
+{
+    const uint16_t *src16 = static_cast<const uint16_t *>(src);
+    const uint32_t *src32 = static_cast<const uint32_t *>(src);
+    int i = 0;
+
+    while(i < count)
+    {
+        if(bytesPerPixel == 2)
+        {
+            while(i < count && (src16[i] & keyMask) == key) ++i;
+        }
+        else
+        {
+            while(i < count && (src32[i] & keyMask) == key) ++i;
+        }
+
+        int start = i;
+        if(bytesPerPixel == 2)
+        {
+            while(i < count && (src16[i] & keyMask) != key) ++i;
+            PixelBlend::blendRgb565A8(static_cast<uint16_t *>(dst) + start, src16 + start, NULL, i - start, globalAlpha);
+        }
+        else
+        {
+            while(i < count && (src32[i] & keyMask) != key) ++i;
+            blendConstant(static_cast<uint32_t *>(dst) + start, src32 + start, i - start, globalAlpha);
+        }
+    }
+}
+
+
+// Reference implementation of the premultiplied blend
+void AlphaBlit::blendPremultipliedScalar(uint32_t *dst, const uint32_t *src, int count, int aShift, uint8_t globalAlpha)
+{
+    for(int i = 0; i < count; ++i)
+    {
+        uint32_t s = src[i];
+        uint32_t d = dst[i];
+        unsigned int inv = 255 - div255(((s >> aShift) & 0xff) * globalAlpha);
+        uint32_t out = 0;
+        for(int shift = 0; shift < 32; shift += 8)
+        {
+            unsigned int c = div255(((s >> shift) & 0xff) * globalAlpha) + div255(((d >> shift) & 0xff) * inv);
+            out |= (c > 255 ? 255 : c) << shift;
+        }
+        dst[i] = out;
+    }
+}
+
+
+void AlphaBlit::blendPremultiplied(uint32_t *dst, const uint32_t *src, int count, int aShift, uint8_t globalAlpha)
+{
+    if(globalAlpha == 0)
+    {
+        return;
+    }
+
+    int i = 0;
+
+#if defined(ALPHABLIT_SSE2)
+    const __m128i global = _mm_set1_epi16(globalAlpha);
+    const __m128i full   = _mm_set1_epi16(255);
+    const __m128i mask   = _mm_set1_epi32(0xff);
+    const __m128i shift  = _mm_cvtsi32_si128(aShift);
+    const __m128i zero   = _mm_setzero_si128();
+    const bool    scaled = globalAlpha != 255;
+
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+
+        // Scaled alpha of each pixel, repeated over its four channels
+        __m128i a = div255(_mm_mullo_epi16(_mm_and_si128(_mm_srl_epi32(s, shift), mask), global));
+        __m128i inv = _mm_sub_epi16(full, _mm_or_si128(a, _mm_slli_epi32(a, 16)));
+
+        __m128i sLo = _mm_unpacklo_epi8(s, zero);
+        __m128i sHi = _mm_unpackhi_epi8(s, zero);
+        if(scaled)
+        {
+            sLo = div255(_mm_mullo_epi16(sLo, global));
+            sHi = div255(_mm_mullo_epi16(sHi, global));
+        }
+
+        __m128i lo = _mm_add_epi16(sLo, div255(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi32(inv, inv))));
+        __m128i hi = _mm_add_epi16(sHi, div255(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi32(inv, inv))));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#elif defined(ALPHABLIT_NEON)
+    const uint8x8_t global = vdup_n_u8(globalAlpha);
+    const uint8x8_t full   = vdup_n_u8(255);
+    const int       alpha  = aShift / 8;
+    const bool      scaled = globalAlpha != 255;
+
+    for(; i + 8 <= count; i += 8)
+    {
+        uint8x8x4_t s = vld4_u8(reinterpret_cast<const uint8_t *>(src + i));
+        uint8x8x4_t d = vld4_u8(reinterpret_cast<const uint8_t *>(dst + i));
+
+        if(scaled)
+        {
+            for(int c = 0; c < 4; ++c)
+            {
+                s.val[c] = div255(vmull_u8(s.val[c], global));
+            }
+        }
+
+        uint8x8_t inv = vsub_u8(full, s.val[alpha]);
+        for(int c = 0; c < 4; ++c)
+        {
+            d.val[c] = vqadd_u8(s.val[c], div255(vmull_u8(d.val[c], inv)));
+        }
+
+        vst4_u8(reinterpret_cast<uint8_t *>(dst + i), d);
+    }
+#endif
+
+    blendPremultipliedScalar(dst + i, src + i, count - i, aShift, globalAlpha);
+}
+
+
+const char *AlphaBlit::getKernelName()
+{
+#if defined(ALPHABLIT_SSE2)
+    return "sse2";
+#elif defined(ALPHABLIT_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,61 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+
+// Blitters for textures sorted at load time by how they use alpha. Opaque
+// textures are copied row by row, binary alpha ones skip their colour key
+// and translucent ones are kept premultiplied, so the blend needs no
+// division and the global alpha is folded into the same multiply.
+//
+// Channels are 8 bits at the shifts of a Layout, in 32-bit pixels. The
+// blends round like the division by 255 they stand for:
+//   constant:      out = (src * g + dst * (255 - g)) / 255
+//   premultiplied: s = src * g / 255, out = s + dst * (255 - s.alpha) / 255
+// Every variant computes exactly this, the vector kernels only process
+// several pixels at once.
+class AlphaBlit
+{
+public:
+    enum AlphaClass
+    {
+        ALPHA_OPAQUE,
+        ALPHA_BINARY,
+        ALPHA_TRANSLUCENT
+    };
+
+    struct Layout
+    {
+        int rShift;
+        int gShift;
+        int bShift;
+        int aShift;
+    };
+
+    static AlphaClass classify(const uint32_t *pixels, int width, int height, int pitch, int aShift);
+    static void premultiply(const uint32_t *src, const Layout &from, uint32_t *dst, const Layout &to, int count);
+    static bool applyColorKey(const uint32_t *alphaPixels, int alphaPitch, int aShift,
+                              void *pixels, int pitch, int bytesPerPixel, int width, int height,
+                              uint32_t key, uint32_t keyMask);
+    static void blendConstant(uint32_t *dst, const uint32_t *src, int count, uint8_t globalAlpha);
+    static void blendConstantScalar(uint32_t *dst, const uint32_t *src, int count, uint8_t globalAlpha);
+    static void blendKeyed(void *dst, const void *src, int count, int bytesPerPixel,
+                           uint32_t key, uint32_t keyMask, uint8_t globalAlpha);
+    static void blendPremultiplied(uint32_t *dst, const uint32_t *src, int count, int aShift, uint8_t globalAlpha);
+    static void blendPremultipliedScalar(uint32_t *dst, const uint32_t *src, int count, int aShift, uint8_t globalAlpha);
+    static const char *getKernelName();
+};
@@ -70,6 +70,29 @@ void AnimationEvents::setAnimation(std::string tween, int index, Animation *anim
     animationMap_[tween][index] = animation;
 }
 
+// Raises value to the largest one any animation takes the property to
+void AnimationEvents::getLargest(TweenProperty property, float &value)
+{
+    for(std::map<std::string, std::map<int, Animation *> >::iterator it = animationMap_.begin(); it != animationMap_.end(); it++)
+    {
+        for(std::map<int, Animation *>::iterator it2 = (it->second).begin(); it2 != (it->second).end(); it2++)
+        {
+            Animation *animation = it2->second;
+            for(unsigned int i = 0; animation && i < animation->size(); i++)
+            {
+                TweenSet *set = animation->tweenSet(i);
+                for(unsigned int j = 0; j < set->size(); j++)
+                {
+                    Tween *tween = set->getTween(j);
+                    if(tween->property != property) continue;
+                    if(tween->startDefined && tween->getStart() > value) value = static_cast<float>(tween->getStart());
+                    if(tween->getEnd() > value) value = static_cast<float>(tween->getEnd());
+                }
+            }
+        }
+    }
+}
+
 void AnimationEvents::clear()
 {
     std::map<std::string, std::map<int, Animation *> >::iterator it = animationMap_.begin();
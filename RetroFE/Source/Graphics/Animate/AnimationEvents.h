@@ -31,6 +31,7 @@ public:
     Animation *getAnimation(std::string tween);
     Animation *getAnimation(std::string tween, int index);
     void setAnimation(std::string tween, int index, Animation *animation);
+    void getLargest(TweenProperty property, float &value);
     void clear();
 
 private:
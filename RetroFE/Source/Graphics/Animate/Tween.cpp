@@ -19,9 +19,41 @@
 #include <math.h>
 #include <string>
 
+// Number of intervals of the single precision easing tables
+#define EASING_LUT_SIZE 256
+
 std::map<std::string, TweenAlgorithm> Tween::tweenTypeMap_;
 std::map<std::string, TweenProperty> Tween::tweenPropertyMap_;
 
+// sin(x * pi/2) and 2^(10 * (x - 1)) sampled over [0, 1]
+static float sineLut_[EASING_LUT_SIZE + 1];
+static float exponentialLut_[EASING_LUT_SIZE + 1];
+
+static bool initializeEasingLuts()
+{
+    for(int i = 0; i <= EASING_LUT_SIZE; i++)
+    {
+        double x = static_cast<double>(i) / EASING_LUT_SIZE;
+        sineLut_[i]        = static_cast<float>(sin(x * M_PI / 2));
+        exponentialLut_[i] = static_cast<float>(pow(2, 10 * (x - 1)));
+    }
+    return true;
+}
+
+static bool easingLutsInitialized_ = initializeEasingLuts();
+
+// Linear interpolation in a table, x in [0, 1]
+static inline float lookup(const float *lut, float x)
+{
+    float position = x * EASING_LUT_SIZE;
+    int   index    = static_cast<int>(position);
+
+    if(index >= EASING_LUT_SIZE) return lut[EASING_LUT_SIZE];
+    if(index < 0) return lut[0];
+
+    return lut[index] + (lut[index + 1] - lut[index]) * (position - index);
+}
+
 Tween::Tween(TweenProperty property, TweenAlgorithm type, double start, double end, double duration)
     : property(property)
     , duration(duration)
@@ -123,6 +155,10 @@ double Tween::getEnd( ){
 	return end;
 }
 
+TweenAlgorithm Tween::getType( ){
+	return type;
+}
+
 float Tween::animate(double elapsedTime)
 {
     return animateSingle(type, start, end, duration, elapsedTime);
@@ -138,8 +174,17 @@ float Tween::animate(double elapsedTime, double startValue, double endValue, dou
     return animateSingle(type, startValue, endValue, durationValue, elapsedTime);
 }
 
-//todo: SDL likes floats, consider having casting being performed elsewhere
 float Tween::animateSingle(TweenAlgorithm type, double start, double end, double duration, double elapsedTime)
+{
+#ifdef TWEEN_FLOAT_EASING
+    return animateFloat(type, static_cast<float>(start), static_cast<float>(end), static_cast<float>(duration), static_cast<float>(elapsedTime));
+#else
+    return animateDouble(type, start, end, duration, elapsedTime);
+#endif
+}
+
+//todo: SDL likes floats, consider having casting being performed elsewhere
+float Tween::animateDouble(TweenAlgorithm type, double start, double end, double duration, double elapsedTime)
 {
     double a = start;
     double b = end - start;
@@ -241,6 +286,128 @@ float Tween::animateSingle(TweenAlgorithm type, double start, double end, double
 
 }
 
+// Single precision variant: the sine and exponential curves come from tables,
+// the circular ones use sqrtf, which is a single instruction on our targets
+float Tween::animateFloat(TweenAlgorithm type, float start, float end, float duration, float elapsedTime)
+{
+    if(duration <= 0) return start;
+
+    float t = elapsedTime / duration;
+    if(t < 0) t = 0;
+    if(t > 1) t = 1;
+
+    return start + (end - start) * ease(type, t);
+}
+
+// Eased progress for a normalised time t in [0, 1]
+static inline float easeProgress(TweenAlgorithm type, float t)
+{
+    float s;
+
+    switch(type)
+    {
+    case EASE_IN_QUADRATIC:
+        return t*t;
+
+    case EASE_OUT_QUADRATIC:
+        return -t*(t-2);
+
+    case EASE_INOUT_QUADRATIC:
+        t *= 2;
+        if (t < 1) return 0.5f*t*t;
+        t--;
+        return -0.5f * (t*(t-2) - 1);
+
+    case EASE_IN_CUBIC:
+        return t*t*t;
+
+    case EASE_OUT_CUBIC:
+        t--;
+        return t*t*t + 1;
+
+    case EASE_INOUT_CUBIC:
+        t *= 2;
+        if (t < 1) return 0.5f*t*t*t;
+        t -= 2;
+        return 0.5f*(t*t*t + 2);
+
+    case EASE_IN_QUARTIC:
+        return t*t*t*t;
+
+    case EASE_OUT_QUARTIC:
+        t--;
+        return -(t*t*t*t - 1);
+
+    case EASE_INOUT_QUARTIC:
+        t *= 2;
+        if (t < 1) return 0.5f*t*t*t*t;
+        t -= 2;
+        return -0.5f * (t*t*t*t - 2);
+
+    case EASE_IN_QUINTIC:
+        return t*t*t*t*t;
+
+    case EASE_OUT_QUINTIC:
+        t--;
+        return t*t*t*t*t + 1;
+
+    case EASE_INOUT_QUINTIC:
+        t *= 2;
+        if (t < 1) return 0.5f*t*t*t*t*t;
+        t -= 2;
+        return 0.5f*(t*t*t*t*t + 2);
+
+    case EASE_IN_SINE:
+        // 1 - cos(t * pi/2) == 1 - sin((1 - t) * pi/2)
+        return 1 - lookup(sineLut_, 1 - t);
+
+    case EASE_OUT_SINE:
+        return lookup(sineLut_, t);
+
+    case EASE_INOUT_SINE:
+        // cos(t * pi) == sin((1 - 2t) * pi/2)
+        s = (t <= 0.5f) ? lookup(sineLut_, 1 - 2*t) : -lookup(sineLut_, 2*t - 1);
+        return 0.5f * (1 - s);
+
+    case EASE_IN_EXPONENTIAL:
+        return lookup(exponentialLut_, t);
+
+    case EASE_OUT_EXPONENTIAL:
+        // 2^(-10t) == 2^(10 * ((1 - t) - 1))
+        return 1 - lookup(exponentialLut_, 1 - t);
+
+    case EASE_INOUT_EXPONENTIAL:
+        t *= 2;
+        if (t < 1) return 0.5f * lookup(exponentialLut_, t);
+        t--;
+        return 0.5f * (2 - lookup(exponentialLut_, 1 - t));
+
+    case EASE_IN_CIRCULAR:
+        s = 1 - t*t;
+        return 1 - sqrtf(s > 0 ? s : 0);
+
+    case EASE_OUT_CIRCULAR:
+        t--;
+        s = 1 - t*t;
+        return sqrtf(s > 0 ? s : 0);
+
+    case EASE_INOUT_CIRCULAR:
+        t *= 2;
+        if (t < 1)
+        {
+            s = 1 - t*t;
+            return -0.5f * (sqrtf(s > 0 ? s : 0) - 1);
+        }
+        t -= 2;
+        s = 1 - t*t;
+        return 0.5f * (sqrtf(s > 0 ? s : 0) + 1);
+
+    case LINEAR:
+    default:
+        return t;
+    }
+}
+
 double Tween::linear(double t, double d, double b, double c)
 {
     if(d == 0) return b;
@@ -397,3 +564,51 @@ double Tween::easeInOutCircular(double t, double d, double b, double c)
     t -= 2;
     return c/2 * (sqrt(1 - t*t) + 1) + b;
 }
+
+
+float Tween::ease(TweenAlgorithm type, float t)
+{
+    return easeProgress(type, t);
+}
+
+
+// One loop per algorithm so the switch above folds away
+template<TweenAlgorithm type>
+static void easeLane(const float *t, float *progress, unsigned int count)
+{
+    for(unsigned int i = 0; i < count; i++)
+    {
+        progress[i] = easeProgress(type, t[i]);
+    }
+}
+
+
+void Tween::ease(TweenAlgorithm type, const float *t, float *progress, unsigned int count)
+{
+    switch(type)
+    {
+    case EASE_IN_QUADRATIC: easeLane<EASE_IN_QUADRATIC>(t, progress, count); break;
+    case EASE_OUT_QUADRATIC: easeLane<EASE_OUT_QUADRATIC>(t, progress, count); break;
+    case EASE_INOUT_QUADRATIC: easeLane<EASE_INOUT_QUADRATIC>(t, progress, count); break;
+    case EASE_IN_CUBIC: easeLane<EASE_IN_CUBIC>(t, progress, count); break;
+    case EASE_OUT_CUBIC: easeLane<EASE_OUT_CUBIC>(t, progress, count); break;
+    case EASE_INOUT_CUBIC: easeLane<EASE_INOUT_CUBIC>(t, progress, count); break;
+    case EASE_IN_QUARTIC: easeLane<EASE_IN_QUARTIC>(t, progress, count); break;
+    case EASE_OUT_QUARTIC: easeLane<EASE_OUT_QUARTIC>(t, progress, count); break;
+    case EASE_INOUT_QUARTIC: easeLane<EASE_INOUT_QUARTIC>(t, progress, count); break;
+    case EASE_IN_QUINTIC: easeLane<EASE_IN_QUINTIC>(t, progress, count); break;
+    case EASE_OUT_QUINTIC: easeLane<EASE_OUT_QUINTIC>(t, progress, count); break;
+    case EASE_INOUT_QUINTIC: easeLane<EASE_INOUT_QUINTIC>(t, progress, count); break;
+    case EASE_IN_SINE: easeLane<EASE_IN_SINE>(t, progress, count); break;
+    case EASE_OUT_SINE: easeLane<EASE_OUT_SINE>(t, progress, count); break;
+    case EASE_INOUT_SINE: easeLane<EASE_INOUT_SINE>(t, progress, count); break;
+    case EASE_IN_EXPONENTIAL: easeLane<EASE_IN_EXPONENTIAL>(t, progress, count); break;
+    case EASE_OUT_EXPONENTIAL: easeLane<EASE_OUT_EXPONENTIAL>(t, progress, count); break;
+    case EASE_INOUT_EXPONENTIAL: easeLane<EASE_INOUT_EXPONENTIAL>(t, progress, count); break;
+    case EASE_IN_CIRCULAR: easeLane<EASE_IN_CIRCULAR>(t, progress, count); break;
+    case EASE_OUT_CIRCULAR: easeLane<EASE_OUT_CIRCULAR>(t, progress, count); break;
+    case EASE_INOUT_CIRCULAR: easeLane<EASE_INOUT_CIRCULAR>(t, progress, count); break;
+    case LINEAR:
+    default:     easeLane<LINEAR>(t, progress, count); break;
+    }
+}
@@ -30,6 +30,10 @@ public:
     float animate(double elapsedTime, double startValue);
     float animate(double elapsedTime, double startValue, double endValue, double durationValue);
     static float animateSingle(TweenAlgorithm type, double start, double end, double duration, double elapsedTime);
+    static float animateDouble(TweenAlgorithm type, double start, double end, double duration, double elapsedTime);
+    static float animateFloat(TweenAlgorithm type, float start, float end, float duration, float elapsedTime);
+    static float ease(TweenAlgorithm type, float t);
+    static void ease(TweenAlgorithm type, const float *t, float *progress, unsigned int count);
     static TweenAlgorithm getTweenType(std::string name);
     static bool getTweenProperty(std::string name, TweenProperty &property);
     TweenProperty property;
@@ -37,6 +41,7 @@ public:
     bool   startDefined;
     double getStart( );
     double getEnd( );
+    TweenAlgorithm getType( );
 
 private:
     static double easeInQuadratic(double elapsedTime, double duration, double b, double c);
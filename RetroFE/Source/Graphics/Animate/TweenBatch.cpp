@@ -0,0 +1,304 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "TweenBatch.h"
+#include "Tween.h"
+#include "TweenSet.h"
+#include "../ViewInfo.h"
+
+TweenBatch::TweenBatch()
+    : size_(0)
+{
+}
+
+
+// Binds every tween of a set to its field of info. Tweens without a start value
+// begin at the value store had when the set started. Returns true if any of the
+// tweens depends on the menu scroll period or direction.
+bool TweenBatch::compile(TweenSet *tweens, ViewInfo &store, ViewInfo &info, std::vector<CompiledTween> &compiled)
+{
+    bool usesMenu = false;
+
+    compiled.clear();
+
+    for(unsigned int i = 0; i < tweens->size(); i++)
+    {
+        Tween *tween = tweens->getTween(i);
+        CompiledTween c;
+
+        c.type               = tween->getType();
+        c.start              = tween->getStart();
+        c.end                = tween->getEnd();
+        c.duration           = tween->duration;
+        c.shiftMenuDirection = false;
+        c.target             = NULL;
+        c.layer              = NULL;
+
+        switch(tween->property)
+        {
+        case TWEEN_PROPERTY_X:
+            c.target = &info.X;
+            if (!tween->startDefined) c.start = store.X;
+            break;
+
+        case TWEEN_PROPERTY_Y:
+            c.target = &info.Y;
+            if (!tween->startDefined) c.start = store.Y;
+            break;
+
+        case TWEEN_PROPERTY_HEIGHT:
+            c.target = &info.Height;
+            if (!tween->startDefined) c.start = store.Height;
+            break;
+
+        case TWEEN_PROPERTY_WIDTH:
+            c.target = &info.Width;
+            if (!tween->startDefined) c.start = store.Width;
+            break;
+
+        case TWEEN_PROPERTY_ANGLE:
+            c.target = &info.Angle;
+            if (!tween->startDefined) c.start = store.Angle;
+            break;
+
+        case TWEEN_PROPERTY_ALPHA:
+            c.target = &info.Alpha;
+            if (!tween->startDefined) c.start = store.Alpha;
+            break;
+
+        case TWEEN_PROPERTY_X_ORIGIN:
+            c.target = &info.XOrigin;
+            if (!tween->startDefined) c.start = store.XOrigin;
+            break;
+
+        case TWEEN_PROPERTY_Y_ORIGIN:
+            c.target = &info.YOrigin;
+            if (!tween->startDefined) c.start = store.YOrigin;
+            break;
+
+        case TWEEN_PROPERTY_X_OFFSET:
+            c.target = &info.XOffset;
+            if (!tween->startDefined) c.start = store.XOffset;
+            break;
+
+        case TWEEN_PROPERTY_Y_OFFSET:
+            c.target = &info.YOffset;
+            if (!tween->startDefined) c.start = store.YOffset;
+            break;
+
+        case TWEEN_PROPERTY_X_OFFSET_SHIFT_MENU_DIRECTION:
+            // starts from the stored Y offset, as it always did
+            c.target = &info.XOffset;
+            c.shiftMenuDirection = true;
+            if (!tween->startDefined) c.start = store.YOffset;
+            break;
+
+        case TWEEN_PROPERTY_Y_OFFSET_SHIFT_MENU_DIRECTION:
+            c.target = &info.YOffset;
+            c.shiftMenuDirection = true;
+            if (!tween->startDefined) c.start = store.YOffset;
+            break;
+
+        case TWEEN_PROPERTY_FONT_SIZE:
+            c.target = &info.FontSize;
+            if (!tween->startDefined) c.start = store.FontSize;
+            break;
+
+        case TWEEN_PROPERTY_BACKGROUND_ALPHA:
+            c.target = &info.BackgroundAlpha;
+            if (!tween->startDefined) c.start = store.BackgroundAlpha;
+            break;
+
+        case TWEEN_PROPERTY_MAX_WIDTH:
+            c.target = &info.MaxWidth;
+            if (!tween->startDefined) c.start = store.MaxWidth;
+            break;
+
+        case TWEEN_PROPERTY_MAX_HEIGHT:
+            c.target = &info.MaxHeight;
+            if (!tween->startDefined) c.start = store.MaxHeight;
+            break;
+
+        case TWEEN_PROPERTY_LAYER:
+            c.layer = &info.Layer;
+            if (!tween->startDefined) c.start = store.Layer;
+            break;
+
+        case TWEEN_PROPERTY_CONTAINER_X:
+            c.target = &info.ContainerX;
+            if (!tween->startDefined) c.start = store.ContainerX;
+            break;
+
+        case TWEEN_PROPERTY_CONTAINER_Y:
+            c.target = &info.ContainerY;
+            if (!tween->startDefined) c.start = store.ContainerY;
+            break;
+
+        case TWEEN_PROPERTY_CONTAINER_WIDTH:
+            c.target = &info.ContainerWidth;
+            if (!tween->startDefined) c.start = store.ContainerWidth;
+            break;
+
+        case TWEEN_PROPERTY_CONTAINER_HEIGHT:
+            c.target = &info.ContainerHeight;
+            if (!tween->startDefined) c.start = store.ContainerHeight;
+            break;
+
+        case TWEEN_PROPERTY_NOP:
+            break;
+        }
+
+        if(c.duration == 0 || c.shiftMenuDirection)
+        {
+            usesMenu = true;
+        }
+
+        // a NOP still delays the end of the set
+        compiled.push_back(c);
+    }
+
+    return usesMenu;
+}
+
+
+// Queues the tweens of one set at elapsedTime into batch, and returns true once
+// all of them reached their end. A finished set, or one scheduled without a
+// batch, is written right away so the caller can store the final values.
+bool TweenBatch::schedule(std::vector<CompiledTween> &compiled, float elapsedTweenTime, double scrollPeriod, bool scrollForward, TweenBatch *batch)
+{
+    bool done = true;
+
+    for(unsigned int i = 0; i < compiled.size(); i++)
+    {
+        double duration = compiled[i].duration ? compiled[i].duration : scrollPeriod;
+        if(elapsedTweenTime < duration)
+        {
+            done = false;
+        }
+    }
+
+    for(unsigned int i = 0; i < compiled.size(); i++)
+    {
+        CompiledTween &c = compiled[i];
+        double elapsedTime = elapsedTweenTime;
+        double duration = c.duration ? c.duration : scrollPeriod;
+        double start = c.start;
+        double end = c.end;
+
+        if(elapsedTime >= duration)
+        {
+            elapsedTime = static_cast<float>(duration);
+        }
+
+        if(c.shiftMenuDirection)
+        {
+            end = start + c.end * (static_cast<double>(scrollForward ? -1.0f : 1.0f));
+        }
+        else
+        {
+            // only the menu shifts evaluate with the scroll period
+            duration = c.duration;
+        }
+
+        if(c.layer)
+        {
+            *c.layer = static_cast<unsigned int>(Tween::animateSingle(c.type, start, end, duration, elapsedTime));
+        }
+        else if(c.target)
+        {
+            if(batch && !done)
+            {
+                batch->add(c.type, static_cast<TweenValue>(start), static_cast<TweenValue>(end),
+                           static_cast<TweenValue>(duration), static_cast<TweenValue>(elapsedTime), c.target);
+            }
+            else
+            {
+                *c.target = Tween::animateSingle(c.type, start, end, duration, elapsedTime);
+            }
+        }
+    }
+
+    return done;
+}
+
+
+void TweenBatch::add(TweenAlgorithm type, TweenValue start, TweenValue end, TweenValue duration, TweenValue elapsedTime, float *target)
+{
+    Lane &lane = lanes_[(type < ALGORITHMS) ? type : LINEAR];
+
+    lane.start.push_back(start);
+    lane.end.push_back(end);
+    lane.duration.push_back(duration);
+    lane.elapsed.push_back(elapsedTime);
+    lane.target.push_back(target);
+    size_++;
+}
+
+
+// Writes every queued tween to its target and empties the batch
+void TweenBatch::evaluate()
+{
+    if(size_ == 0) return;
+
+    for(unsigned int algorithm = 0; algorithm < ALGORITHMS; algorithm++)
+    {
+        Lane &lane = lanes_[algorithm];
+        TweenAlgorithm type = static_cast<TweenAlgorithm>(algorithm);
+        unsigned int count = lane.target.size();
+
+        if(count == 0) continue;
+
+#ifdef TWEEN_FLOAT_EASING
+        // same arithmetic as Tween::animateFloat
+        progress_.resize(count);
+        for(unsigned int i = 0; i < count; i++)
+        {
+            float t = (lane.duration[i] > 0) ? lane.elapsed[i] / lane.duration[i] : 0;
+            if(t < 0) t = 0;
+            if(t > 1) t = 1;
+            progress_[i] = t;
+        }
+
+        Tween::ease(type, &progress_[0], &progress_[0], count);
+
+        for(unsigned int i = 0; i < count; i++)
+        {
+            if(lane.duration[i] <= 0)
+                *lane.target[i] = lane.start[i];
+            else
+                *lane.target[i] = lane.start[i] + (lane.end[i] - lane.start[i]) * progress_[i];
+        }
+#else
+        for(unsigned int i = 0; i < count; i++)
+        {
+            *lane.target[i] = Tween::animateDouble(type, lane.start[i], lane.end[i], lane.duration[i], lane.elapsed[i]);
+        }
+#endif
+
+        lane.start.clear();
+        lane.end.clear();
+        lane.duration.clear();
+        lane.elapsed.clear();
+        lane.target.clear();
+    }
+
+    size_ = 0;
+}
+
+
+unsigned int TweenBatch::size()
+{
+    return size_;
+}
@@ -0,0 +1,69 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "TweenTypes.h"
+#include <vector>
+
+class TweenSet;
+class ViewInfo;
+
+#ifdef TWEEN_FLOAT_EASING
+typedef float TweenValue;
+#else
+typedef double TweenValue;
+#endif
+
+// A tween bound to the ViewInfo field it animates, with its start value resolved
+struct CompiledTween
+{
+    TweenAlgorithm type;
+    double         start;
+    double         end;
+    double         duration;           // 0 means the menu scroll period
+    bool           shiftMenuDirection; // end is relative to start, mirrored when scrolling forward
+    float         *target;
+    unsigned int  *layer;              // set instead of target for the layer property
+};
+
+// Tweens of all the components of a page, evaluated once per frame in one pass
+// per easing algorithm
+class TweenBatch
+{
+public:
+    TweenBatch();
+    static bool compile(TweenSet *tweens, ViewInfo &store, ViewInfo &info, std::vector<CompiledTween> &compiled);
+    static bool schedule(std::vector<CompiledTween> &compiled, float elapsedTime, double scrollPeriod, bool scrollForward, TweenBatch *batch);
+    void add(TweenAlgorithm type, TweenValue start, TweenValue end, TweenValue duration, TweenValue elapsedTime, float *target);
+    void evaluate();
+    unsigned int size();
+
+private:
+    static const unsigned int ALGORITHMS = EASE_INOUT_CIRCULAR + 1;
+
+    struct Lane
+    {
+        std::vector<TweenValue> start;
+        std::vector<TweenValue> end;
+        std::vector<TweenValue> duration;
+        std::vector<TweenValue> elapsed;
+        std::vector<float *>    target;
+    };
+
+    Lane lanes_[ALGORITHMS];
+    std::vector<float> progress_;
+    unsigned int size_;
+};
@@ -15,6 +15,11 @@
 #define BATTERY_BACK_COLOR 0x00000000
 #define BATTERY_FORE_COLOR 0xffffffff
 
+/* Icon buckets, the percentage ones are the filled width in pixels */
+#define BATTERY_BUCKET_NONE     -3
+#define BATTERY_BUCKET_CHARGING -2
+#define BATTERY_BUCKET_NO_BAT   -1
+
 static uint32_t batteryIcon [BATTERY_ICON_HEIGHT][BATTERY_ICON_WIDTH] = {
         {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
         {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
@@ -76,52 +81,37 @@ static uint32_t noBatIcon [NOBAT_ICON_HEIGHT][NOBAT_ICON_WIDTH] = {
         {0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}};
 
 
-/*Default value, reset with config*/
-std::string Battery::fileUsbConnected_ = "/sys/class/power_supply/axp20x-usb/present";
-std::string Battery::fileBatConnected_ = "/sys/class/power_supply/axp20x-battery/present";
-std::string Battery::fileBatCapacity_ = "/sys/class/power_supply/axp20x-battery/capacity";
-
-int 	Battery::last_id_ = 0;
-int 	Battery::percentage_ = 0;
-int 	Battery::prevPercentage_ = 0;
-int 	Battery::percentagePixelWidth_ = 0;
-int 	Battery::prevPercentagePixelWidth_ = 0;
-bool 	Battery::charging_ = false;
-bool 	Battery::prevCharging_ = false;
-bool 	Battery::noBat_ = false;
-bool 	Battery::prevNoBat_ = false;
-float 	Battery::currentWaitTime_ = 0.0f;
-bool 	Battery::mustRender_ = false;
-bool 	Battery::valuesReady_ = false;
-
-
 Battery::Battery(Page &p, Configuration &config, float reloadPeriod, SDL_Color fontColor, float scaleX, float scaleY)
     : Component(p)
-	, id_(last_id_)
 	, config_(config)
     , texture_(NULL)
     , texture_prescaled_(NULL)
-    , mustUpdate_(false)
-    , reloadPeriod_(reloadPeriod)
+    , fontColor_(0xff000000 | ((uint32_t)fontColor.b) << 16 | ((uint32_t)fontColor.g) << 8 | ((uint32_t)fontColor.r))
     , scaleX_(scaleX)
     , scaleY_(scaleY)
-    , fontColor_(0xff000000 | ((uint32_t)fontColor.b) << 16 | ((uint32_t)fontColor.g) << 8 | ((uint32_t)fontColor.r))
+    , reloadPeriod_(reloadPeriod)
+    , mustUpdate_(false)
+    , mustRender_(false)
+    , displayedBucket_(BATTERY_BUCKET_NONE)
+    , snapshot_(BatteryMonitor::getInstance().getSnapshot())
 {
-	last_id_++;
-
     allocateGraphicsMemory();
 
-    if( config_.propertyExists( "fileUsbConnected" ) ){
-        config_.getProperty( "fileUsbConnected", fileUsbConnected_ );
+    /* Default values are kept when not in the config */
+    BatteryMonitor &monitor = BatteryMonitor::getInstance();
+    std::string value;
+    if( config_.getProperty( "batterySysfsRoot", value ) ){
+        monitor.setRoot( value );
     }
-    if( config_.propertyExists( "fileBatConnected" ) ){
-        config_.getProperty( "fileBatConnected", fileBatConnected_ );
+    if( config_.getProperty( "fileUsbConnected", value ) ){
+        monitor.setFile( BatteryMonitor::FILE_USB_PRESENT, value );
     }
-    if( config_.propertyExists( "fileBatCapacity" ) ){
-        config_.getProperty( "fileBatCapacity", fileBatCapacity_ );
+    if( config_.getProperty( "fileBatConnected", value ) ){
+        monitor.setFile( BatteryMonitor::FILE_BATTERY_PRESENT, value );
+    }
+    if( config_.getProperty( "fileBatCapacity", value ) ){
+        monitor.setFile( BatteryMonitor::FILE_CAPACITY, value );
     }
-
-    //printf("battery init OK, fileUsbConnected_=%s, id=%d\n", fileUsbConnected_.c_str(), id_);
 }
 
 Battery::~Battery()
@@ -133,17 +123,15 @@ void Battery::freeGraphicsMemory()
 {
     Component::freeGraphicsMemory();
 
-    last_id_ = 0;
-
     SDL_LockMutex(SDL::getMutex());
     if (texture_ != NULL)
     {
-        SDL_FreeSurface(texture_);
+        SDL::freeSurface(texture_);
         texture_ = NULL;
     }
     if (texture_prescaled_ != NULL)
     {
-        SDL_FreeSurface(texture_prescaled_);
+        SDL::freeSurface(texture_prescaled_);
 	texture_prescaled_ = NULL;
     }
     SDL_UnlockMutex(SDL::getMutex());
@@ -172,7 +160,7 @@ void Battery::allocateGraphicsMemory()
         bmask = 0x00ff0000;
         amask = 0xff000000;
 #endif
-        texture_ = SDL_CreateRGBSurface(0, BATTERY_ICON_WIDTH, BATTERY_ICON_HEIGHT, 32, rmask, gmask, bmask, amask);
+        texture_ = SDL::createSurface(0, BATTERY_ICON_WIDTH, BATTERY_ICON_HEIGHT, 32, rmask, gmask, bmask, amask, "Battery");
         if (!texture_ )
         {
             printf("	Failed-> creating battery icon surface: %s\n", SDL_GetError());
@@ -181,7 +169,7 @@ void Battery::allocateGraphicsMemory()
 
         if (texture_ != NULL)
         {
-	    drawBatteryPercent();
+	    drawBatteryPercent(0);
 
 	    //SDL_SetAlpha(texture_, SDL_SRCALPHA, 255);
 
@@ -198,7 +186,7 @@ void Battery::allocateGraphicsMemory()
 	mustUpdate_ = true;
 }
 
-void Battery::drawBatteryPercent()
+void Battery::drawBatteryPercent(int pixelWidth)
 {
     int i, j;
 
@@ -221,7 +209,7 @@ void Battery::drawBatteryPercent()
 	        uint32_t *currentPixel = texturePixels +
 		  (BATTERY_ICON_WIDTH)*(i+BATTERY_FILL_REGION_OFFSET_Y) +
 		  (j+BATTERY_FILL_REGION_OFFSET_X);
-		*currentPixel = (j <= percentagePixelWidth_) ? fontColor_ : BATTERY_BACK_COLOR;
+		*currentPixel = (j <= pixelWidth) ? fontColor_ : BATTERY_BACK_COLOR;
 	    }
         }
 
@@ -231,7 +219,7 @@ void Battery::drawBatteryPercent()
         /* Free pre-scaled textured to force recomputing */
         if (texture_prescaled_ != NULL)
         {
-	    SDL_FreeSurface(texture_prescaled_);
+	    SDL::freeSurface(texture_prescaled_);
 	    texture_prescaled_ = NULL;
         }
 
@@ -266,7 +254,7 @@ void Battery::drawNoBattery()
         /* Free pre-scaled textured to force recomputing */
         if (texture_prescaled_ != NULL)
         {
-	    SDL_FreeSurface(texture_prescaled_);
+	    SDL::freeSurface(texture_prescaled_);
 	    texture_prescaled_ = NULL;
         }
 
@@ -301,7 +289,7 @@ void Battery::drawBatteryCharging()
         /* Free pre-scaled textured to force recomputing */
         if (texture_prescaled_ != NULL)
         {
-	    SDL_FreeSurface(texture_prescaled_);
+	    SDL::freeSurface(texture_prescaled_);
 	    texture_prescaled_ = NULL;
         }
 
@@ -313,110 +301,57 @@ void Battery::drawBatteryCharging()
 
 }
 
-int Battery::readFileValue(std::string file){
+/* Icon showing the current snapshot */
+int Battery::getBucket(){
 
-	std::ifstream ifs(file.c_str());
-    std::string line;
-    int retVal = -1;
-
-	if (!ifs.is_open())
-	{
-		Logger::write(Logger::ZONE_ERROR, "Configuration", "Could not open " + file + "\"");
-		return -1;
+	if(!snapshot_->batteryConnected){
+		return BATTERY_BUCKET_NO_BAT;
 	}
-
-	while (std::getline (ifs, line))
-	{
-		retVal = atoi(line.c_str());
+	if(snapshot_->usbConnected){
+		return BATTERY_BUCKET_CHARGING;
 	}
-
-	ifs.close();
-
-	return retVal;
+	return snapshot_->percentage * BATTERY_FILL_REGION_OFFSET_WIDTH / 100;
 }
 
 bool Battery::isBatConnected(){
 
-	int res = readFileValue(fileBatConnected_);
-	//printf("%s: %d \n", __func__, res);
-
-	return (res==1)?true:false;
+	return snapshot_->batteryConnected;
 }
 
 bool Battery::isUsbConnected(){
 
-	int res = readFileValue(fileUsbConnected_);
-	//printf("%s: %d \n", __func__, res);
-
-	return (res==1)?true:false;
+	return snapshot_->usbConnected;
 }
 
 int Battery::getBatPercent(){
 
-	int res = readFileValue(fileBatCapacity_);
-	//printf("%s: %d \n", __func__, res);
-
-	return res;
+	return snapshot_->percentage;
 }
 
 void Battery::update(float dt)
 {
-	//printf("battery update, id=%d\n", id_);
-	/** Only 1st battery component id really performs update process */
-	if(id_==0){
-	    if (currentWaitTime_ < reloadPeriod_)
-	    {
-	        currentWaitTime_ += dt;
-	    }
-	    else
-	    {
-	        prevPercentage_ = percentage_;
-		prevNoBat_ = noBat_;
-		prevCharging_ = charging_;
-
-		percentage_ = getBatPercent();
-		noBat_ = !isBatConnected();
-		charging_ = isUsbConnected();
-
-		/** rescale battery values */
-		percentagePixelWidth_ = percentage_ * BATTERY_FILL_REGION_OFFSET_WIDTH / 100;
-		prevPercentagePixelWidth_ = prevPercentage_ * BATTERY_FILL_REGION_OFFSET_WIDTH / 100;
-
-		valuesReady_ = true;
-		currentWaitTime_ = 0.0f;
-	    }
-	}
+	/* Values are read by the monitor shared with the other battery components */
+	BatteryMonitor &monitor = BatteryMonitor::getInstance();
+	monitor.refresh(reloadPeriod_);
+	snapshot_ = monitor.getSnapshot();
 
-	/* Redraw icon if necessary */
-	bool stateChange = ((prevNoBat_ != noBat_) || (prevCharging_ != charging_) || (percentagePixelWidth_ != prevPercentagePixelWidth_));
+	/* Redraw icon only if the displayed bucket changed */
+	int bucket = getBucket();
 
-	if(stateChange || mustUpdate_){
-	    if(noBat_){
+	if(snapshot_->valid && (bucket != displayedBucket_ || mustUpdate_)){
+	    if(bucket == BATTERY_BUCKET_NO_BAT){
 	        drawNoBattery();
 	    }
-	    else if(charging_){
+	    else if(bucket == BATTERY_BUCKET_CHARGING){
 	        drawBatteryCharging();
 	    }
 	    else{
-	        drawBatteryPercent();
-	    }
-
-	    /** Reset values*/
-	    /** Only last battery component id really can reset values (once all others are sure to be redrawn) */
-	    if(id_==last_id_-1){
-	        if(prevPercentage_ != percentage_)
-		    {prevPercentage_ = percentage_;}
-		if(prevPercentagePixelWidth_ != percentagePixelWidth_)
-		    {prevPercentagePixelWidth_ = percentagePixelWidth_;}
-		if(prevNoBat_ != noBat_)
-		    {prevNoBat_ = noBat_;}
-		if(prevCharging_ != charging_)
-		    {prevCharging_ = charging_;}
+	        drawBatteryPercent(bucket);
 	    }
+	    displayedBucket_ = bucket;
+	    mustUpdate_ = false;
 	}
 
-    mustUpdate_ = false;
-
     Component::update(dt);
 }
 
@@ -429,7 +364,7 @@ void Battery::draw()
 
     Component::draw();
 
-    if(texture_ && valuesReady_ && baseViewInfo.Alpha > 0.0f )
+    if(texture_ && snapshot_->valid && baseViewInfo.Alpha > 0.0f )
     {
         SDL_Rect rect;
         rect.x = static_cast<int>(baseViewInfo.XRelativeToOrigin());
@@ -442,6 +377,9 @@ void Battery::draw()
 		if(scaling_needed){
 			cache_scaling_needed = (texture_prescaled_ == NULL)?true:(texture_prescaled_->w != rect.w || texture_prescaled_->h != rect.h);
 			if(cache_scaling_needed){
+				if(texture_prescaled_ != NULL){
+					SDL::freeSurface(texture_prescaled_);
+				}
 				texture_prescaled_ = SDL::zoomSurface(texture_, NULL, &rect, NULL);
 				if(texture_prescaled_ == NULL){
 					printf("ERROR in %s - Could not create texture_prescaled_\n", __func__);
@@ -464,11 +402,32 @@ void Battery::draw()
 }
 
 
+bool Battery::isVisible()
+{
+    return (baseViewInfo.Alpha > 0.0f && isOnScreen());
+}
+
+
+float Battery::getNextUpdateTime()
+{
+    float nextTime = Component::getNextUpdateTime();
+
+    if(mustUpdate_)
+    {
+        return 0;
+    }
+
+    nextTime = earliestUpdateTime(nextTime, BatteryMonitor::getInstance().getNextPollTime(reloadPeriod_));
+
+    return nextTime;
+}
+
+
 bool Battery::mustRender(  )
 {
     if ( Component::mustRender(  ) ) return true;
 
-    if ( mustRender_ && baseViewInfo.Alpha > 0.0f && valuesReady_ )
+    if ( mustRender_ && baseViewInfo.Alpha > 0.0f && snapshot_->valid )
     {
         mustRender_ = false;
 	return true;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Component.h"
+#include "../../Utility/BatteryMonitor.h"
 #include <SDL/SDL.h>
 #include <string>
 
@@ -13,18 +14,19 @@ public:
     void allocateGraphicsMemory();
     void update(float dt);
     void draw();
+    bool isVisible();
     bool mustRender();
+    float getNextUpdateTime();
     bool isBatConnected();
     bool isUsbConnected();
     int getBatPercent();
 
 protected:
-    void drawBatteryPercent();
+    void drawBatteryPercent(int pixelWidth);
     void drawBatteryCharging();
     void drawNoBattery();
-    int readFileValue(std::string file);
+    int getBucket();
 
-    int 		id_;
     Configuration &config_;
     SDL_Surface *texture_;
     SDL_Surface *texture_prescaled_;
@@ -33,21 +35,7 @@ protected:
     float 		scaleY_;
     float		reloadPeriod_;
     bool 		mustUpdate_;
-
-    static std::string fileUsbConnected_;
-    static std::string fileBatConnected_;
-    static std::string fileBatCapacity_;
-
-    static int		last_id_;
-    static float	currentWaitTime_;
-    static bool 	mustRender_;
-    static int 		percentage_;
-    static int 		prevPercentage_;
-    static int 		percentagePixelWidth_;
-    static int 		prevPercentagePixelWidth_;
-    static bool 	charging_;
-    static bool 	prevCharging_;
-    static bool 	noBat_;
-    static bool 	prevNoBat_;
-    static bool		valuesReady_;
+    bool 		mustRender_;
+    int 		displayedBucket_;
+    std::shared_ptr<const BatterySnapshot> snapshot_;
 };
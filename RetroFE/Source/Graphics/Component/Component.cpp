@@ -15,17 +15,21 @@
  */
 #include "Component.h"
 #include "../Animate/Tween.h"
+#include "../Animate/TweenBatch.h"
 #include "../../Graphics/ViewInfo.h"
 #include "../../Utility/Log.h"
 #include "../../SDL.h"
 #include "../PageBuilder.h"
 
+std::atomic<unsigned int> Component::lastChangeStamp_(0);
+
 Component::Component(Page &p)
 : page(p)
 {
     tweens_                   = NULL;
     //backgroundTexture_        = NULL;
     menuScrollReload_         = false;
+    changeStamp_              = 0;
     freeGraphicsMemory();
     id_                       = -1;
 }
@@ -35,6 +39,7 @@ Component::Component(const Component &copy)
 {
     tweens_ = NULL;
     //backgroundTexture_ = NULL;
+    changeStamp_ = 0;
     freeGraphicsMemory();
 
     if ( copy.tweens_ )
@@ -61,9 +66,12 @@ void Component::freeGraphicsMemory()
     menuIndex_              = -1;
 
     currentTweens_        = NULL;
+    compiledTweenSet_     = NULL;
+    compiledUsesMenu_     = false;
     currentTweenIndex_    = 0;
     currentTweenComplete_ = true;
     elapsedTweenTime_     = 0;
+    changed();
 
     /*if ( backgroundTexture_ )
     {
@@ -75,8 +83,21 @@ void Component::freeGraphicsMemory()
         backgroundTexture_ = NULL;
     }*/
 }
+// Called instead of freeGraphicsMemory when the page stays resident
+// during a launch: reset the animation state but keep the surfaces.
+void Component::suspendGraphicsMemory()
+{
+    Component::freeGraphicsMemory();
+}
+
+void Component::resumeGraphicsMemory()
+{
+    Component::allocateGraphicsMemory();
+}
+
 void Component::allocateGraphicsMemory()
 {
+    changed();
 #if 0
     if ( !backgroundTexture_ )
     {
@@ -189,6 +210,7 @@ void Component::update(float dt)
         currentTweenIndex_    = 0;
         elapsedTweenTime_     = 0;
         storeViewInfo_        = baseViewInfo;
+        compiledTweenSet_     = NULL;
         currentTweenComplete_ = false;
       }
       animationRequested_   = false;
@@ -208,6 +230,7 @@ void Component::update(float dt)
         currentTweenIndex_    = 0;
         elapsedTweenTime_     = 0;
         storeViewInfo_        = baseViewInfo;
+        compiledTweenSet_     = NULL;
         currentTweenComplete_ = false;
         animationRequested_   = false;
     }
@@ -244,6 +267,27 @@ void Component::draw()
 #endif
 }
 
+// Whether draw() can put anything on screen; Page skips the component otherwise.
+// Only components whose draw() has no side effects may return false.
+bool Component::isVisible()
+{
+    return true;
+}
+
+
+// Whether the rectangle described by baseViewInfo overlaps the window
+bool Component::isOnScreen()
+{
+    SDL_Rect rect;
+    rect.x = static_cast<int>(baseViewInfo.XRelativeToOrigin());
+    rect.y = static_cast<int>(baseViewInfo.YRelativeToOrigin());
+    rect.h = static_cast<int>(baseViewInfo.ScaledHeight());
+    rect.w = static_cast<int>(baseViewInfo.ScaledWidth());
+
+    return SDL::isOnScreen(&rect);
+}
+
+
 bool Component::animate()
 {
     bool completeDone = false;
@@ -253,212 +297,26 @@ bool Component::animate()
     }
     else if ( currentTweens_ )
     {
-        bool currentDone = true;
         TweenSet *tweens = currentTweens_->tweenSet(currentTweenIndex_);
 
-
-        for(unsigned int i = 0; i < tweens->size(); i++)
+        // Bind the set to our fields once, the page evaluates it with the other components
+        if ( compiledTweenSet_ != tweens )
         {
-            Tween *tween = tweens->tweens()->at(i);
-            double elapsedTime = elapsedTweenTime_;
-
-	    /* Special case get menu scroll duration if duration specified is 0 */
-	    double duration = tween->duration ? tween->duration : page.getScrollPeriod();
-
-            //todo: too many levels of nesting
-            if ( elapsedTime < duration ){
-                currentDone = false;
-            }
-            else{
-                elapsedTime = static_cast<float>(duration);
-            }
-
-            switch(tween->property)
-            {
-            case TWEEN_PROPERTY_X:
-                if (tween->startDefined)
-                    baseViewInfo.X = tween->animate(elapsedTime);
-                else
-                    baseViewInfo.X = tween->animate(elapsedTime, storeViewInfo_.X);
-                break;
-
-            case TWEEN_PROPERTY_Y:
-                if (tween->startDefined)
-                    baseViewInfo.Y = tween->animate(elapsedTime);
-                else
-                    baseViewInfo.Y = tween->animate(elapsedTime, storeViewInfo_.Y);
-                break;
-
-            case TWEEN_PROPERTY_HEIGHT:
-                if (tween->startDefined)
-                    baseViewInfo.Height = tween->animate(elapsedTime);
-                else
-                    baseViewInfo.Height = tween->animate(elapsedTime, storeViewInfo_.Height);
-                break;
-
-            case TWEEN_PROPERTY_WIDTH:
-                if (tween->startDefined)
-                    baseViewInfo.Width = tween->animate(elapsedTime);
-                else
-                    baseViewInfo.Width = tween->animate(elapsedTime, storeViewInfo_.Width);
-                break;
-
-            case TWEEN_PROPERTY_ANGLE:
-                if (tween->startDefined)
-                    baseViewInfo.Angle = tween->animate(elapsedTime);
-                else
-                    baseViewInfo.Angle = tween->animate(elapsedTime, storeViewInfo_.Angle);
-                break;
-
-            case TWEEN_PROPERTY_ALPHA:
-                if (tween->startDefined)
-                    baseViewInfo.Alpha = tween->animate(elapsedTime);
-                else
-                    baseViewInfo.Alpha = tween->animate(elapsedTime, storeViewInfo_.Alpha);
-                break;
-
-            case TWEEN_PROPERTY_X_ORIGIN:
-                if (tween->startDefined)
-                    baseViewInfo.XOrigin = tween->animate(elapsedTime);
-                else
-                    baseViewInfo.XOrigin = tween->animate(elapsedTime, storeViewInfo_.XOrigin);
-                break;
-
-            case TWEEN_PROPERTY_Y_ORIGIN:
-                if (tween->startDefined)
-                    baseViewInfo.YOrigin = tween->animate(elapsedTime);
-                else
-                    baseViewInfo.YOrigin = tween->animate(elapsedTime, storeViewInfo_.YOrigin);
-                break;
-
-            case TWEEN_PROPERTY_X_OFFSET:
-                if (tween->startDefined)
-                    baseViewInfo.XOffset = tween->animate(elapsedTime);
-                else
-                    baseViewInfo.XOffset = tween->animate(elapsedTime, storeViewInfo_.XOffset);
-                break;
-
-            case TWEEN_PROPERTY_Y_OFFSET:
-                if (tween->startDefined)
-                    baseViewInfo.YOffset = tween->animate(elapsedTime);
-                else
-                    baseViewInfo.YOffset = tween->animate(elapsedTime, storeViewInfo_.YOffset);
-                break;
-
-            case TWEEN_PROPERTY_X_OFFSET_SHIFT_MENU_DIRECTION:
-                if (tween->startDefined){
-                    baseViewInfo.XOffset = tween->animate(elapsedTime,
-							  tween->getStart(),
-							  tween->getStart() + tween->getEnd()* (static_cast<double>(page.isMenuScrollForward()?-1.0f:1.0f)),
-							  duration);
-                }
-                else{
-                    baseViewInfo.XOffset = tween->animate(elapsedTime,
-							  static_cast<double>(storeViewInfo_.YOffset),
-							  static_cast<double>(storeViewInfo_.YOffset) + tween->getEnd()* (static_cast<double>(page.isMenuScrollForward()?-1.0f:1.0f)),
-							  duration);
-                }
-                break;
-
-            case TWEEN_PROPERTY_Y_OFFSET_SHIFT_MENU_DIRECTION:
-                if (tween->startDefined){
-		    /*printf("storeViewInfo_.YOffset = %f, tween->start() = %f, page.isMenuScrollForward()=%d, tween->getEnd()=%f, newEnd=%f\n",
-		      storeViewInfo_.YOffset, tween->getStart(), page.isMenuScrollForward(), tween->getOriginalEnd(),
-		      tween->getStart() + tween->getOriginalEnd()* (static_cast<double>(page.isMenuScrollForward()?-1.0f:1.0f)) );*/
-		    /*printf("y_shift_animation, elapsedTime = %f\n", elapsedTime);
-		      printf("page.getScrollPeriod() = %f\n", page.getScrollPeriod());*/
-
-                    baseViewInfo.YOffset = tween->animate(elapsedTime,
-							  tween->getStart(),
-							  tween->getStart() + tween->getEnd()* (static_cast<double>(page.isMenuScrollForward()?-1.0f:1.0f)),
-							  duration);
-                }
-                else{
-		    /*printf("storeViewInfo_.YOffset = %f, page.isMenuScrollForward()=%d, tween->getEnd()=%f, newEnd=%f\n",
-		      storeViewInfo_.YOffset, page.isMenuScrollForward(), tween->getOriginalEnd(),
-		      static_cast<double>(storeViewInfo_.YOffset) + tween->getOriginalEnd()* (static_cast<double>(page.isMenuScrollForward()?-1.0f:1.0f)) );
-		    */
-
-                    baseViewInfo.YOffset = tween->animate(elapsedTime,
-							  static_cast<double>(storeViewInfo_.YOffset),
-							  static_cast<double>(storeViewInfo_.YOffset) + tween->getEnd()* (static_cast<double>(page.isMenuScrollForward()?-1.0f:1.0f)),
-							  duration);
-                }
-                break;
-
-            case TWEEN_PROPERTY_FONT_SIZE:
-                if (tween->startDefined)
-                    baseViewInfo.FontSize = tween->animate(elapsedTime);
-                else
-                    baseViewInfo.FontSize = tween->animate(elapsedTime, storeViewInfo_.FontSize);
-                break;
-
-            case TWEEN_PROPERTY_BACKGROUND_ALPHA:
-                if (tween->startDefined)
-                    baseViewInfo.BackgroundAlpha = tween->animate(elapsedTime);
-                else
-                    baseViewInfo.BackgroundAlpha = tween->animate(elapsedTime, storeViewInfo_.BackgroundAlpha);
-                break;
-
-            case TWEEN_PROPERTY_MAX_WIDTH:
-                if (tween->startDefined)
-                    baseViewInfo.MaxWidth = tween->animate(elapsedTime);
-                else
-                    baseViewInfo.MaxWidth = tween->animate(elapsedTime, storeViewInfo_.MaxWidth);
-                break;
-
-            case TWEEN_PROPERTY_MAX_HEIGHT:
-                if (tween->startDefined)
-                    baseViewInfo.MaxHeight = tween->animate(elapsedTime);
-                else
-                    baseViewInfo.MaxHeight = tween->animate(elapsedTime, storeViewInfo_.MaxHeight);
-                break;
-
-            case TWEEN_PROPERTY_LAYER:
-                if (tween->startDefined)
-                    baseViewInfo.Layer = static_cast<unsigned int>(tween->animate(elapsedTime));
-                else
-                    baseViewInfo.Layer = static_cast<unsigned int>(tween->animate(elapsedTime, storeViewInfo_.Layer));
-                break;
-
-            case TWEEN_PROPERTY_CONTAINER_X:
-                if (tween->startDefined)
-                    baseViewInfo.ContainerX = tween->animate(elapsedTime);
-                else
-                    baseViewInfo.ContainerX = tween->animate(elapsedTime, storeViewInfo_.ContainerX);
-                break;
-
-            case TWEEN_PROPERTY_CONTAINER_Y:
-                if (tween->startDefined)
-                    baseViewInfo.ContainerY = tween->animate(elapsedTime);
-                else
-                    baseViewInfo.ContainerY = tween->animate(elapsedTime, storeViewInfo_.ContainerY);
-                break;
-
-            case TWEEN_PROPERTY_CONTAINER_WIDTH:
-                if (tween->startDefined)
-                    baseViewInfo.ContainerWidth = tween->animate(elapsedTime);
-                else
-                    baseViewInfo.ContainerWidth = tween->animate(elapsedTime, storeViewInfo_.ContainerWidth);
-                break;
-
-            case TWEEN_PROPERTY_CONTAINER_HEIGHT:
-                if (tween->startDefined)
-                    baseViewInfo.ContainerHeight = tween->animate(elapsedTime);
-                else
-                    baseViewInfo.ContainerHeight = tween->animate(elapsedTime, storeViewInfo_.ContainerHeight);
-                break;
-
-            case TWEEN_PROPERTY_NOP:
-                break;
-            }
+            compiledUsesMenu_ = TweenBatch::compile(tweens, storeViewInfo_, baseViewInfo, compiledTweens_);
+            compiledTweenSet_ = tweens;
         }
 
+        bool currentDone = TweenBatch::schedule(compiledTweens_, elapsedTweenTime_,
+                                                compiledUsesMenu_ ? page.getScrollPeriod() : 0,
+                                                compiledUsesMenu_ && page.isMenuScrollForward(),
+                                                page.getTweenBatch());
+
         if ( currentDone )
         {
             currentTweenIndex_++;
             elapsedTweenTime_ = 0;
             storeViewInfo_    = baseViewInfo;
+            compiledTweenSet_ = NULL;
         }
     }
 
@@ -477,6 +335,69 @@ bool Component::isPlaying()
 }
 
 
+// Whether it draws the same pixels every frame for as long as its view
+// and change stamp stay the same: no tween running or due, no video
+bool Component::isStatic()
+{
+    return getNextUpdateTime() < 0 && !mustRender() && !isPlaying();
+}
+
+
+// Renewed whenever what the component draws changes other than through
+// its view, like new text or graphics memory allocated or freed. Stamps
+// are unique over all components, a new one never repeats an old one's.
+unsigned int Component::getChangeStamp()
+{
+    return changeStamp_;
+}
+
+
+void Component::changed()
+{
+    changeStamp_ = ++lastChangeStamp_;
+}
+
+
+// Time in seconds before this component needs another update, or a negative
+// value if nothing will change until the next user input.
+float Component::getNextUpdateTime()
+{
+    if ( animationRequested_ )
+    {
+        return 0;
+    }
+
+    if ( currentTweens_ && currentTweens_->size( ) > 0 )
+    {
+        return 0;
+    }
+
+    // A completed animation is followed by the (menu)idle one, see update()
+    if ( tweens_ && currentTweenComplete_ )
+    {
+        Animation *idleTweens = tweens_->getAnimation( "idle", menuIndex_ );
+        if ( idleTweens && idleTweens->size( ) == 0 && !page.isMenuScrolling( ) )
+        {
+            idleTweens = tweens_->getAnimation( "menuIdle", menuIndex_ );
+        }
+        if ( idleTweens && idleTweens->size( ) > 0 )
+        {
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+
+float Component::earliestUpdateTime(float a, float b)
+{
+    if ( a < 0 ) return b;
+    if ( b < 0 ) return a;
+    return (a < b) ? a : b;
+}
+
+
 void Component::setMenuScrollReload(bool menuScrollReload)
 {
     menuScrollReload_ = menuScrollReload;
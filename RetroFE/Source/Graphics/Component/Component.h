@@ -15,12 +15,14 @@
  */
 #pragma once
 
+#include <atomic>
 #include <vector>
 
 #include "../../SDL.h"
 #include "../Page.h"
 #include "../ViewInfo.h"
 #include "../Animate/Tween.h"
+#include "../Animate/TweenBatch.h"
 #include "../Animate/AnimationEvents.h"
 #include "../../Collection/Item.h"
 class Component
@@ -31,6 +33,8 @@ public:
     virtual ~Component();
     virtual void freeGraphicsMemory();
     virtual void allocateGraphicsMemory();
+    virtual void suspendGraphicsMemory();
+    virtual void resumeGraphicsMemory();
     virtual void deInitializeFonts();
     virtual void initializeFonts();
     virtual bool mustRender();
@@ -46,8 +50,13 @@ public:
 
     virtual void update(float dt);
     virtual void draw();
+    virtual bool isVisible();
     void setTweens(AnimationEvents *set);
     virtual bool isPlaying();
+    virtual bool isStatic();
+    unsigned int getChangeStamp();
+    virtual float getNextUpdateTime();
+    static float earliestUpdateTime(float a, float b);
     ViewInfo baseViewInfo;
     std::string collectionName;
     void setMenuScrollReload(bool menuScrollReload);
@@ -57,6 +66,9 @@ public:
     int getId( );
 
 protected:
+    bool isOnScreen();
+    void changed();
+
     Page &page;
 
     std::string playlistName;
@@ -68,6 +80,9 @@ private:
 
     AnimationEvents *tweens_;
     Animation *currentTweens_;
+    TweenSet  *compiledTweenSet_;
+    std::vector<CompiledTween> compiledTweens_;
+    bool       compiledUsesMenu_;
     //SDL_Surface *backgroundTexture_;
 
     ViewInfo     storeViewInfo_;
@@ -80,4 +95,7 @@ private:
     bool         menuScrollReload_;
     int          menuIndex_;
     int          id_;
+    unsigned int changeStamp_;
+
+    static std::atomic<unsigned int> lastChangeStamp_;
 };
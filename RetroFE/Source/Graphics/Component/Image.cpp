@@ -18,19 +18,40 @@
 #include "../../SDL.h"
 #include "../../Utility/Log.h"
 #include <SDL/SDL_image.h>
+#include <algorithm>
 
-Image::Image(std::string file, std::string altFile, Page &p, float scaleX, float scaleY, bool dithering)
+Image::Image(std::string file, std::string altFile, Page &p, float scaleX, float scaleY, bool dithering,
+             SpriteAtlas *atlas, const ViewInfo *viewInfo, AnimationEvents *tweens)
     : Component(p)
     , texture_(NULL)
     , texture_prescaled_(NULL)
     , ditheringAuthorized_(dithering)
-    , needDithering_(false)
     , imgBitsPerPx_(32)
     , file_(file)
     , altFile_(altFile)
     , scaleX_(scaleX)
     , scaleY_(scaleY)
+    , atlas_(atlas)
+    , atlasSlot_(-1)
+    , largestViewKnown_(false)
 {
+    // Known before loading, the texture is shrunk to the largest size it is
+    // shown at: the view's, grown to the sizes its tweens go to. Unknown when
+    // a tween sizes a side the view leaves to the image's aspect.
+    if (viewInfo != NULL)
+    {
+        baseViewInfo = *viewInfo;
+        largestView_ = *viewInfo;
+        if (tweens != NULL)
+        {
+            tweens->getLargest(TWEEN_PROPERTY_WIDTH, largestView_.Width);
+            tweens->getLargest(TWEEN_PROPERTY_HEIGHT, largestView_.Height);
+            tweens->getLargest(TWEEN_PROPERTY_MAX_WIDTH, largestView_.MaxWidth);
+            tweens->getLargest(TWEEN_PROPERTY_MAX_HEIGHT, largestView_.MaxHeight);
+        }
+        largestViewKnown_ = (viewInfo->Width != -1 || largestView_.Width == -1) &&
+                            (viewInfo->Height != -1 || largestView_.Height == -1);
+    }
     allocateGraphicsMemory();
 }
 
@@ -47,14 +68,20 @@ void Image::freeGraphicsMemory()
     SDL_LockMutex(SDL::getMutex());
     if (texture_ != NULL)
     {
-        SDL_FreeSurface(texture_);
+        SDL::freeSurface(texture_);
         texture_ = NULL;
     }
+    if (atlas_ != NULL)
+    {
+        atlas_->release(atlasSlot_);
+        atlasSlot_ = -1;
+    }
     if (texture_prescaled_ != NULL)
     {
-        SDL_FreeSurface(texture_prescaled_);
+        SDL::freeSurface(texture_prescaled_);
 	texture_prescaled_ = NULL;
     }
+    reflection_.clear();
     SDL_UnlockMutex(SDL::getMutex());
 }
 
@@ -70,41 +97,57 @@ void Image::allocateGraphicsMemory()
         /* Load image */
         SDL_Surface * img_tmp = NULL;
         //printf("Loading image: %s\n", file_.c_str());
-        img_tmp = IMG_Load(file_.c_str());
+        img_tmp = SDL::loadSurface(file_, "Image");
         if (!img_tmp && altFile_ != "")
         {
 	    //printf("	Failed-> Loading backup image: %s\n", altFile_.c_str());
-	    img_tmp = IMG_Load(altFile_.c_str());
+	    img_tmp = SDL::loadSurface(altFile_, "Image");
         }
 
 
         if (img_tmp != NULL)
         {
-	    /* Check if dithering needed */
 	    imgBitsPerPx_ = img_tmp->format->BitsPerPixel;
-	    if( imgBitsPerPx_ > 16 && ditheringAuthorized_){
-	        needDithering_ = true;
-	    }
 
             /* Convert to RGB 32bit if necessary */
 	    if(imgBitsPerPx_ != 32){
-	        texture_ = SDL_CreateRGBSurface(0, img_tmp->w, img_tmp->h, 32, 0, 0, 0, 0);
+	        texture_ = SDL::createSurface(0, img_tmp->w, img_tmp->h, 32, 0, 0, 0, 0, "Image");
 		SDL_BlitSurface(img_tmp, NULL, texture_, NULL);
 
 		/* Free img_tmp */
-		SDL_FreeSurface(img_tmp);
+		SDL::freeSurface(img_tmp);
 	    }
 	    else{
 	        texture_ = img_tmp;
 	    }
 	    //SDL_SetAlpha(texture_, SDL_SRCALPHA, 255);
 
-	    /* Set real dimensions */
+	    /* Set real dimensions, kept when the pixels are shrunk */
 	    if (texture_ != NULL)
 	    {
 	      baseViewInfo.ImageWidth = texture_->w * scaleX_;
 	      baseViewInfo.ImageHeight = texture_->h * scaleY_;
 	    }
+
+	    /* Shrunk once to the size it is shown at, averaging instead of sampling */
+	    if (texture_ != NULL && getShownSize(width, height))
+	    {
+	      SDL::downscaleTexture(texture_, width, height);
+	    }
+
+	    /* Dithered once here, scaled copies are made from the dithered pixels */
+	    if(texture_ != NULL && imgBitsPerPx_ > 16 && ditheringAuthorized_){
+	        SDL::ditherSurface32bppTo16Bpp(texture_);
+	    }
+
+	    /* Kept opaque, colour keyed or premultiplied, whichever its alpha allows */
+	    SDL::prepareTexture(texture_);
+
+	    /* Pixels moved to the atlas of a scrolling list, shown from there at the real dimensions */
+	    if (texture_ != NULL && atlas_ != NULL)
+	    {
+	      SDL::packTexture(texture_, *atlas_, atlasSlot_);
+	    }
         }
         SDL_UnlockMutex(SDL::getMutex());
 
@@ -115,6 +158,73 @@ void Image::allocateGraphicsMemory()
 }
 
 
+// The largest size the texture is drawn at, as far as it is known: the
+// largest view saved at construction, or the image fitted into a slot of
+// the atlas. False unless it is smaller than the texture.
+bool Image::getShownSize(int &width, int &height)
+{
+    width = 0;
+    height = 0;
+    if (largestViewKnown_)
+    {
+        largestView_.ImageWidth = baseViewInfo.ImageWidth;
+        largestView_.ImageHeight = baseViewInfo.ImageHeight;
+        width = static_cast<int>(largestView_.ScaledWidth());
+        height = static_cast<int>(largestView_.ScaledHeight());
+    }
+    else if (atlas_ != NULL)
+    {
+        width = static_cast<int>(baseViewInfo.ImageWidth);
+        height = static_cast<int>(baseViewInfo.ImageHeight);
+    }
+
+    if (atlas_ != NULL && atlas_->isValid() && width > 0 && height > 0 &&
+        (width > atlas_->getSlotWidth() || height > atlas_->getSlotHeight()))
+    {
+        int slotWidth = atlas_->getSlotWidth();
+        int slotHeight = atlas_->getSlotHeight();
+        if (static_cast<long long>(width) * slotHeight > static_cast<long long>(height) * slotWidth)
+        {
+            height = std::max(1, static_cast<int>(static_cast<long long>(height) * slotWidth / width));
+            width = slotWidth;
+        }
+        else
+        {
+            width = std::max(1, static_cast<int>(static_cast<long long>(width) * slotHeight / height));
+            height = slotHeight;
+        }
+    }
+
+    return (width > 0 && height > 0 && width <= texture_->w && height <= texture_->h &&
+            (width < texture_->w || height < texture_->h));
+}
+
+
+// Drawn in its view rectangle, nothing to do when transparent or outside the
+// window unless its reflection is on it
+bool Image::isVisible()
+{
+    if (!texture_ || baseViewInfo.Alpha <= 0.0f) return false;
+    if (isOnScreen()) return true;
+
+    Reflection::Side side = Reflection::parseSide(baseViewInfo.Reflection);
+    if (side == Reflection::SIDE_NONE) return false;
+
+    Reflection::Rect image = { static_cast<int>(baseViewInfo.XRelativeToOrigin()),
+                               static_cast<int>(baseViewInfo.YRelativeToOrigin()),
+                               static_cast<int>(baseViewInfo.ScaledWidth()),
+                               static_cast<int>(baseViewInfo.ScaledHeight()) };
+    Reflection::Rect placement = Reflection::place(side, image, baseViewInfo.ReflectionScale,
+                                                   static_cast<int>(baseViewInfo.ReflectionDistance));
+    SDL_Rect rect;
+    rect.x = placement.x;
+    rect.y = placement.y;
+    rect.w = placement.w;
+    rect.h = placement.h;
+    return SDL::isOnScreen(&rect);
+}
+
+
 void Image::draw()
 {
 	bool scaling_needed = false;
@@ -154,14 +264,15 @@ void Image::draw()
 	       (cropping_needed && (texture_prescaled_->w != rect_cropping.w || texture_prescaled_->h != rect_cropping.h) ));
 	    if(cache_scaling_needed){
 	        /*printf("\nComputing prescaling and cropping in Image.cpp %s\n", cropping_needed?"and cropping":"");*/
+	        if(texture_prescaled_ != NULL){
+	            SDL::freeSurface(texture_prescaled_);
+	            reflection_.clear();
+	        }
 	        texture_prescaled_ = SDL::zoomSurface(texture_, NULL, &rect, cropping_needed?&rect_cropping:NULL);
 		if(texture_prescaled_ == NULL){
 		    printf("ERROR in %s - Could not create texture_prescaled_\n", __func__);
 		    use_prescaled = false;
 		}
-		if(imgBitsPerPx_ > 16 && ditheringAuthorized_){
-		    needDithering_ = true;
-		}
 	    }
 
 	    if(texture_prescaled_ != NULL){
@@ -178,15 +289,8 @@ void Image::draw()
 	    surfaceToRender = texture_;
 	}
 
-	/* Dithering */
-	if(needDithering_){
-	    //printf("Dither: %s\n", file_.c_str());
-	    SDL::ditherSurface32bppTo16Bpp(surfaceToRender);
-	    needDithering_ = false;
-	}
-
 	/* Render */
 	//printf("image render\n");
-	SDL::renderCopy(surfaceToRender, baseViewInfo.Alpha, NULL, &rect, baseViewInfo);
+	SDL::renderCopy(surfaceToRender, baseViewInfo.Alpha, NULL, &rect, baseViewInfo, &reflection_);
     }
 }
@@ -16,26 +16,37 @@
 #pragma once
 
 #include "Component.h"
+#include "../Reflection.h"
+#include "../SpriteAtlas.h"
 #include <SDL/SDL.h>
 #include <string>
 
 class Image : public Component
 {
 public:
-    Image(std::string file, std::string altFile, Page &p, float scaleX, float scaleY, bool dithering);
+    Image(std::string file, std::string altFile, Page &p, float scaleX, float scaleY, bool dithering,
+          SpriteAtlas *atlas = NULL, const ViewInfo *viewInfo = NULL, AnimationEvents *tweens = NULL);
     virtual ~Image();
     void freeGraphicsMemory();
     void allocateGraphicsMemory();
     void draw();
+    bool isVisible();
 
 protected:
     SDL_Surface *texture_;
     SDL_Surface *texture_prescaled_;
+    Reflection reflection_;
     std::string file_;
     std::string altFile_;
     float scaleX_;
     float scaleY_;
     bool ditheringAuthorized_;
-    bool needDithering_;
     int imgBitsPerPx_;
+    SpriteAtlas *atlas_;
+    int atlasSlot_;
+    ViewInfo largestView_;
+    bool largestViewKnown_;
+
+private:
+    bool getShownSize(int &width, int &height);
 };
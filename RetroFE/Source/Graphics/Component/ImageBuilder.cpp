@@ -18,7 +18,8 @@
 #include "../../Utility/Log.h"
 #include <fstream>
 
-Image * ImageBuilder::CreateImage(std::string path, Page &p, std::string name, float scaleX, float scaleY, bool dithering)
+Image * ImageBuilder::CreateImage(std::string path, Page &p, std::string name, float scaleX, float scaleY, bool dithering,
+                                  SpriteAtlas *atlas)
 {
     Image *image = NULL;
     std::vector<std::string> extensions;
@@ -37,7 +38,7 @@ Image * ImageBuilder::CreateImage(std::string path, Page &p, std::string name, f
     if(Utils::findMatchingFile(prefix, extensions, file))
     {
         //printf("		fFound Matching File, prefix = %s, file = %s\n", prefix.c_str(), file.c_str());
-        image = new Image(file, "", p, scaleX, scaleY, dithering);
+        image = new Image(file, "", p, scaleX, scaleY, dithering, atlas);
     }
 
     return image;
@@ -24,5 +24,6 @@
 class ImageBuilder
 {
 public:
-    Image * CreateImage(std::string path, Page &p, std::string name, float scaleX, float scaleY, bool dithering);
+    Image * CreateImage(std::string path, Page &p, std::string name, float scaleX, float scaleY, bool dithering,
+                        SpriteAtlas *atlas = NULL);
 };
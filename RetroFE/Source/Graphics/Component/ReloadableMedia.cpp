@@ -114,6 +114,22 @@ void ReloadableMedia::update(float dt)
 
 }
 
+float ReloadableMedia::getNextUpdateTime()
+{
+    if(newItemSelected || (newScrollItemSelected && getMenuScrollReload()))
+    {
+        return 0;
+    }
+
+    float nextTime = Component::getNextUpdateTime();
+    if(loadedComponent_)
+    {
+        nextTime = earliestUpdateTime(nextTime, loadedComponent_->getNextUpdateTime());
+    }
+
+    return nextTime;
+}
+
 void ReloadableMedia::allocateGraphicsMemory()
 {
     if(loadedComponent_)
@@ -137,6 +153,29 @@ void ReloadableMedia::freeGraphicsMemory()
 }
 
 
+void ReloadableMedia::suspendGraphicsMemory()
+{
+    Component::freeGraphicsMemory();
+
+    if(loadedComponent_)
+    {
+        loadedComponent_->suspendGraphicsMemory();
+    }
+}
+
+
+void ReloadableMedia::resumeGraphicsMemory()
+{
+    if(loadedComponent_)
+    {
+        loadedComponent_->resumeGraphicsMemory();
+    }
+
+    // NOTICE! needs to be done last to prevent flags from being missed
+    Component::allocateGraphicsMemory();
+}
+
+
 void ReloadableMedia::reloadTexture()
 {
 	reloadTexture(false);
@@ -491,6 +530,23 @@ Component *ReloadableMedia::findComponent(std::string collection, std::string ty
 
 }
 
+// Videos have to be drawn to acknowledge their frames, even when hidden
+bool ReloadableMedia::isVisible()
+{
+    if(!loadedComponent_) return false;
+    if(isVideo_) return true;
+
+    return baseViewInfo.Alpha > 0.0f;
+}
+
+
+// Reloaded with the selected item, never flattened with the layers below
+bool ReloadableMedia::isStatic()
+{
+    return false;
+}
+
+
 void ReloadableMedia::draw()
 {
     Component::draw();
@@ -30,9 +30,14 @@ public:
     ReloadableMedia(Configuration &config, bool systemMode, bool layoutMode, bool commonMode, bool menuMode, std::string type, Page &page, int displayOffset, bool isVideo, Font *font, float scaleX, float scaleY, bool dithering);
     virtual ~ReloadableMedia();
     void update(float dt);
+    float getNextUpdateTime();
     void draw();
+    bool isVisible();
+    bool isStatic();
     void freeGraphicsMemory();
     void allocateGraphicsMemory();
+    void suspendGraphicsMemory();
+    void resumeGraphicsMemory();
     Component *findComponent(std::string collection, std::string type, std::string basename, std::string filepath, bool systemMode);
 
     void enableImageAndText_(bool value);
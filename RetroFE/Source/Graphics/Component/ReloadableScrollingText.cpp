@@ -128,6 +128,33 @@ void ReloadableScrollingText::update(float dt)
 }
 
 
+float ReloadableScrollingText::getNextUpdateTime( )
+{
+    if (newItemSelected || (newScrollItemSelected && getMenuScrollReload()))
+    {
+        return 0;
+    }
+
+    float nextTime = Component::getNextUpdateTime( );
+
+    if (needScrolling_)
+    {
+        float wait = 0;
+        if (waitEndTime_ > 0)
+        {
+            wait = waitEndTime_;
+        }
+        else if (waitStartTime_ > 0)
+        {
+            wait = waitStartTime_;
+        }
+        nextTime = earliestUpdateTime(nextTime, wait);
+    }
+
+    return nextTime;
+}
+
+
 void ReloadableScrollingText::allocateGraphicsMemory( )
 {
     Component::allocateGraphicsMemory( );
@@ -433,10 +460,10 @@ void ReloadableScrollingText::reloadTexture( bool previousItem )
 	{
 	    curLineWidth = 0;
 
-	    for (unsigned int i = 0; i < text_[l].size( ); ++i)
+	    for (size_t i = 0; i < text_[l].size( ); )
 	    {
 	        Font::GlyphInfo glyph;
-		if (font->getRect( text_[l][i], glyph ))
+		if (font->getRect( Utils::decodeUtf8( text_[l], i ), glyph ))
 		{
 		  if ( glyph.minX < 0 )
 		  {
@@ -536,6 +563,19 @@ void ReloadableScrollingText::loadText( std::string collection, std::string type
 }
 
 
+bool ReloadableScrollingText::isVisible( )
+{
+    return baseViewInfo.Alpha > 0.0f;
+}
+
+
+// Reloaded with the selected item, never flattened with the layers below
+bool ReloadableScrollingText::isStatic( )
+{
+    return false;
+}
+
+
 void ReloadableScrollingText::draw( )
 {
     Component::draw( );
@@ -549,8 +589,6 @@ void ReloadableScrollingText::draw( )
         else                   // If not, use the general font settings
           font = fontInst_;
 
-        SDL_Surface *t = font->getTexture( );
-
         float imageHeight = 0;
         float imageWidth     = 0;
         float imageMaxWidth  = 0;
@@ -583,10 +621,10 @@ void ReloadableScrollingText::draw( )
         // Compute image width that fits inside the the container width to get the origin position
         if (direction_ == "horizontal")
         {
-	    for ( unsigned int i = 0; i < text_[0].size( ); ++i )
+	    for ( size_t i = 0; i < text_[0].size( ); )
 	    {
 	        Font::GlyphInfo glyph;
-		if ( font->getRect( text_[0][i], glyph ) )
+		if ( font->getRect( Utils::decodeUtf8( text_[0], i ), glyph ) )
 		{
 		    if ( glyph.minX < 0 )
 		    {
@@ -649,7 +687,7 @@ void ReloadableScrollingText::draw( )
 
             for (unsigned int l = 0; l < text_.size( ); ++l)
             {
-                for (unsigned int i = 0; i < text_[l].size( ); ++i)
+                for (size_t i = 0; i < text_[l].size( ); )
                 {
 
                     // Do not print outside the box
@@ -663,7 +701,7 @@ void ReloadableScrollingText::draw( )
                     //printf("text_[%d][%d] = %c, 0x%02X\n", l, i, text_[l][i], text_[l][i]);
 
                     //if (font->getRect( text_[l][i], glyph) && glyph.rect.h > 0)
-                    if (font->getRect( text_[l][i], glyph))
+                    if (font->getRect( Utils::decodeUtf8( text_[l], i ), glyph ))
                     {
                         SDL_Rect charRect = glyph.rect;
                         rect.h  = static_cast<int>( charRect.h * scale * scaleY_ );
@@ -696,7 +734,7 @@ void ReloadableScrollingText::draw( )
                             }
                             if (rect.w > 0)
                             {
-                                SDL::renderCopy(t, baseViewInfo.Alpha, &charRect, &rect, baseViewInfo);
+                                SDL::renderCopy(glyph.texture, baseViewInfo.Alpha, &charRect, &rect, baseViewInfo);
                                 rect.x += rect.w;
                             }
                             else if ((rect.x + static_cast<int>( char_width * scale * scaleX_ )) >= (static_cast<int>( xOrigin ) + imageMaxWidth))
@@ -723,10 +761,10 @@ void ReloadableScrollingText::draw( )
 		{
 		    curLineWidth = 0;
 
-		    for (unsigned int i = 0; i < text_[l].size( ); ++i)
+		    for (size_t i = 0; i < text_[l].size( ); )
 		    {
 		        Font::GlyphInfo glyph;
-			if (font->getRect( text_[l][i], glyph ))
+			if (font->getRect( Utils::decodeUtf8( text_[l], i ), glyph ))
 			{
 			    if ( glyph.minX < 0 )
 			    {
@@ -796,10 +834,10 @@ void ReloadableScrollingText::draw( )
 
                     // Determine word image width
                     unsigned int wordWidth = 0;
-                    for (unsigned int i = 0; i < word.size( ); ++i)
+                    for (size_t i = 0; i < word.size( ); )
                     {
                         Font::GlyphInfo glyph;
-                        if (font->getRect( word[i], glyph) )
+                        if (font->getRect( Utils::decodeUtf8( word, i ), glyph ) )
                         {
                             wordWidth += static_cast<int>( glyph.advance * scale * scaleX_ );
                         }
@@ -889,12 +927,12 @@ void ReloadableScrollingText::draw( )
                 while (iss >> word)
                 {
 
-                    for (unsigned int i = 0; i < word.size( ); ++i)
+                    for (size_t i = 0; i < word.size( ); )
                     {
                         Font::GlyphInfo glyph;
 
                         //if (font->getRect( word[i], glyph) && glyph.rect.h > 0)
-                        if (font->getRect( word[i], glyph))
+                        if (font->getRect( Utils::decodeUtf8( word, i ), glyph ))
                         {
                             SDL_Rect charRect = glyph.rect;
                             rect.h   = static_cast<int>( charRect.h * scale * scaleY_ );
@@ -921,7 +959,7 @@ void ReloadableScrollingText::draw( )
                                 }
                                 if (rect.h > 0)
                                 {
-                                    SDL::renderCopy(t, baseViewInfo.Alpha, &charRect, &rect, baseViewInfo);
+                                    SDL::renderCopy(glyph.texture, baseViewInfo.Alpha, &charRect, &rect, baseViewInfo);
                                 }
                             }
                             rect.x += static_cast<int>( glyph.advance * scale * scaleX_ );
@@ -27,7 +27,10 @@ public:
     ReloadableScrollingText(Configuration &config, bool systemMode, bool layoutMode, bool menuMode, std::string type, std::string textFormat, std::string singlePrefix, std::string singlePostfix, std::string pluralPrefix, std::string pluralPostfix, std::string alignment, Page &page, int displayOffset, Font *font, float scaleX, float scaleY, std::string direction, float scrollingSpeed, float startPosition, float startTime, float endTime );
     virtual ~ReloadableScrollingText( );
     void     update(float dt);
+    float    getNextUpdateTime( );
     void     draw( );
+    bool     isVisible( );
+    bool     isStatic( );
     bool 	 mustRender( );
     void     allocateGraphicsMemory( );
     void     freeGraphicsMemory( );
@@ -23,6 +23,7 @@
 #include <vector>
 #include <iostream>
 #include <time.h>
+#include <chrono>
 #include <algorithm>
 
 ReloadableText::ReloadableText(std::string type, Page &page, Configuration &config, Font *font, std::string layoutKey, std::string timeFormat, std::string textFormat, std::string singlePrefix, std::string singlePostfix, std::string pluralPrefix, std::string pluralPostfix, int displayOffset, float scaleX, float scaleY)
@@ -74,6 +75,26 @@ void ReloadableText::update(float dt)
 
 }
 
+float ReloadableText::getNextUpdateTime()
+{
+    if(newItemSelected || (newScrollItemSelected && getMenuScrollReload()))
+    {
+        return 0;
+    }
+
+    float nextTime = Component::getNextUpdateTime();
+
+    // Time is reloaded on the next wall clock second
+    if(type_ == "time")
+    {
+        std::chrono::milliseconds ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()) % 1000;
+        nextTime = earliestUpdateTime(nextTime, static_cast<float>(1000 - ms.count()) / 1000);
+    }
+
+    return nextTime;
+}
+
 void ReloadableText::allocateGraphicsMemory()
 {
     ReloadTexture();
@@ -296,6 +317,19 @@ void ReloadableText::ReloadTexture( bool previousItem )
 }
 
 
+bool ReloadableText::isVisible()
+{
+    return (imageInst_ && baseViewInfo.Alpha > 0.0f);
+}
+
+
+// Reloaded with the selected item, never flattened with the layers below
+bool ReloadableText::isStatic()
+{
+    return false;
+}
+
+
 void ReloadableText::draw()
 {
     if(imageInst_)
@@ -28,7 +28,10 @@ public:
     ReloadableText(std::string type, Page &page, Configuration &config, Font *font, std::string layoutKey, std::string timeFormat, std::string textFormat, std::string singlePrefix, std::string singlePostfix, std::string pluralPrefix, std::string pluralPostfix, int displayOffset, float scaleX, float scaleY);
     virtual ~ReloadableText();
     void     update(float dt);
+    float    getNextUpdateTime();
     void     draw();
+    bool     isVisible();
+    bool     isStatic();
     void     freeGraphicsMemory();
     void     allocateGraphicsMemory();
     void     deInitializeFonts();
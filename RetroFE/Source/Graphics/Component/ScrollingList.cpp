@@ -22,6 +22,7 @@
 #include "../Animate/AnimationEvents.h"
 #include "../Animate/TweenTypes.h"
 #include "../Font.h"
+#include "../SurfaceTracker.h"
 #include "ImageBuilder.h"
 #include "VideoBuilder.h"
 #include "VideoComponent.h"
@@ -34,6 +35,7 @@
 #include "../../SDL.h"
 #include "../ViewInfo.h"
 #include <math.h>
+#include <algorithm>
 #include <SDL/SDL_image.h>
 #include <sstream>
 #include <cctype>
@@ -106,6 +108,7 @@ ScrollingList::ScrollingList( const ScrollingList &copy )
 ScrollingList::~ScrollingList( )
 {
     destroyItems( );
+    SurfaceTracker::remove( &atlas_ );
 }
 
 
@@ -162,6 +165,8 @@ void ScrollingList::allocateSpritePoints( )
     if ( !scrollPoints_ ) return;
     if ( components_.size( ) == 0 ) return;
 
+    if ( !atlas_.isValid( ) ) createAtlas( );
+
     for ( unsigned int i = 0; i < scrollPoints_->size( ); ++i )
     {
         unsigned int index  = loopIncrement( itemIndex_, i, items_->size( ) );
@@ -187,6 +192,40 @@ void ScrollingList::allocateSpritePoints( )
 }
 
 
+// One slot per scroll point, as large as the biggest item the layout
+// shows. A side left to the image's aspect is bounded by the window. The
+// item surfaces only point into it, the list accounts for its pixels.
+void ScrollingList::createAtlas( )
+{
+    if ( !imageType_.compare( "null" ) ) return;
+
+    int windowWidth  = SDL::getWindowWidth( );
+    int windowHeight = SDL::getWindowHeight( );
+    int width        = 0;
+    int height       = 0;
+    for ( unsigned int i = 0; i < scrollPoints_->size( ); ++i )
+    {
+        ViewInfo *view = scrollPoints_->at( i );
+        float w = ( view->Width > 0 ) ? view->Width : view->MaxWidth;
+        float h = ( view->Height > 0 ) ? view->Height : view->MaxHeight;
+        w = std::min( std::max( w, view->MinWidth ), static_cast<float>( windowWidth ) );
+        h = std::min( std::max( h, view->MinHeight ), static_cast<float>( windowHeight ) );
+        width  = std::max( width, static_cast<int>( ceil( w ) ) );
+        height = std::max( height, static_cast<int>( ceil( h ) ) );
+    }
+
+    if ( atlas_.create( width, height, scrollPoints_->size( ), 4 ) )
+    {
+        SurfaceTracker::add( &atlas_, atlas_.getBytes( ), "ScrollingList" );
+
+        std::stringstream ss;
+        ss << "Item atlas of " << scrollPoints_->size( ) << " slots of " << width << "x" << height
+           << ", " << atlas_.getBytes( ) / 1024 << " kB";
+        Logger::write( Logger::ZONE_DEBUG, "ScrollingList", ss.str( ) );
+    }
+}
+
+
 void ScrollingList::destroyItems( )
 {
     for ( unsigned int i = 0; i < components_.size( ); ++i )
@@ -394,6 +433,40 @@ void ScrollingList::freeGraphicsMemory( )
     scrollPeriod_ = 0;
 
     deallocateSpritePoints( );
+    SurfaceTracker::remove( &atlas_ );
+    atlas_.destroy( );
+}
+
+
+// Keep the item components and their surfaces, only reset the
+// animation state the way freeGraphicsMemory does
+void ScrollingList::suspendGraphicsMemory( )
+{
+    Component::freeGraphicsMemory( );
+    scrollPeriod_ = 0;
+
+    for ( unsigned int i = 0; i < components_.size( ); ++i )
+    {
+        if ( components_.at( i ) )
+        {
+            components_.at( i )->suspendGraphicsMemory( );
+        }
+    }
+}
+
+
+void ScrollingList::resumeGraphicsMemory( )
+{
+    Component::allocateGraphicsMemory( );
+    scrollPeriod_ = startScrollTime_;
+
+    for ( unsigned int i = 0; i < components_.size( ); ++i )
+    {
+        if ( components_.at( i ) )
+        {
+            components_.at( i )->resumeGraphicsMemory( );
+        }
+    }
 }
 
 void ScrollingList::triggerEnterEvent( )
@@ -674,7 +747,7 @@ bool ScrollingList::allocateTexture( unsigned int index, Item *item )
             else
                 config_.getMediaPropertyAbsolutePath( collectionName, imageType_, false, imagePath );
         }
-        t = imageBuild.CreateImage( imagePath, page, names[n], scaleX_, scaleY_, ditheringAuthorized_ );
+        t = imageBuild.CreateImage( imagePath, page, names[n], scaleX_, scaleY_, ditheringAuthorized_, &atlas_ );
 
         // check sub-collection path for art
         if ( !t && !commonMode_ )
@@ -688,7 +761,7 @@ bool ScrollingList::allocateTexture( unsigned int index, Item *item )
             {
                 config_.getMediaPropertyAbsolutePath( item->collectionInfo->name, imageType_, false, imagePath );
             }
-            t = imageBuild.CreateImage( imagePath, page, names[n], scaleX_, scaleY_, ditheringAuthorized_ );
+            t = imageBuild.CreateImage( imagePath, page, names[n], scaleX_, scaleY_, ditheringAuthorized_, &atlas_ );
         }
     }
 
@@ -716,12 +789,12 @@ bool ScrollingList::allocateTexture( unsigned int index, Item *item )
                 config_.getMediaPropertyAbsolutePath( item->name, imageType_, true, imagePath );
             }
         }
-        t = imageBuild.CreateImage( imagePath, page, imageType_, scaleX_, scaleY_, ditheringAuthorized_ );
+        t = imageBuild.CreateImage( imagePath, page, imageType_, scaleX_, scaleY_, ditheringAuthorized_, &atlas_ );
     }
 
     // check rom directory path for art
     if ( !t ){
-        t = imageBuild.CreateImage( item->filepath, page, imageType_, scaleX_, scaleY_, ditheringAuthorized_ );
+        t = imageBuild.CreateImage( item->filepath, page, imageType_, scaleX_, scaleY_, ditheringAuthorized_, &atlas_ );
     }
 
     // Image fallback
@@ -729,7 +802,7 @@ bool ScrollingList::allocateTexture( unsigned int index, Item *item )
         //imagePath = Utils::combinePath(Configuration::isUserLayout_?Configuration::userPath:Configuration::absolutePath, "collections", collectionName );
         imagePath = Utils::combinePath(Configuration::absolutePath, "collections", collectionName ); // forcing absolutePath and folder "Collection" for backups
         imagePath = Utils::combinePath( imagePath, "system_artwork" );
-        t = imageBuild.CreateImage( imagePath, page, std::string("fallback"), scaleX_, scaleY_, ditheringAuthorized_ );
+        t = imageBuild.CreateImage( imagePath, page, std::string("fallback"), scaleX_, scaleY_, ditheringAuthorized_, &atlas_ );
     }
 
     if ( !t )
@@ -778,6 +851,16 @@ void ScrollingList::draw( unsigned int layer )
 }
 
 
+void ScrollingList::addToDrawList( DrawList &list )
+{
+    for ( unsigned int i = 0; i < components_.size(  ); ++i )
+    {
+        Component *c = components_.at( i );
+        if ( c && c->isVisible(  ) ) list.add( c, c->baseViewInfo.Layer );
+    }
+}
+
+
 bool ScrollingList::isIdle(  )
 {
     if ( !Component::isIdle(  ) ) return false;
@@ -792,6 +875,20 @@ bool ScrollingList::isIdle(  )
 }
 
 
+float ScrollingList::getNextUpdateTime(  )
+{
+    float nextTime = Component::getNextUpdateTime(  );
+
+    for ( unsigned int i = 0; i < components_.size(  ); ++i )
+    {
+        Component *c = components_.at( i );
+        if ( c ) nextTime = earliestUpdateTime( nextTime, c->getNextUpdateTime(  ) );
+    }
+
+    return nextTime;
+}
+
+
 bool ScrollingList::getScrollDirectionForward(  )
 {
     return scrollDirectionForward_;
@@ -857,15 +954,18 @@ void ScrollingList::scroll( bool forward )
     if ( !items_ || items_->size(  ) == 0 ) return;
     if ( !scrollPoints_ || scrollPoints_->size(  ) == 0 ) return;
 
-    // Replace the item that's scrolled out
+    // Replace the item that's scrolled out, its slot of the atlas is
+    // released before the new item takes one
+    unsigned int replaced = forward ? 0 : loopDecrement( 0, 1, components_.size(  ) );
+    Component *old = components_.at( replaced );
     if ( forward )
     {
         scrollDirectionForward_ = true;
         Item *i    = items_->at( loopIncrement( itemIndex_, scrollPoints_->size(  ), items_->size(  ) ) );
         prevItemIndex_ = itemIndex_;
         itemIndex_ = loopIncrement( itemIndex_, 1, items_->size(  ) );
-        deallocateTexture( 0 );
-        allocateTexture( 0, i );
+        deallocateTexture( replaced );
+        allocateTexture( replaced, i );
     }
     else
     {
@@ -873,8 +973,12 @@ void ScrollingList::scroll( bool forward )
         Item *i    = items_->at( loopDecrement( itemIndex_, 1, items_->size(  ) ) );
         prevItemIndex_ = itemIndex_;
         itemIndex_ = loopDecrement( itemIndex_, 1, items_->size(  ) );
-        deallocateTexture( loopDecrement( 0, 1, components_.size(  ) ) );
-        allocateTexture( loopDecrement( 0, 1, components_.size(  ) ), i );
+        deallocateTexture( replaced );
+        allocateTexture( replaced, i );
+    }
+    if ( old && old != components_.at( replaced ) )
+    {
+        delete old;
     }
 
     // Set the animations
@@ -21,6 +21,7 @@
 #include "../Animate/Tween.h"
 #include "../Page.h"
 #include "../ViewInfo.h"
+#include "../SpriteAtlas.h"
 #include "../../Database/Configuration.h"
 #include <SDL/SDL.h>
 
@@ -75,6 +76,7 @@ public:
     void letterChange( bool increment );
     void random( );
     bool isIdle( );
+    float getNextUpdateTime( );
     bool getScrollDirectionForward( );
     float getScrollPeriod( );
     unsigned int getScrollOffsetIndex( );
@@ -85,9 +87,12 @@ public:
     Item *getSelectedItem( );
     void allocateGraphicsMemory( );
     void freeGraphicsMemory( );
+    void suspendGraphicsMemory( );
+    void resumeGraphicsMemory( );
     void update( float dt );
     void draw( );
     void draw( unsigned int layer );
+    void addToDrawList( DrawList &list );
     void setScrollAcceleration( float value );
     void setStartScrollTime( float value );
     bool horizontalScroll;
@@ -102,6 +107,7 @@ private:
     void resetTweens( Component *c, AnimationEvents *sets, ViewInfo *currentViewInfo, ViewInfo *nextViewInfo, double scrollTime );
     unsigned int loopIncrement( unsigned int offset, unsigned int i, unsigned int size );
     unsigned int loopDecrement( unsigned int offset, unsigned int i, unsigned int size );
+    void createAtlas( );
 
     bool layoutMode_;
     bool commonMode_;
@@ -129,5 +135,6 @@ private:
 
     std::vector<Item *>     *items_;
     std::vector<Component *> components_;
+    SpriteAtlas              atlas_;
 
 };
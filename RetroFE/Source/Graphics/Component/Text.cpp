@@ -17,6 +17,7 @@
 
 #include "Text.h"
 #include "../../Utility/Log.h"
+#include "../../Utility/Utils.h"
 #include "../../SDL.h"
 #include "../Font.h"
 #include <sstream>
@@ -61,10 +62,20 @@ void Text::initializeFonts( )
 
 void Text::setText( std::string text, int id )
 {
-    if ( getId( ) == id )
+    if ( getId( ) == id && textData_ != text )
+    {
         textData_ = text;
+        changed( );
+    }
 }
 
+// Glyphs are placed from the font metrics, so only transparency is checked
+bool Text::isVisible( )
+{
+    return baseViewInfo.Alpha > 0.0f;
+}
+
+
 void Text::draw( )
 {
     Component::draw( );
@@ -75,9 +86,6 @@ void Text::draw( )
     else                     // If not, use the general font settings
       font = fontInst_;
 
-    //SDL_Texture *t = font->getTexture( );
-    SDL_Surface *t = font->getTexture( );
-
     float imageHeight = 0;
     float imageWidth = 0;
     float imageMaxWidth = 0;
@@ -99,13 +107,14 @@ void Text::draw( )
     /*printf("\n");
     printf("imageMaxWidth=%f, imageHeight=%f, baseViewInfo.FontSize=%f,scale=%f\n", imageMaxWidth, imageHeight, baseViewInfo.FontSize, scale);
 */
-    unsigned int textIndexMax = 0;
+    size_t textIndexMax = 0;
 
     // determine image width
-    for ( unsigned int i = 0; i < textData_.size( ); ++i )
+    for ( size_t i = 0; i < textData_.size( ); )
     {
+        size_t start = i;
         Font::GlyphInfo glyph;
-        if ( font->getRect( textData_[i], glyph ) )
+        if ( font->getRect( Utils::decodeUtf8( textData_, i ), glyph ) )
         {
             SDL_Rect charRect = glyph.rect;
             //charRect.w  = static_cast<int>( glyph.advance );
@@ -121,7 +130,7 @@ void Text::draw( )
                 break;
             }
 
-            textIndexMax = i;
+            textIndexMax = start;
             imageWidth  += charRect.w;
 
             /*printf("textData_[%d]=%c, glyph.advance= %f - %d\n", i, textData_[i], glyph.advance, glyph.advance);
@@ -158,12 +167,12 @@ void Text::draw( )
     SDL_Rect rect;
     rect.x = static_cast<int>( xOrigin );
 
-    for ( unsigned int i = 0; i <= textIndexMax; ++i )
+    for ( size_t i = 0; i <= textIndexMax && i < textData_.size( ); )
     {
         Font::GlyphInfo glyph;
 
         //if ( font->getRect(textData_[i], glyph) && glyph.rect.h > 0 ) 	// Not working in SDL1.2 because glyph.rect.h = 0 for spaces
-        if ( font->getRect(textData_[i], glyph))
+        if ( font->getRect( Utils::decodeUtf8( textData_, i ), glyph ) )
         {
             SDL_Rect charRect = glyph.rect;
             float h = static_cast<float>( charRect.h * scale );
@@ -184,7 +193,7 @@ void Text::draw( )
             /*printf("font->getAscent( ) = %d, glyph.maxY : %d\n", font->getAscent( ), glyph.maxY );*/
             rect.y += static_cast<int>( (font->getAscent( ) - glyph.maxY)*scale );
 
-            SDL::renderCopy( t, baseViewInfo.Alpha, &charRect, &rect, baseViewInfo );
+            SDL::renderCopy( glyph.texture, baseViewInfo.Alpha, &charRect, &rect, baseViewInfo );
 
             rect.x += rect.w;
         }
@@ -37,6 +37,7 @@ public:
     void     deInitializeFonts( );
     void     initializeFonts( );
     void     draw( );
+    bool     isVisible( );
 
 private:
     std::string textData_;
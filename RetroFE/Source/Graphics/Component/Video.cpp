@@ -113,6 +113,19 @@ void Video::allocateGraphicsMemory( )
 }
 
 
+// Playback can't continue while a game runs, so stop it as usual
+void Video::suspendGraphicsMemory( )
+{
+    freeGraphicsMemory( );
+}
+
+
+void Video::resumeGraphicsMemory( )
+{
+    allocateGraphicsMemory( );
+}
+
+
 void Video::draw( )
 {
     Component::draw( );
@@ -137,3 +150,10 @@ bool Video::isPlaying( )
         return false;
     }
 }
+
+
+// Frames keep coming, never flattened with the layers below
+bool Video::isStatic( )
+{
+    return false;
+}
@@ -28,8 +28,11 @@ public:
     void update(float dt);
     void freeGraphicsMemory( );
     void allocateGraphicsMemory( );
+    void suspendGraphicsMemory( );
+    void resumeGraphicsMemory( );
     void draw( );
     virtual bool isPlaying( );
+    bool isStatic( );
 
 protected:
     Component  *video_;
@@ -82,6 +82,17 @@ void VideoComponent::freeGraphicsMemory()
     Component::freeGraphicsMemory();
 }
 
+// Playback can't continue while a game runs, so stop it as usual
+void VideoComponent::suspendGraphicsMemory()
+{
+    freeGraphicsMemory();
+}
+
+void VideoComponent::resumeGraphicsMemory()
+{
+    allocateGraphicsMemory();
+}
+
 
 void VideoComponent::draw()
 {
@@ -105,3 +116,10 @@ bool VideoComponent::isPlaying()
 {
     return isPlaying_;
 }
+
+
+// Frames keep coming, never flattened with the layers below
+bool VideoComponent::isStatic()
+{
+    return false;
+}
@@ -31,7 +31,10 @@ public:
     void draw();
     void freeGraphicsMemory();
     void allocateGraphicsMemory();
+    void suspendGraphicsMemory();
+    void resumeGraphicsMemory();
     virtual bool isPlaying();
+    bool isStatic();
 
 private:
     std::string videoFile_;
@@ -0,0 +1,204 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Dither.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define DITHER_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DITHER_NEON
+#endif
+
+#define DITHER_MIN(a,b) (((a)<(b))?(a):(b))
+#define DITHER_MAX(a,b) (((a)>(b))?(a):(b))
+
+/* Closest 5-bit level */
+#define CLOSEST_RB(c) (DITHER_MIN(c+4,0xff) >> 3 << 3)
+
+#define RGB32BIT(a, r, g, b) ((a<<24) | (r<<16) | (g<<8) | b)
+#define GET_A_32BIT(c)  ((c & 0xff000000) >> 24)
+#define GET_R_32BIT(c)  ((c & 0x00ff0000) >> 16)
+#define GET_G_32BIT(c)  ((c & 0x0000ff00) >> 8)
+#define GET_B_32BIT(c)  (c & 0x000000ff)
+
+static const unsigned char bayer4[4][4] =
+{
+    {  0,  8,  2, 10 },
+    { 12,  4, 14,  6 },
+    {  3, 11,  1,  9 },
+    { 15,  7, 13,  5 }
+};
+
+// Thresholds of one matrix row, 0..7 in each dithered byte of a pixel
+static void buildThresholds(uint32_t thresholds[4], int y, uint32_t keepMask)
+{
+    for(unsigned int x = 0; x < 4; ++x)
+    {
+        thresholds[x] = ((bayer4[y & 3][x] / 2) * 0x01010101u) & ~keepMask;
+    }
+}
+
+static inline uint32_t ditherPixel(uint32_t p, uint32_t threshold, uint32_t mask)
+{
+    uint32_t out = 0;
+    for(int shift = 0; shift < 32; shift += 8)
+    {
+        unsigned int c = ((p >> shift) & 0xff) + ((threshold >> shift) & 0xff);
+        out |= DITHER_MIN(c, 0xff) << shift;
+    }
+    return out & mask;
+}
+
+
+/* Error diffusion with "Filter Lite" also called "Sierra lite" method */
+void Dither::errorDiffusion(uint32_t *pixels, int width, int height, int pitch)
+{
+	/* Vars */
+	int x, y;
+	uint8_t r_old, g_old, b_old;
+	uint8_t r_new, g_new, b_new;
+	int r_error, g_error, b_error;
+	uint32_t cur_px;
+	uint32_t *row;
+	uint32_t *next_row;
+
+	/* Loop for dithering */
+	for (y=0; y<height; y++){
+		row = (uint32_t*)((uint8_t*)pixels + y*pitch);
+		next_row = (uint32_t*)((uint8_t*)row + pitch);
+		for (x=0; x < width; x++){
+
+			/* Get old and new rgb values of current pixel */
+			cur_px = row[x];
+			r_old = GET_R_32BIT(cur_px);
+			g_old = GET_G_32BIT(cur_px);
+			b_old = GET_B_32BIT(cur_px);
+			r_new = CLOSEST_RB(r_old);
+			g_new = CLOSEST_RB(g_old);	//RGB555
+			b_new = CLOSEST_RB(b_old);
+
+			/* Set new pixel value */
+			row[x] = RGB32BIT(GET_A_32BIT(cur_px), r_new, g_new, b_new);
+
+			/* Get errors */
+			r_error = r_old - r_new;
+			g_error = g_old - g_new;
+			b_error = b_old - b_new;
+
+			/* Right pixel */
+			if(x + 1 < width){
+				cur_px = row[x+1];
+				r_old = GET_R_32BIT(cur_px);
+				g_old = GET_G_32BIT(cur_px);
+				b_old = GET_B_32BIT(cur_px);
+				row[x+1] =
+						RGB32BIT( GET_A_32BIT(cur_px),
+								DITHER_MAX(DITHER_MIN((int)r_old + (r_error>>1), 0xff), 0),
+								DITHER_MAX(DITHER_MIN((int)g_old + (g_error>>1), 0xff), 0),
+								DITHER_MAX(DITHER_MIN((int)b_old + (b_error>>1), 0xff), 0) );
+			}
+
+			/* Bottom pixel */
+			if(y + 1 < height){
+				cur_px = next_row[x];
+				r_old = GET_R_32BIT(cur_px);
+				g_old = GET_G_32BIT(cur_px);
+				b_old = GET_B_32BIT(cur_px);
+				next_row[x] =
+						RGB32BIT( GET_A_32BIT(cur_px),
+								DITHER_MAX(DITHER_MIN((int)r_old + (r_error>>2), 0xff), 0),
+								DITHER_MAX(DITHER_MIN((int)g_old + (g_error>>2), 0xff), 0),
+								DITHER_MAX(DITHER_MIN((int)b_old + (b_error>>2), 0xff), 0) );
+			}
+
+			/* Bottom left pixel */
+			if( x > 0 &&  y + 1 < height){
+				cur_px = next_row[x-1];
+				r_old = GET_R_32BIT(cur_px);
+				g_old = GET_G_32BIT(cur_px);
+				b_old = GET_B_32BIT(cur_px);
+				next_row[x-1] =
+						RGB32BIT( GET_A_32BIT(cur_px),
+								DITHER_MAX(DITHER_MIN((int)r_old + (r_error>>2), 0xff), 0),
+								DITHER_MAX(DITHER_MIN((int)g_old + (g_error>>2), 0xff), 0),
+								DITHER_MAX(DITHER_MIN((int)b_old + (b_error>>2), 0xff), 0) );
+			}
+		}
+	}
+}
+
+
+// Reference implementation. Bytes set in keepMask (alpha) are left alone,
+// the others become min(c + threshold, 255) & 0xf8.
+void Dither::orderedScalar(uint32_t *pixels, int width, int height, int pitch, uint32_t keepMask)
+{
+    uint32_t mask = 0xf8f8f8f8u | keepMask;
+    uint32_t thresholds[4];
+
+    for(int y = 0; y < height; ++y)
+    {
+        uint32_t *row = reinterpret_cast<uint32_t *>(reinterpret_cast<uint8_t *>(pixels) + y * pitch);
+        buildThresholds(thresholds, y, keepMask);
+        for(int x = 0; x < width; ++x)
+        {
+            row[x] = ditherPixel(row[x], thresholds[x & 3], mask);
+        }
+    }
+}
+
+
+void Dither::ordered(uint32_t *pixels, int width, int height, int pitch, uint32_t keepMask)
+{
+#if defined(DITHER_SSE2) || defined(DITHER_NEON)
+    uint32_t mask = 0xf8f8f8f8u | keepMask;
+    uint32_t thresholds[4];
+
+    for(int y = 0; y < height; ++y)
+    {
+        uint32_t *row = reinterpret_cast<uint32_t *>(reinterpret_cast<uint8_t *>(pixels) + y * pitch);
+        buildThresholds(thresholds, y, keepMask);
+
+        // Four pixels at a time, one matrix row
+        int x = 0;
+#if defined(DITHER_SSE2)
+        const __m128i maskVector = _mm_set1_epi32(mask);
+        const __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i *>(thresholds));
+        for(; x + 4 <= width; x += 4)
+        {
+            __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + x));
+            p = _mm_and_si128(_mm_adds_epu8(p, t), maskVector);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(row + x), p);
+        }
+#else
+        const uint8x16_t maskVector = vreinterpretq_u8_u32(vdupq_n_u32(mask));
+        const uint8x16_t t = vreinterpretq_u8_u32(vld1q_u32(thresholds));
+        for(; x + 4 <= width; x += 4)
+        {
+            uint8x16_t p = vreinterpretq_u8_u32(vld1q_u32(row + x));
+            p = vandq_u8(vqaddq_u8(p, t), maskVector);
+            vst1q_u32(row + x, vreinterpretq_u32_u8(p));
+        }
+#endif
+        for(; x < width; ++x)
+        {
+            row[x] = ditherPixel(row[x], thresholds[x & 3], mask);
+        }
+    }
+#else
+    orderedScalar(pixels, width, height, pitch, keepMask);
+#endif
+}
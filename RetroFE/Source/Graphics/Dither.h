@@ -0,0 +1,34 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+
+// Reduces 32bpp pixels to the 5 bits per channel levels the panel shows.
+// Pixels are 32-bit words with 8-bit channels, pitch is in bytes.
+//
+// Error diffusion (Sierra lite) gives the best result but every pixel
+// depends on the previous ones. Ordered dither adds a threshold taken from
+// a 4x4 Bayer matrix, so each pixel is independent and several are done at
+// once with SSE2 or NEON. With 8 input values per output level there are
+// only 8 distinct thresholds, a larger matrix would give the same result.
+class Dither
+{
+public:
+    static void errorDiffusion(uint32_t *pixels, int width, int height, int pitch);
+    static void ordered(uint32_t *pixels, int width, int height, int pitch, uint32_t keepMask);
+    static void orderedScalar(uint32_t *pixels, int width, int height, int pitch, uint32_t keepMask);
+};
@@ -0,0 +1,352 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Downscale.h"
+#include "AlphaBlit.h"
+#include <cmath>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define DOWNSCALE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DOWNSCALE_NEON
+#endif
+
+#define WEIGHT_BITS  14
+#define MIDDLE_BITS  7
+
+// For every destination pixel along one axis, the first source pixel it
+// covers and the weight of each it covers, adding up to 1 << WEIGHT_BITS
+struct Filter
+{
+    std::vector<int>     first;
+    std::vector<int>     count;
+    std::vector<int16_t> weights;
+    int                  taps;
+};
+
+static void buildFilter(int srcSize, int dstSize, Filter &filter)
+{
+    double scale = static_cast<double>(srcSize) / dstSize;
+    filter.taps = static_cast<int>(ceil(scale)) + 1;
+    filter.first.resize(dstSize);
+    filter.count.resize(dstSize);
+    filter.weights.assign(static_cast<size_t>(dstSize) * filter.taps, 0);
+
+    for(int i = 0; i < dstSize; ++i)
+    {
+        double start = i * scale;
+        double end   = (i == dstSize - 1) ? srcSize : (i + 1) * scale;
+        int first    = static_cast<int>(floor(start));
+        int last     = static_cast<int>(ceil(end)) - 1;
+        if(last >= srcSize) last = srcSize - 1;
+        if(last < first) last = first;
+
+        // Rounded from the running total, so the weights add up exactly
+        int previous = 0;
+        for(int j = first; j <= last; ++j)
+        {
+            double covered = ((j + 1 < end) ? j + 1 : end) - start;
+            int total = (j == last) ? (1 << WEIGHT_BITS)
+                                    : static_cast<int>(floor(covered / (end - start) * (1 << WEIGHT_BITS) + 0.5));
+            filter.weights[i * filter.taps + j - first] = static_cast<int16_t>(total - previous);
+            previous = total;
+        }
+        filter.first[i] = first;
+        filter.count[i] = last - first + 1;
+    }
+}
+
+
+// Averages one source row into the 4 channels of each destination pixel,
+// with MIDDLE_BITS of fraction
+static void horizontalScalar(const uint32_t *src, int16_t *dst, const Filter &filter, int width)
+{
+    for(int x = 0; x < width; ++x)
+    {
+        const uint32_t *p = src + filter.first[x];
+        const int16_t *w  = &filter.weights[x * filter.taps];
+        int sum[4] = { 0, 0, 0, 0 };
+        for(int k = 0; k < filter.count[x]; ++k)
+        {
+            for(int c = 0; c < 4; ++c)
+            {
+                sum[c] += w[k] * static_cast<int>((p[k] >> (8 * c)) & 0xff);
+            }
+        }
+        for(int c = 0; c < 4; ++c)
+        {
+            dst[x * 4 + c] = static_cast<int16_t>((sum[c] + (1 << (WEIGHT_BITS - MIDDLE_BITS - 1))) >> (WEIGHT_BITS - MIDDLE_BITS));
+        }
+    }
+}
+
+
+// Averages the rows a destination row covers, from value start on
+static void verticalScalar(const int16_t *const *rows, const int16_t *w, int count, int16_t *dst, int start, int values)
+{
+    for(int i = start; i < values; ++i)
+    {
+        int sum = 0;
+        for(int k = 0; k < count; ++k)
+        {
+            sum += w[k] * rows[k][i];
+        }
+        dst[i] = static_cast<int16_t>((sum + (1 << (WEIGHT_BITS - 1))) >> WEIGHT_BITS);
+    }
+}
+
+
+#if defined(DOWNSCALE_SSE2)
+// Two source pixels per multiply: their channels interleaved against
+// their two weights, pmaddwd adds both products per channel
+static void horizontalVector(const uint32_t *src, int16_t *dst, const Filter &filter, int width)
+{
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(1 << (WEIGHT_BITS - MIDDLE_BITS - 1));
+
+    for(int x = 0; x < width; ++x)
+    {
+        const uint32_t *p = src + filter.first[x];
+        const int16_t *w  = &filter.weights[x * filter.taps];
+        int count         = filter.count[x];
+        __m128i sum       = zero;
+        for(int k = 0; k < count; k += 2)
+        {
+            uint32_t second = (k + 1 < count) ? p[k + 1] : 0;
+            int16_t weight  = (k + 1 < count) ? w[k + 1] : 0;
+            __m128i a       = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(p[k])), zero);
+            __m128i b       = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(second)), zero);
+            __m128i weights = _mm_set1_epi32(static_cast<int>((static_cast<uint32_t>(static_cast<uint16_t>(weight)) << 16) |
+                                                              static_cast<uint16_t>(w[k])));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), weights));
+        }
+        sum = _mm_srai_epi32(_mm_add_epi32(sum, round), WEIGHT_BITS - MIDDLE_BITS);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + x * 4), _mm_packs_epi32(sum, sum));
+    }
+}
+
+
+// Eight values of two rows per step, interleaved the same way
+static void verticalVector(const int16_t *const *rows, const int16_t *w, int count, int16_t *dst, int values)
+{
+    const __m128i round = _mm_set1_epi32(1 << (WEIGHT_BITS - 1));
+    int i = 0;
+
+    for(; i + 8 <= values; i += 8)
+    {
+        __m128i low  = _mm_setzero_si128();
+        __m128i high = _mm_setzero_si128();
+        for(int k = 0; k < count; k += 2)
+        {
+            bool pair       = k + 1 < count;
+            __m128i a       = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[k] + i));
+            __m128i b       = pair ? _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[k + 1] + i)) : _mm_setzero_si128();
+            int16_t weight  = pair ? w[k + 1] : 0;
+            __m128i weights = _mm_set1_epi32(static_cast<int>((static_cast<uint32_t>(static_cast<uint16_t>(weight)) << 16) |
+                                                              static_cast<uint16_t>(w[k])));
+            low  = _mm_add_epi32(low, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), weights));
+            high = _mm_add_epi32(high, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), weights));
+        }
+        low  = _mm_srai_epi32(_mm_add_epi32(low, round), WEIGHT_BITS);
+        high = _mm_srai_epi32(_mm_add_epi32(high, round), WEIGHT_BITS);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packs_epi32(low, high));
+    }
+
+    verticalScalar(rows, w, count, dst, i, values);
+}
+#elif defined(DOWNSCALE_NEON)
+static void horizontalVector(const uint32_t *src, int16_t *dst, const Filter &filter, int width)
+{
+    for(int x = 0; x < width; ++x)
+    {
+        const uint32_t *p = src + filter.first[x];
+        const int16_t *w  = &filter.weights[x * filter.taps];
+        int32x4_t sum     = vdupq_n_s32(0);
+        for(int k = 0; k < filter.count[x]; ++k)
+        {
+            int16x4_t channels = vreinterpret_s16_u16(vget_low_u16(vmovl_u8(vcreate_u8(p[k]))));
+            sum = vmlal_n_s16(sum, channels, w[k]);
+        }
+        vst1_s16(dst + x * 4, vmovn_s32(vrshrq_n_s32(sum, WEIGHT_BITS - MIDDLE_BITS)));
+    }
+}
+
+
+static void verticalVector(const int16_t *const *rows, const int16_t *w, int count, int16_t *dst, int values)
+{
+    int i = 0;
+
+    for(; i + 8 <= values; i += 8)
+    {
+        int32x4_t low  = vdupq_n_s32(0);
+        int32x4_t high = vdupq_n_s32(0);
+        for(int k = 0; k < count; ++k)
+        {
+            int16x8_t v = vld1q_s16(rows[k] + i);
+            low  = vmlal_n_s16(low, vget_low_s16(v), w[k]);
+            high = vmlal_n_s16(high, vget_high_s16(v), w[k]);
+        }
+        vst1q_s16(dst + i, vcombine_s16(vmovn_s32(vrshrq_n_s32(low, WEIGHT_BITS)),
+                                        vmovn_s32(vrshrq_n_s32(high, WEIGHT_BITS))));
+    }
+
+    verticalScalar(rows, w, count, dst, i, values);
+}
+#endif
+
+
+// Back to 8-bit channels, colors divided by the averaged alpha
+static void pack(const int16_t *src, uint32_t *dst, int width, int aShift)
+{
+    const int half = 1 << (MIDDLE_BITS - 1);
+    int alpha = aShift / 8;
+
+    for(int x = 0; x < width; ++x)
+    {
+        const int16_t *v = src + x * 4;
+        uint32_t out = 0;
+        if(aShift < 0)
+        {
+            for(int c = 0; c < 4; ++c)
+            {
+                out |= static_cast<uint32_t>((v[c] + half) >> MIDDLE_BITS) << (8 * c);
+            }
+        }
+        else if(v[alpha] > 0)
+        {
+            int a = v[alpha];
+            for(int c = 0; c < 4; ++c)
+            {
+                int value = (c == alpha) ? (a + half) >> MIDDLE_BITS : (v[c] * 255 + a / 2) / a;
+                out |= static_cast<uint32_t>(value > 255 ? 255 : value) << (8 * c);
+            }
+        }
+        dst[x] = out;
+    }
+}
+
+
+// The rows a destination row needs are averaged horizontally as it needs
+// them, into a ring of as many rows as a destination row covers at most
+bool Downscale::run(const uint32_t *src, int srcWidth, int srcHeight, int srcPitch,
+                    uint32_t *dst, int dstWidth, int dstHeight, int dstPitch, int aShift, bool vector)
+{
+    if(!src || !dst || dstWidth <= 0 || dstHeight <= 0 || dstWidth > srcWidth || dstHeight > srcHeight ||
+       srcPitch < srcWidth * 4 || dstPitch < dstWidth * 4 ||
+       (aShift != -1 && aShift != 0 && aShift != 8 && aShift != 16 && aShift != 24))
+    {
+        return false;
+    }
+
+    Filter columns;
+    Filter rows;
+    buildFilter(srcWidth, dstWidth, columns);
+    buildFilter(srcHeight, dstHeight, rows);
+
+    AlphaBlit::Layout layout = { 0, 8, 16, aShift };
+    int other = 0;
+    for(int shift = 0; shift < 32 && aShift >= 0; shift += 8)
+    {
+        if(shift == aShift) continue;
+        if(other == 0) layout.rShift = shift;
+        if(other == 1) layout.gShift = shift;
+        if(other == 2) layout.bShift = shift;
+        other++;
+    }
+
+    int values = dstWidth * 4;
+    std::vector<int16_t> ring(static_cast<size_t>(rows.taps) * values);
+    std::vector<int16_t> averaged(values);
+    std::vector<uint32_t> premultiplied(aShift >= 0 ? srcWidth : 0);
+    std::vector<const int16_t *> needed(rows.taps);
+    int next = 0;
+
+    for(int y = 0; y < dstHeight; ++y)
+    {
+        int first = rows.first[y];
+        int count = rows.count[y];
+        for(; next < first + count; ++next)
+        {
+            const uint32_t *row = reinterpret_cast<const uint32_t *>(reinterpret_cast<const uint8_t *>(src) +
+                                                                     static_cast<size_t>(srcPitch) * next);
+            if(aShift >= 0)
+            {
+                AlphaBlit::premultiply(row, layout, &premultiplied[0], layout, srcWidth);
+                row = &premultiplied[0];
+            }
+            int16_t *out = &ring[static_cast<size_t>(next % rows.taps) * values];
+#if defined(DOWNSCALE_SSE2) || defined(DOWNSCALE_NEON)
+            if(vector)
+            {
+                horizontalVector(row, out, columns, dstWidth);
+            }
+            else
+#endif
+            {
+                horizontalScalar(row, out, columns, dstWidth);
+            }
+        }
+
+        for(int k = 0; k < count; ++k)
+        {
+            needed[k] = &ring[static_cast<size_t>((first + k) % rows.taps) * values];
+        }
+        const int16_t *w = &rows.weights[y * rows.taps];
+#if defined(DOWNSCALE_SSE2) || defined(DOWNSCALE_NEON)
+        if(vector)
+        {
+            verticalVector(&needed[0], w, count, &averaged[0], values);
+        }
+        else
+#endif
+        {
+            verticalScalar(&needed[0], w, count, &averaged[0], 0, values);
+        }
+
+        pack(&averaged[0], reinterpret_cast<uint32_t *>(reinterpret_cast<uint8_t *>(dst) + static_cast<size_t>(dstPitch) * y),
+             dstWidth, aShift);
+    }
+
+    return true;
+}
+
+
+bool Downscale::scale(const uint32_t *src, int srcWidth, int srcHeight, int srcPitch,
+                      uint32_t *dst, int dstWidth, int dstHeight, int dstPitch, int aShift)
+{
+    return run(src, srcWidth, srcHeight, srcPitch, dst, dstWidth, dstHeight, dstPitch, aShift, true);
+}
+
+
+bool Downscale::scaleScalar(const uint32_t *src, int srcWidth, int srcHeight, int srcPitch,
+                            uint32_t *dst, int dstWidth, int dstHeight, int dstPitch, int aShift)
+{
+    return run(src, srcWidth, srcHeight, srcPitch, dst, dstWidth, dstHeight, dstPitch, aShift, false);
+}
+
+
+const char *Downscale::getKernelName()
+{
+#if defined(DOWNSCALE_SSE2)
+    return "sse2";
+#elif defined(DOWNSCALE_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
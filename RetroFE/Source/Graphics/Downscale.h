@@ -0,0 +1,45 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+
+// Shrinks 32-bit textures once when they load, to the size they are shown
+// at. Every destination pixel is the average of the source area it covers,
+// the pixels on its edges weighted by how much of them it covers. Rows
+// are averaged first, then columns of the averaged rows.
+//
+// With an alpha channel, colors are averaged premultiplied by their alpha
+// and divided by the averaged alpha at the end, so transparent pixels do
+// not darken the edges. The averages use 14-bit weights and keep 7 bits
+// of fraction between the two passes; the vector kernels compute exactly
+// what the scalar ones do.
+//
+// Per frame scaling while a size animates stays the nearest neighbour
+// sampling of SDL::zoomSurface.
+class Downscale
+{
+public:
+    static bool scale(const uint32_t *src, int srcWidth, int srcHeight, int srcPitch,
+                      uint32_t *dst, int dstWidth, int dstHeight, int dstPitch, int aShift);
+    static bool scaleScalar(const uint32_t *src, int srcWidth, int srcHeight, int srcPitch,
+                            uint32_t *dst, int dstWidth, int dstHeight, int dstPitch, int aShift);
+    static const char *getKernelName();
+
+private:
+    static bool run(const uint32_t *src, int srcWidth, int srcHeight, int srcPitch,
+                    uint32_t *dst, int dstWidth, int dstHeight, int dstPitch, int aShift, bool vector);
+};
@@ -0,0 +1,62 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "DrawList.h"
+
+DrawList::DrawList(unsigned int layers)
+    : layers_(layers)
+    , size_(0)
+{
+}
+
+
+// Empties the buckets, keeping their memory for the next frame
+void DrawList::clear()
+{
+    for(unsigned int i = 0; i < layers_.size(); ++i)
+    {
+        layers_[i].clear();
+    }
+    size_ = 0;
+}
+
+
+// Components on a layer past the last one are never drawn
+bool DrawList::add(Component *component, unsigned int layer)
+{
+    if(layer >= layers_.size()) return false;
+
+    layers_[layer].push_back(component);
+    size_++;
+    return true;
+}
+
+
+unsigned int DrawList::getLayerCount()
+{
+    return layers_.size();
+}
+
+
+std::vector<Component *> &DrawList::getLayer(unsigned int layer)
+{
+    return layers_[layer];
+}
+
+
+unsigned int DrawList::size()
+{
+    return size_;
+}
@@ -0,0 +1,36 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <vector>
+
+class Component;
+
+// Components to draw in one frame, bucketed by layer in the order they were added
+class DrawList
+{
+public:
+    DrawList(unsigned int layers);
+    void clear();
+    bool add(Component *component, unsigned int layer);
+    unsigned int getLayerCount();
+    std::vector<Component *> &getLayer(unsigned int layer);
+    unsigned int size();
+
+private:
+    std::vector< std::vector<Component *> > layers_;
+    unsigned int size_;
+};
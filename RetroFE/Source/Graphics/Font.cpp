@@ -21,9 +21,20 @@
 //#include <SDL/SDL_gfxBlitFunc.h>
 #include <cstdio>
 #include <cstring>
+#include <sstream>
+
+#define FONT_PAGE_SIZE  256   // pixels, doubled until a page holds 4 lines
+#define FONT_MAX_PAGES  4
+#define FONT_PRELOAD_FIRST  32
+#define FONT_PRELOAD_LAST   127
 
 Font::Font(std::string fontPath, int fontSize, SDL_Color color)
-    : texture(NULL)
+    : font_(NULL)
+    , cache_(NULL)
+    , atlasFile_(NULL)
+    , fontHash_(0)
+    , height(0)
+    , ascent(0)
     , fontPath_(fontPath)
     , fontSize_(fontSize)
     , color_(color)
@@ -35,9 +46,16 @@ Font::~Font()
     deInitialize();
 }
 
-SDL_Surface *Font::getTexture()
+// Where the preloaded glyphs are kept between runs, none when empty
+void Font::setCacheFile(std::string file)
+{
+    cacheFile_ = file;
+}
+
+// Hash of the font file, read from the file on first use when not given
+void Font::setFontHash(uint64_t hash)
 {
-    return texture;
+    fontHash_ = hash;
 }
 
 int Font::getHeight()
@@ -50,25 +68,37 @@ int Font::getAscent()
 }
 bool Font::getRect(unsigned int charCode, GlyphInfo &glyph)
 {
-    std::map<unsigned int, GlyphInfoBuild *>::iterator it = atlas.find(charCode);
+    if(!cache_) return false;
 
-    if(it != atlas.end())
+    GlyphCache::Glyph cached;
+    if(!cache_->find(charCode, cached) && !renderGlyph(charCode, cached))
     {
-        GlyphInfoBuild *info = it->second;
+        return false;
+    }
 
-        glyph = info->glyph;
+    if(!cached.provided) return false;
 
-        return true;
-    }
+    glyph.minX    = cached.minX;
+    glyph.maxX    = cached.maxX;
+    glyph.minY    = cached.minY;
+    glyph.maxY    = cached.maxY;
+    glyph.advance = cached.advance;
+    glyph.rect.x  = cached.x;
+    glyph.rect.y  = cached.y;
+    glyph.rect.w  = cached.w;
+    glyph.rect.h  = cached.h;
+    glyph.texture = pages_[cached.page];
 
-    return false;
+    return true;
 }
 
 bool Font::initialize()
 {
-    TTF_Font *font = TTF_OpenFont(fontPath_.c_str(), fontSize_);
+    if(font_) return true;
 
-    if (!font)
+    font_ = TTF_OpenFont(fontPath_.c_str(), fontSize_);
+
+    if (!font_)
     {
         std::stringstream ss;
         ss << "Could not open font: " << TTF_GetError();
@@ -76,51 +106,192 @@ bool Font::initialize()
         return false;
     }
 
-    int x = 0;
-    int y = 0;
-    int atlasHeight = 0;
-    int atlasWidth = 0;
-    height = TTF_FontHeight(font);
-    ascent = TTF_FontAscent(font);
+    height = TTF_FontHeight(font_);
+    ascent = TTF_FontAscent(font_);
+
+    int pageSize = FONT_PAGE_SIZE;
+    while(pageSize < height * 4)
+    {
+        pageSize *= 2;
+    }
+    cache_ = new GlyphCache(pageSize, pageSize, FONT_MAX_PAGES);
+
+    if(!cacheFile_.empty() && loadAtlas())
+    {
+        return true;
+    }
 
-    for(unsigned short int i = 32; i < 128; ++i)
+    // ASCII is used by almost every text, other glyphs come when shown
+    for(unsigned int i = FONT_PRELOAD_FIRST; i <= FONT_PRELOAD_LAST; ++i)
     {
-        GlyphInfoBuild *info = new GlyphInfoBuild;
-        memset(info, 0, sizeof(GlyphInfoBuild));
+        GlyphCache::Glyph glyph;
+        renderGlyph(i, glyph);
+    }
 
-        //color_.a = 255;
-        info->surface = TTF_RenderGlyph_Blended(font, i, color_);
-        TTF_GlyphMetrics(font, i,
-        		&info->glyph.minX, &info->glyph.maxX,
-        		&info->glyph.minY, &info->glyph.maxY,
-        		&info->glyph.advance);
+    if(!cacheFile_.empty())
+    {
+        saveAtlas();
+    }
+
+    return true;
+}
+
+bool Font::buildAtlasKey(FontAtlasFile::Key &key)
+{
+    memset(&key, 0, sizeof(key));
+    if(fontHash_ == 0)
+    {
+        fontHash_ = FontAtlasFile::hashFile(fontPath_);
+    }
+    key.fontHash   = fontHash_;
+    key.fontSize   = fontSize_;
+    key.r          = color_.r;
+    key.g          = color_.g;
+    key.b          = color_.b;
+    key.firstGlyph = FONT_PRELOAD_FIRST;
+    key.lastGlyph  = FONT_PRELOAD_LAST;
+
+    return key.fontHash != 0;
+}
+
+// Uses the pages saved by a previous run instead of rendering the preloaded
+// glyphs again
+bool Font::loadAtlas()
+{
+    FontAtlasFile::Key key;
+    if(!buildAtlasKey(key)) return false;
+
+    atlasFile_ = new FontAtlasFile();
+    bool loaded = atlasFile_->open(cacheFile_, key) &&
+                  atlasFile_->getHeight() == height &&
+                  atlasFile_->getAscent() == ascent &&
+                  atlasFile_->getPageWidth() == cache_->getPageWidth() &&
+                  atlasFile_->getPageHeight() == cache_->getPageHeight() &&
+                  atlasFile_->getPageCount() <= FONT_MAX_PAGES;
+
+    // Placing the glyphs in the order they were saved puts them back where
+    // they were, anything else means the packing changed since
+    const FontAtlasFile::Entry *entries = loaded ? atlasFile_->getGlyphs() : NULL;
+    for(unsigned int i = 0; loaded && i < atlasFile_->getGlyphCount(); ++i)
+    {
+        GlyphCache::Glyph glyph = entries[i].glyph;
+        bool pageReset;
+        loaded = cache_->insert(entries[i].codepoint, glyph, pageReset) && !pageReset &&
+                 glyph.page == entries[i].glyph.page &&
+                 glyph.x == entries[i].glyph.x &&
+                 glyph.y == entries[i].glyph.y;
+    }
+
+    loaded = loaded && cache_->getPageCount() == atlasFile_->getPageCount();
+
+    if(!loaded)
+    {
+        cache_->clear();
+        delete atlasFile_;
+        atlasFile_ = NULL;
+        return false;
+    }
+
+    for(unsigned int i = 0; i < atlasFile_->getPageCount(); ++i)
+    {
+        pages_.push_back(createPage(atlasFile_->getPage(i)));
+    }
+
+    return true;
+}
 
-        if(x + info->surface->w >= 1024)
+void Font::saveAtlas()
+{
+    FontAtlasFile::Key key;
+    if(!buildAtlasKey(key) || pages_.empty()) return;
+
+    std::vector<FontAtlasFile::Entry> entries;
+    for(unsigned int i = FONT_PRELOAD_FIRST; i <= FONT_PRELOAD_LAST; ++i)
+    {
+        FontAtlasFile::Entry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.codepoint = i;
+        if(cache_->find(i, entry.glyph))
         {
-            atlasHeight += y;
-            atlasWidth = (atlasWidth >= x) ? atlasWidth : x;
-            x = 0;
-            y = 0;
+            entries.push_back(entry);
         }
+    }
+
+    std::vector<const void *> pixels;
+    for(std::vector<SDL_Surface *>::iterator it = pages_.begin(); it != pages_.end(); it++)
+    {
+        pixels.push_back((*it)->pixels);
+    }
+
+    if(FontAtlasFile::write(cacheFile_, key, height, ascent, cache_->getPageWidth(), cache_->getPageHeight(),
+                            pages_[0]->pitch, entries, pixels))
+    {
+        Logger::write(Logger::ZONE_INFO, "FontCache", "Saved font atlas " + cacheFile_);
+    }
+}
 
-        info->glyph.rect.w = info->surface->w;
-        info->glyph.rect.h = info->surface->h;
-        info->glyph.rect.x = x;
-        info->glyph.rect.y = atlasHeight;
-        atlas[i] = info;
+// Renders a glyph into the cache, or records that the font lacks it
+bool Font::renderGlyph(unsigned int charCode, GlyphCache::Glyph &glyph)
+{
+    memset(&glyph, 0, sizeof(glyph));
+
+    // SDL_ttf only renders the basic multilingual plane
+    SDL_Surface *surface = NULL;
+    if(charCode <= 0xffff && TTF_GlyphIsProvided(font_, charCode))
+    {
+        //color_.a = 255;
+        surface = TTF_RenderGlyph_Blended(font_, charCode, color_);
+    }
 
-        x += info->glyph.rect.w;
-        y = (y > info->glyph.rect.h) ? y : info->glyph.rect.h;
+    if(surface)
+    {
+        TTF_GlyphMetrics(font_, charCode,
+        		&glyph.minX, &glyph.maxX,
+        		&glyph.minY, &glyph.maxY,
+        		&glyph.advance);
+        glyph.w = surface->w;
+        glyph.h = surface->h;
+        glyph.provided = true;
+    }
+
+    bool pageReset;
+    if(!cache_->insert(charCode, glyph, pageReset))
+    {
+        std::stringstream ss;
+        ss << "Glyph " << charCode << " does not fit in a font page";
+        Logger::write(Logger::ZONE_WARNING, "FontCache", ss.str());
+        if(surface) SDL_FreeSurface(surface);
+        return false;
+    }
 
-        /*std::stringstream ss;
-        ss << " tw:" << atlasWidth << " th:" << atlasHeight << " x:" << x << " y:" << y << " w:" << info->glyph.rect.w << " h:" << info->glyph.rect.h;
-        Logger::write(Logger::ZONE_INFO, "FontCache", ss.str());*/
+    if(surface)
+    {
+        if(glyph.page >= pages_.size())
+        {
+            pages_.push_back(createPage());
+        }
+        else if(pageReset)
+        {
+            SDL_FillRect(pages_[glyph.page], NULL, SDL_MapRGBA(pages_[glyph.page]->format, 0, 0, 0, 0));
+        }
 
+        SDL_Rect rect;
+        rect.x = glyph.x;
+        rect.y = glyph.y;
+        rect.w = glyph.w;
+        rect.h = glyph.h;
+        SDL_SetAlpha( surface, 0, SDL_ALPHA_OPAQUE );
+        SDL_BlitSurface(surface, NULL, pages_[glyph.page], &rect);
+        //SDL_gfxBlitRGBA (surface, NULL, pages_[glyph.page], &rect);
+        SDL_FreeSurface(surface);
     }
 
-    atlasWidth = (atlasWidth >= x) ? atlasWidth : x;
-    atlasHeight += y;
+    return true;
+}
 
+// Pages loaded from an atlas file use its mapped pixels
+SDL_Surface *Font::createPage(void *pixels)
+{
     unsigned int rmask;
     unsigned int gmask;
     unsigned int bmask;
@@ -137,59 +308,49 @@ bool Font::initialize()
     amask = 0xff000000;
 #endif
 
-    //SDL_Surface *atlasSurface = SDL_CreateRGBSurface(0, atlasWidth, atlasHeight, 32, rmask, gmask, bmask, amask);
-    texture = SDL_CreateRGBSurface(0, atlasWidth, atlasHeight, 32, rmask, gmask, bmask, amask);
-    SDL_FillRect(texture, NULL, SDL_MapRGBA(texture->format, 0, 0, 0, 0));
-
-    /*texture = SDL_CreateRGBSurface(0, atlasWidth, atlasHeight, 32, 0, 0, 0, 0);
-    int transparentColorKey = SDL_MapRGB(texture->format, color_.r-1, color_.g-1, color_.b-1);
-    SDL_FillRect(texture, NULL, transparentColorKey);
-    SDL_SetColorKey(texture, SDL_SRCCOLORKEY, transparentColorKey);*/
-
-    std::map<unsigned int, GlyphInfoBuild *>::iterator it;
-    for(it = atlas.begin(); it != atlas.end(); it++)
+    if(pixels)
     {
-        GlyphInfoBuild *info = it->second;
-        //SDL_BlitSurface(info->surface, NULL, atlasSurface, &info->glyph.rect);
-        SDL_SetAlpha( info->surface, 0, SDL_ALPHA_OPAQUE );
-        SDL_BlitSurface(info->surface, NULL, texture, &info->glyph.rect);
-        //SDL_gfxBlitRGBA (info->surface, NULL, texture, &info->glyph.rect);
-        SDL_FreeSurface(info->surface);
-        info->surface = NULL;
+        return SDL::createSurfaceFrom(pixels, cache_->getPageWidth(), cache_->getPageHeight(), 32,
+                                      cache_->getPageWidth() * 4, rmask, gmask, bmask, amask, "Font");
     }
 
-    /*SDL_LockMutex(SDL::getMutex());
-    //texture = SDL_CreateTextureFromSurface(SDL::getRenderer(), atlasSurface);
-    //SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
-    SDL_FreeSurface(atlasSurface);
-    SDL_UnlockMutex(SDL::getMutex());*/
+    SDL_Surface *page = SDL::createSurface(0, cache_->getPageWidth(), cache_->getPageHeight(), 32, rmask, gmask, bmask, amask, "Font");
+    SDL_FillRect(page, NULL, SDL_MapRGBA(page->format, 0, 0, 0, 0));
 
-    TTF_CloseFont(font);
-
-    return true;
+    return page;
 }
 
 
 
 void Font::deInitialize()
 {
-    if(texture)
+    if(!pages_.empty())
     {
         SDL_LockMutex(SDL::getMutex());
-        //SDL_DestroyTexture(texture);
-        SDL_FreeSurface(texture);
-        texture = NULL;
+        for(std::vector<SDL_Surface *>::iterator it = pages_.begin(); it != pages_.end(); it++)
+        {
+            SDL::freeSurface(*it);
+        }
+        pages_.clear();
         SDL_UnlockMutex(SDL::getMutex());
     }
 
-    std::map<unsigned int, GlyphInfoBuild *>::iterator atlasIt = atlas.begin();
-    while(atlasIt != atlas.end())
+    // Only after the pages using its pixels are gone
+    if(atlasFile_)
     {
-        delete atlasIt->second;
-        atlas.erase(atlasIt);
-        atlasIt = atlas.begin();
+        delete atlasFile_;
+        atlasFile_ = NULL;
     }
 
-}
-
+    if(cache_)
+    {
+        delete cache_;
+        cache_ = NULL;
+    }
 
+    if(font_)
+    {
+        TTF_CloseFont(font_);
+        font_ = NULL;
+    }
+}
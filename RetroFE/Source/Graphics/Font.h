@@ -15,9 +15,12 @@
  */
 #pragma once
 
+#include "FontAtlasFile.h"
+#include "GlyphCache.h"
 #include <SDL/SDL.h>
-#include <map>
+#include <SDL/SDL_ttf.h>
 #include <string>
+#include <vector>
 
 class Font
 {
@@ -30,30 +33,35 @@ public:
         int maxY;
         int advance;
         SDL_Rect rect;
+        SDL_Surface *texture;
     };
 
     Font(std::string fontPath, int fontSize, SDL_Color color);
     virtual ~Font();
+    void setCacheFile(std::string file);
+    void setFontHash(uint64_t hash);
     bool initialize();
     void deInitialize();
-    //SDL_Texture *getTexture();
-    SDL_Surface *getTexture();
     bool getRect(unsigned int charCode, GlyphInfo &glyph);
     int getHeight();
     int getAscent();
 
 private:
-    struct GlyphInfoBuild
-    {
-        Font::GlyphInfo glyph;
-        SDL_Surface *surface;
-    };
+    bool renderGlyph(unsigned int charCode, GlyphCache::Glyph &glyph);
+    SDL_Surface *createPage(void *pixels = NULL);
+    bool buildAtlasKey(FontAtlasFile::Key &key);
+    bool loadAtlas();
+    void saveAtlas();
 
-    //SDL_Texture *texture;
-    SDL_Surface *texture;
+    // Glyphs are rendered on first use into the pages of the cache
+    TTF_Font *font_;
+    GlyphCache *cache_;
+    std::vector<SDL_Surface *> pages_;
+    FontAtlasFile *atlasFile_;
+    std::string cacheFile_;
+    uint64_t fontHash_;
     int height;
     int ascent;
-    std::map<unsigned int, GlyphInfoBuild *> atlas;
     std::string fontPath_;
     int fontSize_;
     SDL_Color color_;
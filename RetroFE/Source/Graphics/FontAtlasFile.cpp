@@ -0,0 +1,270 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "FontAtlasFile.h"
+#include "../Utility/Log.h"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FONT_ATLAS_MAGIC    0x54414652u   // "RFAT", a file from a different byte order does not match
+#define FONT_ATLAS_VERSION  1
+#define FONT_ATLAS_ALIGN    4096
+#define FONT_ATLAS_MAX_PAGE_SIZE 4096
+
+
+FontAtlasFile::FontAtlasFile()
+    : data_(NULL)
+    , size_(0)
+{
+}
+
+
+FontAtlasFile::~FontAtlasFile()
+{
+    close();
+}
+
+
+// FNV-1a over the file contents, 0 when it cannot be read
+uint64_t FontAtlasFile::hashFile(std::string path)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    if(!file) return 0;
+
+    uint64_t hash = 14695981039346656037ULL;
+    unsigned char buffer[4096];
+    size_t length;
+    while((length = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        for(size_t i = 0; i < length; ++i)
+        {
+            hash ^= buffer[i];
+            hash *= 1099511628211ULL;
+        }
+    }
+
+    bool failed = ferror(file) != 0;
+    fclose(file);
+
+    return failed ? 0 : hash;
+}
+
+
+size_t FontAtlasFile::getDataOffset(unsigned int glyphCount)
+{
+    size_t offset = sizeof(Header) + glyphCount * sizeof(Entry);
+    return (offset + FONT_ATLAS_ALIGN - 1) / FONT_ATLAS_ALIGN * FONT_ATLAS_ALIGN;
+}
+
+
+bool FontAtlasFile::sameKey(const Key &a, const Key &b)
+{
+    return a.fontHash == b.fontHash && a.fontSize == b.fontSize &&
+           a.r == b.r && a.g == b.g && a.b == b.b &&
+           a.firstGlyph == b.firstGlyph && a.lastGlyph == b.lastGlyph;
+}
+
+
+// Written next to the target and renamed over it, so a reader never maps a
+// half written file
+bool FontAtlasFile::write(std::string file, const Key &key, int height, int ascent,
+                          int pageWidth, int pageHeight, int pitch,
+                          const std::vector<Entry> &glyphs, const std::vector<const void *> &pages)
+{
+    Header header;
+    memset(&header, 0, sizeof(header));
+    header.magic      = FONT_ATLAS_MAGIC;
+    header.version    = FONT_ATLAS_VERSION;
+    header.entrySize  = sizeof(Entry);
+    header.dataOffset = getDataOffset(glyphs.size());
+    header.key        = key;
+    header.height     = height;
+    header.ascent     = ascent;
+    header.pageWidth  = pageWidth;
+    header.pageHeight = pageHeight;
+    header.pageCount  = pages.size();
+    header.glyphCount = glyphs.size();
+
+    std::string tmpFile = file + ".tmp";
+    FILE *out = fopen(tmpFile.c_str(), "wb");
+    if(!out)
+    {
+        Logger::write(Logger::ZONE_WARNING, "FontCache", "Could not create " + tmpFile);
+        return false;
+    }
+
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+    if(ok && !glyphs.empty())
+    {
+        ok = fwrite(&glyphs[0], sizeof(Entry), glyphs.size(), out) == glyphs.size();
+    }
+
+    size_t padding = header.dataOffset - sizeof(header) - glyphs.size() * sizeof(Entry);
+    std::vector<char> zeros(padding, 0);
+    if(ok && padding > 0)
+    {
+        ok = fwrite(&zeros[0], 1, padding, out) == padding;
+    }
+
+    size_t rowBytes = pageWidth * 4;
+    for(unsigned int i = 0; ok && i < pages.size(); ++i)
+    {
+        const char *row = static_cast<const char *>(pages[i]);
+        for(int y = 0; ok && y < pageHeight; ++y, row += pitch)
+        {
+            ok = fwrite(row, 1, rowBytes, out) == rowBytes;
+        }
+    }
+
+    if(fclose(out) != 0) ok = false;
+
+    if(!ok || rename(tmpFile.c_str(), file.c_str()) != 0)
+    {
+        Logger::write(Logger::ZONE_WARNING, "FontCache", "Could not write " + file);
+        unlink(tmpFile.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+
+bool FontAtlasFile::open(std::string file, const Key &key)
+{
+    close();
+
+    int fd = ::open(file.c_str(), O_RDONLY);
+    if(fd < 0) return false;
+
+    struct stat info;
+    if(fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(Header))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void *data = mmap(NULL, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(data == MAP_FAILED) return false;
+
+    data_ = data;
+    size_ = info.st_size;
+
+    const Header *header = static_cast<const Header *>(data_);
+    bool valid = header->magic == FONT_ATLAS_MAGIC &&
+                 header->version == FONT_ATLAS_VERSION &&
+                 header->entrySize == sizeof(Entry) &&
+                 sameKey(header->key, key) &&
+                 header->pageWidth > 0 && header->pageWidth <= FONT_ATLAS_MAX_PAGE_SIZE &&
+                 header->pageHeight > 0 && header->pageHeight <= FONT_ATLAS_MAX_PAGE_SIZE &&
+                 header->glyphCount <= (size_ - sizeof(Header)) / sizeof(Entry) &&
+                 header->dataOffset == getDataOffset(header->glyphCount) &&
+                 header->dataOffset <= size_;
+
+    if(valid)
+    {
+        size_t pageBytes = (size_t)header->pageWidth * header->pageHeight * 4;
+        valid = (size_ - header->dataOffset) == header->pageCount * pageBytes;
+    }
+
+    for(unsigned int i = 0; valid && i < header->glyphCount; ++i)
+    {
+        const GlyphCache::Glyph &glyph = getGlyphs()[i].glyph;
+        valid = !glyph.provided ||
+                (glyph.page < header->pageCount &&
+                 glyph.x >= 0 && glyph.y >= 0 && glyph.w >= 0 && glyph.h >= 0 &&
+                 glyph.x + glyph.w <= header->pageWidth &&
+                 glyph.y + glyph.h <= header->pageHeight);
+    }
+
+    if(!valid)
+    {
+        Logger::write(Logger::ZONE_INFO, "FontCache", "Ignoring stale atlas " + file);
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+
+void FontAtlasFile::close()
+{
+    if(data_)
+    {
+        munmap(data_, size_);
+        data_ = NULL;
+        size_ = 0;
+    }
+}
+
+
+bool FontAtlasFile::isOpen()
+{
+    return data_ != NULL;
+}
+
+
+int FontAtlasFile::getHeight()
+{
+    return static_cast<const Header *>(data_)->height;
+}
+
+
+int FontAtlasFile::getAscent()
+{
+    return static_cast<const Header *>(data_)->ascent;
+}
+
+
+int FontAtlasFile::getPageWidth()
+{
+    return static_cast<const Header *>(data_)->pageWidth;
+}
+
+
+int FontAtlasFile::getPageHeight()
+{
+    return static_cast<const Header *>(data_)->pageHeight;
+}
+
+
+unsigned int FontAtlasFile::getPageCount()
+{
+    return static_cast<const Header *>(data_)->pageCount;
+}
+
+
+unsigned int FontAtlasFile::getGlyphCount()
+{
+    return static_cast<const Header *>(data_)->glyphCount;
+}
+
+
+const FontAtlasFile::Entry *FontAtlasFile::getGlyphs()
+{
+    return reinterpret_cast<const Entry *>(static_cast<const char *>(data_) + sizeof(Header));
+}
+
+
+void *FontAtlasFile::getPage(unsigned int index)
+{
+    size_t pageBytes = (size_t)getPageWidth() * getPageHeight() * 4;
+    return static_cast<char *>(data_) + static_cast<const Header *>(data_)->dataOffset + index * pageBytes;
+}
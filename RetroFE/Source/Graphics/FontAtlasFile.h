@@ -0,0 +1,87 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "GlyphCache.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Font atlas pages and glyph metrics saved by a previous run. The file is
+// mapped privately, so the pages can be used as surface pixels directly and
+// glyphs added later only touch this process' copy.
+class FontAtlasFile
+{
+public:
+    // Everything the rendered pixels depend on
+    struct Key
+    {
+        uint64_t fontHash;
+        int32_t  fontSize;
+        uint8_t  r;
+        uint8_t  g;
+        uint8_t  b;
+        uint32_t firstGlyph;
+        uint32_t lastGlyph;
+    };
+
+    // Glyphs are stored in the order they were inserted in the cache
+    struct Entry
+    {
+        uint32_t          codepoint;
+        GlyphCache::Glyph glyph;
+    };
+
+    FontAtlasFile();
+    virtual ~FontAtlasFile();
+    static uint64_t hashFile(std::string path);
+    static bool write(std::string file, const Key &key, int height, int ascent,
+                      int pageWidth, int pageHeight, int pitch,
+                      const std::vector<Entry> &glyphs, const std::vector<const void *> &pages);
+    bool open(std::string file, const Key &key);
+    void close();
+    bool isOpen();
+    int getHeight();
+    int getAscent();
+    int getPageWidth();
+    int getPageHeight();
+    unsigned int getPageCount();
+    unsigned int getGlyphCount();
+    const Entry *getGlyphs();
+    void *getPage(unsigned int index);
+
+private:
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entrySize;
+        uint32_t dataOffset;
+        Key      key;
+        int32_t  height;
+        int32_t  ascent;
+        int32_t  pageWidth;
+        int32_t  pageHeight;
+        uint32_t pageCount;
+        uint32_t glyphCount;
+    };
+
+    static bool sameKey(const Key &a, const Key &b);
+    static size_t getDataOffset(unsigned int glyphCount);
+
+    void   *data_;
+    size_t  size_;
+};
@@ -17,9 +17,12 @@
 #include "FontCache.h"
 #include "Font.h"
 #include "../Utility/Log.h"
+#include "../Utility/Utils.h"
 #include "../SDL.h"
 #include <SDL/SDL_ttf.h>
-#include <sstream>
+#include <cstdio>
+#include <functional>
+#include <sys/stat.h>
 
 //todo: memory leak when launching games
 FontCache::FontCache()
@@ -33,13 +36,11 @@ FontCache::~FontCache()
 
 void FontCache::deInitialize()
 {
-    std::map<std::string, Font *>::iterator it = fontFaceMap_.begin();
-    while(it != fontFaceMap_.end())
+    for(FontMap::iterator it = fontFaceMap_.begin(); it != fontFaceMap_.end(); it++)
     {
         delete it->second;
-        fontFaceMap_.erase(it);
-        it = fontFaceMap_.begin();
     }
+    fontFaceMap_.clear();
 
     SDL_LockMutex(SDL::getMutex());
     TTF_Quit();
@@ -52,11 +53,25 @@ void FontCache::initialize()
     //todo: make bool
     TTF_Init();
 }
+
+// Fonts loaded afterwards keep their preloaded glyphs in this directory
+void FontCache::setCacheDirectory(std::string directory)
+{
+    if(directory.empty() || Utils::createDirectories(directory))
+    {
+        cacheDirectory_ = directory;
+    }
+    else
+    {
+        Logger::write(Logger::ZONE_WARNING, "FontCache", "Font atlases will not be cached in " + directory);
+        cacheDirectory_ = "";
+    }
+}
 Font *FontCache::getFont(std::string fontPath, int fontSize, SDL_Color color)
 {
     Font *t = NULL;
 
-    std::map<std::string, Font *>::iterator it = fontFaceMap_.find(buildFontKey(fontPath, fontSize, color));
+    FontMap::iterator it = fontFaceMap_.find(buildFontKey(fontPath, fontSize, color));
 
     if(it != fontFaceMap_.end())
     {
@@ -66,22 +81,74 @@ Font *FontCache::getFont(std::string fontPath, int fontSize, SDL_Color color)
     return t;
 }
 
-std::string FontCache::buildFontKey(std::string font, int fontSize, SDL_Color color)
+bool FontCache::FontKey::operator==(const FontKey &other) const
+{
+    return fontSize == other.fontSize && r == other.r && g == other.g && b == other.b && font == other.font;
+}
+
+size_t FontCache::FontKeyHash::operator()(const FontKey &key) const
+{
+    size_t hash = std::hash<std::string>()(key.font);
+    size_t attributes = ((size_t)key.fontSize << 24) | (key.r << 16) | (key.g << 8) | key.b;
+    return hash ^ (attributes + 0x9e3779b9 + (hash << 6) + (hash >> 2));
+}
+
+FontCache::FontKey FontCache::buildFontKey(std::string font, int fontSize, SDL_Color color)
+{
+    FontKey key;
+    key.font     = font;
+    key.fontSize = fontSize;
+    key.r        = color.r;
+    key.g        = color.g;
+    key.b        = color.b;
+
+    return key;
+}
+
+// The file name only has to tell fonts apart, the atlas itself checks that
+// it still matches the font file
+std::string FontCache::getCacheFile(const FontKey &key)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "%016zx_%d_%02x%02x%02x.atlas",
+             std::hash<std::string>()(key.font), key.fontSize, key.r, key.g, key.b);
+
+    return Utils::combinePath(cacheDirectory_, name);
+}
+
+uint64_t FontCache::hashFontFile(std::string font)
 {
-    std::stringstream ss;
-    ss << font << "_SIZE=" << fontSize << " RGB=" << color.r << "." << color.g << "." << color.b;
+    struct stat info;
+    if(stat(font.c_str(), &info) != 0) return 0;
+
+    FontFileMap::iterator it = fontFiles_.find(font);
+    if(it != fontFiles_.end() && it->second.size == info.st_size && it->second.mtime == info.st_mtime)
+    {
+        return it->second.hash;
+    }
+
+    FontFile file;
+    file.size  = info.st_size;
+    file.mtime = info.st_mtime;
+    file.hash  = FontAtlasFile::hashFile(font);
+    fontFiles_[font] = file;
 
-    return ss.str();
+    return file.hash;
 }
 
 bool FontCache::loadFont(std::string fontPath, int fontSize, SDL_Color color)
 {
-    std::string key = buildFontKey(fontPath, fontSize, color);
-    std::map<std::string, Font *>::iterator it = fontFaceMap_.find(key);
+    FontKey key = buildFontKey(fontPath, fontSize, color);
+    FontMap::iterator it = fontFaceMap_.find(key);
 
     if(it == fontFaceMap_.end())
     {
         Font *f = new Font(fontPath, fontSize, color);
+        if(!cacheDirectory_.empty())
+        {
+            f->setCacheFile(getCacheFile(key));
+            f->setFontHash(hashFontFile(fontPath));
+        }
         f->initialize();
         fontFaceMap_[key] = f;
     }
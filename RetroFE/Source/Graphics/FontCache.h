@@ -16,22 +16,55 @@
 #pragma once
 
 #include "Font.h"
+#include <stdint.h>
 #include <string>
-#include <map>
+#include <sys/types.h>
+#include <unordered_map>
 
 class FontCache
 {
 public:
     FontCache();
     void initialize();
+    void setCacheDirectory(std::string directory);
     void deInitialize();
     bool loadFont(std::string font, int fontSize, SDL_Color color);
     Font *getFont(std::string font, int fontSize, SDL_Color color);
 
     virtual ~FontCache();
 private:
-    std::map<std::string, Font *> fontFaceMap_;
-    std::string buildFontKey(std::string font, int fontSize, SDL_Color color);
+    struct FontKey
+    {
+        std::string font;
+        int fontSize;
+        Uint8 r;
+        Uint8 g;
+        Uint8 b;
+        bool operator==(const FontKey &other) const;
+    };
+
+    struct FontKeyHash
+    {
+        size_t operator()(const FontKey &key) const;
+    };
+
+    // Font files are hashed once, and again only if their size or date change
+    struct FontFile
+    {
+        off_t size;
+        time_t mtime;
+        uint64_t hash;
+    };
+
+    typedef std::unordered_map<FontKey, Font *, FontKeyHash> FontMap;
+    typedef std::unordered_map<std::string, FontFile> FontFileMap;
+
+    FontMap fontFaceMap_;
+    FontFileMap fontFiles_;
+    std::string cacheDirectory_;
+    FontKey buildFontKey(std::string font, int fontSize, SDL_Color color);
+    std::string getCacheFile(const FontKey &key);
+    uint64_t hashFontFile(std::string font);
 
 };
 
@@ -0,0 +1,88 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "FrameSnapshot.h"
+#include <cstring>
+
+
+FrameSnapshot::FrameSnapshot()
+    : width_(0)
+    , height_(0)
+    , bytesPerPixel_(0)
+{
+}
+
+
+bool FrameSnapshot::capture(const void *pixels, int width, int height, int pitch, int bytesPerPixel)
+{
+    clear();
+
+    if(!pixels || width <= 0 || height <= 0 || bytesPerPixel <= 0 || pitch < width * bytesPerPixel)
+    {
+        return false;
+    }
+
+    size_t rowSize = static_cast<size_t>(width * bytesPerPixel);
+    pixels_.resize(rowSize * height);
+
+    const unsigned char *src = static_cast<const unsigned char *>(pixels);
+    for(int y = 0; y < height; y++)
+    {
+        memcpy(&pixels_[rowSize * y], src + static_cast<size_t>(pitch) * y, rowSize);
+    }
+
+    width_         = width;
+    height_        = height;
+    bytesPerPixel_ = bytesPerPixel;
+
+    return true;
+}
+
+
+// Only restores into a surface of the same size and depth, a snapshot
+// taken before a video mode change is useless
+bool FrameSnapshot::restore(void *pixels, int width, int height, int pitch, int bytesPerPixel)
+{
+    if(!isValid() || !pixels ||
+       width != width_ || height != height_ || bytesPerPixel != bytesPerPixel_ ||
+       pitch < width * bytesPerPixel)
+    {
+        return false;
+    }
+
+    size_t rowSize = static_cast<size_t>(width * bytesPerPixel);
+    unsigned char *dst = static_cast<unsigned char *>(pixels);
+    for(int y = 0; y < height; y++)
+    {
+        memcpy(dst + static_cast<size_t>(pitch) * y, &pixels_[rowSize * y], rowSize);
+    }
+
+    return true;
+}
+
+
+bool FrameSnapshot::isValid()
+{
+    return !pixels_.empty();
+}
+
+
+void FrameSnapshot::clear()
+{
+    std::vector<unsigned char>().swap(pixels_);
+    width_         = 0;
+    height_        = 0;
+    bytesPerPixel_ = 0;
+}
@@ -0,0 +1,36 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <vector>
+
+// Copy of the last frame drawn before a launch, shown as the first frame
+// on return while the page loads its textures again
+class FrameSnapshot
+{
+public:
+    FrameSnapshot();
+    bool capture(const void *pixels, int width, int height, int pitch, int bytesPerPixel);
+    bool restore(void *pixels, int width, int height, int pitch, int bytesPerPixel);
+    bool isValid();
+    void clear();
+
+private:
+    std::vector<unsigned char> pixels_;
+    int width_;
+    int height_;
+    int bytesPerPixel_;
+};
@@ -0,0 +1,268 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "GlyphCache.h"
+#include <cstddef>
+
+#define GLYPH_SLOT_EMPTY   0xffffffffu
+#define GLYPH_SLOT_ERASED  0xfffffffeu
+#define GLYPH_INITIAL_SLOTS 256
+
+
+GlyphCache::GlyphCache(int pageWidth, int pageHeight, unsigned int maxPages)
+    : pageWidth_(pageWidth)
+    , pageHeight_(pageHeight)
+    , maxPages_(maxPages > 0 ? maxPages : 1)
+    , useCounter_(0)
+    , size_(0)
+    , used_(0)
+{
+    keys_.assign(GLYPH_INITIAL_SLOTS, GLYPH_SLOT_EMPTY);
+    values_.resize(GLYPH_INITIAL_SLOTS);
+}
+
+
+bool GlyphCache::find(unsigned int codepoint, Glyph &glyph)
+{
+    if(codepoint >= GLYPH_SLOT_ERASED) return false;
+
+    unsigned int slot = findSlot(codepoint);
+
+    if(keys_[slot] != codepoint) return false;
+
+    glyph = values_[slot];
+    if(glyph.provided)
+    {
+        pages_[glyph.page].lastUse = ++useCounter_;
+    }
+
+    return true;
+}
+
+
+// Fills in the page and position of a glyph of glyph.w by glyph.h pixels.
+// Fails if the glyph is larger than a page.
+bool GlyphCache::insert(unsigned int codepoint, Glyph &glyph, bool &pageReset)
+{
+    pageReset = false;
+
+    if(codepoint >= GLYPH_SLOT_ERASED) return false;
+    if(glyph.provided && (glyph.w > pageWidth_ || glyph.h > pageHeight_)) return false;
+
+    erase(codepoint);
+
+    if(glyph.provided)
+    {
+        // Most recently used pages first, their glyphs are the ones on screen
+        std::vector<unsigned int> order;
+        for(unsigned int i = 0; i < pages_.size(); i++)
+        {
+            std::vector<unsigned int>::iterator it = order.begin();
+            while(it != order.end() && pages_[*it].lastUse > pages_[i].lastUse) it++;
+            order.insert(it, i);
+        }
+
+        bool placed = false;
+        for(unsigned int i = 0; i < order.size() && !placed; i++)
+        {
+            if(place(pages_[order[i]], glyph.w, glyph.h, glyph.x, glyph.y))
+            {
+                glyph.page = order[i];
+                placed = true;
+            }
+        }
+
+        if(!placed && pages_.size() < maxPages_)
+        {
+            pages_.push_back(Page());
+            pages_.back().nextY   = 0;
+            pages_.back().lastUse = 0;
+            glyph.page = pages_.size() - 1;
+            placed = place(pages_.back(), glyph.w, glyph.h, glyph.x, glyph.y);
+        }
+
+        if(!placed)
+        {
+            glyph.page = order.back();
+            resetPage(glyph.page);
+            pageReset = true;
+            place(pages_[glyph.page], glyph.w, glyph.h, glyph.x, glyph.y);
+        }
+
+        pages_[glyph.page].lastUse = ++useCounter_;
+        pages_[glyph.page].codepoints.push_back(codepoint);
+    }
+    else
+    {
+        glyph.page = 0;
+        glyph.x    = 0;
+        glyph.y    = 0;
+    }
+
+    if((used_ + 1) * 2 > keys_.size()) grow();
+
+    unsigned int slot = findSlot(codepoint);
+    if(keys_[slot] == GLYPH_SLOT_EMPTY) used_++;
+    keys_[slot]   = codepoint;
+    values_[slot] = glyph;
+    size_++;
+
+    return true;
+}
+
+
+void GlyphCache::clear()
+{
+    pages_.clear();
+    keys_.assign(GLYPH_INITIAL_SLOTS, GLYPH_SLOT_EMPTY);
+    values_.resize(GLYPH_INITIAL_SLOTS);
+    size_ = 0;
+    used_ = 0;
+}
+
+
+unsigned int GlyphCache::size()
+{
+    return size_;
+}
+
+
+unsigned int GlyphCache::getPageCount()
+{
+    return pages_.size();
+}
+
+
+int GlyphCache::getPageWidth()
+{
+    return pageWidth_;
+}
+
+
+int GlyphCache::getPageHeight()
+{
+    return pageHeight_;
+}
+
+
+// Uses the shelf with the least height to spare, or opens a new one below
+bool GlyphCache::place(Page &page, int w, int h, int &x, int &y)
+{
+    Shelf *best = NULL;
+    for(std::vector<Shelf>::iterator it = page.shelves.begin(); it != page.shelves.end(); it++)
+    {
+        if(it->height >= h && it->x + w <= pageWidth_ && (!best || it->height < best->height))
+        {
+            best = &(*it);
+        }
+    }
+
+    if(!best)
+    {
+        if(page.nextY + h > pageHeight_) return false;
+
+        Shelf shelf;
+        shelf.y      = page.nextY;
+        shelf.height = h;
+        shelf.x      = 0;
+        page.shelves.push_back(shelf);
+        page.nextY  += h;
+        best = &page.shelves.back();
+    }
+
+    x = best->x;
+    y = best->y;
+    best->x += w;
+
+    return true;
+}
+
+
+void GlyphCache::resetPage(unsigned int index)
+{
+    Page &page = pages_[index];
+
+    // A code point inserted again since then lives on another page
+    for(std::vector<unsigned int>::iterator it = page.codepoints.begin(); it != page.codepoints.end(); it++)
+    {
+        unsigned int slot = findSlot(*it);
+        if(keys_[slot] == *it && values_[slot].provided && values_[slot].page == index)
+        {
+            keys_[slot] = GLYPH_SLOT_ERASED;
+            size_--;
+        }
+    }
+
+    page.codepoints.clear();
+    page.shelves.clear();
+    page.nextY = 0;
+}
+
+
+// Slot holding the code point, or the slot where it should be inserted
+unsigned int GlyphCache::findSlot(unsigned int codepoint)
+{
+    unsigned int mask   = keys_.size() - 1;
+    unsigned int slot   = (codepoint * 2654435761u) & mask;
+    unsigned int erased = GLYPH_SLOT_EMPTY;
+
+    while(keys_[slot] != GLYPH_SLOT_EMPTY)
+    {
+        if(keys_[slot] == codepoint) return slot;
+        if(keys_[slot] == GLYPH_SLOT_ERASED && erased == GLYPH_SLOT_EMPTY) erased = slot;
+        slot = (slot + 1) & mask;
+    }
+
+    return (erased != GLYPH_SLOT_EMPTY) ? erased : slot;
+}
+
+
+void GlyphCache::erase(unsigned int codepoint)
+{
+    unsigned int slot = findSlot(codepoint);
+
+    if(keys_[slot] != codepoint) return;
+
+    keys_[slot] = GLYPH_SLOT_ERASED;
+    size_--;
+}
+
+
+// Rehashes into a table twice as large, dropping the erased slots
+void GlyphCache::grow()
+{
+    std::vector<unsigned int> keys;
+    std::vector<Glyph>        values;
+    keys.swap(keys_);
+    values.swap(values_);
+
+    unsigned int slots = keys.size();
+    if(size_ * 4 >= slots) slots *= 2;
+
+    keys_.assign(slots, GLYPH_SLOT_EMPTY);
+    values_.resize(slots);
+    used_ = 0;
+
+    for(unsigned int i = 0; i < keys.size(); i++)
+    {
+        if(keys[i] < GLYPH_SLOT_ERASED)
+        {
+            unsigned int slot = findSlot(keys[i]);
+            keys_[slot]   = keys[i];
+            values_[slot] = values[i];
+            used_++;
+        }
+    }
+}
@@ -0,0 +1,86 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <vector>
+
+// Places glyphs on fixed-size atlas pages, filled shelf by shelf. Glyphs are
+// looked up by code point in an open addressing hash table. When every page
+// is full, the least recently used page is emptied and reused, and the
+// glyphs it held are forgotten.
+//
+// The cache only does the bookkeeping, the caller owns the page pixels: it
+// must create a page the first time it is used and clear it when insert()
+// reports it was reset.
+class GlyphCache
+{
+public:
+    struct Glyph
+    {
+        unsigned int page;
+        int x;
+        int y;
+        int w;
+        int h;
+        int minX;
+        int maxX;
+        int minY;
+        int maxY;
+        int advance;
+        bool provided;   // false when the font has no glyph for the code point
+    };
+
+    GlyphCache(int pageWidth, int pageHeight, unsigned int maxPages);
+    bool find(unsigned int codepoint, Glyph &glyph);
+    bool insert(unsigned int codepoint, Glyph &glyph, bool &pageReset);
+    void clear();
+    unsigned int size();
+    unsigned int getPageCount();
+    int getPageWidth();
+    int getPageHeight();
+
+private:
+    struct Shelf
+    {
+        int y;
+        int height;
+        int x;
+    };
+
+    struct Page
+    {
+        std::vector<Shelf>        shelves;
+        int                       nextY;
+        unsigned long             lastUse;
+        std::vector<unsigned int> codepoints;
+    };
+
+    bool place(Page &page, int w, int h, int &x, int &y);
+    void resetPage(unsigned int index);
+    unsigned int findSlot(unsigned int codepoint);
+    void erase(unsigned int codepoint);
+    void grow();
+
+    int                       pageWidth_;
+    int                       pageHeight_;
+    unsigned int              maxPages_;
+    unsigned long             useCounter_;
+    std::vector<Page>         pages_;
+    std::vector<unsigned int> keys_;
+    std::vector<Glyph>        values_;
+    unsigned int              size_;
+    unsigned int              used_;       // entries plus erased slots
+};
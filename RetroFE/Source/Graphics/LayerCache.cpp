@@ -0,0 +1,90 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "LayerCache.h"
+
+LayerCache::LayerCache()
+    : hits_(0)
+    , misses_(0)
+{
+}
+
+
+bool LayerCache::sameMember(const Member &a, const Member &b)
+{
+    return a.component == b.component && a.changeStamp == b.changeStamp && a.layer == b.layer &&
+           a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height && a.alpha == b.alpha;
+}
+
+
+// Copies the cached layers into the window when they were drawn from the
+// same members, counting a hit; otherwise counts a miss and leaves the
+// window alone, the caller draws the layers then stores them
+bool LayerCache::restore(const std::vector<Member> &members, void *pixels, int width, int height, int pitch, int bytesPerPixel)
+{
+    bool same = pixels_.isValid() && members.size() == members_.size();
+    for(unsigned int i = 0; same && i < members.size(); ++i)
+    {
+        same = sameMember(members[i], members_[i]);
+    }
+
+    if(same && pixels_.restore(pixels, width, height, pitch, bytesPerPixel))
+    {
+        ++hits_;
+        return true;
+    }
+
+    ++misses_;
+    return false;
+}
+
+
+bool LayerCache::store(const std::vector<Member> &members, const void *pixels, int width, int height, int pitch, int bytesPerPixel)
+{
+    members_ = members;
+    if(!pixels_.capture(pixels, width, height, pitch, bytesPerPixel))
+    {
+        invalidate();
+        return false;
+    }
+
+    return true;
+}
+
+
+// Drops the cached pixels, the next restore is a miss
+void LayerCache::invalidate()
+{
+    members_.clear();
+    pixels_.clear();
+}
+
+
+bool LayerCache::isValid()
+{
+    return pixels_.isValid();
+}
+
+
+unsigned int LayerCache::getHits()
+{
+    return hits_;
+}
+
+
+unsigned int LayerCache::getMisses()
+{
+    return misses_;
+}
@@ -0,0 +1,56 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "FrameSnapshot.h"
+#include <vector>
+
+// The window as drawn up to the last of the bottom layers that stopped
+// changing. While the same components are drawn there, at the same place
+// with the same alpha and content, the page copies it back instead of
+// drawing them again.
+class LayerCache
+{
+public:
+    // What a component was when it was drawn into the cache
+    struct Member
+    {
+        const void  *component;
+        unsigned int changeStamp;
+        unsigned int layer;
+        int          x;
+        int          y;
+        int          width;
+        int          height;
+        float        alpha;
+    };
+
+    LayerCache();
+    bool restore(const std::vector<Member> &members, void *pixels, int width, int height, int pitch, int bytesPerPixel);
+    bool store(const std::vector<Member> &members, const void *pixels, int width, int height, int pitch, int bytesPerPixel);
+    void invalidate();
+    bool isValid();
+    unsigned int getHits();
+    unsigned int getMisses();
+
+private:
+    static bool sameMember(const Member &a, const Member &b);
+
+    std::vector<Member> members_;
+    FrameSnapshot       pixels_;
+    unsigned int        hits_;
+    unsigned int        misses_;
+};
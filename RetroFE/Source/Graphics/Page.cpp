@@ -31,6 +31,8 @@
 Page::Page(Configuration &config)
     : config_(config)
     , menuDepth_(0)
+    , drawList_(NUM_LAYERS)
+    , flattenLayers_(true)
     , scrollActive_(false)
     , scrollDirectionForward_(false)
     , selectedItem_(NULL)
@@ -40,7 +42,9 @@ Page::Page(Configuration &config)
     , highlightSoundChunk_(NULL)
     , selectSoundChunk_(NULL)
     , minShowTime_(0)
+    , tweenBatchActive_(false)
 {
+    config_.getProperty("flattenLayers", flattenLayers_);
 }
 
 
@@ -1085,6 +1089,8 @@ void Page::selectPlaylist(std::string playlist)
 
 void Page::update(float dt)
 {
+    tweenBatchActive_ = true;
+
     for(MenuVector_T::iterator it = menus_.begin(); it != menus_.end(); it++)
     {
         for(std::vector<ScrollingList *>::iterator it2 = menus_[std::distance(menus_.begin(), it)].begin(); it2 != menus_[std::distance(menus_.begin(), it)].end(); it2++)
@@ -1106,6 +1112,10 @@ void Page::update(float dt)
         if(*it) (*it)->update(dt);
     }
 
+    // Components queued their running tweens, write them all at once
+    tweenBatch_.evaluate();
+    tweenBatchActive_ = false;
+
 }
 
 
@@ -1139,23 +1149,140 @@ void Page::cleanup()
 
 void Page::draw()
 {
-    for(unsigned int i = 0; i < NUM_LAYERS; ++i)
+    // Sort the visible components by layer in a single pass. Within a layer the
+    // page components come first, then the menu items, each in their own order.
+    drawList_.clear();
+
+    for(std::vector<Component *>::iterator it = LayerComponents.begin(); it != LayerComponents.end(); ++it)
+    {
+        if(*it && (*it)->isVisible()) drawList_.add(*it, (*it)->baseViewInfo.Layer);
+    }
+
+    for(MenuVector_T::iterator it = menus_.begin(); it != menus_.end(); it++)
     {
-        for(std::vector<Component *>::iterator it = LayerComponents.begin(); it != LayerComponents.end(); ++it)
+        for(std::vector<ScrollingList *>::iterator it2 = menus_[std::distance(menus_.begin(), it)].begin(); it2 != menus_[std::distance(menus_.begin(), it)].end(); it2++)
         {
-            if(*it && (*it)->baseViewInfo.Layer == i) (*it)->draw();
+            ScrollingList *menu = *it2;
+            menu->addToDrawList(drawList_);
         }
+    }
 
-        for(MenuVector_T::iterator it = menus_.begin(); it != menus_.end(); it++)
+    // The bottom layers that stopped changing are copied from the layer
+    // cache, and only drawn, then stored, when one of them changed. The
+    // copy covers the whole window, which is only cleared without it.
+    SDL_Surface *window = SDL::getWindow();
+    unsigned int first = flattenedLayers();
+    bool hit = false;
+    if(first > 0)
+    {
+        if(SDL_MUSTLOCK(window)) SDL_LockSurface(window);
+        hit = layerCache_.restore(layerMembers_, window->pixels, window->w, window->h, window->pitch,
+                                  window->format->BytesPerPixel);
+        if(SDL_MUSTLOCK(window)) SDL_UnlockSurface(window);
+    }
+    if(!hit && window)
+    {
+        SDL_FillRect(window, NULL, SDL_MapRGB(window->format, 0, 0, 0));
+    }
+
+    if(first > 0)
+    {
+        if(!hit)
         {
-            for(std::vector<ScrollingList *>::iterator it2 = menus_[std::distance(menus_.begin(), it)].begin(); it2 != menus_[std::distance(menus_.begin(), it)].end(); it2++)
+            std::stringstream ss;
+            ss << "Flattening " << first << " layers, layer cache hits: " << layerCache_.getHits()
+               << ", misses: " << layerCache_.getMisses();
+            Logger::write(Logger::ZONE_DEBUG, "Page", ss.str());
+
+            for(unsigned int i = 0; i < first; ++i)
             {
-                ScrollingList *menu = *it2;
-                menu->draw(i);
+                std::vector<Component *> &layer = drawList_.getLayer(i);
+                for(std::vector<Component *>::iterator it = layer.begin(); it != layer.end(); ++it)
+                {
+                    (*it)->draw();
+                }
+            }
+
+            if(SDL_MUSTLOCK(window)) SDL_LockSurface(window);
+            layerCache_.store(layerMembers_, window->pixels, window->w, window->h, window->pitch,
+                              window->format->BytesPerPixel);
+            if(SDL_MUSTLOCK(window)) SDL_UnlockSurface(window);
+        }
+    }
+    else if(layerCache_.isValid())
+    {
+        layerCache_.invalidate();
+    }
+
+    for(unsigned int i = first; i < drawList_.getLayerCount(); ++i)
+    {
+        std::vector<Component *> &layer = drawList_.getLayer(i);
+        for(std::vector<Component *>::iterator it = layer.begin(); it != layer.end(); ++it)
+        {
+            (*it)->draw();
+        }
+    }
+
+}
+
+
+// How many of the bottom layers are drawn from the layer cache, listing
+// their components in layerMembers_. All their components must be static,
+// and cover at least half the window: below that, drawing them costs less
+// than copying the whole window. None when flattenLayers is off.
+unsigned int Page::flattenedLayers()
+{
+    layerMembers_.clear();
+
+    SDL_Surface *window = SDL::getWindow();
+    if(!window || !flattenLayers_)
+    {
+        return 0;
+    }
+
+    unsigned int layers = 0;
+    long long area = 0;
+    for(unsigned int i = 0; i < drawList_.getLayerCount(); ++i)
+    {
+        std::vector<Component *> &layer = drawList_.getLayer(i);
+        std::vector<Component *>::iterator it = layer.begin();
+        while(it != layer.end() && (*it)->isStatic()) ++it;
+        if(it != layer.end())
+        {
+            break;
+        }
+
+        for(it = layer.begin(); it != layer.end(); ++it)
+        {
+            ViewInfo &info = (*it)->baseViewInfo;
+            LayerCache::Member member;
+            member.component   = *it;
+            member.changeStamp = (*it)->getChangeStamp();
+            member.layer       = i;
+            member.x           = static_cast<int>(info.XRelativeToOrigin());
+            member.y           = static_cast<int>(info.YRelativeToOrigin());
+            member.width       = static_cast<int>(info.ScaledWidth());
+            member.height      = static_cast<int>(info.ScaledHeight());
+            member.alpha       = info.Alpha;
+            layerMembers_.push_back(member);
+
+            int w = std::min(member.x + member.width, window->w) - std::max(member.x, 0);
+            int h = std::min(member.y + member.height, window->h) - std::max(member.y, 0);
+            if(w > 0 && h > 0)
+            {
+                area += static_cast<long long>(w) * h;
             }
         }
+        layers = i + 1;
     }
 
+    if(layerMembers_.size() < 2 || area * 2 < static_cast<long long>(window->w) * window->h)
+    {
+        layerMembers_.clear();
+        return 0;
+    }
+
+    return layers;
 }
 
 
@@ -1209,6 +1336,8 @@ std::string Page::getCollectionName()
 
 void Page::freeGraphicsMemory()
 {
+    layerCache_.invalidate();
+
     for(MenuVector_T::iterator it = menus_.begin(); it != menus_.end(); it++)
     {
         for(std::vector<ScrollingList *>::iterator it2 = menus_[std::distance(menus_.begin(), it)].begin(); it2 != menus_[std::distance(menus_.begin(), it)].end(); it2++)
@@ -1232,6 +1361,8 @@ void Page::freeGraphicsMemory()
 
 void Page::allocateGraphicsMemory()
 {
+    layerCache_.invalidate();
+
     Logger::write(Logger::ZONE_DEBUG, "Page", "Allocating graphics memory");
 
     for(MenuVector_T::iterator it = menus_.begin(); it != menus_.end(); it++)
@@ -1259,8 +1390,66 @@ void Page::allocateGraphicsMemory()
 }
 
 
+// Same walk as freeGraphicsMemory, but components keep their decoded
+// surfaces so resumeGraphicsMemory does not have to load them again
+void Page::suspendGraphicsMemory()
+{
+    layerCache_.invalidate();
+
+    for(MenuVector_T::iterator it = menus_.begin(); it != menus_.end(); it++)
+    {
+        for(std::vector<ScrollingList *>::iterator it2 = it->begin(); it2 != it->end(); it2++)
+        {
+            (*it2)->suspendGraphicsMemory();
+        }
+    }
+
+    if(loadSoundChunk_) loadSoundChunk_->free();
+    if(unloadSoundChunk_) unloadSoundChunk_->free();
+    if(highlightSoundChunk_) highlightSoundChunk_->free();
+    if(selectSoundChunk_) selectSoundChunk_->free();
+
+    for(std::vector<Component *>::iterator it = LayerComponents.begin(); it != LayerComponents.end(); ++it)
+    {
+        (*it)->suspendGraphicsMemory();
+    }
+}
+
+
+void Page::resumeGraphicsMemory()
+{
+    layerCache_.invalidate();
+
+    Logger::write(Logger::ZONE_DEBUG, "Page", "Resuming graphics memory");
+
+    for(MenuVector_T::iterator it = menus_.begin(); it != menus_.end(); it++)
+    {
+        if ( std::distance(menus_.begin(), it) < (signed int)menuDepth_ )
+        {
+            for(std::vector<ScrollingList *>::iterator it2 = it->begin(); it2 != it->end(); it2++)
+            {
+                (*it2)->resumeGraphicsMemory();
+            }
+        }
+    }
+
+    if(loadSoundChunk_) loadSoundChunk_->allocate();
+    if(unloadSoundChunk_) unloadSoundChunk_->allocate();
+    if(highlightSoundChunk_) highlightSoundChunk_->allocate();
+    if(selectSoundChunk_) selectSoundChunk_->allocate();
+
+    for(std::vector<Component *>::iterator it = LayerComponents.begin(); it != LayerComponents.end(); ++it)
+    {
+        (*it)->resumeGraphicsMemory();
+    }
+    Logger::write(Logger::ZONE_DEBUG, "Page", "Resume graphics memory complete");
+}
+
+
 void Page::deInitializeFonts()
 {
+    layerCache_.invalidate();
+
     for(MenuVector_T::iterator it = menus_.begin(); it != menus_.end(); it++)
     {
         for(std::vector<ScrollingList *>::iterator it2 = menus_[std::distance(menus_.begin(), it)].begin(); it2 != menus_[std::distance(menus_.begin(), it)].end(); it2++)
@@ -1279,6 +1468,8 @@ void Page::deInitializeFonts()
 
 void Page::initializeFonts()
 {
+    layerCache_.invalidate();
+
     for(MenuVector_T::iterator it = menus_.begin(); it != menus_.end(); it++)
     {
         for(std::vector<ScrollingList *>::iterator it2 = menus_[std::distance(menus_.begin(), it)].begin(); it2 != menus_[std::distance(menus_.begin(), it)].end(); it2++)
@@ -1354,6 +1545,34 @@ bool Page::isPlaying()
 }
 
 
+// Batch of tweens evaluated at the end of update(), NULL outside of it
+TweenBatch *Page::getTweenBatch()
+{
+    return tweenBatchActive_ ? &tweenBatch_ : NULL;
+}
+
+
+float Page::getNextUpdateTime()
+{
+    float nextTime = -1;
+
+    for(MenuVector_T::iterator it = menus_.begin(); it != menus_.end(); it++)
+    {
+        for(std::vector<ScrollingList *>::iterator it2 = it->begin(); it2 != it->end(); it2++)
+        {
+            nextTime = Component::earliestUpdateTime(nextTime, (*it2)->getNextUpdateTime());
+        }
+    }
+
+    for(std::vector<Component *>::iterator it = LayerComponents.begin(); it != LayerComponents.end(); ++it)
+    {
+        if(*it) nextTime = Component::earliestUpdateTime(nextTime, (*it)->getNextUpdateTime());
+    }
+
+    return nextTime;
+}
+
+
 void Page::resetScrollPeriod()
 {
     for(std::vector<ScrollingList *>::iterator it = activeMenu_.begin(); it != activeMenu_.end(); it++)
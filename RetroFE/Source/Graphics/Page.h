@@ -16,6 +16,9 @@
 #pragma once
 
 #include "../Collection/CollectionInfo.h"
+#include "Animate/TweenBatch.h"
+#include "DrawList.h"
+#include "LayerCache.h"
 
 #include <map>
 #include <string>
@@ -91,6 +94,8 @@ public:
     void draw();
     void freeGraphicsMemory();
     void allocateGraphicsMemory();
+    void suspendGraphicsMemory();
+    void resumeGraphicsMemory();
     void deInitializeFonts( );
     void initializeFonts( );
     void playSelect();
@@ -114,13 +119,18 @@ public:
     bool isMenuScrolling();
     bool isMenuScrollForward();
     bool isPlaying();
+    float getNextUpdateTime();
+    TweenBatch *getTweenBatch();
     void resetScrollPeriod();
     float getScrollPeriod();
     void updateScrollPeriod();
     void scroll(bool forward);
 
 private:
+    friend class PageTest;
+
     void playlistChange();
+    unsigned int flattenedLayers();
     std::string collectionName_;
     Configuration &config_;
 
@@ -142,6 +152,10 @@ private:
 
     static const unsigned int NUM_LAYERS = 20;
     std::vector<Component *> LayerComponents;
+    DrawList drawList_;
+    LayerCache layerCache_;
+    bool flattenLayers_;
+    std::vector<LayerCache::Member> layerMembers_;
     std::list<ScrollingList *> deleteMenuList_;
     std::list<CollectionInfo *> deleteCollectionList_;
 
@@ -157,6 +171,8 @@ private:
     Sound *selectSoundChunk_;
     float minShowTime_;
     float elapsedTime_;
+    TweenBatch tweenBatch_;
+    bool tweenBatchActive_;
     CollectionInfo::Playlists_T::iterator playlist_;
 
 
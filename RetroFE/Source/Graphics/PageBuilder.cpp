@@ -464,7 +464,10 @@ bool PageBuilder::buildComponents(xml_node<> *layout, Page *page)
             altImagePath = Utils::combinePath(userLayout_?Configuration::userPath:Configuration::absolutePath, 
                 "layouts", layoutName, std::string(src->value()));
 
-            Image *c = new Image(imagePath, altImagePath, *page, scaleX_, scaleY_, dithering);
+            ViewInfo viewInfo;
+            buildViewInfo(componentXml, viewInfo);
+            AnimationEvents *tweens = createTweenInstance(componentXml);
+            Image *c = new Image(imagePath, altImagePath, *page, scaleX_, scaleY_, dithering, NULL, &viewInfo, tweens);
             c->setId( id );
             xml_attribute<> *menuScrollReload = componentXml->first_attribute("menuScrollReload");
             if (menuScrollReload &&
@@ -473,8 +476,7 @@ bool PageBuilder::buildComponents(xml_node<> *layout, Page *page)
             {
                 c->setMenuScrollReload(true);
             }
-            buildViewInfo(componentXml, c->baseViewInfo);
-            loadTweens(c, componentXml);
+            c->setTweens(tweens);
             page->addComponent(c);
         }
     }
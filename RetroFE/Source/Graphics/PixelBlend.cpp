@@ -0,0 +1,172 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "PixelBlend.h"
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define PIXELBLEND_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PIXELBLEND_NEON
+#endif
+
+// Source alpha scaled by the global alpha, reduced to 0..32
+static inline unsigned int blendFactor(unsigned int alpha, unsigned int globalAlpha)
+{
+    return (((alpha * globalAlpha + 255) >> 8) + 4) >> 3;
+}
+
+static inline uint16_t blendPixel(uint16_t d, uint16_t s, unsigned int a)
+{
+    unsigned int r = (((s >> 11) * a + (d >> 11) * (32 - a)) >> 5);
+    unsigned int g = ((((s >> 5) & 0x3f) * a + ((d >> 5) & 0x3f) * (32 - a)) >> 5);
+    unsigned int b = (((s & 0x1f) * a + (d & 0x1f) * (32 - a)) >> 5);
+
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+
+// Converts ARGB pixels, whatever the channel order, to an RGB565 row and an
+// alpha row. Channels are truncated like SDL does when converting surfaces.
+void PixelBlend::splitArgb8888(const uint32_t *src, uint16_t *rgb, uint8_t *alpha, int count,
+                               int rShift, int gShift, int bShift, int aShift)
+{
+    for(int i = 0; i < count; ++i)
+    {
+        uint32_t p = src[i];
+        rgb[i] = static_cast<uint16_t>((((p >> rShift) & 0xf8) << 8) |
+                                       (((p >> gShift) & 0xfc) << 3) |
+                                       (((p >> bShift) & 0xff) >> 3));
+        alpha[i] = static_cast<uint8_t>(p >> aShift);
+    }
+}
+
+
+// Reference implementation, alpha is NULL for an opaque source
+void PixelBlend::blendRgb565A8Scalar(uint16_t *dst, const uint16_t *src, const uint8_t *alpha, int count, uint8_t globalAlpha)
+{
+    unsigned int constant = blendFactor(255, globalAlpha);
+
+    for(int i = 0; i < count; ++i)
+    {
+        unsigned int a = alpha ? blendFactor(alpha[i], globalAlpha) : constant;
+        dst[i] = blendPixel(dst[i], src[i], a);
+    }
+}
+
+
+void PixelBlend::blendRgb565A8(uint16_t *dst, const uint16_t *src, const uint8_t *alpha, int count, uint8_t globalAlpha)
+{
+    if(!alpha && globalAlpha == 255)
+    {
+        memcpy(dst, src, count * sizeof(uint16_t));
+        return;
+    }
+    if(!alpha && blendFactor(255, globalAlpha) == 0)
+    {
+        return;
+    }
+
+    int i = 0;
+
+#if defined(PIXELBLEND_SSE2)
+    const __m128i global   = _mm_set1_epi16(globalAlpha);
+    const __m128i round    = _mm_set1_epi16(255);
+    const __m128i four     = _mm_set1_epi16(4);
+    const __m128i full     = _mm_set1_epi16(32);
+    const __m128i mask5    = _mm_set1_epi16(0x1f);
+    const __m128i mask6    = _mm_set1_epi16(0x3f);
+    const __m128i zero     = _mm_setzero_si128();
+    const __m128i constant = _mm_set1_epi16(blendFactor(255, globalAlpha));
+
+    for(; i + 8 <= count; i += 8)
+    {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+
+        __m128i a = constant;
+        if(alpha)
+        {
+            a = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(alpha + i)), zero);
+            a = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(a, global), round), 8);
+            a = _mm_srli_epi16(_mm_add_epi16(a, four), 3);
+        }
+        __m128i inv = _mm_sub_epi16(full, a);
+
+        __m128i r = _mm_add_epi16(_mm_mullo_epi16(_mm_srli_epi16(s, 11), a),
+                                  _mm_mullo_epi16(_mm_srli_epi16(d, 11), inv));
+        __m128i g = _mm_add_epi16(_mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(s, 5), mask6), a),
+                                  _mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(d, 5), mask6), inv));
+        __m128i b = _mm_add_epi16(_mm_mullo_epi16(_mm_and_si128(s, mask5), a),
+                                  _mm_mullo_epi16(_mm_and_si128(d, mask5), inv));
+
+        r = _mm_slli_epi16(_mm_srli_epi16(r, 5), 11);
+        g = _mm_slli_epi16(_mm_srli_epi16(g, 5), 5);
+        b = _mm_srli_epi16(b, 5);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_or_si128(r, _mm_or_si128(g, b)));
+    }
+#elif defined(PIXELBLEND_NEON)
+    const uint16x8_t global   = vdupq_n_u16(globalAlpha);
+    const uint16x8_t round    = vdupq_n_u16(255);
+    const uint16x8_t four     = vdupq_n_u16(4);
+    const uint16x8_t full     = vdupq_n_u16(32);
+    const uint16x8_t mask5    = vdupq_n_u16(0x1f);
+    const uint16x8_t mask6    = vdupq_n_u16(0x3f);
+    const uint16x8_t constant = vdupq_n_u16(blendFactor(255, globalAlpha));
+
+    for(; i + 8 <= count; i += 8)
+    {
+        uint16x8_t s = vld1q_u16(src + i);
+        uint16x8_t d = vld1q_u16(dst + i);
+
+        uint16x8_t a = constant;
+        if(alpha)
+        {
+            a = vmovl_u8(vld1_u8(alpha + i));
+            a = vshrq_n_u16(vmlaq_u16(round, a, global), 8);
+            a = vshrq_n_u16(vaddq_u16(a, four), 3);
+        }
+        uint16x8_t inv = vsubq_u16(full, a);
+
+        uint16x8_t r = vmlaq_u16(vmulq_u16(vshrq_n_u16(s, 11), a), vshrq_n_u16(d, 11), inv);
+        uint16x8_t g = vmlaq_u16(vmulq_u16(vandq_u16(vshrq_n_u16(s, 5), mask6), a),
+                                 vandq_u16(vshrq_n_u16(d, 5), mask6), inv);
+        uint16x8_t b = vmlaq_u16(vmulq_u16(vandq_u16(s, mask5), a), vandq_u16(d, mask5), inv);
+
+        r = vshlq_n_u16(vshrq_n_u16(r, 5), 11);
+        g = vshlq_n_u16(vshrq_n_u16(g, 5), 5);
+        b = vshrq_n_u16(b, 5);
+
+        vst1q_u16(dst + i, vorrq_u16(r, vorrq_u16(g, b)));
+    }
+#endif
+
+    blendRgb565A8Scalar(dst + i, src + i, alpha ? alpha + i : NULL, count - i, globalAlpha);
+}
+
+
+const char *PixelBlend::getKernelName()
+{
+#if defined(PIXELBLEND_SSE2)
+    return "sse2";
+#elif defined(PIXELBLEND_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
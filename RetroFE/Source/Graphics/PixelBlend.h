@@ -0,0 +1,36 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+
+// Alpha blending kernels for the RGB565 pipeline. Translucent sources are
+// blended as an RGB565 row plus a separate 8-bit alpha row; opaque sources
+// have no alpha row and only use the global alpha.
+//
+// The blend is done per channel at 5-bit alpha precision:
+//   out = (src * a + dst * (32 - a)) >> 5
+// Every variant computes exactly this, the vector kernels only process
+// several pixels at once.
+class PixelBlend
+{
+public:
+    static void splitArgb8888(const uint32_t *src, uint16_t *rgb, uint8_t *alpha, int count,
+                              int rShift, int gShift, int bShift, int aShift);
+    static void blendRgb565A8(uint16_t *dst, const uint16_t *src, const uint8_t *alpha, int count, uint8_t globalAlpha);
+    static void blendRgb565A8Scalar(uint16_t *dst, const uint16_t *src, const uint8_t *alpha, int count, uint8_t globalAlpha);
+    static const char *getKernelName();
+};
@@ -0,0 +1,323 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "PixelRotate.h"
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define PIXELROTATE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PIXELROTATE_NEON
+#endif
+
+#define TILE 16
+
+
+// Transposes an 8x8 block of 16-bit pixels: out[k][i] = in[i][k]
+static inline void transposeBlock(const uint16_t *const *in, uint16_t *const *out)
+{
+#if defined(PIXELROTATE_SSE2)
+    __m128i r[8];
+    for(int i = 0; i < 8; ++i)
+    {
+        r[i] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in[i]));
+    }
+
+    __m128i a0 = _mm_unpacklo_epi16(r[0], r[1]);
+    __m128i a1 = _mm_unpackhi_epi16(r[0], r[1]);
+    __m128i a2 = _mm_unpacklo_epi16(r[2], r[3]);
+    __m128i a3 = _mm_unpackhi_epi16(r[2], r[3]);
+    __m128i a4 = _mm_unpacklo_epi16(r[4], r[5]);
+    __m128i a5 = _mm_unpackhi_epi16(r[4], r[5]);
+    __m128i a6 = _mm_unpacklo_epi16(r[6], r[7]);
+    __m128i a7 = _mm_unpackhi_epi16(r[6], r[7]);
+
+    __m128i b0 = _mm_unpacklo_epi32(a0, a2);
+    __m128i b1 = _mm_unpackhi_epi32(a0, a2);
+    __m128i b2 = _mm_unpacklo_epi32(a1, a3);
+    __m128i b3 = _mm_unpackhi_epi32(a1, a3);
+    __m128i b4 = _mm_unpacklo_epi32(a4, a6);
+    __m128i b5 = _mm_unpackhi_epi32(a4, a6);
+    __m128i b6 = _mm_unpacklo_epi32(a5, a7);
+    __m128i b7 = _mm_unpackhi_epi32(a5, a7);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out[0]), _mm_unpacklo_epi64(b0, b4));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out[1]), _mm_unpackhi_epi64(b0, b4));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out[2]), _mm_unpacklo_epi64(b1, b5));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out[3]), _mm_unpackhi_epi64(b1, b5));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out[4]), _mm_unpacklo_epi64(b2, b6));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out[5]), _mm_unpackhi_epi64(b2, b6));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out[6]), _mm_unpacklo_epi64(b3, b7));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out[7]), _mm_unpackhi_epi64(b3, b7));
+#elif defined(PIXELROTATE_NEON)
+    uint16x8x2_t t01 = vtrnq_u16(vld1q_u16(in[0]), vld1q_u16(in[1]));
+    uint16x8x2_t t23 = vtrnq_u16(vld1q_u16(in[2]), vld1q_u16(in[3]));
+    uint16x8x2_t t45 = vtrnq_u16(vld1q_u16(in[4]), vld1q_u16(in[5]));
+    uint16x8x2_t t67 = vtrnq_u16(vld1q_u16(in[6]), vld1q_u16(in[7]));
+
+    // Columns 0 and 4, 2 and 6, 1 and 5, 3 and 7 of rows 0-3 then 4-7
+    uint32x4x2_t u02 = vtrnq_u32(vreinterpretq_u32_u16(t01.val[0]), vreinterpretq_u32_u16(t23.val[0]));
+    uint32x4x2_t u13 = vtrnq_u32(vreinterpretq_u32_u16(t01.val[1]), vreinterpretq_u32_u16(t23.val[1]));
+    uint32x4x2_t u46 = vtrnq_u32(vreinterpretq_u32_u16(t45.val[0]), vreinterpretq_u32_u16(t67.val[0]));
+    uint32x4x2_t u57 = vtrnq_u32(vreinterpretq_u32_u16(t45.val[1]), vreinterpretq_u32_u16(t67.val[1]));
+
+    vst1q_u16(out[0], vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(u02.val[0]),  vget_low_u32(u46.val[0]))));
+    vst1q_u16(out[1], vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(u13.val[0]),  vget_low_u32(u57.val[0]))));
+    vst1q_u16(out[2], vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(u02.val[1]),  vget_low_u32(u46.val[1]))));
+    vst1q_u16(out[3], vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(u13.val[1]),  vget_low_u32(u57.val[1]))));
+    vst1q_u16(out[4], vreinterpretq_u16_u32(vcombine_u32(vget_high_u32(u02.val[0]), vget_high_u32(u46.val[0]))));
+    vst1q_u16(out[5], vreinterpretq_u16_u32(vcombine_u32(vget_high_u32(u13.val[0]), vget_high_u32(u57.val[0]))));
+    vst1q_u16(out[6], vreinterpretq_u16_u32(vcombine_u32(vget_high_u32(u02.val[1]), vget_high_u32(u46.val[1]))));
+    vst1q_u16(out[7], vreinterpretq_u16_u32(vcombine_u32(vget_high_u32(u13.val[1]), vget_high_u32(u57.val[1]))));
+#else
+    for(int k = 0; k < 8; ++k)
+    {
+        for(int i = 0; i < 8; ++i)
+        {
+            out[k][i] = in[i][k];
+        }
+    }
+#endif
+}
+
+
+// Transposes a 4x4 block of 32-bit pixels: out[k][i] = in[i][k]
+static inline void transposeBlock(const uint32_t *const *in, uint32_t *const *out)
+{
+#if defined(PIXELROTATE_SSE2)
+    __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in[0]));
+    __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in[1]));
+    __m128i r2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in[2]));
+    __m128i r3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in[3]));
+
+    __m128i a0 = _mm_unpacklo_epi32(r0, r1);
+    __m128i a1 = _mm_unpacklo_epi32(r2, r3);
+    __m128i a2 = _mm_unpackhi_epi32(r0, r1);
+    __m128i a3 = _mm_unpackhi_epi32(r2, r3);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out[0]), _mm_unpacklo_epi64(a0, a1));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out[1]), _mm_unpackhi_epi64(a0, a1));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out[2]), _mm_unpacklo_epi64(a2, a3));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out[3]), _mm_unpackhi_epi64(a2, a3));
+#elif defined(PIXELROTATE_NEON)
+    uint32x4x2_t t01 = vtrnq_u32(vld1q_u32(in[0]), vld1q_u32(in[1]));
+    uint32x4x2_t t23 = vtrnq_u32(vld1q_u32(in[2]), vld1q_u32(in[3]));
+
+    vst1q_u32(out[0], vcombine_u32(vget_low_u32(t01.val[0]),  vget_low_u32(t23.val[0])));
+    vst1q_u32(out[1], vcombine_u32(vget_low_u32(t01.val[1]),  vget_low_u32(t23.val[1])));
+    vst1q_u32(out[2], vcombine_u32(vget_high_u32(t01.val[0]), vget_high_u32(t23.val[0])));
+    vst1q_u32(out[3], vcombine_u32(vget_high_u32(t01.val[1]), vget_high_u32(t23.val[1])));
+#else
+    for(int k = 0; k < 4; ++k)
+    {
+        for(int i = 0; i < 4; ++i)
+        {
+            out[k][i] = in[i][k];
+        }
+    }
+#endif
+}
+
+
+// Copies count pixels in reverse order
+static inline void reverseRow(const uint16_t *src, uint16_t *dst, int count)
+{
+    int i = 0;
+#if defined(PIXELROTATE_SSE2)
+    for(; i + 8 <= count; i += 8)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0x1b), 0x1b);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + count - i - 8), _mm_shuffle_epi32(v, 0x4e));
+    }
+#elif defined(PIXELROTATE_NEON)
+    for(; i + 8 <= count; i += 8)
+    {
+        uint16x8_t v = vrev64q_u16(vld1q_u16(src + i));
+        vst1q_u16(dst + count - i - 8, vcombine_u16(vget_high_u16(v), vget_low_u16(v)));
+    }
+#endif
+    for(; i < count; ++i)
+    {
+        dst[count - 1 - i] = src[i];
+    }
+}
+
+
+static inline void reverseRow(const uint32_t *src, uint32_t *dst, int count)
+{
+    int i = 0;
+#if defined(PIXELROTATE_SSE2)
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + count - i - 4), _mm_shuffle_epi32(v, 0x1b));
+    }
+#elif defined(PIXELROTATE_NEON)
+    for(; i + 4 <= count; i += 4)
+    {
+        uint32x4_t v = vrev64q_u32(vld1q_u32(src + i));
+        vst1q_u32(dst + count - i - 4, vcombine_u32(vget_high_u32(v), vget_low_u32(v)));
+    }
+#endif
+    for(; i < count; ++i)
+    {
+        dst[count - 1 - i] = src[i];
+    }
+}
+
+
+static void reverseRowBytes(const uint8_t *src, uint8_t *dst, int count, int bytesPerPixel)
+{
+    for(int i = 0; i < count; ++i)
+    {
+        memcpy(dst + (count - 1 - i) * bytesPerPixel, src + i * bytesPerPixel, bytesPerPixel);
+    }
+}
+
+
+// Pixel by pixel quarter turn of the source area [x0,x1) x [y0,y1)
+static void rotateArea(const uint8_t *src, int width, int height, int srcPitch,
+                       uint8_t *dst, int dstPitch, int bytesPerPixel, bool clockwise,
+                       int x0, int y0, int x1, int y1)
+{
+    for(int y = y0; y < y1; ++y)
+    {
+        const uint8_t *s = src + y * srcPitch + x0 * bytesPerPixel;
+        for(int x = x0; x < x1; ++x, s += bytesPerPixel)
+        {
+            uint8_t *d = clockwise ? dst + x * dstPitch + (height - 1 - y) * bytesPerPixel
+                                   : dst + (width - 1 - x) * dstPitch + y * bytesPerPixel;
+            memcpy(d, s, bytesPerPixel);
+        }
+    }
+}
+
+
+// Quarter turn built on transposes. Clockwise, destination row x holds
+// source column x bottom up, so the block's rows are read from the last;
+// the other way, destination row width-1-x holds it top down.
+template<typename T, int N>
+static void rotateQuarter(const uint8_t *src, int width, int height, int srcPitch,
+                          uint8_t *dst, int dstPitch, bool clockwise)
+{
+    int blocksW = width - width % N;
+    int blocksH = height - height % N;
+    const T *in[N];
+    T *out[N];
+
+    for(int ty = 0; ty < blocksH; ty += TILE)
+    {
+        int tyEnd = ty + TILE < blocksH ? ty + TILE : blocksH;
+        for(int tx = 0; tx < blocksW; tx += TILE)
+        {
+            int txEnd = tx + TILE < blocksW ? tx + TILE : blocksW;
+            for(int y = ty; y < tyEnd; y += N)
+            {
+                for(int x = tx; x < txEnd; x += N)
+                {
+                    for(int i = 0; i < N; ++i)
+                    {
+                        int row = clockwise ? y + N - 1 - i : y + i;
+                        in[i] = reinterpret_cast<const T *>(src + row * srcPitch) + x;
+                        out[i] = clockwise ? reinterpret_cast<T *>(dst + (x + i) * dstPitch) + (height - N - y)
+                                           : reinterpret_cast<T *>(dst + (width - 1 - x - i) * dstPitch) + y;
+                    }
+                    transposeBlock(in, out);
+                }
+            }
+        }
+    }
+
+    rotateArea(src, width, height, srcPitch, dst, dstPitch, sizeof(T), clockwise, blocksW, 0, width, height);
+    rotateArea(src, width, height, srcPitch, dst, dstPitch, sizeof(T), clockwise, 0, blocksH, blocksW, height);
+}
+
+
+bool PixelRotate::rotate(const void *src, int width, int height, int srcPitch,
+                         void *dst, int dstPitch, int bytesPerPixel, int degrees)
+{
+    const uint8_t *s = static_cast<const uint8_t *>(src);
+    uint8_t       *d = static_cast<uint8_t *>(dst);
+
+    switch(degrees)
+    {
+    case 0:
+        flip(src, width, height, srcPitch, dst, dstPitch, bytesPerPixel, false, false);
+        return true;
+    case 180:
+        flip(src, width, height, srcPitch, dst, dstPitch, bytesPerPixel, true, true);
+        return true;
+    case 90:
+    case 270:
+        if(bytesPerPixel == 2)
+        {
+            rotateQuarter<uint16_t, 8>(s, width, height, srcPitch, d, dstPitch, degrees == 90);
+        }
+        else if(bytesPerPixel == 4)
+        {
+            rotateQuarter<uint32_t, 4>(s, width, height, srcPitch, d, dstPitch, degrees == 90);
+        }
+        else
+        {
+            rotateArea(s, width, height, srcPitch, d, dstPitch, bytesPerPixel, degrees == 90, 0, 0, width, height);
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+
+void PixelRotate::flip(const void *src, int width, int height, int srcPitch,
+                       void *dst, int dstPitch, int bytesPerPixel, bool horizontal, bool vertical)
+{
+    for(int y = 0; y < height; ++y)
+    {
+        const uint8_t *s = static_cast<const uint8_t *>(src) + y * srcPitch;
+        uint8_t       *d = static_cast<uint8_t *>(dst) + (vertical ? height - 1 - y : y) * dstPitch;
+
+        if(!horizontal)
+        {
+            memcpy(d, s, width * bytesPerPixel);
+        }
+        else if(bytesPerPixel == 2)
+        {
+            reverseRow(reinterpret_cast<const uint16_t *>(s), reinterpret_cast<uint16_t *>(d), width);
+        }
+        else if(bytesPerPixel == 4)
+        {
+            reverseRow(reinterpret_cast<const uint32_t *>(s), reinterpret_cast<uint32_t *>(d), width);
+        }
+        else
+        {
+            reverseRowBytes(s, d, width, bytesPerPixel);
+        }
+    }
+}
+
+
+const char *PixelRotate::getKernelName()
+{
+#if defined(PIXELROTATE_SSE2)
+    return "sse2";
+#elif defined(PIXELROTATE_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
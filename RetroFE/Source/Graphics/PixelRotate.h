@@ -0,0 +1,37 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+
+// Rotation and mirroring of frames and textures into a preallocated
+// destination, which must not overlap the source. Rotations are clockwise
+// by 0, 90, 180 or 270 degrees; quarter turns give a destination of
+// height x width pixels.
+//
+// 16 and 32-bit pixels go through vector kernels: quarter turns transpose
+// blocks of 8x8 (16-bit) or 4x4 (32-bit) pixels in registers, walked in
+// 16x16 tiles so the destination columns stay in cache. Other depths and
+// the edges left by odd sizes are copied pixel by pixel.
+class PixelRotate
+{
+public:
+    static bool rotate(const void *src, int width, int height, int srcPitch,
+                       void *dst, int dstPitch, int bytesPerPixel, int degrees);
+    static void flip(const void *src, int width, int height, int srcPitch,
+                     void *dst, int dstPitch, int bytesPerPixel, bool horizontal, bool vertical);
+    static const char *getKernelName();
+};
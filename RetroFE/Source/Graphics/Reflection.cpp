@@ -0,0 +1,313 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Reflection.h"
+#include "PixelBlend.h"
+#include <cstring>
+
+
+Reflection::Reflection()
+    : valid_(false)
+    , fade_(0)
+{
+    memset(&key_, 0, sizeof(key_));
+}
+
+
+Reflection::Side Reflection::parseSide(const std::string &name)
+{
+    if(name == "top")    return SIDE_TOP;
+    if(name == "bottom") return SIDE_BOTTOM;
+    if(name == "left")   return SIDE_LEFT;
+    if(name == "right")  return SIDE_RIGHT;
+    return SIDE_NONE;
+}
+
+
+// Where the reflection goes for an image drawn at the given rectangle,
+// squeezed by scale along the mirrored axis
+Reflection::Rect Reflection::place(Side side, const Rect &image, float scale, int distance)
+{
+    Rect r = image;
+
+    switch(side)
+    {
+    case SIDE_TOP:
+        r.h = static_cast<int>(image.h * scale);
+        r.y = image.y - r.h - distance;
+        break;
+    case SIDE_BOTTOM:
+        r.h = static_cast<int>(image.h * scale);
+        r.y = image.y + image.h + distance;
+        break;
+    case SIDE_LEFT:
+        r.w = static_cast<int>(image.w * scale);
+        r.x = image.x - r.w - distance;
+        break;
+    case SIDE_RIGHT:
+        r.w = static_cast<int>(image.w * scale);
+        r.x = image.x + image.w + distance;
+        break;
+    default:
+        r.w = 0;
+        r.h = 0;
+        break;
+    }
+
+    return r;
+}
+
+
+void Reflection::clear()
+{
+    valid_ = false;
+    std::vector<uint16_t>().swap(rgb_);
+    std::vector<uint8_t>().swap(alpha_);
+    std::vector<uint32_t>().swap(argb_);
+}
+
+
+bool Reflection::sameKey(const Key &a, const Key &b)
+{
+    return a.pixels == b.pixels && a.width == b.width && a.height == b.height &&
+           a.area.x == b.area.x && a.area.y == b.area.y && a.area.w == b.area.w && a.area.h == b.area.h &&
+           a.side == b.side && a.placementW == b.placementW && a.placementH == b.placementH && a.fade == b.fade &&
+           memcmp(a.textureFormat, b.textureFormat, sizeof(a.textureFormat)) == 0 &&
+           memcmp(a.targetFormat, b.targetFormat, sizeof(a.targetFormat)) == 0;
+}
+
+
+// Alpha at a distance d from the image, out of len lines: full at the
+// image's edge and down to nothing at the far edge
+static inline unsigned int fadeAt(int fade, int d, int len)
+{
+    return static_cast<unsigned int>(fade * (len - d) / len);
+}
+
+// Straight color of a premultiplied channel
+static inline unsigned int unpremultiply(unsigned int c, unsigned int a)
+{
+    c = (c * 255 + a / 2) / a;
+    return c > 255 ? 255 : c;
+}
+
+
+// Samples one row of the reflection into the row buffers at offset, in
+// the target's form: RGB565 plus alpha, or 8-bit ARGB
+void Reflection::sampleRow(const Surface &texture, const Rect &area, Side side, const Rect &placement,
+                           int row, int targetBytesPerPixel, int offset)
+{
+    bool vertical = side == SIDE_TOP || side == SIDE_BOTTOM;
+    int  srcY;
+    unsigned int rowFade = 255;
+
+    if(vertical)
+    {
+        int d = side == SIDE_BOTTOM ? row : placement.h - 1 - row;
+        int line = d * area.h / placement.h;
+        srcY = side == SIDE_BOTTOM ? area.y + area.h - 1 - line : area.y + line;
+        rowFade = fadeAt(fade_, d, placement.h);
+    }
+    else
+    {
+        srcY = area.y + row * area.h / placement.h;
+    }
+
+    const uint8_t *src = static_cast<const uint8_t *>(texture.pixels) + srcY * texture.pitch;
+    uint32_t rgbMask = (0xffu << texture.rShift) | (0xffu << texture.gShift) | (0xffu << texture.bShift);
+
+    for(int j = 0; j < placement.w; ++j)
+    {
+        unsigned int a;
+        unsigned int r;
+        unsigned int g;
+        unsigned int b;
+        int x = columnX_[j];
+
+        if(texture.bytesPerPixel == 2)
+        {
+            uint16_t p = reinterpret_cast<const uint16_t *>(src)[x];
+            r = ((p >> 8) & 0xf8) | (p >> 13);
+            g = ((p >> 3) & 0xfc) | ((p >> 9) & 0x03);
+            b = ((p << 3) & 0xf8) | ((p >> 2) & 0x07);
+            a = texture.keyed && p == texture.key ? 0 : 255;
+        }
+        else
+        {
+            uint32_t p = reinterpret_cast<const uint32_t *>(src)[x];
+            r = (p >> texture.rShift) & 0xff;
+            g = (p >> texture.gShift) & 0xff;
+            b = (p >> texture.bShift) & 0xff;
+            a = texture.aShift < 0 ? 255 : (p >> texture.aShift) & 0xff;
+            if(texture.keyed && (p & rgbMask) == texture.key)
+            {
+                a = 0;
+            }
+            else if(texture.premultiplied && a > 0 && a < 255)
+            {
+                r = unpremultiply(r, a);
+                g = unpremultiply(g, a);
+                b = unpremultiply(b, a);
+            }
+        }
+
+        unsigned int fade = vertical ? rowFade : columnFade_[j];
+        a = (a * fade + 127) / 255;
+
+        if(targetBytesPerPixel == 2)
+        {
+            rgb_[offset + j]   = static_cast<uint16_t>(((r & 0xf8) << 8) | ((g & 0xfc) << 3) | (b >> 3));
+            alpha_[offset + j] = static_cast<uint8_t>(a);
+        }
+        else
+        {
+            argb_[offset + j] = (a << 24) | (r << 16) | (g << 8) | b;
+        }
+    }
+}
+
+
+// Blends the columns [x0, x1) of a sampled row into the target row y
+void Reflection::blendRow(const Surface &target, int y, int x0, int x1, int offset, uint8_t alpha)
+{
+    uint8_t *dst = static_cast<uint8_t *>(target.pixels) + y * target.pitch;
+
+    if(target.bytesPerPixel == 2)
+    {
+        PixelBlend::blendRgb565A8(reinterpret_cast<uint16_t *>(dst) + x0, &rgb_[offset], &alpha_[offset], x1 - x0, alpha);
+        return;
+    }
+
+    uint32_t *out = reinterpret_cast<uint32_t *>(dst) + x0;
+    for(int i = 0; i < x1 - x0; ++i)
+    {
+        uint32_t s = argb_[offset + i];
+        unsigned int a = ((s >> 24) * alpha + 127) / 255;
+        if(a == 0)
+        {
+            continue;
+        }
+
+        uint32_t d = out[i];
+        unsigned int r = (((s >> 16) & 0xff) * a + ((d >> target.rShift) & 0xff) * (255 - a) + 127) / 255;
+        unsigned int g = (((s >> 8) & 0xff) * a + ((d >> target.gShift) & 0xff) * (255 - a) + 127) / 255;
+        unsigned int b = ((s & 0xff) * a + ((d >> target.bShift) & 0xff) * (255 - a) + 127) / 255;
+
+        uint32_t keep = ~((0xffu << target.rShift) | (0xffu << target.gShift) | (0xffu << target.bShift));
+        out[i] = (d & keep) | (r << target.rShift) | (g << target.gShift) | (b << target.bShift);
+    }
+}
+
+
+// Draws the reflection of the texture's area at placement. With keep set
+// the sampled rows are kept and reused while the texture and geometry
+// stay the same; otherwise each row is sampled and blended in turn.
+void Reflection::draw(const Surface &texture, const Rect &area, Side side, const Rect &placement,
+                      float reflectionAlpha, const Surface &target, uint8_t alpha, bool keep)
+{
+    if(side == SIDE_NONE || alpha == 0 || placement.w <= 0 || placement.h <= 0 || area.w <= 0 || area.h <= 0 ||
+       (texture.bytesPerPixel != 2 && texture.bytesPerPixel != 4) ||
+       (target.bytesPerPixel != 2 && target.bytesPerPixel != 4))
+    {
+        return;
+    }
+
+    int x0 = placement.x < 0 ? 0 : placement.x;
+    int y0 = placement.y < 0 ? 0 : placement.y;
+    int x1 = placement.x + placement.w < target.width  ? placement.x + placement.w : target.width;
+    int y1 = placement.y + placement.h < target.height ? placement.y + placement.h : target.height;
+    if(x0 >= x1 || y0 >= y1)
+    {
+        return;
+    }
+
+    int fade = static_cast<int>(reflectionAlpha * 255 + 0.5f);
+    fade_ = fade < 0 ? 0 : (fade > 255 ? 255 : fade);
+
+    Key key;
+    memset(&key, 0, sizeof(key));
+    key.pixels     = texture.pixels;
+    key.width      = texture.width;
+    key.height     = texture.height;
+    key.area       = area;
+    key.side       = side;
+    key.placementW = placement.w;
+    key.placementH = placement.h;
+    key.fade       = fade_;
+    int textureFormat[5] = { texture.bytesPerPixel, texture.rShift, texture.gShift, texture.bShift, texture.aShift };
+    int targetFormat[5]  = { target.bytesPerPixel, target.rShift, target.gShift, target.bShift, target.aShift };
+    memcpy(key.textureFormat, textureFormat, sizeof(textureFormat));
+    memcpy(key.targetFormat, targetFormat, sizeof(targetFormat));
+
+    bool sample = !keep || !valid_ || !sameKey(key, key_);
+    if(sample)
+    {
+        // Source column and fade of every column, mirrored for left and right
+        bool vertical = side == SIDE_TOP || side == SIDE_BOTTOM;
+        columnX_.resize(placement.w);
+        columnFade_.resize(placement.w);
+        for(int j = 0; j < placement.w; ++j)
+        {
+            if(vertical)
+            {
+                columnX_[j]    = area.x + j * area.w / placement.w;
+                columnFade_[j] = 255;
+            }
+            else
+            {
+                int d = side == SIDE_RIGHT ? j : placement.w - 1 - j;
+                int line = d * area.w / placement.w;
+                columnX_[j]    = side == SIDE_RIGHT ? area.x + area.w - 1 - line : area.x + line;
+                columnFade_[j] = static_cast<uint8_t>(fadeAt(fade_, d, placement.w));
+            }
+        }
+
+        size_t size = keep ? static_cast<size_t>(placement.w) * placement.h : placement.w;
+        if(target.bytesPerPixel == 2)
+        {
+            rgb_.resize(size);
+            alpha_.resize(size);
+        }
+        else
+        {
+            argb_.resize(size);
+        }
+    }
+
+    if(keep && sample)
+    {
+        for(int row = 0; row < placement.h; ++row)
+        {
+            sampleRow(texture, area, side, placement, row, target.bytesPerPixel, row * placement.w);
+        }
+        key_   = key;
+        valid_ = true;
+    }
+    else if(!keep)
+    {
+        valid_ = false;
+    }
+
+    for(int y = y0; y < y1; ++y)
+    {
+        int row = y - placement.y;
+        int offset = keep ? row * placement.w : 0;
+        if(!keep)
+        {
+            sampleRow(texture, area, side, placement, row, target.bytesPerPixel, 0);
+        }
+        blendRow(target, y, x0, x1, offset + x0 - placement.x, alpha);
+    }
+}
@@ -0,0 +1,101 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Mirror image drawn next to a texture, fading out away from it. Every
+// row of the reflection is sampled straight from the texture, mirrored
+// and scaled, then blended into the window: no flipped copy of the
+// texture is made. A static texture keeps its sampled rows between frames.
+class Reflection
+{
+public:
+    enum Side
+    {
+        SIDE_NONE,
+        SIDE_TOP,
+        SIDE_BOTTOM,
+        SIDE_LEFT,
+        SIDE_RIGHT
+    };
+
+    // Two bytes per pixel is RGB565, four is 8-bit channels at the given
+    // shifts, a negative alpha shift meaning opaque. A keyed texture hides
+    // its pixels of the key color, a premultiplied one has its colors
+    // multiplied by their alpha.
+    struct Surface
+    {
+        void    *pixels;
+        int      width;
+        int      height;
+        int      pitch;
+        int      bytesPerPixel;
+        int      rShift;
+        int      gShift;
+        int      bShift;
+        int      aShift;
+        bool     premultiplied;
+        bool     keyed;
+        uint32_t key;
+    };
+
+    struct Rect
+    {
+        int x;
+        int y;
+        int w;
+        int h;
+    };
+
+    Reflection();
+    static Side parseSide(const std::string &name);
+    static Rect place(Side side, const Rect &image, float scale, int distance);
+    void draw(const Surface &texture, const Rect &area, Side side, const Rect &placement,
+              float reflectionAlpha, const Surface &target, uint8_t alpha, bool keep);
+    void clear();
+
+private:
+    struct Key
+    {
+        const void *pixels;
+        int         width;
+        int         height;
+        Rect        area;
+        Side        side;
+        int         placementW;
+        int         placementH;
+        int         fade;
+        int         textureFormat[5];
+        int         targetFormat[5];
+    };
+
+    static bool sameKey(const Key &a, const Key &b);
+    void sampleRow(const Surface &texture, const Rect &area, Side side, const Rect &placement,
+                   int row, int targetBytesPerPixel, int offset);
+    void blendRow(const Surface &target, int y, int x0, int x1, int offset, uint8_t alpha);
+
+    bool                  valid_;
+    Key                   key_;
+    int                   fade_;
+    std::vector<int>      columnX_;
+    std::vector<uint8_t>  columnFade_;
+    std::vector<uint16_t> rgb_;
+    std::vector<uint8_t>  alpha_;
+    std::vector<uint32_t> argb_;
+};
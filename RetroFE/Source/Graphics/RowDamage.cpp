@@ -0,0 +1,72 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "RowDamage.h"
+#include <cstring>
+
+
+// Runs of adjacent changed rows are merged, an unchanged row ends a run
+void RowDamage::collect(const void *back, int backPitch, const void *front, int frontPitch,
+                        int rowBytes, int height, std::vector<Span> &spans)
+{
+    spans.clear();
+
+    const unsigned char *backRow  = static_cast<const unsigned char *>(back);
+    const unsigned char *frontRow = static_cast<const unsigned char *>(front);
+
+    for(int y = 0; y < height; y++, backRow += backPitch, frontRow += frontPitch)
+    {
+        if(memcmp(backRow, frontRow, rowBytes) == 0)
+        {
+            continue;
+        }
+
+        if(!spans.empty() && spans.back().first + spans.back().count == y)
+        {
+            spans.back().count++;
+        }
+        else
+        {
+            Span span = { y, 1 };
+            spans.push_back(span);
+        }
+    }
+}
+
+
+void RowDamage::copy(const void *src, int srcPitch, void *dst, int dstPitch,
+                     int rowBytes, const std::vector<Span> &spans)
+{
+    const unsigned char *srcPixels = static_cast<const unsigned char *>(src);
+    unsigned char       *dstPixels = static_cast<unsigned char *>(dst);
+
+    for(size_t i = 0; i < spans.size(); i++)
+    {
+        const unsigned char *srcRow = srcPixels + static_cast<size_t>(srcPitch) * spans[i].first;
+        unsigned char       *dstRow = dstPixels + static_cast<size_t>(dstPitch) * spans[i].first;
+
+        // One copy for the whole run when both buffers are laid out alike
+        if(srcPitch == dstPitch && srcPitch == rowBytes)
+        {
+            memcpy(dstRow, srcRow, static_cast<size_t>(rowBytes) * spans[i].count);
+            continue;
+        }
+
+        for(int y = 0; y < spans[i].count; y++, srcRow += srcPitch, dstRow += dstPitch)
+        {
+            memcpy(dstRow, srcRow, rowBytes);
+        }
+    }
+}
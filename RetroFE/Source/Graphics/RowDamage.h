@@ -0,0 +1,35 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <vector>
+
+// Rows of a frame that differ from the frame shown before it, grouped in
+// runs so a run costs one screen update instead of one per row
+class RowDamage
+{
+public:
+    struct Span
+    {
+        int first;
+        int count;
+    };
+
+    static void collect(const void *back, int backPitch, const void *front, int frontPitch,
+                        int rowBytes, int height, std::vector<Span> &spans);
+    static void copy(const void *src, int srcPitch, void *dst, int dstPitch,
+                     int rowBytes, const std::vector<Span> &spans);
+};
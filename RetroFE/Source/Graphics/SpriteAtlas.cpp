@@ -0,0 +1,212 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "SpriteAtlas.h"
+#include <cstring>
+
+
+SpriteAtlas::SpriteAtlas()
+    : slotWidth_(0)
+    , slotHeight_(0)
+    , bytesPerPixel_(0)
+{
+}
+
+
+bool SpriteAtlas::create(int slotWidth, int slotHeight, unsigned int slots, int bytesPerPixel)
+{
+    destroy();
+
+    if(slotWidth <= 0 || slotHeight <= 0 || slots == 0 || bytesPerPixel <= 0)
+    {
+        return false;
+    }
+
+    slotWidth_     = slotWidth;
+    slotHeight_    = slotHeight;
+    bytesPerPixel_ = bytesPerPixel;
+    pixels_.resize(static_cast<size_t>(getPitch()) * slotHeight * slots);
+    used_.resize(slots, false);
+
+    // Handed out from the back, slot 0 first
+    for(unsigned int i = slots; i > 0; --i)
+    {
+        freeSlots_.push_back(i - 1);
+    }
+
+    return true;
+}
+
+
+void SpriteAtlas::destroy()
+{
+    std::vector<unsigned char>().swap(pixels_);
+    std::vector<int>().swap(freeSlots_);
+    std::vector<bool>().swap(used_);
+    slotWidth_     = 0;
+    slotHeight_    = 0;
+    bytesPerPixel_ = 0;
+}
+
+
+bool SpriteAtlas::isValid()
+{
+    return !pixels_.empty();
+}
+
+
+// A free slot, or -1 when they are all taken
+int SpriteAtlas::allocate()
+{
+    if(freeSlots_.empty())
+    {
+        return -1;
+    }
+
+    int slot = freeSlots_.back();
+    freeSlots_.pop_back();
+    used_[slot] = true;
+
+    return slot;
+}
+
+
+void SpriteAtlas::release(int slot)
+{
+    if(slot < 0 || slot >= static_cast<int>(used_.size()) || !used_[slot])
+    {
+        return;
+    }
+
+    used_[slot] = false;
+    freeSlots_.push_back(slot);
+}
+
+
+// Copies an image to the top left of a slot, in its own depth as long as it
+// is no deeper than the atlas. An image larger than the slot is scaled
+// down to fit, keeping its aspect, with the nearest neighbour sampling of
+// SDL::zoomSurface.
+bool SpriteAtlas::store(int slot, const void *pixels, int width, int height, int pitch, int bytesPerPixel,
+                        int &storedWidth, int &storedHeight)
+{
+    if(slot < 0 || slot >= static_cast<int>(used_.size()) || !used_[slot] || !pixels ||
+       width <= 0 || height <= 0 || bytesPerPixel <= 0 || bytesPerPixel > bytesPerPixel_ || pitch < width * bytesPerPixel)
+    {
+        return false;
+    }
+
+    storedWidth  = width;
+    storedHeight = height;
+    if(width > slotWidth_ || height > slotHeight_)
+    {
+        if(static_cast<long long>(width) * slotHeight_ > static_cast<long long>(height) * slotWidth_)
+        {
+            storedWidth  = slotWidth_;
+            storedHeight = static_cast<int>(static_cast<long long>(height) * slotWidth_ / width);
+        }
+        else
+        {
+            storedWidth  = static_cast<int>(static_cast<long long>(width) * slotHeight_ / height);
+            storedHeight = slotHeight_;
+        }
+        if(storedWidth < 1) storedWidth = 1;
+        if(storedHeight < 1) storedHeight = 1;
+    }
+
+    const unsigned char *src = static_cast<const unsigned char *>(pixels);
+    unsigned char *dst = static_cast<unsigned char *>(getSlotPixels(slot));
+    int dstPitch = getPitch();
+
+    if(storedWidth == width && storedHeight == height)
+    {
+        for(int y = 0; y < height; y++)
+        {
+            memcpy(dst + static_cast<size_t>(dstPitch) * y, src + static_cast<size_t>(pitch) * y,
+                   static_cast<size_t>(width * bytesPerPixel));
+        }
+        return true;
+    }
+
+    int xRatio = (width << 16) / storedWidth;
+    int yRatio = (height << 16) / storedHeight;
+    for(int y = 0; y < storedHeight; y++)
+    {
+        const unsigned char *row = src + static_cast<size_t>(pitch) * ((y * yRatio) >> 16);
+        unsigned char *out = dst + static_cast<size_t>(dstPitch) * y;
+        int x2 = 0;
+        for(int x = 0; x < storedWidth; x++)
+        {
+            memcpy(out, row + (x2 >> 16) * bytesPerPixel, bytesPerPixel);
+            out += bytesPerPixel;
+            x2 += xRatio;
+        }
+    }
+
+    return true;
+}
+
+
+void *SpriteAtlas::getSlotPixels(int slot)
+{
+    if(slot < 0 || slot >= static_cast<int>(used_.size()))
+    {
+        return NULL;
+    }
+
+    return &pixels_[static_cast<size_t>(getPitch()) * slotHeight_ * slot];
+}
+
+
+int SpriteAtlas::getPitch()
+{
+    return slotWidth_ * bytesPerPixel_;
+}
+
+
+int SpriteAtlas::getSlotWidth()
+{
+    return slotWidth_;
+}
+
+
+int SpriteAtlas::getSlotHeight()
+{
+    return slotHeight_;
+}
+
+
+int SpriteAtlas::getBytesPerPixel()
+{
+    return bytesPerPixel_;
+}
+
+
+unsigned int SpriteAtlas::getSlotCount()
+{
+    return used_.size();
+}
+
+
+unsigned int SpriteAtlas::getUsedSlots()
+{
+    return used_.size() - freeSlots_.size();
+}
+
+
+size_t SpriteAtlas::getBytes()
+{
+    return pixels_.size();
+}
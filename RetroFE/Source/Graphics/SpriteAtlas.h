@@ -0,0 +1,52 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Pixels of every item texture of a scrolling list, allocated once. The
+// atlas is a column of equal slots, each as large as the biggest item the
+// layout shows, so a scroll reuses the slot the leaving item released
+// instead of freeing and allocating a surface.
+class SpriteAtlas
+{
+public:
+    SpriteAtlas();
+    bool create(int slotWidth, int slotHeight, unsigned int slots, int bytesPerPixel);
+    void destroy();
+    bool isValid();
+    int allocate();
+    void release(int slot);
+    bool store(int slot, const void *pixels, int width, int height, int pitch, int bytesPerPixel,
+               int &storedWidth, int &storedHeight);
+    void *getSlotPixels(int slot);
+    int getPitch();
+    int getSlotWidth();
+    int getSlotHeight();
+    int getBytesPerPixel();
+    unsigned int getSlotCount();
+    unsigned int getUsedSlots();
+    size_t getBytes();
+
+private:
+    std::vector<unsigned char> pixels_;
+    std::vector<int> freeSlots_;
+    std::vector<bool> used_;
+    int slotWidth_;
+    int slotHeight_;
+    int bytesPerPixel_;
+};
@@ -0,0 +1,140 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "SurfaceTracker.h"
+
+std::mutex                                        SurfaceTracker::mutex_;
+std::map<const void *, SurfaceTracker::Allocation> SurfaceTracker::allocations_;
+std::map<std::string, size_t>                     SurfaceTracker::tagBytes_;
+size_t                                            SurfaceTracker::liveBytes_ = 0;
+size_t                                            SurfaceTracker::peakBytes_ = 0;
+
+
+// A surface freed behind the tracker's back may come back at the same
+// address, the stale entry is then replaced
+void SurfaceTracker::add(const void *surface, size_t bytes, const std::string &tag)
+{
+    if(!surface)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    removeLocked(surface);
+
+    Allocation allocation;
+    allocation.surface = surface;
+    allocation.bytes   = bytes;
+    allocation.tag     = tag;
+    allocations_[surface] = allocation;
+
+    tagBytes_[tag] += bytes;
+    liveBytes_     += bytes;
+    if(liveBytes_ > peakBytes_)
+    {
+        peakBytes_ = liveBytes_;
+    }
+}
+
+
+// Returns false for a surface the tracker did not see made
+bool SurfaceTracker::remove(const void *surface)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return removeLocked(surface);
+}
+
+
+bool SurfaceTracker::removeLocked(const void *surface)
+{
+    std::map<const void *, Allocation>::iterator it = allocations_.find(surface);
+    if(it == allocations_.end())
+    {
+        return false;
+    }
+
+    std::map<std::string, size_t>::iterator tag = tagBytes_.find(it->second.tag);
+    tag->second -= it->second.bytes;
+    if(tag->second == 0)
+    {
+        tagBytes_.erase(tag);
+    }
+    liveBytes_ -= it->second.bytes;
+    allocations_.erase(it);
+
+    return true;
+}
+
+
+// The tag of a tracked surface, empty when it is not tracked; a surface
+// made from another one belongs to the same component
+std::string SurfaceTracker::getTag(const void *surface)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::map<const void *, Allocation>::iterator it = allocations_.find(surface);
+    return (it == allocations_.end()) ? "" : it->second.tag;
+}
+
+
+size_t SurfaceTracker::getLiveBytes()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return liveBytes_;
+}
+
+
+size_t SurfaceTracker::getLiveBytes(const std::string &tag)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::map<std::string, size_t>::iterator it = tagBytes_.find(tag);
+    return (it == tagBytes_.end()) ? 0 : it->second;
+}
+
+
+size_t SurfaceTracker::getPeakBytes()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return peakBytes_;
+}
+
+
+unsigned int SurfaceTracker::getLiveCount()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return static_cast<unsigned int>(allocations_.size());
+}
+
+
+// A copy of the outstanding allocations, in address order
+std::vector<SurfaceTracker::Allocation> SurfaceTracker::getAllocations()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<Allocation> allocations;
+    allocations.reserve(allocations_.size());
+    for(std::map<const void *, Allocation>::iterator it = allocations_.begin(); it != allocations_.end(); ++it)
+    {
+        allocations.push_back(it->second);
+    }
+
+    return allocations;
+}
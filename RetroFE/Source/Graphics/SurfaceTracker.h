@@ -0,0 +1,56 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Accounts for the pixel memory of the textures the components hold, by
+// the kind of component that owns them. SDL::loadSurface and the other
+// tracked surface calls add a surface when they make it and
+// SDL::freeSurface removes it, so whatever is still here once the pages
+// are deleted has leaked.
+class SurfaceTracker
+{
+public:
+    struct Allocation
+    {
+        const void *surface;
+        size_t      bytes;
+        std::string tag;
+    };
+
+    static void add(const void *surface, size_t bytes, const std::string &tag);
+    static bool remove(const void *surface);
+    static std::string getTag(const void *surface);
+    static size_t getLiveBytes();
+    static size_t getLiveBytes(const std::string &tag);
+    static size_t getPeakBytes();
+    static unsigned int getLiveCount();
+    static std::vector<Allocation> getAllocations();
+
+private:
+    static bool removeLocked(const void *surface);
+
+    static std::mutex                          mutex_;
+    static std::map<const void *, Allocation>  allocations_;
+    static std::map<std::string, size_t>       tagBytes_;
+    static size_t                              liveBytes_;
+    static size_t                              peakBytes_;
+};
@@ -1,7 +1,10 @@
 #include "MenuMode.h"
 #include "../Utility/Utils.h"
+#include "../Utility/HelperExecutor.h"
+#include "MenuSystemValues.h"
 #include <iostream>
 #include "../SDL.h"
+#include "../RetroFE.h"
 #include "../Utility/Utils.h"
 
 /// -------------- DEFINES --------------
@@ -35,15 +38,18 @@
 #define MENU_BG_SQURE_WIDTH         180
 #define MENU_BG_SQUREE_HEIGHT       140
 
-#define MENU_FONT_NAME_TITLE        "/usr/games/menu_resources/OpenSans-Bold.ttf"
+#ifndef MENU_RESOURCES_DIR
+#define MENU_RESOURCES_DIR          "/usr/games/menu_resources/"
+#endif
+#define MENU_FONT_NAME_TITLE        MENU_RESOURCES_DIR "OpenSans-Bold.ttf"
 #define MENU_FONT_SIZE_TITLE        22
-#define MENU_FONT_NAME_INFO         "/usr/games/menu_resources/OpenSans-Bold.ttf"
+#define MENU_FONT_NAME_INFO         MENU_RESOURCES_DIR "OpenSans-Bold.ttf"
 #define MENU_FONT_SIZE_INFO         16
-#define MENU_FONT_NAME_SMALL_INFO   "/usr/games/menu_resources/OpenSans-Regular.ttf"
+#define MENU_FONT_NAME_SMALL_INFO   MENU_RESOURCES_DIR "OpenSans-Regular.ttf"
 #define MENU_FONT_SIZE_SMALL_INFO   13
-#define MENU_PNG_BG_PATH            "/usr/games/menu_resources/zone_bg.png"
-#define MENU_PNG_ARROW_TOP_PATH     "/usr/games/menu_resources/arrow_top.png"
-#define MENU_PNG_ARROW_BOTTOM_PATH  "/usr/games/menu_resources/arrow_bottom.png"
+#define MENU_PNG_BG_PATH            MENU_RESOURCES_DIR "zone_bg.png"
+#define MENU_PNG_ARROW_TOP_PATH     MENU_RESOURCES_DIR "arrow_top.png"
+#define MENU_PNG_ARROW_BOTTOM_PATH  MENU_RESOURCES_DIR "arrow_bottom.png"
 
 #define GRAY_MAIN_R                 85
 #define GRAY_MAIN_G                 85
@@ -81,8 +87,9 @@ uint16_t MenuMode::y_volume_bar = 0;
 uint16_t MenuMode::x_brightness_bar = 0;
 uint16_t MenuMode::y_brightness_bar = 0;
 
-int MenuMode::volume_percentage = 0;
-int MenuMode::brightness_percentage = 0;
+int MenuMode::volume_percentage = 50;
+int MenuMode::brightness_percentage = 50;
+MenuSystemValues *MenuMode::system_values = NULL;
 
 #undef X
 #define X(a, b) b,
@@ -121,7 +128,9 @@ void MenuMode::init(Configuration &c)
 	/// ----- Copy virtual_hw_screen at init ------
 	SDL_Surface * virtual_hw_screen = SDL::getWindow();
 	backup_hw_screen = SDL_CreateRGBSurface(SDL_SWSURFACE,
-			virtual_hw_screen->w, virtual_hw_screen->h, 32, 0, 0, 0, 0);
+			virtual_hw_screen->w, virtual_hw_screen->h, virtual_hw_screen->format->BitsPerPixel,
+			virtual_hw_screen->format->Rmask, virtual_hw_screen->format->Gmask,
+			virtual_hw_screen->format->Bmask, 0);
 	if(backup_hw_screen == NULL){
 		MENU_ERROR_PRINTF("ERROR in init_menu_SDL: Could not create backup_hw_screen: %s\n", SDL_GetError());
 	}
@@ -142,6 +151,12 @@ void MenuMode::init(Configuration &c)
 	/// ------ Init menu zones ------
 	init_menu_zones();
 
+	/// ------ Start reading the system values, so they are known when the menu opens ------
+	system_values = new MenuSystemValues(HelperExecutor::getInstance(), SYSTEM_VALUES_MAX_AGE,
+			SHELL_CMD_VOLUME_GET, SHELL_CMD_BRIGHTNESS_GET,
+			SHELL_CMD_SHARE_IS_USB_DATA_CONNECTED, SHELL_CMD_SHARE_IS_SHARING);
+	system_values->refresh();
+
 	return;
 }
 
@@ -174,6 +189,9 @@ void MenuMode::end( )
 	idx_menus=NULL;
 	nb_menu_zones = 0;
 
+	delete system_values;
+	system_values = NULL;
+
 	return;
 }
 
@@ -389,54 +407,30 @@ void MenuMode::init_menu_zones(){
 
 
 void MenuMode::init_menu_system_values(){
-	FILE *fp;
-	char res[100];
-
-	/// ------- Get system volume percentage --------
-	fp = popen(SHELL_CMD_VOLUME_GET, "r");
-	if (fp == NULL) {
-		MENU_ERROR_PRINTF("Failed to run command %s\n", SHELL_CMD_VOLUME_GET );
-		volume_percentage = 50; ///wrong value: setting default to 50
-	}
-	else{
-		fgets(res, sizeof(res)-1, fp);
-		pclose(fp);
-
-		/// Check if Volume is a number (at least the first char)
-		if(res[0] < '0' || res[0] > '9'){
-			MENU_ERROR_PRINTF("Wrong return value: %s for volume cmd: %s\n",res, SHELL_CMD_VOLUME_GET);
-			volume_percentage = 50; ///wrong value: setting default to 50
-		}
-		else{
-			volume_percentage = atoi(res);
-			MENU_DEBUG_PRINTF("System volume = %d%%\n", volume_percentage);
-		}
-	}
-
-	/// ------- Get system brightness percentage -------
-	fp = popen(SHELL_CMD_BRIGHTNESS_GET, "r");
-	if (fp == NULL) {
-		MENU_ERROR_PRINTF("Failed to run command %s\n", SHELL_CMD_BRIGHTNESS_GET );
-		brightness_percentage = 50; ///wrong value: setting default to 50
-	}
-	else{
-		fgets(res, sizeof(res)-1, fp);
-		pclose(fp);
+	/// ------- Read the system values again, the menu is drawn with the last known ones meanwhile -------
+	system_values->refresh();
+	update_menu_system_values();
+}
 
-		/// Check if brightness is a number (at least the first char)
-		if(res[0] < '0' || res[0] > '9'){
-			MENU_ERROR_PRINTF("Wrong return value: %s for volume cmd: %s\n",res, SHELL_CMD_BRIGHTNESS_GET);
-			brightness_percentage = 50; ///wrong value: setting default to 50
-		}
-		else{
-			brightness_percentage = atoi(res);
-			MENU_DEBUG_PRINTF("System brightness = %d%%\n", brightness_percentage);
-		}
+/// Applies the system values read in the background, returns the MenuSystemValues fields that changed
+unsigned int MenuMode::update_menu_system_values(){
+	MenuSystemState state;
+	state.volume = volume_percentage;
+	state.brightness = brightness_percentage;
+	state.usbDataConnected = usb_data_connected;
+	state.usbSharing = usb_sharing;
+
+	unsigned int changed = system_values->update(state);
+	if(!changed){
+		return 0;
 	}
 
-	/// ------- Get USB Value -------
-	usb_data_connected = Utils::executeRawPath(SHELL_CMD_SHARE_IS_USB_DATA_CONNECTED);
-	usb_sharing = Utils::executeRawPath(SHELL_CMD_SHARE_IS_SHARING);
+	volume_percentage = state.volume;
+	brightness_percentage = state.brightness;
+	usb_data_connected = state.usbDataConnected;
+	usb_sharing = state.usbSharing;
+	MENU_DEBUG_PRINTF("System volume = %d%%, brightness = %d%%, usb connected = %d, sharing = %d\n",
+			volume_percentage, brightness_percentage, usb_data_connected, usb_sharing);
 
 	/** Sanity check if usb not connected */
 	if(!usb_data_connected){
@@ -459,6 +453,8 @@ void MenuMode::init_menu_system_values(){
 			}
 		}
 	}
+
+	return changed;
 }
 
 void MenuMode::menu_screen_refresh(int menuItem, int prevItem, int scroll, uint8_t menu_confirmation, uint8_t menu_action){
@@ -705,6 +701,47 @@ void MenuMode::menu_screen_refresh(int menuItem, int prevItem, int scroll, uint8
 	SDL::renderAndFlipWindow();
 }
 
+/// Redraw only the value bar of a volume or brightness zone, the rest of the screen is left as is
+void MenuMode::menu_value_refresh(int menuItem){
+	uint8_t percentage;
+	uint16_t nb_bars;
+	switch(idx_menus[menuItem]){
+	case MENU_TYPE_VOLUME:
+		percentage = volume_percentage;
+		nb_bars = 100/STEP_CHANGE_VOLUME;
+		break;
+	case MENU_TYPE_BRIGHTNESS:
+		percentage = brightness_percentage;
+		nb_bars = 100/STEP_CHANGE_BRIGHTNESS;
+		break;
+	default:
+		return;
+	}
+
+	/// --------- Restore the bar's rows: background, then menu zone ----------
+	SDL_Surface * virtual_hw_screen = SDL::getWindow();
+	SDL_Rect damage;
+	damage.x = (virtual_hw_screen->w - MENU_ZONE_WIDTH)/2;
+	damage.y = y_volume_bar;
+	damage.w = MENU_ZONE_WIDTH;
+	damage.h = height_progress_bar;
+	SDL_Rect dest = damage;
+	if(SDL_BlitSurface(backup_hw_screen, &damage, virtual_hw_screen, &dest)){
+		MENU_ERROR_PRINTF("ERROR Could not Clear virtual_hw_screen: %s\n", SDL_GetError());
+	}
+	dest = damage;
+	if(SDL_BlitSurface(menu_zone_surfaces[menuItem], &damage, virtual_hw_screen, &dest)){
+		MENU_ERROR_PRINTF("ERROR Could not Blit surface on virtual_hw_screen: %s\n", SDL_GetError());
+	}
+
+	/// --------- Draw the new value ----------
+	draw_progress_bar(virtual_hw_screen, x_volume_bar, y_volume_bar,
+			width_progress_bar, height_progress_bar, percentage, nb_bars);
+
+	/// --------- Flip Screen, only the changed rows are presented ----------
+	SDL::renderAndFlipWindow();
+}
+
 
 int MenuMode::launch( )
 {
@@ -716,6 +753,7 @@ int MenuMode::launch( )
 	int scroll=0;
 	int start_scroll=0;
 	uint8_t screen_refresh = 1;
+	uint8_t value_refresh = 0;
 	char shell_cmd[100];
 	uint8_t menu_confirmation = 0;
 	stop_menu_loop = 0;
@@ -745,6 +783,21 @@ int MenuMode::launch( )
 	/// -------- Main loop ---------
 	while (!stop_menu_loop)
 	{
+		/// -------- Apply system values read in the background ---------
+		if(!scroll){
+			unsigned int changed = update_menu_system_values();
+
+			/// Only the bar showing a changed value is redrawn, USB changes may also move to another zone
+			if(changed & (MenuSystemValues::USB_DATA_CONNECTED | MenuSystemValues::USB_SHARING)){
+				prevItem = menuItem;
+				screen_refresh = 1;
+			}
+			else if(((changed & MenuSystemValues::VOLUME) && idx_menus[menuItem] == MENU_TYPE_VOLUME) ||
+					((changed & MenuSystemValues::BRIGHTNESS) && idx_menus[menuItem] == MENU_TYPE_BRIGHTNESS)){
+				value_refresh = 1;
+			}
+		}
+
 		/// -------- Handle Keyboard Events ---------
 		if(!scroll){
 			while (SDL_PollEvent(&event))
@@ -844,10 +897,12 @@ int MenuMode::launch( )
 
 							/// ----- Shell cmd ----
 							sprintf(shell_cmd, "%s %d", SHELL_CMD_VOLUME_SET, volume_percentage);
-							system(shell_cmd);
+							HelperExecutor::getInstance().run(shell_cmd);
+							HelperExecutor::getInstance().invalidate(SHELL_CMD_VOLUME_GET);
+							system_values->changed(MenuSystemValues::VOLUME);
 
-							/// ------ Refresh screen ------
-							screen_refresh = 1;
+							/// ------ Refresh the bar ------
+							value_refresh = 1;
 						}
 						else if(idx_menus[menuItem] == MENU_TYPE_BRIGHTNESS){
 							MENU_DEBUG_PRINTF("Brightness DOWN\n");
@@ -857,10 +912,12 @@ int MenuMode::launch( )
 
 							/// ----- Shell cmd ----
 							sprintf(shell_cmd, "%s %d", SHELL_CMD_BRIGHTNESS_SET, brightness_percentage);
-							system(shell_cmd);
+							HelperExecutor::getInstance().run(shell_cmd);
+							HelperExecutor::getInstance().invalidate(SHELL_CMD_BRIGHTNESS_GET);
+							system_values->changed(MenuSystemValues::BRIGHTNESS);
 
-							/// ------ Refresh screen ------
-							screen_refresh = 1;
+							/// ------ Refresh the bar ------
+							value_refresh = 1;
 						}
 						else if(idx_menus[menuItem] == MENU_TYPE_SAVE){
 							MENU_DEBUG_PRINTF("Save Slot DOWN\n");
@@ -900,10 +957,12 @@ int MenuMode::launch( )
 
 							/// ----- Shell cmd ----
 							sprintf(shell_cmd, "%s %d", SHELL_CMD_VOLUME_SET, volume_percentage);
-							system(shell_cmd);
+							HelperExecutor::getInstance().run(shell_cmd);
+							HelperExecutor::getInstance().invalidate(SHELL_CMD_VOLUME_GET);
+							system_values->changed(MenuSystemValues::VOLUME);
 
-							/// ------ Refresh screen ------
-							screen_refresh = 1;
+							/// ------ Refresh the bar ------
+							value_refresh = 1;
 						}
 						else if(idx_menus[menuItem] == MENU_TYPE_BRIGHTNESS){
 							MENU_DEBUG_PRINTF("Brightness UP\n");
@@ -913,10 +972,12 @@ int MenuMode::launch( )
 
 							/// ----- Shell cmd ----
 							sprintf(shell_cmd, "%s %d", SHELL_CMD_BRIGHTNESS_SET, brightness_percentage);
-							system(shell_cmd);
+							HelperExecutor::getInstance().run(shell_cmd);
+							HelperExecutor::getInstance().invalidate(SHELL_CMD_BRIGHTNESS_GET);
+							system_values->changed(MenuSystemValues::BRIGHTNESS);
 
-							/// ------ Refresh screen ------
-							screen_refresh = 1;
+							/// ------ Refresh the bar ------
+							value_refresh = 1;
 						}
 						else if(idx_menus[menuItem] == MENU_TYPE_SAVE){
 							MENU_DEBUG_PRINTF("Save Slot UP\n");
@@ -989,7 +1050,9 @@ int MenuMode::launch( )
 								/// ----- Shell cmd ----
 								/*system(usb_sharing?SHELL_CMD_SHARE_STOP:SHELL_CMD_SHARE_START);*/
 
-								bool res = Utils::executeRawPath(usb_sharing?SHELL_CMD_SHARE_STOP:SHELL_CMD_SHARE_START);
+								bool res = RetroFE::runHelper(usb_sharing?SHELL_CMD_SHARE_STOP:SHELL_CMD_SHARE_START).success();
+								HelperExecutor::getInstance().invalidate(SHELL_CMD_SHARE_IS_SHARING);
+								system_values->changed(MenuSystemValues::USB_SHARING);
 								if (!res) {
 									MENU_ERROR_PRINTF("Failed to run command %s\n", shell_cmd);
 								}
@@ -1123,9 +1186,13 @@ int MenuMode::launch( )
 		if(screen_refresh){
 			menu_screen_refresh(menuItem, prevItem, scroll, menu_confirmation, 0);
 		}
+		else if(value_refresh){
+			menu_value_refresh(menuItem);
+		}
 
 		/// --------- reset screen refresh ---------
 		screen_refresh = 0;
+		value_refresh = 0;
 	}
 
 	/// ------ Reset prev key repeat params -------
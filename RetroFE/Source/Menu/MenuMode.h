@@ -5,6 +5,8 @@
 #include <SDL/SDL_image.h>
 #include "../Database/Configuration.h"
 
+class MenuSystemValues;
+
 typedef enum{
     MENU_TYPE_VOLUME,
     MENU_TYPE_BRIGHTNESS,
@@ -42,6 +44,7 @@ typedef enum {ASPECT_RATIOS} ENUM_ASPECT_RATIOS_TYPES;
 ////------ Defines to be shared -------
 #define STEP_CHANGE_VOLUME          10
 #define STEP_CHANGE_BRIGHTNESS      10
+#define SYSTEM_VALUES_MAX_AGE       1.0f   // seconds a volume/brightness/usb reading is reused
 
 ////------ Menu commands -------
 #define SHELL_CMD_VOLUME_GET                    "volume get"
@@ -101,12 +104,16 @@ public:
         static int savestate_slot;*/
 
 private:
+    friend class MenuModeTest;
+
     static void draw_progress_bar(SDL_Surface * surface, uint16_t x, uint16_t y, uint16_t width,
             uint16_t height, uint8_t percentage, uint16_t nb_bars);
     static void add_menu_zone(ENUM_MENU_TYPE menu_type);
     static void init_menu_zones();
     static void init_menu_system_values();
+    static unsigned int update_menu_system_values();
     static void menu_screen_refresh(int menuItem, int prevItem, int scroll, uint8_t menu_confirmation, uint8_t menu_action);
+    static void menu_value_refresh(int menuItem);
 
     //static SDL_Surface * hw_screen;
     //static SDL_Surface * virtual_hw_screen; // this one is not rotated
@@ -137,6 +144,7 @@ private:
 
     static int volume_percentage;
     static int brightness_percentage;
+    static MenuSystemValues *system_values;
 
     static const char *aspect_ratio_name[];
     static int aspect_ratio;
@@ -0,0 +1,176 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "MenuSystemValues.h"
+#include "../Utility/HelperExecutor.h"
+#include "../Utility/Log.h"
+#include <cstdlib>
+
+MenuSystemState::MenuSystemState()
+    : volume(50)
+    , brightness(50)
+    , usbDataConnected(false)
+    , usbSharing(false)
+{
+}
+
+
+MenuSystemValues::Shared::Shared()
+    : received(0)
+{
+    for(unsigned int i = 0; i < FIELD_COUNT; i++)
+    {
+        generation[i] = 0;
+    }
+}
+
+
+MenuSystemValues::MenuSystemValues(HelperExecutor &helpers, float maxAge,
+                                   std::string volumeCommand, std::string brightnessCommand,
+                                   std::string usbDataConnectedCommand, std::string usbSharingCommand)
+    : helpers_(helpers)
+    , maxAge_(maxAge)
+    , shared_(std::make_shared<Shared>())
+{
+    commands_[0] = volumeCommand;
+    commands_[1] = brightnessCommand;
+    commands_[2] = usbDataConnectedCommand;
+    commands_[3] = usbSharingCommand;
+}
+
+
+// Starts reading every value again, without waiting for the helpers
+void MenuSystemValues::refresh()
+{
+    for(unsigned int i = 0; i < FIELD_COUNT; i++)
+    {
+        query(1 << i, commands_[i]);
+    }
+}
+
+
+// Copies the values read since the last call into state, and returns the
+// fields whose value differs from what state held
+unsigned int MenuSystemValues::update(MenuSystemState &state)
+{
+    std::unique_lock<std::mutex> lock(shared_->mutex);
+    unsigned int received = shared_->received;
+    const MenuSystemState &latest = shared_->latest;
+    unsigned int changedFields = 0;
+
+    shared_->received = 0;
+
+    if((received & VOLUME) && state.volume != latest.volume)
+    {
+        state.volume = latest.volume;
+        changedFields |= VOLUME;
+    }
+    if((received & BRIGHTNESS) && state.brightness != latest.brightness)
+    {
+        state.brightness = latest.brightness;
+        changedFields |= BRIGHTNESS;
+    }
+    if((received & USB_DATA_CONNECTED) && state.usbDataConnected != latest.usbDataConnected)
+    {
+        state.usbDataConnected = latest.usbDataConnected;
+        changedFields |= USB_DATA_CONNECTED;
+    }
+    if((received & USB_SHARING) && state.usbSharing != latest.usbSharing)
+    {
+        state.usbSharing = latest.usbSharing;
+        changedFields |= USB_SHARING;
+    }
+
+    return changedFields;
+}
+
+
+// The menu just set these values itself: readings still in flight are outdated
+void MenuSystemValues::changed(unsigned int fields)
+{
+    std::unique_lock<std::mutex> lock(shared_->mutex);
+
+    for(unsigned int i = 0; i < FIELD_COUNT; i++)
+    {
+        if(fields & (1 << i))
+        {
+            shared_->generation[i]++;
+        }
+    }
+    shared_->received &= ~fields;
+}
+
+
+bool MenuSystemValues::parsePercentage(const HelperResult &result, const std::string &command, int &percentage)
+{
+    const char *res = result.output.c_str();
+
+    if(!result.started)
+    {
+        Logger::write(Logger::ZONE_ERROR, "MenuSystemValues", "Failed to run command " + command);
+        return false;
+    }
+
+    // Check if the value is a number (at least the first char)
+    if(res[0] < '0' || res[0] > '9')
+    {
+        Logger::write(Logger::ZONE_ERROR, "MenuSystemValues", "Wrong return value: \"" + result.output + "\" for cmd: " + command);
+        return false;
+    }
+
+    percentage = atoi(res);
+    return true;
+}
+
+
+void MenuSystemValues::query(unsigned int field, const std::string &command)
+{
+    std::shared_ptr<Shared> shared = shared_;
+    unsigned int index = 0;
+    unsigned int generation;
+
+    while(!(field & (1 << index))) index++;
+
+    {
+        std::unique_lock<std::mutex> lock(shared->mutex);
+        generation = shared->generation[index];
+    }
+
+    // Runs on the helper thread, or right away when the result is cached
+    helpers_.query(command, maxAge_, [shared, field, index, generation, command](const HelperResult &result)
+    {
+        std::unique_lock<std::mutex> lock(shared->mutex);
+
+        if(shared->generation[index] != generation) return;
+
+        switch(field)
+        {
+        case VOLUME:
+            // An unreadable value keeps the last known one
+            if(!parsePercentage(result, command, shared->latest.volume)) return;
+            break;
+        case BRIGHTNESS:
+            if(!parsePercentage(result, command, shared->latest.brightness)) return;
+            break;
+        case USB_DATA_CONNECTED:
+            shared->latest.usbDataConnected = result.success();
+            break;
+        case USB_SHARING:
+            shared->latest.usbSharing = result.success();
+            break;
+        }
+        shared->received |= field;
+    });
+}
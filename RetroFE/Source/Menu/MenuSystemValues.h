@@ -0,0 +1,76 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+class HelperExecutor;
+struct HelperResult;
+
+// System values shown by the in-game menu
+struct MenuSystemState
+{
+    MenuSystemState();
+
+    int  volume;             // percentage
+    int  brightness;         // percentage
+    bool usbDataConnected;
+    bool usbSharing;
+};
+
+// Keeps the last known system values so the menu can be drawn right away, and
+// refreshes them in the background through the shell helpers. The main loop
+// collects the new values with update(), which tells what changed.
+class MenuSystemValues
+{
+public:
+    enum Field
+    {
+        VOLUME             = 1 << 0,
+        BRIGHTNESS         = 1 << 1,
+        USB_DATA_CONNECTED = 1 << 2,
+        USB_SHARING        = 1 << 3,
+        FIELD_COUNT        = 4
+    };
+
+    MenuSystemValues(HelperExecutor &helpers, float maxAge,
+                     std::string volumeCommand, std::string brightnessCommand,
+                     std::string usbDataConnectedCommand, std::string usbSharingCommand);
+    void refresh();
+    unsigned int update(MenuSystemState &state);
+    void changed(unsigned int fields);
+
+    static bool parsePercentage(const HelperResult &result, const std::string &command, int &percentage);
+
+private:
+    struct Shared
+    {
+        Shared();
+        std::mutex      mutex;
+        MenuSystemState latest;
+        unsigned int    received;                 // fields read since the last update()
+        unsigned int    generation[FIELD_COUNT];  // bumped when the menu sets a value
+    };
+
+    void query(unsigned int field, const std::string &command);
+
+    HelperExecutor          &helpers_;
+    float                    maxAge_;
+    std::string              commands_[FIELD_COUNT];
+    std::shared_ptr<Shared>  shared_;
+};
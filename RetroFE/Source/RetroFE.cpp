@@ -25,7 +25,11 @@
 #include "Menu/MenuMode.h"
 #include "Utility/Log.h"
 #include "Utility/Utils.h"
+#include "Utility/HelperExecutor.h"
+#include "Utility/MemInfo.h"
+#include "Sound/AmpController.h"
 #include "Collection/MenuParser.h"
+#include "Collection/FavoritesWriter.h"
 #include "SDL.h"
 #include <SDL/SDL_ttf.h>
 #include "Control/UserInput.h"
@@ -35,10 +39,13 @@
 #include "Graphics/Component/Video.h"
 #include "Video/VideoFactory.h"
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <dirent.h>
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <vector>
 #include <time.h>
@@ -49,6 +56,8 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <cstring>
 #endif
 
@@ -62,7 +71,8 @@
 #define GET_RUN_TIME_MS    (SDL_GetTicks())
 
 //#define PERIOD_FORCE_REFRESH    1000 //ms
-#define FPS 60 // TODO: set in conf file
+#define FPS 60 // default, see "fps" in settings.conf
+#define FRAME_HISTOGRAM_PERIOD  30 // s
 
 //#define DEBUG_FPS
 #ifdef DEBUG_FPS
@@ -71,6 +81,12 @@
 #define DEBUG_FPS_PRINTF(...)
 #endif //MENU_DEBUG
 
+// Set by the SIGUSR1 handler, the main loop does the poweroff
+volatile sig_atomic_t RetroFE::poweroffRequested_ = 0;
+
+// Written to by wakeup, so that blocking waits notice a poweroff request
+int RetroFE::wakeupPipe_[2] = { -1, -1 };
+
 
 RetroFE::RetroFE( Configuration &c )
     : initialized(false)
@@ -90,6 +106,9 @@ RetroFE::RetroFE( Configuration &c )
 {
     menuMode_ = false;
     mustRender_ = true;
+    idleWait_ = true;
+    frameHistogramTime_ = 0;
+    graphicsResident_ = false;
 }
 
 
@@ -104,17 +123,35 @@ void RetroFE::render( )
 {
 
     SDL_LockMutex( SDL::getMutex( ) );
+    draw( );
+
+    //SDL_Flip(SDL::getWindow( ));
+    SDL::renderAndFlipWindow();
+
+    SDL_UnlockMutex( SDL::getMutex( ) );
+
+}
+
+
+// Draw the current page into the window without showing it. The window
+// surface holds an older frame between flips unless it is drawn again.
+void RetroFE::draw( )
+{
     //SDL_SetRenderDrawColor( SDL::getRenderer( ), 0x0, 0x0, 0x00, 0xFF );
     //SDL_RenderClear( SDL::getRenderer( ) );
-    SDL_FillRect(SDL::getWindow( ), NULL, SDL_MapRGB(SDL::getWindow( )->format, 0, 0, 0));
 
 #ifdef DEBUG_FPS
     uint32_t draw_ticks = static_cast<unsigned int>GET_RUN_TIME_MS;
 #endif //DEBUG_FPS
+    // The page clears the window, unless its layer cache covers it
     if ( currentPage_ )
     {
         currentPage_->draw( );
     }
+    else
+    {
+        SDL_FillRect(SDL::getWindow( ), NULL, SDL_MapRGB(SDL::getWindow( )->format, 0, 0, 0));
+    }
 #ifdef DEBUG_FPS
     int draw_time = static_cast<int>(GET_RUN_TIME_MS)-draw_ticks;
     //printf("draw time: %dms\n", draw_time);
@@ -133,12 +170,6 @@ void RetroFE::render( )
         avg_draw_time_nb_vals=0;
     }
 #endif //DEBUG_FPS
-
-    //SDL_Flip(SDL::getWindow( ));
-    SDL::renderAndFlipWindow();
-
-    SDL_UnlockMutex( SDL::getMutex( ) );
-
 }
 
 
@@ -184,6 +215,10 @@ int RetroFE::initialize( void *context )
 
     /* Init Signals */
     Logger::write( Logger::ZONE_INFO, "RetroFE", "Initializing signal USR1..." );
+    if ( pipe2( wakeupPipe_, O_NONBLOCK | O_CLOEXEC ) != 0 )
+    {
+        Logger::write( Logger::ZONE_ERROR, "RetroFE", "Could not create the wakeup pipe" );
+    }
     signal(SIGUSR1, instance->handle_sigusr1); 
 
     instance->initialized = true;
@@ -199,6 +234,18 @@ void RetroFE::launchEnter( )
     // Disable window focus
     //SDL_SetWindowGrab(SDL::getWindow( ), SDL_FALSE);
 
+    // Write the favorites before the game gets the device
+    FavoritesWriter::getInstance( ).flush( );
+
+    // Keep the last frame to show it as soon as the launch returns
+    SDL_LockMutex( SDL::getMutex( ) );
+    draw( );
+    SDL_UnlockMutex( SDL::getMutex( ) );
+    SDL::captureSnapshot( );
+
+    // Keep the textures loaded during the launch if there is RAM to spare
+    graphicsResident_ = keepGraphicsResident( );
+
     // Free the textures, and optionally take down SDL
     freeGraphicsMemory( );
 
@@ -232,6 +279,8 @@ void RetroFE::launchExit( )
     // Restore time settings
     currentTime_ = static_cast<float>( GET_RUN_TIME_MS ) / 1000;
     lastLaunchReturnTime_ = currentTime_;
+    frameScheduler_.resync( );
+    frameScheduler_.tick( );
 
 }
 
@@ -243,7 +292,14 @@ void RetroFE::freeGraphicsMemory( )
     // Free textures
     if ( currentPage_ )
     {
-        currentPage_->freeGraphicsMemory( );
+        if ( graphicsResident_ )
+        {
+            currentPage_->suspendGraphicsMemory( );
+        }
+        else
+        {
+            currentPage_->freeGraphicsMemory( );
+        }
     }
 
     // Close down SDL
@@ -271,6 +327,13 @@ void RetroFE::allocateGraphicsMemory( )
     if ( unloadSDL )
     {
         SDL::initialize( config_ );
+    }
+
+    // Show the frame from before the launch while the page is loaded again
+    SDL::showSnapshot( );
+
+    if ( unloadSDL )
+    {
         currentPage_->initializeFonts( );
 
         // Init MenuMode
@@ -280,9 +343,42 @@ void RetroFE::allocateGraphicsMemory( )
     // Allocate textures
     if ( currentPage_ )
     {
-        currentPage_->allocateGraphicsMemory( );
+        if ( graphicsResident_ )
+        {
+            currentPage_->resumeGraphicsMemory( );
+        }
+        else
+        {
+            currentPage_->allocateGraphicsMemory( );
+        }
+    }
+    graphicsResident_ = false;
+
+}
+
+
+// Check whether the page textures can stay loaded while a game runs,
+// see "keepGraphicsMinFreeRam" in settings.conf
+bool RetroFE::keepGraphicsResident( )
+{
+
+    int minFreeRam = -1;
+    config_.getProperty( "keepGraphicsMinFreeRam", minFreeRam );
+    if ( minFreeRam < 0 )
+    {
+        return false;
     }
 
+    MemInfo memInfo;
+    bool keep = memInfo.hasAvailable( static_cast<unsigned long>( minFreeRam ) );
+
+    std::stringstream ss;
+    ss << ( keep ? "Keeping" : "Freeing" ) << " textures during launch, "
+       << memInfo.getAvailable( ) / 1024 << " MB available";
+    Logger::write( Logger::ZONE_INFO, "RetroFE", ss.str( ) );
+
+    return keep;
+
 }
 
 
@@ -316,6 +412,15 @@ bool RetroFE::deInitialize( )
         db_ = NULL;
     }
 
+    // Write the favorites saved by the deleted pages
+    FavoritesWriter::getInstance( ).flush( );
+
+    // Every texture is freed with its page and fonts, what is left leaked
+    fontcache_.deInitialize( );
+#ifndef NDEBUG
+    SDL::logSurfaces( );
+#endif
+
     initialized = false;
 
     Logger::write( Logger::ZONE_INFO, "RetroFE", "Exiting" );
@@ -383,6 +488,36 @@ void RetroFE::run( )
 
     config_.getProperty( "attractModeTime", attractModeTime );
     config_.getProperty( "firstCollection", firstCollection );
+    config_.getProperty( "idleWait", idleWait_ );
+
+    int fps          = FPS;
+    int maxFrameSkip = 3;
+    config_.getProperty( "fps", fps );
+    config_.getProperty( "maxFrameSkip", maxFrameSkip );
+    frameScheduler_.setTargetFps( fps );
+    frameScheduler_.setMaxFrameSkip( maxFrameSkip > 0 ? static_cast<unsigned int>( maxFrameSkip ) : 0 );
+
+    int audioAmpIdleTime = 500;
+    config_.getProperty( "audioAmpIdleTime", audioAmpIdleTime );
+    AmpController::getInstance( ).setIdleTime( static_cast<float>( audioAmpIdleTime ) / 1000 );
+
+    std::string favoritesPath;
+    bool favoritesRemount = true;
+    int  favoritesSaveDelay = 3000;
+    if ( config_.getPropertyAbsolutePath( "favoritesPath", favoritesPath ) )
+    {
+        favoritesRemount = false;
+    }
+    config_.getProperty( "favoritesRemount", favoritesRemount );
+    config_.getProperty( "favoritesSaveDelay", favoritesSaveDelay );
+    FavoritesWriter::getInstance( ).setDirectory( favoritesPath, favoritesRemount );
+    FavoritesWriter::getInstance( ).setDelay( static_cast<float>( favoritesSaveDelay ) / 1000 );
+
+    std::string fontCachePath;
+    if ( config_.getPropertyAbsolutePath( "fontCachePath", fontCachePath ) )
+    {
+        fontcache_.setCacheDirectory( fontCachePath );
+    }
 
     attract_.idleTime = static_cast<float>(attractModeTime);
 
@@ -397,6 +532,10 @@ void RetroFE::run( )
     Launcher l( config_ );
     Menu     m( config_ );
     preloadTime = static_cast<float>( GET_RUN_TIME_MS ) / 1000;
+    wakeups_.reset( preloadTime );
+    idlePolls_.reset( preloadTime );
+    frameHistogramTime_ = preloadTime;
+    frameScheduler_.resync( );
 
     while ( running )
     {
@@ -404,6 +543,9 @@ void RetroFE::run( )
         float lastTime = 0;
         float deltaTime = 0;
 
+        // Poweroff requested by SIGUSR1
+        checkPoweroff( );
+
         // Exit splash mode when an active key is pressed
         SDL_Event e;
         if ( splashMode )
@@ -820,16 +962,17 @@ void RetroFE::run( )
                 printf("BIBI !!!!\n");
 
                 /* Restart audio amp */
-                system(SHELL_CMD_AUDIO_AMP_ON);
+                AmpController::getInstance().reset();
+                runHelper(SHELL_CMD_AUDIO_AMP_ON);
 
                 /* Execute game */
-                if(system(BIBI_CMD) < 0)
+                if(runProcess(BIBI_CMD) < 0)
                 {
                     Logger::write(Logger::ZONE_ERROR, "Launcher", "Failed to launch bibi with cmd: \"" + std::string(BIBI_CMD) +"\"");
                 }
 
                 /* Stop audio amp */
-                system(SHELL_CMD_AUDIO_AMP_OFF);
+                HelperExecutor::getInstance().run(SHELL_CMD_AUDIO_AMP_OFF);
 
                 /* Exit animation */
                 launchExit( );
@@ -965,6 +1108,10 @@ void RetroFE::run( )
             /// Launch menu
             menuMode_ = true;
             printf("Menu launched here\n");
+            /// The menu keeps the window contents as its background
+            SDL_LockMutex( SDL::getMutex( ) );
+            draw( );
+            SDL_UnlockMutex( SDL::getMutex( ) );
             res = MenuMode::launch();
             menuMode_ = false;
             forceRender(true);
@@ -1030,6 +1177,26 @@ void RetroFE::run( )
         // Handle screen updates and attract mode
         if ( running )
         {
+            // ------- Check if previous update of page needed to be rendered -------
+            if(!currentPage_->isIdle( ) || currentPage_->mustRender( ) || splashMode){
+                //printf("Not idle\n");
+                forceRender(true);
+            }
+
+            // Nothing to animate: sleep until the next input event or timer deadline.
+            // This frame's update absorbs the wait, so that tweens started by the
+            // waking input event begin with a regular delta time.
+            float idleTime = idleWaitTime( state, splashMode );
+            if ( idleTime != 0 )
+            {
+                idleWait( idleTime );
+                frameScheduler_.resync( );
+            }
+            else
+            {
+                frameScheduler_.waitFrame( );
+            }
+
             // Handle FPS
             lastTime = currentTime_;
             currentTime_ = static_cast<float>( GET_RUN_TIME_MS ) / 1000;
@@ -1039,18 +1206,21 @@ void RetroFE::run( )
                 currentTime_ = lastTime;
             }
 
-            deltaTime = currentTime_ - lastTime;
+            deltaTime = frameScheduler_.tick( );
 
-            double sleepTime = 1000.0/FPS - deltaTime*1000;
-            if ( sleepTime > 0 )
+            if ( wakeups_.wakeup( currentTime_ ) )
             {
-                SDL_Delay( static_cast<unsigned int>( sleepTime ) );
+                DEBUG_FPS_PRINTF("Main loop wakeups: %.1f/s, idle input polls: %.1f/s\n", wakeups_.getRate( ), idlePolls_.getRate( ));
             }
 
-            // ------- Check if previous update of page needed to be rendered -------
-            if(!currentPage_->isIdle( ) || currentPage_->mustRender( ) || splashMode){
-                //printf("Not idle\n");
-                forceRender(true);
+            if ( currentTime_ - frameHistogramTime_ > FRAME_HISTOGRAM_PERIOD )
+            {
+                if ( frameScheduler_.getHistogramFrames( ) > 0 )
+                {
+                    Logger::write( Logger::ZONE_DEBUG, "RetroFE", "Frame times: " + frameScheduler_.getHistogram( ) );
+                }
+                frameScheduler_.clearHistogram( );
+                frameHistogramTime_ = currentTime_;
             }
 
             // Force refresh variables
@@ -1067,8 +1237,8 @@ void RetroFE::run( )
                 currentPage_->update( deltaTime );
             }
 
-            // ------- Real render here -------
-            if(mustRender_){
+            // ------- Real render here, unless late and skipping frames -------
+            if(mustRender_ && frameScheduler_.mustDraw( )){
                 //printf("render\n");
                 mustRender_ = false;
                 render( );
@@ -1109,6 +1279,78 @@ void RetroFE::forceRender( bool render )
 }
 
 
+// Time in seconds the main loop can sleep before the next update: 0 when a
+// regular frame is needed, negative when only user input can change anything
+float RetroFE::idleWaitTime( RETROFE_STATE state, bool splashMode )
+{
+    if ( !idleWait_ || splashMode || state != RETROFE_IDLE || mustRender_ || !currentPage_ )
+    {
+        return 0;
+    }
+
+    // Pending key repeats and the post-launch input guard are polled every frame
+    if ( lastLaunchReturnTime_ != 0 || input_.anyKeyPressed( ) )
+    {
+        return 0;
+    }
+
+    if ( !currentPage_->isIdle( ) || currentPage_->isPlaying( ) )
+    {
+        return 0;
+    }
+
+    float nextTime = Component::earliestUpdateTime( currentPage_->getNextUpdateTime( ), attract_.getNextUpdateTime( ) );
+    if ( nextTime >= 0 && nextTime <= frameScheduler_.getPeriod( ) )
+    {
+        return 0;
+    }
+
+    return nextTime;
+}
+
+
+// Block until an input event arrives, a poweroff is requested or waitTime
+// seconds have elapsed, forever if negative. The input event is only peeked
+// at and stays in place for processUserInput.
+//
+// SDL 1.2 cannot block on its input devices: SDL_WaitEvent itself pumps the
+// events and sleeps 10 ms at a time. The input is polled every
+// IDLE_INPUT_POLL_MS instead, and the sleep in between is on the wakeup
+// pipe, so that the deadline and a poweroff request still end it on time.
+void RetroFE::idleWait( float waitTime )
+{
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now( ) +
+        std::chrono::microseconds( static_cast<long long>( waitTime * 1000000 ) );
+
+    SDL_Event e;
+    while ( true )
+    {
+        SDL_PumpEvents( );
+        if ( SDL_PeepEvents( &e, 1, SDL_PEEKEVENT, SDL_ALLEVENTS ) != 0 || poweroffRequested_ )
+        {
+            break;
+        }
+
+        int timeout = IDLE_INPUT_POLL_MS;
+        if ( waitTime > 0 )
+        {
+            std::chrono::steady_clock::duration left = deadline - std::chrono::steady_clock::now( );
+            if ( left <= std::chrono::steady_clock::duration::zero( ) )
+            {
+                break;
+            }
+
+            // Rounded up, not to wake up just short of the deadline
+            int leftMs = static_cast<int>( ( std::chrono::duration_cast<std::chrono::microseconds>( left ).count( ) + 999 ) / 1000 );
+            timeout = std::min( timeout, leftMs );
+        }
+
+        waitWakeup( timeout );
+        idlePolls_.wakeup( static_cast<float>( GET_RUN_TIME_MS ) / 1000 );
+    }
+}
+
+
 // Process the user input
 RetroFE::RETROFE_STATE RetroFE::processUserInput( Page *page )
 {
@@ -1585,18 +1827,15 @@ CollectionInfo *RetroFE::getMenuCollection( std::string collectionName )
 
 
 /* Handler for SIGUSR1, caused by closing the console */
-void RetroFE::handle_sigusr1(int sig)
+void RetroFE::handle_sigusr1(int /*sig*/)
 {
-    printf("Caught signal USR1 %d\n", sig);
-    std::stringstream ss;
-    ss << "Caught signal USR1: " << sig;
-    Logger::write( Logger::ZONE_ERROR, "RetroFE", ss.str() );
+    /* Locks are not safe in a signal handler, the main loop or the launch
+       waiting for its process powers off */
+    poweroffRequested_ = 1;
+    wakeup();
 
     /* Exit menu if it was launched */
     MenuMode::stop();
-
-    /** Poweroff */
-    quick_poweroff();
 }
 
 
@@ -1616,6 +1855,9 @@ void RetroFE::quick_poweroff()
         exit(0);
     }
 
+    /* Write the favorites that are still pending */
+    FavoritesWriter::getInstance( ).flush( );
+
     /* Perform Instant Play save and shutdown */
     execlp(SHELL_CMD_POWERDOWN, SHELL_CMD_POWERDOWN);
 
@@ -1625,3 +1867,84 @@ void RetroFE::quick_poweroff()
     /* Exit Emulator */
     exit(0);
 }
+
+
+/* Power off if SIGUSR1 asked to */
+void RetroFE::checkPoweroff()
+{
+    if ( poweroffRequested_ )
+    {
+        Logger::write( Logger::ZONE_ERROR, "RetroFE", "Caught signal USR1" );
+        quick_poweroff( );
+    }
+}
+
+
+/* Wake up waitWakeup, safe from a signal handler or any thread */
+void RetroFE::wakeup()
+{
+    int savedErrno = errno;
+    char byte = 0;
+    if ( write( wakeupPipe_[1], &byte, 1 ) < 0 )
+    {
+        /* The pipe is full, a wakeup is pending anyway */
+    }
+    errno = savedErrno;
+}
+
+
+/* Block until wakeup is called or timeout ms have passed, forever if
+   negative. Without the pipe, check back every 100 ms */
+void RetroFE::waitWakeup( int timeout )
+{
+    if ( wakeupPipe_[0] < 0 && ( timeout < 0 || timeout > 100 ) )
+    {
+        timeout = 100;
+    }
+
+    struct pollfd fd = { wakeupPipe_[0], POLLIN, 0 };
+    if ( poll( &fd, 1, timeout ) > 0 )
+    {
+        char buffer[64];
+        while ( read( wakeupPipe_[0], buffer, sizeof( buffer ) ) > 0 );
+    }
+}
+
+
+/* Run a shell command like system(), but power off right away if SIGUSR1
+   arrives while it runs: the wait is on the wakeup pipe, not on the process */
+int RetroFE::runProcess( std::string command )
+{
+    std::atomic<bool> done( false );
+    int status = -1;
+    std::thread waiter( [&command, &done, &status]( )
+    {
+        status = system( command.c_str( ) );
+        done = true;
+        wakeup( );
+    } );
+
+    while ( !done )
+    {
+        checkPoweroff( );
+        waitWakeup( );
+    }
+    waiter.join( );
+
+    return status;
+}
+
+
+/* Run a helper and wait for it, with the same poweroff as runProcess */
+HelperResult RetroFE::runHelper( std::string command )
+{
+    HelperExecutor::Future future = HelperExecutor::getInstance( ).run( command, []( const HelperResult & ) { wakeup( ); } );
+
+    while ( future.wait_for( std::chrono::seconds( 0 ) ) != std::future_status::ready )
+    {
+        checkPoweroff( );
+        waitWakeup( );
+    }
+
+    return future.get( );
+}
@@ -22,10 +22,14 @@
 #include "Database/MetadataDatabase.h"
 #include "Execute/AttractMode.h"
 #include "Graphics/FontCache.h"
+#include "Utility/HelperExecutor.h"
+#include "Utility/WakeupCounter.h"
+#include "Utility/FrameScheduler.h"
 #include "Video/IVideo.h"
 #include "Video/VideoFactory.h"
 #include <SDL/SDL.h>
 #include <SDL/SDL_ttf.h>
+#include <signal.h>
 #include <list>
 #include <stack>
 #include <map>
@@ -73,6 +77,9 @@
 
 #define BIBI_CMD    "cd /usr/games/bibi/; ./bibi; cd -"
 
+/* Input polling period while the page is idle, below a frame at 30 fps */
+#define IDLE_INPUT_POLL_MS  30
+
 class CollectionInfo;
 class Configuration;
 class Page;
@@ -91,7 +98,13 @@ public:
     void     launchEnter( );
     void     launchExit( );
 
+    // Blocking waits of a launch, cut short by a SIGUSR1 poweroff
+    static int          runProcess( std::string command );
+    static HelperResult runHelper( std::string command );
+
 private:
+    friend class RetroFETest;
+
     volatile bool   initialized;
     volatile bool   initializeError;
     volatile bool   initMetaDb;
@@ -99,14 +112,22 @@ private:
     static int      initialize( void *context );
     static void     handle_sigusr1(int sig);
     static void     quick_poweroff( );
+    static void     checkPoweroff( );
+    static void     wakeup( );
+    static void     waitWakeup( int timeout = -1 );
+    static volatile sig_atomic_t poweroffRequested_;
+    static int      wakeupPipe_[2];
 
     #undef X
     #define X(a, b) a,
     enum RETROFE_STATE {RETROFE_STATES};
 
     void            render( );
+    void            draw( );
     bool            back( bool &exit );
     void            forceRender( bool render );
+    float           idleWaitTime( RETROFE_STATE state, bool splashMode );
+    void            idleWait( float waitTime );
     void            quit( );
     Page           *loadPage( );
     Page           *loadSplashPage( );
@@ -115,6 +136,7 @@ private:
     CollectionInfo *getCollection( std::string collectionName );
     CollectionInfo *getMenuCollection( std::string collectionName );
     void            printState(RETROFE_STATE state);
+    bool            keepGraphicsResident( );
 
     Configuration     &config_;
     DB                *db_;
@@ -132,6 +154,12 @@ private:
     AttractMode        attract_;
     bool               menuMode_;
     bool               mustRender_;
+    bool               idleWait_;
+    WakeupCounter      wakeups_;
+    WakeupCounter      idlePolls_;
+    FrameScheduler     frameScheduler_;
+    float              frameHistogramTime_;
+    bool               graphicsResident_;
 
     std::map<std::string, unsigned int> lastMenuOffsets_;
     std::map<std::string, std::string>  lastMenuPlaylists_;
@@ -18,7 +18,18 @@
 #include "SDL.h"
 #include "Database/Configuration.h"
 #include "Utility/Log.h"
+#include "Sound/SoundBank.h"
+#include "Graphics/AlphaBlit.h"
+#include "Graphics/Dither.h"
+#include "Graphics/Downscale.h"
+#include "Graphics/PixelBlend.h"
+#include "Graphics/PixelRotate.h"
+#include "Graphics/SpriteAtlas.h"
+#include "Graphics/SurfaceTracker.h"
+#include <SDL/SDL_image.h>
 #include <SDL/SDL_mixer.h>
+#include <algorithm>
+#include <sstream>
 //#include <SDL/SDL_rotozoom.h>
 //#include <SDL/SDL_gfxBlitFunc.h>
 
@@ -26,22 +37,14 @@
 #define MIN(a,b) (((a)<(b))?(a):(b))
 #define MAX(a,b) (((a)>(b))?(a):(b))
 
-/* Get 16bit closest color */
-#define CLOSEST_RB(c) (MIN(c+4,0xff) >> 3 << 3)
-#define CLOSEST_G(c) (MIN(c+2,0xff) >> 2 << 2)
-
-/* RGB8888 */
-#define RGB32BIT(a, r, g, b) ((a<<24) | (r<<16) | (g<<8) | b)
-#define GET_A_32BIT(c)  ((c & 0xff000000) >> 24)
-#define GET_R_32BIT(c)  ((c & 0x00ff0000) >> 16)
-#define GET_G_32BIT(c)  ((c & 0x0000ff00) >> 8)
-#define GET_B_32BIT(c)  (c & 0x000000ff)
 
 
 //SDL_Window   *SDL::window_        = NULL;
 //SDL_Renderer *SDL::renderer_      = NULL;
 SDL_Surface  *SDL::window_		  		= NULL;
 SDL_Surface  *SDL::window_virtual_		= NULL;
+SDL_Surface  *SDL::window_front_		= NULL;
+SDL_Surface  *SDL::window_rotated_		= NULL;
 SDL_Surface  *SDL::texture_copy_alpha_	= NULL;
 SDL_mutex    *SDL::mutex_         = NULL;
 int           SDL::displayWidth_  = 0;
@@ -50,6 +53,20 @@ int           SDL::windowWidth_   = 0;
 int           SDL::windowHeight_  = 0;
 bool          SDL::fullscreen_    = false;
 bool          SDL::showFrame_    		= true;
+#ifdef RGB565_PIPELINE
+int           SDL::bitsPerPixel_  = 16;
+#else
+int           SDL::bitsPerPixel_  = 32;
+#endif
+SDL::DitherMode SDL::ditherMode_ = SDL::DITHER_ORDERED;
+SDL::PresentMode SDL::presentMode_ = SDL::PRESENT_COPY;
+int           SDL::screenRotation_ = 0;
+std::vector<Uint16> SDL::rowRgb_;
+std::vector<Uint8>  SDL::rowAlpha_;
+FrameSnapshot SDL::snapshot_;
+Reflection    SDL::reflection_;
+std::vector<RowDamage::Span> SDL::damage_;
+std::vector<SDL_Rect>        SDL::damageRects_;
 
 
 // Initialize SDL
@@ -87,6 +104,17 @@ bool SDL::initialize( Configuration &config )
         }
     }
 
+    // The layout is drawn upright and turned when presented, for panels
+    // mounted in another orientation
+    screenRotation_ = 0;
+    if ( retVal && config.getProperty( "screenRotation", screenRotation_ ) &&
+         screenRotation_ != 0 && screenRotation_ != 90 && screenRotation_ != 180 && screenRotation_ != 270 )
+    {
+        Logger::write( Logger::ZONE_WARNING, "Configuration", "Invalid property value for \"screenRotation\", using 0" );
+        screenRotation_ = 0;
+    }
+    bool quarterTurn = screenRotation_ == 90 || screenRotation_ == 270;
+
     // check for a few other necessary Configurations
     if ( retVal )
     {
@@ -98,8 +126,8 @@ bool SDL::initialize( Configuration &config )
 	    retVal = false;
 	}
 	else{
-	    displayWidth_ = videoInfo->current_w;
-	    displayHeight_ = videoInfo->current_h;
+	    displayWidth_ = quarterTurn ? videoInfo->current_h : videoInfo->current_w;
+	    displayHeight_ = quarterTurn ? videoInfo->current_w : videoInfo->current_h;
         }
 
         if ( !config.getProperty( "horizontal", hString ) )
@@ -156,15 +184,80 @@ bool SDL::initialize( Configuration &config )
         windowFlags |= SDL_NOFRAME;
     }
 
+    std::string pixelFormat;
+    if ( retVal && config.getProperty( "pixelFormat", pixelFormat ) )
+    {
+        if ( pixelFormat == "rgb565" )
+        {
+            bitsPerPixel_ = 16;
+        }
+        else if ( pixelFormat == "rgb888" )
+        {
+            bitsPerPixel_ = 32;
+        }
+        else
+        {
+            Logger::write( Logger::ZONE_WARNING, "Configuration", "Invalid property value for \"pixelFormat\", using the default" );
+        }
+    }
+
+    std::string ditherMode;
+    if ( retVal && config.getProperty( "ditherMode", ditherMode ) )
+    {
+        if ( ditherMode == "ordered" )
+        {
+            ditherMode_ = DITHER_ORDERED;
+        }
+        else if ( ditherMode == "diffusion" )
+        {
+            ditherMode_ = DITHER_DIFFUSION;
+        }
+        else
+        {
+            Logger::write( Logger::ZONE_WARNING, "Configuration", "Invalid property value for \"ditherMode\", using ordered" );
+        }
+    }
+
+    std::string presentMode;
+    bool        presentAuto = true;
+    if ( retVal && config.getProperty( "presentMode", presentMode ) && presentMode != "auto" )
+    {
+        presentAuto = false;
+        if ( presentMode == "direct" )
+        {
+            presentMode_ = PRESENT_DIRECT;
+        }
+        else if ( presentMode == "swap" )
+        {
+            presentMode_ = PRESENT_SWAP;
+        }
+        else if ( presentMode == "copy" )
+        {
+            presentMode_ = PRESENT_COPY;
+        }
+        else
+        {
+            presentAuto = true;
+            Logger::write( Logger::ZONE_WARNING, "Configuration", "Invalid property value for \"presentMode\", using auto" );
+        }
+    }
+
     if ( retVal )
     {
         std::string fullscreenStr = fullscreen_ ? "yes" : "no";
         std::stringstream ss;
-        ss << "Creating "<< windowWidth_ << "x" << windowHeight_ << " window (fullscreen: " << fullscreenStr << ")";
+        ss << "Creating "<< windowWidth_ << "x" << windowHeight_ << "x" << bitsPerPixel_ << " window (fullscreen: " << fullscreenStr << ")";
 
         Logger::write( Logger::ZONE_INFO, "SDL", ss.str( ));
 
-        window_ = SDL_SetVideoMode(windowWidth_, windowHeight_, 32, windowFlags);
+        if ( quarterTurn )
+        {
+            window_ = SDL_SetVideoMode(windowHeight_, windowWidth_, bitsPerPixel_, windowFlags);
+        }
+        else
+        {
+            window_ = SDL_SetVideoMode(windowWidth_, windowHeight_, bitsPerPixel_, windowFlags);
+        }
         if ( window_ == NULL )
         {
             std::string error = SDL_GetError( );
@@ -187,7 +280,14 @@ bool SDL::initialize( Configuration &config )
         bmask = 0x00ff0000;
         amask = 0xff000000;
 #endif*/
-        window_virtual_ = SDL_CreateRGBSurface(0, windowWidth_, windowHeight_, 32, 0,0,0,0);
+        if ( bitsPerPixel_ == 16 )
+        {
+            window_virtual_ = SDL_CreateRGBSurface(0, windowWidth_, windowHeight_, 16, 0xf800, 0x07e0, 0x001f, 0);
+        }
+        else
+        {
+            window_virtual_ = SDL_CreateRGBSurface(0, windowWidth_, windowHeight_, 32, 0,0,0,0);
+        }
         //window_virtual_ = SDL_CreateRGBSurface(0, windowWidth_, windowHeight_, 32, rmask, gmask, bmask, amask); // colors are reversed with this !
         if ( window_virtual_ == NULL )
         {
@@ -195,7 +295,15 @@ bool SDL::initialize( Configuration &config )
             Logger::write( Logger::ZONE_ERROR, "SDL", "SDL_CreateRGBSurface window_virtual_ failed: " + error );
             retVal = false;
     }
-        SDL_FillRect(window_virtual_, NULL, SDL_MapRGBA(window_virtual_->format, 0, 0, 0, 0));
+        else
+        {
+            SDL_FillRect(window_virtual_, NULL, SDL_MapRGBA(window_virtual_->format, 0, 0, 0, 0));
+        }
+
+        if ( retVal && !choosePresentMode( presentAuto ) )
+        {
+            retVal = false;
+        }
 
         /*texture_copy_alpha_ = SDL_CreateRGBSurface(0, windowWidth_, windowHeight_, 32, rmask, gmask, bmask, amask);
         if ( texture_copy_alpha_ == NULL )
@@ -266,6 +374,8 @@ bool SDL::deInitialize( )
     std::string error = SDL_GetError( );
     Logger::write( Logger::ZONE_INFO, "SDL", "DeInitializing" );
 
+    // Keep the decoded sounds for the next initialization
+    SoundBank::getInstance( ).closeAudio( );
     Mix_CloseAudio( );
 
     while(Mix_Init(0))
@@ -283,10 +393,23 @@ bool SDL::deInitialize( )
         renderer_ = NULL;
     }*/
 
-    if ( window_virtual_ )
+    // In direct mode the drawing surface is the window, SDL_Quit frees it
+    if ( window_virtual_ && window_virtual_ != window_ )
     {
         SDL_FreeSurface(window_virtual_);
-        window_virtual_ = NULL;
+    }
+    window_virtual_ = NULL;
+
+    if ( window_front_ )
+    {
+        SDL_FreeSurface(window_front_);
+        window_front_ = NULL;
+    }
+
+    if ( window_rotated_ )
+    {
+        SDL_FreeSurface(window_rotated_);
+        window_rotated_ = NULL;
     }
 
     /*if ( texture_copy_alpha_ )
@@ -329,161 +452,514 @@ SDL_Surface* SDL::getWindow( )
 }*/
 
 
+// Counts a new surface for the component it is made for. A surface made
+// over pixels it does not own counts no bytes, it is still listed.
+SDL_Surface *SDL::trackSurface( SDL_Surface *surface, const std::string &tag )
+{
+    if ( surface )
+    {
+        size_t bytes = ( surface->flags & SDL_PREALLOC ) ? 0 : static_cast<size_t>( surface->pitch ) * surface->h;
+        SurfaceTracker::add( surface, bytes, tag );
+    }
 
+    return surface;
+}
 
 
+SDL_Surface *SDL::loadSurface( const std::string &file, const std::string &tag )
+{
+    return trackSurface( IMG_Load( file.c_str( ) ), tag );
+}
 
-void SDL::SDL_Rotate_270(SDL_Surface * src, SDL_Surface * dst){
-  int i, j;
-    uint32_t *source_pixels = (uint32_t*) src->pixels;
-    uint32_t *dest_pixels = (uint32_t*) dst->pixels;
-
-    /// --- Checking for right pixel format ---
-    //MENU_DEBUG_PRINTF("Source bpb = %d, Dest bpb = %d\n", src->format->BitsPerPixel, dst->format->BitsPerPixel);
-    if(src->format->BitsPerPixel != 32){
-      printf("Error in SDL_Rotate_270, Wrong virtual_hw_surface pixel format: %d bpb, expected: uint32_t bpb\n", src->format->BitsPerPixel);
-      return;
+
+SDL_Surface *SDL::createSurface( Uint32 flags, int width, int height, int depth,
+                                 Uint32 Rmask, Uint32 Gmask, Uint32 Bmask, Uint32 Amask, const std::string &tag )
+{
+    return trackSurface( SDL_CreateRGBSurface( flags, width, height, depth, Rmask, Gmask, Bmask, Amask ), tag );
+}
+
+
+SDL_Surface *SDL::createSurfaceFrom( void *pixels, int width, int height, int depth, int pitch,
+                                     Uint32 Rmask, Uint32 Gmask, Uint32 Bmask, Uint32 Amask, const std::string &tag )
+{
+    return trackSurface( SDL_CreateRGBSurfaceFrom( pixels, width, height, depth, pitch, Rmask, Gmask, Bmask, Amask ), tag );
+}
+
+
+SDL_Surface *SDL::convertSurface( SDL_Surface *surface, SDL_PixelFormat *format, Uint32 flags, const std::string &tag )
+{
+    return trackSurface( SDL_ConvertSurface( surface, format, flags ), tag );
+}
+
+
+// Frees any surface, tracked or not
+void SDL::freeSurface( SDL_Surface *surface )
+{
+    if ( surface )
+    {
+        SurfaceTracker::remove( surface );
+        SDL_FreeSurface( surface );
+    }
+}
+
+
+// Lists the surfaces still held, all of them should be freed by then
+void SDL::logSurfaces( )
+{
+    std::vector<SurfaceTracker::Allocation> allocations = SurfaceTracker::getAllocations( );
+    for ( std::vector<SurfaceTracker::Allocation>::iterator it = allocations.begin( ); it != allocations.end( ); ++it )
+    {
+        std::stringstream ss;
+        ss << "Surface " << it->surface << " of " << it->tag << " still holds " << it->bytes << " bytes";
+        Logger::write( Logger::ZONE_WARNING, "SDL", ss.str( ) );
+    }
+
+    std::stringstream ss;
+    ss << allocations.size( ) << " surfaces left holding " << SurfaceTracker::getLiveBytes( )
+       << " bytes, at most " << SurfaceTracker::getPeakBytes( ) << " bytes were held";
+    Logger::write( allocations.empty( ) ? Logger::ZONE_INFO : Logger::ZONE_WARNING, "SDL", ss.str( ) );
 }
-    if(dst->format->BitsPerPixel != 32){
-      printf("Error in SDL_Rotate_270, Wrong hw_surface pixel format: %d bpb, expected: uint32_t bpb\n", dst->format->BitsPerPixel);
+
+
+
+
+
+
+void SDL::SDL_Rotate_270(SDL_Surface * src, SDL_Surface * dst){
+
+    /// --- Checking for same pixel format ---
+    if(src->format->BitsPerPixel != dst->format->BitsPerPixel){
+      printf("Error in SDL_Rotate_270, virtual_hw_surface is %d bpp while hw_surface is %d bpp\n",
+         src->format->BitsPerPixel, dst->format->BitsPerPixel);
       return;
     }
 
-    /// --- Checking if same dimensions ---
-    if(dst->w != src->w || dst->h != src->h){
-      printf("Error in SDL_Rotate_270, hw_surface (%dx%d) and virtual_hw_surface (%dx%d) have different dimensions\n",
+    /// --- Checking if rotated dimensions ---
+    if(dst->w != src->h || dst->h != src->w){
+      printf("Error in SDL_Rotate_270, hw_surface (%dx%d) is not virtual_hw_surface (%dx%d) turned\n",
 	     dst->w, dst->h, src->w, src->h);
       return;
     }
 
-  /// --- Pixel copy and rotation (270) ---
-  uint32_t *cur_p_src, *cur_p_dst;
-  for(i=0; i<src->h; i++){
-    for(j=0; j<src->w; j++){
-      cur_p_src = source_pixels + i*src->w + j;
-      cur_p_dst = dest_pixels + (dst->h-1-j)*dst->w + i;
-      *cur_p_dst = *cur_p_src;
-    }
-  }
+    /// --- Pixel copy and rotation (270) ---
+    if( SDL_MUSTLOCK( dst ) ) SDL_LockSurface( dst );
+    PixelRotate::rotate(src->pixels, src->w, src->h, src->pitch, dst->pixels, dst->pitch, src->format->BytesPerPixel, 270);
+    if( SDL_MUSTLOCK( dst ) ) SDL_UnlockSurface( dst );
 }
 
 
-/* Dithering 32bpp RGB Surface
- *
- * error diffusion with "Filter Lite" also called "Sierra lite" method
- *
- */
+// Dithers a 32bpp surface in place with the configured method
 void SDL::ditherSurface32bppTo16Bpp(SDL_Surface * src_surface){
 
-	/* Vars */
-	int x, y;
-	uint8_t r_old, g_old, b_old;
-	uint8_t r_new, g_new, b_new;
-	int r_error, g_error, b_error;
-	uint32_t cur_px;
-
 	/* Sanity check */
 	if(src_surface->format->BitsPerPixel != 32){
 		printf("Error: src_surface is %dBpp while dst_surface is not 32\n", src_surface->format->BitsPerPixel);
 		return;
 	}
 
-	/* Loop for dithering */
-	for (y=0; y<src_surface->h; y++){
-		for (x=0; x < src_surface->w; x++){
-
-			/* Get old and new rgb values of current pixel */
-			cur_px = *((uint32_t*)src_surface->pixels + (y)*src_surface->w + (x));
-			r_old = GET_R_32BIT(cur_px);
-			g_old = GET_G_32BIT(cur_px);
-			b_old = GET_B_32BIT(cur_px);
-			r_new = CLOSEST_RB(r_old);
-			//g_new = CLOSEST_G(g_old);
-			g_new = CLOSEST_RB(g_old);	//RGB555
-			b_new = CLOSEST_RB(b_old);
-
-			/* Set new pixel value */
-			*((uint32_t*)src_surface->pixels + (y)*src_surface->w + (x)) = RGB32BIT(GET_A_32BIT(cur_px), r_new, g_new, b_new);
-
-			/* Get errors */
-			r_error = r_old - r_new;
-			g_error = g_old - g_new;
-			b_error = b_old - b_new;
-
-			/* Right pixel */
-			if(x + 1 < src_surface->w){
-				cur_px = *((uint32_t*)src_surface->pixels + (y)*src_surface->w + (x+1));
-				r_old = GET_R_32BIT(cur_px);
-				g_old = GET_G_32BIT(cur_px);
-				b_old = GET_B_32BIT(cur_px);
-				*((uint32_t*)src_surface->pixels + (y)*src_surface->w + (x+1)) =
-						RGB32BIT( GET_A_32BIT(cur_px),
-								MAX(MIN((int)r_old + (r_error>>1), 0xff), 0),
-								MAX(MIN((int)g_old + (g_error>>1), 0xff), 0),
-								MAX(MIN((int)b_old + (b_error>>1), 0xff), 0) );
-			}
+	uint32_t *pixels = (uint32_t*)src_surface->pixels;
+	uint32_t keep = ~(src_surface->format->Rmask | src_surface->format->Gmask | src_surface->format->Bmask);
+	if(ditherMode_ == DITHER_DIFFUSION){
+		Dither::errorDiffusion(pixels, src_surface->w, src_surface->h, src_surface->pitch);
+	}
+	else{
+		Dither::ordered(pixels, src_surface->w, src_surface->h, src_surface->pitch, keep);
+	}
+}
 
-			/* Bottom pixel */
-			if(y + 1 < src_surface->h){
-				cur_px = *((uint32_t*)src_surface->pixels + (y+1)*src_surface->w + (x));
-				r_old = GET_R_32BIT(cur_px);
-				g_old = GET_G_32BIT(cur_px);
-				b_old = GET_B_32BIT(cur_px);
-				*((uint32_t*)src_surface->pixels + (y+1)*src_surface->w + (x)) =
-						RGB32BIT( GET_A_32BIT(cur_px),
-								MAX(MIN((int)r_old + (r_error>>2), 0xff), 0),
-								MAX(MIN((int)g_old + (g_error>>2), 0xff), 0),
-								MAX(MIN((int)b_old + (b_error>>2), 0xff), 0) );
-			}
 
-			/* Bottom left pixel */
-			if( x > 0 &&  y + 1 < src_surface->h){
-				cur_px = *((uint32_t*)src_surface->pixels + (y+1)*src_surface->w + (x-1));
-				r_old = GET_R_32BIT(cur_px);
-				g_old = GET_G_32BIT(cur_px);
-				b_old = GET_B_32BIT(cur_px);
-				*((uint32_t*)src_surface->pixels + (y+1)*src_surface->w + (x-1)) =
-						RGB32BIT( GET_A_32BIT(cur_px),
-								MAX(MIN((int)r_old + (r_error>>2), 0xff), 0),
-								MAX(MIN((int)g_old + (g_error>>2), 0xff), 0),
-								MAX(MIN((int)b_old + (b_error>>2), 0xff), 0) );
-			}
-		}
-	}
+// Shrinks a loaded 32bpp texture to the size it is shown at, averaging
+// the pixels each shown pixel covers. Done once, the texture is then
+// drawn without scaling.
+bool SDL::downscaleTexture( SDL_Surface *&texture, int width, int height )
+{
+    if ( !texture || texture->format->BitsPerPixel != 32 || width <= 0 || height <= 0 ||
+         width > texture->w || height > texture->h || (width == texture->w && height == texture->h) )
+    {
+        return false;
+    }
+
+    SDL_PixelFormat *format = texture->format;
+    SDL_Surface *scaled = createSurface( SDL_SWSURFACE, width, height, 32,
+                                         format->Rmask, format->Gmask, format->Bmask, format->Amask,
+                                         SurfaceTracker::getTag( texture ) );
+    if ( !scaled )
+    {
+        return false;
+    }
+
+    if ( SDL_MUSTLOCK( texture ) ) SDL_LockSurface( texture );
+    bool done = Downscale::scale( static_cast<Uint32 *>( texture->pixels ), texture->w, texture->h, texture->pitch,
+                                  static_cast<Uint32 *>( scaled->pixels ), width, height, scaled->pitch,
+                                  format->Amask ? format->Ashift : -1 );
+    if ( SDL_MUSTLOCK( texture ) ) SDL_UnlockSurface( texture );
+    if ( !done )
+    {
+        freeSurface( scaled );
+        return false;
+    }
+
+    freeSurface( texture );
+    texture = scaled;
+
+    return true;
+}
+
+
+// Keeps a loaded 32bpp texture in the form blendBlit draws it fastest
+// from, by how it uses alpha: opaque ones in the window format, binary
+// alpha ones too with a colour key over their transparent pixels, and
+// translucent ones premultiplied in the window's channel order. In RGB565
+// translucent textures are left as they are, blendBlit splits them.
+void SDL::prepareTexture( SDL_Surface *&texture )
+{
+    SDL_Surface *window = getWindow( );
+    if ( !texture || !window || texture->format->BitsPerPixel != 32 )
+    {
+        return;
+    }
+
+    SDL_PixelFormat *format       = texture->format;
+    SDL_PixelFormat *windowFormat = window->format;
+    AlphaBlit::AlphaClass alphaClass = AlphaBlit::ALPHA_OPAQUE;
+    if ( format->Amask )
+    {
+        alphaClass = AlphaBlit::classify( static_cast<Uint32 *>( texture->pixels ), texture->w, texture->h,
+                                          texture->pitch, format->Ashift );
+    }
+
+    SDL_Surface *prepared = NULL;
+    if ( alphaClass != AlphaBlit::ALPHA_TRANSLUCENT )
+    {
+        prepared = convertSurface( texture, windowFormat, SDL_SWSURFACE, SurfaceTracker::getTag( texture ) );
+        if ( !prepared )
+        {
+            return;
+        }
+
+        // The key is a color none of the shown pixels has, near magenta
+        if ( alphaClass == AlphaBlit::ALPHA_BINARY )
+        {
+            Uint32 keyMask = windowFormat->Rmask | windowFormat->Gmask | windowFormat->Bmask;
+            bool   keyed   = false;
+            for ( int i = 0; i < 16 && !keyed; ++i )
+            {
+                Uint32 key = SDL_MapRGB( windowFormat, 255, 0, 255 - 8 * i );
+                keyed = AlphaBlit::applyColorKey( static_cast<Uint32 *>( texture->pixels ), texture->pitch, format->Ashift,
+                                                  prepared->pixels, prepared->pitch, windowFormat->BytesPerPixel,
+                                                  texture->w, texture->h, key, keyMask );
+                if ( keyed )
+                {
+                    SDL_SetColorKey( prepared, SDL_SRCCOLORKEY, key );
+                }
+            }
+            if ( !keyed )
+            {
+                freeSurface( prepared );
+                prepared   = NULL;
+                alphaClass = AlphaBlit::ALPHA_TRANSLUCENT;
+            }
+        }
+    }
+
+    // Also taken by a binary alpha texture using every candidate key
+    if ( alphaClass == AlphaBlit::ALPHA_TRANSLUCENT )
+    {
+        if ( windowFormat->BitsPerPixel != 32 )
+        {
+            return;
+        }
+        Uint32 amask = ~(windowFormat->Rmask | windowFormat->Gmask | windowFormat->Bmask);
+        prepared = createSurface( SDL_SWSURFACE, texture->w, texture->h, 32,
+                                  windowFormat->Rmask, windowFormat->Gmask, windowFormat->Bmask, amask,
+                                  SurfaceTracker::getTag( texture ) );
+        if ( !prepared )
+        {
+            return;
+        }
+
+        AlphaBlit::Layout from = { format->Rshift, format->Gshift, format->Bshift, format->Ashift };
+        AlphaBlit::Layout to   = { windowFormat->Rshift, windowFormat->Gshift, windowFormat->Bshift, prepared->format->Ashift };
+        for ( int y = 0; y < texture->h; ++y )
+        {
+            AlphaBlit::premultiply( reinterpret_cast<Uint32 *>( static_cast<Uint8 *>( texture->pixels ) + y * texture->pitch ), from,
+                                    reinterpret_cast<Uint32 *>( static_cast<Uint8 *>( prepared->pixels ) + y * prepared->pitch ), to,
+                                    texture->w );
+        }
+        prepared->flags |= SURFACE_PREMULTIPLIED;
+    }
+
+    freeSurface( texture );
+    texture = prepared;
+}
+
+
+// Moves a prepared texture into a free slot of the atlas, scaled down to
+// the slot when larger, and points it there: the surface left is only a
+// header over the slot pixels, freeing it leaves them alone. The texture
+// is kept as it is when the atlas is full or cannot hold its pixels.
+bool SDL::packTexture( SDL_Surface *&texture, SpriteAtlas &atlas, int &slot )
+{
+    slot = -1;
+    if ( !texture || !atlas.isValid( ) || texture->format->palette ||
+         texture->format->BytesPerPixel > atlas.getBytesPerPixel( ) )
+    {
+        return false;
+    }
+
+    int index = atlas.allocate( );
+    if ( index < 0 )
+    {
+        return false;
+    }
+
+    SDL_PixelFormat *format = texture->format;
+    int width  = 0;
+    int height = 0;
+    SDL_Surface *packed = NULL;
+    if ( atlas.store( index, texture->pixels, texture->w, texture->h, texture->pitch, format->BytesPerPixel, width, height ) )
+    {
+        packed = createSurfaceFrom( atlas.getSlotPixels( index ), width, height, format->BitsPerPixel, atlas.getPitch( ),
+                                    format->Rmask, format->Gmask, format->Bmask, format->Amask,
+                                    SurfaceTracker::getTag( texture ) );
+    }
+    if ( !packed )
+    {
+        atlas.release( index );
+        return false;
+    }
+
+    if ( texture->flags & SDL_SRCCOLORKEY )
+    {
+        SDL_SetColorKey( packed, SDL_SRCCOLORKEY, format->colorkey );
+    }
+    packed->flags |= texture->flags & SURFACE_PREMULTIPLIED;
+
+    freeSurface( texture );
+    texture = packed;
+    slot    = index;
+
+    return true;
+}
+
+
+// Picks how frames reach the screen once the window exists. Drawing
+// straight into the window needs its pixel layout and a second hardware
+// buffer, or the half drawn frame would show. Without one, two buffers
+// are swapped and only the rows that changed are copied to the window.
+bool SDL::choosePresentMode( bool presentAuto )
+{
+    SDL_PixelFormat *windowFormat  = window_->format;
+    SDL_PixelFormat *virtualFormat = window_virtual_->format;
+    bool sameFormat = windowFormat->BitsPerPixel == virtualFormat->BitsPerPixel &&
+                      windowFormat->Rmask == virtualFormat->Rmask &&
+                      windowFormat->Gmask == virtualFormat->Gmask &&
+                      windowFormat->Bmask == virtualFormat->Bmask;
+
+    // A turned frame is always written to the window by the rotation, and
+    // through a buffer in the drawing format if the window has another one
+    if ( screenRotation_ )
+    {
+        if ( !presentAuto && presentMode_ != PRESENT_COPY )
+        {
+            Logger::write( Logger::ZONE_WARNING, "SDL", "The screen is rotated, copying frames to the window" );
+        }
+        presentMode_ = PRESENT_COPY;
+
+        if ( !sameFormat )
+        {
+            window_rotated_ = SDL_CreateRGBSurface( 0, window_->w, window_->h, virtualFormat->BitsPerPixel,
+                                                    virtualFormat->Rmask, virtualFormat->Gmask, virtualFormat->Bmask, virtualFormat->Amask );
+            if ( window_rotated_ == NULL )
+            {
+                std::string error = SDL_GetError( );
+                Logger::write( Logger::ZONE_ERROR, "SDL", "SDL_CreateRGBSurface window_rotated_ failed: " + error );
+                return false;
+            }
+        }
+
+        std::stringstream ss;
+        ss << "Presenting frames: rotated by " << screenRotation_ << " degrees (" << PixelRotate::getKernelName( ) << ")";
+        Logger::write( Logger::ZONE_INFO, "SDL", ss.str( ) );
+        return true;
+    }
+
+    if ( presentAuto )
+    {
+        if ( !sameFormat )
+        {
+            presentMode_ = PRESENT_COPY;
+        }
+        else if ( window_->flags & SDL_DOUBLEBUF )
+        {
+            presentMode_ = PRESENT_DIRECT;
+        }
+        else
+        {
+            presentMode_ = PRESENT_SWAP;
+        }
+    }
+    else if ( presentMode_ != PRESENT_COPY && !sameFormat )
+    {
+        Logger::write( Logger::ZONE_WARNING, "SDL", "The window does not use the drawing pixel format, copying frames to it" );
+        presentMode_ = PRESENT_COPY;
+    }
+
+    if ( presentMode_ == PRESENT_DIRECT )
+    {
+        SDL_FreeSurface( window_virtual_ );
+        window_virtual_ = window_;
+        SDL_FillRect( window_, NULL, SDL_MapRGB( window_->format, 0, 0, 0 ) );
+        Logger::write( Logger::ZONE_INFO, "SDL", "Presenting frames: drawn into the window" );
+    }
+    else if ( presentMode_ == PRESENT_SWAP )
+    {
+        window_front_ = SDL_CreateRGBSurface( 0, window_virtual_->w, window_virtual_->h, virtualFormat->BitsPerPixel,
+                                              virtualFormat->Rmask, virtualFormat->Gmask, virtualFormat->Bmask, virtualFormat->Amask );
+        if ( window_front_ == NULL )
+        {
+            std::string error = SDL_GetError( );
+            Logger::write( Logger::ZONE_ERROR, "SDL", "SDL_CreateRGBSurface window_front_ failed: " + error );
+            return false;
+        }
+
+        // Both buffers and the window start black, the first damage is then right
+        SDL_FillRect( window_front_, NULL, SDL_MapRGBA( window_front_->format, 0, 0, 0, 0 ) );
+        SDL_FillRect( window_, NULL, SDL_MapRGB( window_->format, 0, 0, 0 ) );
+        SDL_Flip( window_ );
+        Logger::write( Logger::ZONE_INFO, "SDL", "Presenting frames: swapped buffers, changed rows copied" );
+    }
+    else
+    {
+        Logger::write( Logger::ZONE_INFO, "SDL", "Presenting frames: full copy to the window" );
+    }
+
+    return true;
 }
 
 
 // Copy virtual window to HW window and Flip display
 void SDL::renderAndFlipWindow( )
 {
+    if ( presentMode_ == PRESENT_DIRECT )
+    {
+        SDL_Flip(window_);
+        return;
+    }
+
+    if ( presentMode_ == PRESENT_SWAP )
+    {
+        presentDamage( );
+        return;
+    }
+
+    if ( screenRotation_ )
+    {
+        SDL_Surface *target = window_rotated_ ? window_rotated_ : window_;
+        if ( SDL_MUSTLOCK( target ) ) SDL_LockSurface( target );
+        PixelRotate::rotate( window_virtual_->pixels, window_virtual_->w, window_virtual_->h, window_virtual_->pitch,
+                             target->pixels, target->pitch, window_virtual_->format->BytesPerPixel, screenRotation_ );
+        if ( SDL_MUSTLOCK( target ) ) SDL_UnlockSurface( target );
+        if ( window_rotated_ )
+        {
+            SDL_BlitSurface( window_rotated_, NULL, window_, NULL );
+        }
+        SDL_Flip( window_ );
+        return;
+    }
+
 	//SDL_BlitSurface(window_virtual_, NULL, window_, NULL);
-    memcpy(window_->pixels, window_virtual_->pixels, window_->h*window_->w*sizeof(uint32_t));
+    if ( window_->pitch == window_virtual_->pitch )
+    {
+        memcpy(window_->pixels, window_virtual_->pixels, window_->h*window_->pitch);
+    }
+    else
+    {
+        SDL_BlitSurface(window_virtual_, NULL, window_, NULL);
+    }
 	//SDL_Rotate_270(window_virtual_, window_);
 
 	SDL_Flip(window_);
 }
 
 
+// Copies the rows that differ from the frame on screen, then swaps the
+// buffers: the next frame is drawn over the older one, which every
+// caller redraws entirely
+void SDL::presentDamage( )
+{
+    int rowBytes = window_virtual_->w * window_virtual_->format->BytesPerPixel;
+
+    RowDamage::collect( window_virtual_->pixels, window_virtual_->pitch,
+                        window_front_->pixels, window_front_->pitch,
+                        rowBytes, window_virtual_->h, damage_ );
+    if ( damage_.empty( ) )
+    {
+        return;
+    }
+
+    if ( SDL_MUSTLOCK( window_ ) ) SDL_LockSurface( window_ );
+    RowDamage::copy( window_virtual_->pixels, window_virtual_->pitch, window_->pixels, window_->pitch, rowBytes, damage_ );
+    if ( SDL_MUSTLOCK( window_ ) ) SDL_UnlockSurface( window_ );
+
+    damageRects_.resize( damage_.size( ) );
+    for ( size_t i = 0; i < damage_.size( ); ++i )
+    {
+        damageRects_[i].x = 0;
+        damageRects_[i].y = static_cast<Sint16>( damage_[i].first );
+        damageRects_[i].w = static_cast<Uint16>( window_->w );
+        damageRects_[i].h = static_cast<Uint16>( damage_[i].count );
+    }
+    SDL_UpdateRects( window_, static_cast<int>( damageRects_.size( ) ), &damageRects_[0] );
 
-Uint32 SDL::get_pixel32( SDL_Surface *surface, int x, int y )
+    std::swap( window_virtual_, window_front_ );
+}
+
+
+// Keep a copy of the current frame, it survives deInitialize
+bool SDL::captureSnapshot( )
 {
-    //Convert the pixels to 32 bit
-    Uint32 *pixels = (Uint32 *)surface->pixels;
+    if ( !window_virtual_ )
+    {
+        return false;
+    }
+
+    SDL_LockMutex( mutex_ );
+    if ( SDL_MUSTLOCK( window_virtual_ ) ) SDL_LockSurface( window_virtual_ );
+    bool retVal = snapshot_.capture( window_virtual_->pixels, window_virtual_->w, window_virtual_->h,
+                                     window_virtual_->pitch, window_virtual_->format->BytesPerPixel );
+    if ( SDL_MUSTLOCK( window_virtual_ ) ) SDL_UnlockSurface( window_virtual_ );
+    SDL_UnlockMutex( mutex_ );
 
-    //Get the requested pixel
-    return pixels[ ( y * surface->w ) + x ];
+    return retVal;
 }
 
-void SDL::put_pixel32( SDL_Surface *surface, int x, int y, Uint32 pixel )
+
+// Display the captured frame once and release it
+bool SDL::showSnapshot( )
 {
-    //Convert the pixels to 32 bit
-    Uint32 *pixels = (Uint32 *)surface->pixels;
+    if ( !window_virtual_ || !snapshot_.isValid( ) )
+    {
+        return false;
+    }
+
+    SDL_LockMutex( mutex_ );
+    if ( SDL_MUSTLOCK( window_virtual_ ) ) SDL_LockSurface( window_virtual_ );
+    bool retVal = snapshot_.restore( window_virtual_->pixels, window_virtual_->w, window_virtual_->h,
+                                     window_virtual_->pitch, window_virtual_->format->BytesPerPixel );
+    if ( SDL_MUSTLOCK( window_virtual_ ) ) SDL_UnlockSurface( window_virtual_ );
+    if ( retVal )
+    {
+        renderAndFlipWindow( );
+    }
+    snapshot_.clear( );
+    SDL_UnlockMutex( mutex_ );
 
-    //Set the pixel
-    pixels[ ( y * surface->w ) + x ] = pixel;
+    return retVal;
 }
 
 
+
 // Flip a surface
 SDL_Surface * SDL::flip_surface( SDL_Surface *surface, int flags )
 {
@@ -493,12 +969,16 @@ SDL_Surface * SDL::flip_surface( SDL_Surface *surface, int flags )
     //If the image is color keyed
     if( surface->flags & SDL_SRCCOLORKEY )
     {
-        flipped = SDL_CreateRGBSurface( SDL_SWSURFACE, surface->w, surface->h, surface->format->BitsPerPixel, surface->format->Rmask, surface->format->Gmask, surface->format->Bmask, 0 );
+        flipped = createSurface( SDL_SWSURFACE, surface->w, surface->h, surface->format->BitsPerPixel, surface->format->Rmask, surface->format->Gmask, surface->format->Bmask, 0, SurfaceTracker::getTag( surface ) );
     }
     //Otherwise
     else
     {
-        flipped = SDL_CreateRGBSurface( SDL_SWSURFACE, surface->w, surface->h, surface->format->BitsPerPixel, surface->format->Rmask, surface->format->Gmask, surface->format->Bmask, surface->format->Amask );
+        flipped = createSurface( SDL_SWSURFACE, surface->w, surface->h, surface->format->BitsPerPixel, surface->format->Rmask, surface->format->Gmask, surface->format->Bmask, surface->format->Amask, SurfaceTracker::getTag( surface ) );
+    }
+    if( flipped == NULL )
+    {
+        return NULL;
     }
 
     //If the surface must be locked
@@ -508,30 +988,9 @@ SDL_Surface * SDL::flip_surface( SDL_Surface *surface, int flags )
         SDL_LockSurface( surface );
     }
 
-    //Go through columns
-    for( int x = 0, rx = flipped->w - 1; x < flipped->w; x++, rx-- )
-    {
-        //Go through rows
-        for( int y = 0, ry = flipped->h - 1; y < flipped->h; y++, ry-- )
-        {
-            //Get pixel
-            Uint32 pixel = get_pixel32( surface, x, y );
-
-            //Copy pixel
-            if( ( flags & FLIP_VERTICAL ) && ( flags & FLIP_HORIZONTAL ) )
-            {
-                put_pixel32( flipped, rx, ry, pixel );
-            }
-            else if( flags & FLIP_HORIZONTAL )
-            {
-                put_pixel32( flipped, rx, y, pixel );
-            }
-            else if( flags & FLIP_VERTICAL )
-            {
-                put_pixel32( flipped, x, ry, pixel );
-            }
-        }
-    }
+    //Copy the rows, mirrored
+    PixelRotate::flip( surface->pixels, surface->w, surface->h, surface->pitch, flipped->pixels, flipped->pitch,
+                       surface->format->BytesPerPixel, (flags & FLIP_HORIZONTAL) != 0, (flags & FLIP_VERTICAL) != 0 );
 
     //Unlock surface
     if( SDL_MUSTLOCK( surface ) )
@@ -610,11 +1069,12 @@ SDL_Surface * SDL::zoomSurface(SDL_Surface *src_surface, SDL_Rect *src_rect_orig
 	y_ratio = (int)((srcRect.h <<16) / dst_rect->h);
 
 	/* Create dst surface */
-	SDL_Surface *dst_surface = SDL_CreateRGBSurface(src_surface->flags,
+	SDL_Surface *dst_surface = createSurface(src_surface->flags,
 			dst_rect->w, dst_rect->h,
 			src_surface->format->BitsPerPixel,
 			src_surface->format->Rmask, src_surface->format->Gmask,
-			src_surface->format->Bmask, src_surface->format->Amask);
+			src_surface->format->Bmask, src_surface->format->Amask,
+			SurfaceTracker::getTag(src_surface));
 	if(dst_surface == NULL){
 		printf("ERROR in %s, cannot create dst_surface: %s\n", __func__, SDL_GetError());
 	}
@@ -624,9 +1084,9 @@ SDL_Surface * SDL::zoomSurface(SDL_Surface *src_surface, SDL_Rect *src_rect_orig
 	{
 
 		/* Get current lines in src and dst surfaces */
-		uint8_t* t = ( (uint8_t*) dst_surface->pixels + (i*dst_surface->w)*dst_surface->format->BytesPerPixel );
+		uint8_t* t = ( (uint8_t*) dst_surface->pixels + i*dst_surface->pitch );
 		y2 = ((i*y_ratio)>>16);
-		uint8_t* p = ( (uint8_t*) src_surface->pixels + ((y2+srcRect.y)*src_surface->w)*src_surface->format->BytesPerPixel );
+		uint8_t* p = ( (uint8_t*) src_surface->pixels + (y2+srcRect.y)*src_surface->pitch );
 		rat =  srcRect.x << 16;
 
 		/* Lines iterations */
@@ -652,11 +1112,12 @@ SDL_Surface * SDL::zoomSurface(SDL_Surface *src_surface, SDL_Rect *src_rect_orig
 		SDL_Surface *prev_dst_surface = dst_surface;
 
 		/* Create dst surface */
-		dst_surface = SDL_CreateRGBSurface(src_surface->flags,
-						   post_cropping_rect->w, post_cropping_rect->h,
-						   src_surface->format->BitsPerPixel,
-						   src_surface->format->Rmask, src_surface->format->Gmask,
-						   src_surface->format->Bmask, src_surface->format->Amask);
+		dst_surface = createSurface(src_surface->flags,
+					    post_cropping_rect->w, post_cropping_rect->h,
+					    src_surface->format->BitsPerPixel,
+					    src_surface->format->Rmask, src_surface->format->Gmask,
+					    src_surface->format->Bmask, src_surface->format->Amask,
+					    SurfaceTracker::getTag(src_surface));
 		if(dst_surface == NULL){
 			printf("ERROR in %s, cannot create dst_surface for post cropping: %s\n", __func__, SDL_GetError());
 			dst_surface = prev_dst_surface;
@@ -675,9 +1136,9 @@ SDL_Surface * SDL::zoomSurface(SDL_Surface *src_surface, SDL_Rect *src_rect_orig
 			{
 
 				/* Get current lines in src and dst surfaces */
-				uint8_t* t = ( (uint8_t*) dst_surface->pixels + i*dst_surface->w*dst_surface->format->BytesPerPixel );
+				uint8_t* t = ( (uint8_t*) dst_surface->pixels + i*dst_surface->pitch );
 				uint8_t* p = ( (uint8_t*) prev_dst_surface->pixels +
-					       (i+post_cropping_rect->y)*prev_dst_surface->w*prev_dst_surface->format->BytesPerPixel +
+					       (i+post_cropping_rect->y)*prev_dst_surface->pitch +
 					       post_cropping_rect->x*prev_dst_surface->format->BytesPerPixel);
 
 				/* Copy src pixel in dst surface */
@@ -685,17 +1146,209 @@ SDL_Surface * SDL::zoomSurface(SDL_Surface *src_surface, SDL_Rect *src_rect_orig
 			}
 
 			/* Free previous surface */
-			SDL_FreeSurface(prev_dst_surface);
+			freeSurface(prev_dst_surface);
 		}
 	}
 
+	/* Pixels are read as in the source: same colour key, same premultiplication */
+	if(dst_surface != NULL){
+		if(src_surface->flags & SDL_SRCCOLORKEY){
+			SDL_SetColorKey(dst_surface, SDL_SRCCOLORKEY, src_surface->format->colorkey);
+		}
+		dst_surface->flags |= src_surface->flags & SURFACE_PREMULTIPLIED;
+	}
+
 	/* Return new zoomed surface */
 	return dst_surface;
 }
 
 
+// Whether renderCopy to dest would touch the window at all
+bool SDL::isOnScreen( SDL_Rect *dest )
+{
+    SDL_Surface *window = getWindow( );
+    int x = dest->x;
+    int y = dest->y;
+
+    if ( !window ) return true;
+
+    if ( fullscreen_ )
+    {
+        x += (displayWidth_ - windowWidth_)/2;
+        y += (displayHeight_ - windowHeight_)/2;
+    }
+
+    return (x < window->w && y < window->h && x + dest->w > 0 && y + dest->h > 0);
+}
+
+
+// Blends a texture into the window with the pipeline's own kernels, picked
+// by what prepareTexture made of it: rows copied for an opaque texture,
+// the key skipped for a colour keyed one and the premultiplied blend for a
+// translucent one. An RGB565 window also takes straight alpha textures.
+// Returns false when the formats are not handled, SDL blits it then.
+bool SDL::blendBlit( SDL_Surface *src, SDL_Rect *srcRect, SDL_Rect *dstRect, Uint8 alpha )
+{
+    SDL_Surface     *window = getWindow( );
+    SDL_PixelFormat *format = src->format;
+    if ( !window )
+    {
+        return false;
+    }
+
+    SDL_PixelFormat *windowFormat = window->format;
+    bool sameLayout    = format->BitsPerPixel == windowFormat->BitsPerPixel && format->Rmask == windowFormat->Rmask &&
+                         format->Gmask == windowFormat->Gmask && format->Bmask == windowFormat->Bmask &&
+                         (format->BitsPerPixel == 16 || format->BitsPerPixel == 32);
+    bool premultiplied = sameLayout && format->Amask && (src->flags & SURFACE_PREMULTIPLIED);
+    bool keyed         = sameLayout && !format->Amask && (src->flags & SDL_SRCCOLORKEY);
+    bool opaque        = sameLayout && !format->Amask && !keyed;
+    bool translucent   = windowFormat->BitsPerPixel == 16 && format->BitsPerPixel == 32 && format->Amask &&
+                         !(src->flags & SURFACE_PREMULTIPLIED);
+    if ( !opaque && !keyed && !premultiplied && !translucent )
+    {
+        return false;
+    }
+
+    // Clipped like SDL_BlitSurface does: the source rectangle gives the size
+    int sx = 0;
+    int sy = 0;
+    int w  = src->w;
+    int h  = src->h;
+    if ( srcRect )
+    {
+        sx = srcRect->x;
+        sy = srcRect->y;
+        w  = MIN( srcRect->w, src->w - sx );
+        h  = MIN( srcRect->h, src->h - sy );
+    }
+    int dx = dstRect->x;
+    int dy = dstRect->y;
+    if ( dx < 0 ) { sx -= dx; w += dx; dx = 0; }
+    if ( dy < 0 ) { sy -= dy; h += dy; dy = 0; }
+    w = MIN( w, window->w - dx );
+    h = MIN( h, window->h - dy );
+    if ( w <= 0 || h <= 0 || sx < 0 || sy < 0 )
+    {
+        return true;
+    }
+
+    // In direct mode the window may be a hardware surface
+    if ( SDL_MUSTLOCK( src ) ) SDL_LockSurface( src );
+    if ( SDL_MUSTLOCK( window ) ) SDL_LockSurface( window );
+
+    Uint8 *srcRow = static_cast<Uint8 *>( src->pixels ) + sy * src->pitch + sx * format->BytesPerPixel;
+    Uint8 *dstRow = static_cast<Uint8 *>( window->pixels ) + dy * window->pitch + dx * windowFormat->BytesPerPixel;
+    Uint32 keyMask = windowFormat->BitsPerPixel == 16 ? 0xffff : windowFormat->Rmask | windowFormat->Gmask | windowFormat->Bmask;
+
+    if ( translucent )
+    {
+        rowRgb_.resize( w );
+        rowAlpha_.resize( w );
+    }
+
+    for ( int y = 0; y < h; ++y, srcRow += src->pitch, dstRow += window->pitch )
+    {
+        if ( opaque && format->BitsPerPixel == 16 )
+        {
+            PixelBlend::blendRgb565A8( reinterpret_cast<Uint16 *>( dstRow ), reinterpret_cast<Uint16 *>( srcRow ), NULL, w, alpha );
+        }
+        else if ( opaque )
+        {
+            AlphaBlit::blendConstant( reinterpret_cast<Uint32 *>( dstRow ), reinterpret_cast<Uint32 *>( srcRow ), w, alpha );
+        }
+        else if ( keyed )
+        {
+            AlphaBlit::blendKeyed( dstRow, srcRow, w, format->BytesPerPixel, format->colorkey & keyMask, keyMask, alpha );
+        }
+        else if ( premultiplied )
+        {
+            AlphaBlit::blendPremultiplied( reinterpret_cast<Uint32 *>( dstRow ), reinterpret_cast<Uint32 *>( srcRow ), w,
+                                           format->Ashift, alpha );
+        }
+        else
+        {
+            PixelBlend::splitArgb8888( reinterpret_cast<Uint32 *>( srcRow ), &rowRgb_[0], &rowAlpha_[0], w,
+                                       format->Rshift, format->Gshift, format->Bshift, format->Ashift );
+            PixelBlend::blendRgb565A8( reinterpret_cast<Uint16 *>( dstRow ), &rowRgb_[0], &rowAlpha_[0], w, alpha );
+        }
+    }
+
+    if ( SDL_MUSTLOCK( window ) ) SDL_UnlockSurface( window );
+    if ( SDL_MUSTLOCK( src ) ) SDL_UnlockSurface( src );
+
+    return true;
+}
+
+
+// Layout of a 16-bit RGB565 or 32-bit surface for the reflection code
+bool SDL::describeSurface( SDL_Surface *surface, Reflection::Surface &description )
+{
+    SDL_PixelFormat *format = surface->format;
+
+    if ( format->BytesPerPixel == 2 && !(format->Rmask == 0xf800 && format->Gmask == 0x07e0 && format->Bmask == 0x001f) )
+    {
+        return false;
+    }
+    if ( format->BytesPerPixel != 2 && format->BytesPerPixel != 4 )
+    {
+        return false;
+    }
+
+    description.pixels        = surface->pixels;
+    description.width         = surface->w;
+    description.height        = surface->h;
+    description.pitch         = surface->pitch;
+    description.bytesPerPixel = format->BytesPerPixel;
+    description.rShift        = format->Rshift;
+    description.gShift        = format->Gshift;
+    description.bShift        = format->Bshift;
+    description.aShift        = format->Amask ? format->Ashift : -1;
+    description.premultiplied = (surface->flags & SURFACE_PREMULTIPLIED) != 0;
+    description.keyed         = (surface->flags & SDL_SRCCOLORKEY) != 0;
+    description.key           = format->colorkey;
+    if ( format->BytesPerPixel == 4 )
+    {
+        description.key &= format->Rmask | format->Gmask | format->Bmask;
+    }
+
+    return true;
+}
+
+
+// Blends the reflection of the texture's area, drawn at image, into the
+// window. Without a cache from the caller the rows are sampled each time.
+void SDL::drawReflection( SDL_Surface *texture, const Reflection::Rect &area, const Reflection::Rect &image,
+                          ViewInfo &viewInfo, Uint8 alpha, Reflection *reflection )
+{
+    Reflection::Side side = Reflection::parseSide( viewInfo.Reflection );
+    if ( side == Reflection::SIDE_NONE )
+    {
+        return;
+    }
+
+    SDL_Surface *window = getWindow( );
+    if ( SDL_MUSTLOCK( texture ) ) SDL_LockSurface( texture );
+    if ( SDL_MUSTLOCK( window ) ) SDL_LockSurface( window );
+
+    Reflection::Surface source;
+    Reflection::Surface target;
+    if ( describeSurface( texture, source ) && describeSurface( window, target ) )
+    {
+        Reflection::Rect placement = Reflection::place( side, image, viewInfo.ReflectionScale,
+                                                        static_cast<int>( viewInfo.ReflectionDistance ) );
+        Reflection *drawer = reflection ? reflection : &reflection_;
+        drawer->draw( source, area, side, placement, viewInfo.ReflectionAlpha, target, alpha, reflection != NULL );
+    }
+
+    if ( SDL_MUSTLOCK( window ) ) SDL_UnlockSurface( window );
+    if ( SDL_MUSTLOCK( texture ) ) SDL_UnlockSurface( texture );
+}
+
+
 // Render a copy of a texture
-bool SDL::renderCopy( SDL_Surface *texture, float alpha, SDL_Rect *src, SDL_Rect *dest, ViewInfo &viewInfo )
+bool SDL::renderCopy( SDL_Surface *texture, float alpha, SDL_Rect *src, SDL_Rect *dest, ViewInfo &viewInfo,
+                      Reflection *reflection )
 {
 	SDL_Surface * surface_to_blit = texture;
 	SDL_Surface * texture_zoomed = NULL;
@@ -891,16 +1544,37 @@ bool SDL::renderCopy( SDL_Surface *texture, float alpha, SDL_Rect *src, SDL_Rect
         SDL_FreeSurface(texture_tmp);
     }*/
 
-    /* Blit surface */
+    /* Blit surface, SDL_BlitSurface clips the rectangle it is given and the reflection needs the whole one */
 	bool perform_blit = (alpha != 0) && !dstRect.w==0 && !dstRect.h==0;
-    if(perform_blit){
+    SDL_Rect blitRect = dstRect;
+    if(perform_blit && !blendBlit(surface_to_blit, scaling_needed ? NULL : &srcRect, &blitRect, static_cast<uint8_t>( alpha * 255 ))){
         SDL_SetAlpha(surface_to_blit, SDL_SRCALPHA, static_cast<uint8_t>( alpha * 255 ));
-        SDL_BlitSurface(surface_to_blit, scaling_needed ? NULL : &srcRect, getWindow(), &dstRect);
+        SDL_BlitSurface(surface_to_blit, scaling_needed ? NULL : &srcRect, getWindow(), &blitRect);
+    }
+
+    /* Reflection, sampled from the unscaled texture where the image is shown */
+    if ( perform_blit && !viewInfo.Reflection.empty( ) )
+    {
+        Reflection::Rect area  = { srcRect.x, srcRect.y, srcRect.w, srcRect.h };
+        Reflection::Rect image = { dstRect.x, dstRect.y, srcRect.w, srcRect.h };
+        if ( scaling_needed )
+        {
+            image.w = cropping_needed ? rect_cropping.w : dstRect.w;
+            image.h = cropping_needed ? rect_cropping.h : dstRect.h;
+        }
+        if ( scaling_needed && cropping_needed )
+        {
+            area.x = srcRect.x + MAX( 0, rect_cropping.x ) * srcRect.w / dstRect.w;
+            area.y = srcRect.y + MAX( 0, rect_cropping.y ) * srcRect.h / dstRect.h;
+            area.w = MAX( 1, MIN( rect_cropping.w * srcRect.w / dstRect.w, srcRect.x + srcRect.w - area.x ) );
+            area.h = MAX( 1, MIN( rect_cropping.h * srcRect.h / dstRect.h, srcRect.y + srcRect.h - area.y ) );
+        }
+        drawReflection( texture, area, image, viewInfo, static_cast<Uint8>( alpha * 255 ), reflection );
     }
 
     /* Free zoomed texture */
     if(texture_zoomed)
-	SDL_FreeSurface(texture_zoomed);
+	freeSurface(texture_zoomed);
 
 
 
@@ -913,60 +1587,6 @@ bool SDL::renderCopy( SDL_Surface *texture, float alpha, SDL_Rect *src, SDL_Rect
     //double scale_y = 240/1080;
     //texture = rotozoomSurfaceXY(texture, 0, 0.5, 0.6, SMOOTHING_ON);
 
-    /*if ( viewInfo.Reflection == "top" )
-    {
-        dstRect.h = static_cast<unsigned int>( static_cast<float>(dstRect.h ) * viewInfo.ReflectionScale);
-        dstRect.y = dstRect.y - dstRect.h - viewInfo.ReflectionDistance;
-        //SDL_SetTextureAlphaMod( texture, static_cast<char>( viewInfo.ReflectionAlpha * alpha * 255 ) );
-        //SDL_RenderCopyEx( getRenderer( ), texture, src, &dstRect, viewInfo.Angle, NULL, SDL_FLIP_VERTICAL );
-
-        //texture = rotozoomSurfaceXY(texture, viewInfo.Angle, scaleX, scaleY, SMOOTHING_ON);
-
-
-        SDL_SetAlpha( texture, 0, SDL_ALPHA_OPAQUE );
-        SDL_BlitSurface (texture, &srcRect, texture_copy_alpha_, &dstRect);
-        texture_copy_alpha_ = flip_surface(texture_copy_alpha_, FLIP_VERTICAL);
-        SDL_gfxMultiplyAlpha (texture_copy_alpha_, static_cast<char>( alpha * 255 ));
-        SDL_BlitSurface (texture_copy_alpha_, &dstRect, getWindow(), &dstRect);
-    }*/
-
-    /*if ( viewInfo.Reflection == "bottom" )
-    {
-        dstRect.y = dstRect.y + dstRect.h + viewInfo.ReflectionDistance;
-        dstRect.h = static_cast<unsigned int>( static_cast<float>(dstRect.h ) * viewInfo.ReflectionScale);
-        //SDL_SetTextureAlphaMod( texture, static_cast<char>( viewInfo.ReflectionAlpha * alpha * 255 ) );
-        //SDL_RenderCopyEx( getRenderer( ), texture, src, &dstRect, viewInfo.Angle, NULL, SDL_FLIP_VERTICAL );
-        SDL_SetAlpha(texture, SDL_SRCALPHA, static_cast<char>( alpha * 255 ));
-        //texture = flip_surface(texture, FLIP_VERTICAL);
-        //texture = rotozoomSurfaceXY(texture, viewInfo.Angle, scaleX, scaleY, SMOOTHING_ON);
-        SDL_BlitSurface(texture, src, getWindow(), &dstRect);
-    }
-
-    if ( viewInfo.Reflection == "left" )
-    {
-        dstRect.w = static_cast<unsigned int>( static_cast<float>(dstRect.w ) * viewInfo.ReflectionScale);
-        dstRect.x = dstRect.x - dstRect.w - viewInfo.ReflectionDistance;
-        //SDL_SetTextureAlphaMod( texture, static_cast<char>( viewInfo.ReflectionAlpha * alpha * 255 ) );
-        //SDL_RenderCopyEx( getRenderer( ), texture, src, &dstRect, viewInfo.Angle, NULL, SDL_FLIP_HORIZONTAL );
-        SDL_SetAlpha(texture, SDL_SRCALPHA, static_cast<char>( alpha * 255 ));
-        //texture = flip_surface(texture, FLIP_HORIZONTAL);
-        //texture = rotozoomSurfaceXY(texture, viewInfo.Angle, scaleX, scaleY, SMOOTHING_ON);
-        SDL_BlitSurface(texture, src, getWindow(), &dstRect);
-    }
-
-    if ( viewInfo.Reflection == "right" )
-    {
-        dstRect.x = dstRect.x + dstRect.w + viewInfo.ReflectionDistance;
-        dstRect.w = static_cast<unsigned int>( static_cast<float>(dstRect.w ) * viewInfo.ReflectionScale);
-        //SDL_SetTextureAlphaMod( texture, static_cast<char>( viewInfo.ReflectionAlpha * alpha * 255 ) );
-        //SDL_RenderCopyEx( getRenderer( ), texture, src, &dstRect, viewInfo.Angle, NULL, SDL_FLIP_HORIZONTAL );
-        SDL_SetAlpha(texture, SDL_SRCALPHA, static_cast<char>( alpha * 255 ));
-        //texture = flip_surface(texture, FLIP_HORIZONTAL);
-        //texture = rotozoomSurfaceXY(texture, viewInfo.Angle, scaleX, scaleY, SMOOTHING_ON);
-        SDL_BlitSurface(texture, src, getWindow(), &dstRect);
-    }*/
-
-
     return true;
 }
 
@@ -19,7 +19,11 @@
 //#include <SDL/SDL.h>
 #include <SDL/SDL.h>
 #include <string>
+#include <vector>
 #include "Graphics/ViewInfo.h"
+#include "Graphics/FrameSnapshot.h"
+#include "Graphics/Reflection.h"
+#include "Graphics/RowDamage.h"
 
 //Flip flags
 #define FLIP_VERTICAL	1
@@ -27,20 +31,54 @@
 #define MIN(a,b) (((a)<(b))?(a):(b))
 #define MAX(a,b) (((a)>(b))?(a):(b))
 
+// Our own surface flag, SDL 1.2 leaves bits it does not use alone: the
+// colors of the texture are stored premultiplied by its alpha
+#define SURFACE_PREMULTIPLIED 0x00800000
+
 class Configuration;
+class SpriteAtlas;
 
 
 class SDL
 {
 public:
+    enum DitherMode
+    {
+        DITHER_ORDERED,
+        DITHER_DIFFUSION
+    };
+
+    // How a drawn frame reaches the screen
+    enum PresentMode
+    {
+        PRESENT_DIRECT, // drawn straight into the double buffered window
+        PRESENT_SWAP,   // drawn into one of two buffers, changed rows are copied
+        PRESENT_COPY    // drawn into a buffer converted to the window each frame
+    };
+
     static bool initialize( Configuration &config );
     static bool deInitialize( );
     static SDL_mutex *getMutex( );
     static SDL_Surface *getWindow( );
+    static SDL_Surface *loadSurface( const std::string &file, const std::string &tag );
+    static SDL_Surface *createSurface( Uint32 flags, int width, int height, int depth,
+                                       Uint32 Rmask, Uint32 Gmask, Uint32 Bmask, Uint32 Amask, const std::string &tag );
+    static SDL_Surface *createSurfaceFrom( void *pixels, int width, int height, int depth, int pitch,
+                                           Uint32 Rmask, Uint32 Gmask, Uint32 Bmask, Uint32 Amask, const std::string &tag );
+    static SDL_Surface *convertSurface( SDL_Surface *surface, SDL_PixelFormat *format, Uint32 flags, const std::string &tag );
+    static void freeSurface( SDL_Surface *surface );
+    static void logSurfaces( );
     static void renderAndFlipWindow( );
+    static bool captureSnapshot( );
+    static bool showSnapshot( );
     static SDL_Surface * zoomSurface(SDL_Surface *surface_ptr, SDL_Rect *src_rect_origin, SDL_Rect *dst_rect, SDL_Rect *post_cropping_rect);
     static void ditherSurface32bppTo16Bpp(SDL_Surface *src_surface);
-    static bool renderCopy( SDL_Surface *texture, float alpha, SDL_Rect *src, SDL_Rect *dest, ViewInfo &viewInfo );
+    static bool downscaleTexture( SDL_Surface *&texture, int width, int height );
+    static void prepareTexture( SDL_Surface *&texture );
+    static bool packTexture( SDL_Surface *&texture, SpriteAtlas &atlas, int &slot );
+    static bool renderCopy( SDL_Surface *texture, float alpha, SDL_Rect *src, SDL_Rect *dest, ViewInfo &viewInfo,
+                            Reflection *reflection = NULL );
+    static bool isOnScreen( SDL_Rect *dest );
     static int getWindowWidth( )
     {
         return windowWidth_;
@@ -53,14 +91,33 @@ public:
     {
         return fullscreen_;
     }
+    static int getBitsPerPixel( )
+    {
+        return bitsPerPixel_;
+    }
+    static PresentMode getPresentMode( )
+    {
+        return presentMode_;
+    }
+    static int getScreenRotation( )
+    {
+        return screenRotation_;
+    }
     static void SDL_Rotate_270(SDL_Surface * dst, SDL_Surface * src);
 
 private:
-    static Uint32 get_pixel32( SDL_Surface *surface, int x, int y );
-    static void put_pixel32( SDL_Surface *surface, int x, int y, Uint32 pixel );
+    static SDL_Surface *trackSurface( SDL_Surface *surface, const std::string &tag );
     static SDL_Surface * flip_surface( SDL_Surface *surface, int flags );
+    static bool blendBlit( SDL_Surface *src, SDL_Rect *srcRect, SDL_Rect *dstRect, Uint8 alpha );
+    static bool choosePresentMode( bool presentAuto );
+    static void presentDamage( );
+    static bool describeSurface( SDL_Surface *surface, Reflection::Surface &description );
+    static void drawReflection( SDL_Surface *texture, const Reflection::Rect &area, const Reflection::Rect &image,
+                                ViewInfo &viewInfo, Uint8 alpha, Reflection *reflection );
     static SDL_Surface  *window_;
     static SDL_Surface 	*window_virtual_;
+    static SDL_Surface 	*window_front_;
+    static SDL_Surface 	*window_rotated_;
     static SDL_Surface 	*texture_copy_alpha_;
     static SDL_mutex    *mutex_;
     static int           displayWidth_;
@@ -69,5 +126,15 @@ private:
     static int           windowHeight_;
     static bool          fullscreen_;
     static bool          showFrame_;
+    static int           bitsPerPixel_;
+    static DitherMode    ditherMode_;
+    static PresentMode   presentMode_;
+    static int           screenRotation_;
+    static std::vector<Uint16> rowRgb_;
+    static std::vector<Uint8>  rowAlpha_;
+    static FrameSnapshot snapshot_;
+    static Reflection    reflection_;
+    static std::vector<RowDamage::Span> damage_;
+    static std::vector<SDL_Rect>        damageRects_;
 };
 
@@ -0,0 +1,260 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "AmpController.h"
+#include "../Utility/HelperExecutor.h"
+#include "../Utility/Utils.h"
+#include <chrono>
+#include <time.h>
+
+#define AMP_DEFAULT_IDLE_TIME_NS    500000000ULL   // as the former SDL timer
+#define AMP_DEFAULT_WARMUP_TIME_NS  50000000ULL
+
+
+AmpController::AmpController(NowFunction now, CommandSink sink)
+    : now_(now)
+    , sink_(sink)
+    , stopping_(false)
+    , wakeup_(false)
+    , state_(STATE_OFF)
+    , playing_(false)
+    , warmupTime_(AMP_DEFAULT_WARMUP_TIME_NS)
+    , idleTime_(AMP_DEFAULT_IDLE_TIME_NS)
+    , deadline_(0)
+{
+}
+
+
+AmpController::~AmpController()
+{
+    stop();
+}
+
+
+AmpController &AmpController::getInstance()
+{
+    // The helper executor must outlive the controller thread that feeds it
+    HelperExecutor::getInstance();
+
+    static AmpController instance;
+    static std::once_flag started;
+    std::call_once(started, [] { instance.start(); });
+    return instance;
+}
+
+
+void AmpController::start()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if(thread_.joinable()) return;
+    stopping_ = false;
+    thread_ = std::thread(&AmpController::threadLoop, this);
+}
+
+
+void AmpController::stop()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    condition_.notify_all();
+
+    if(thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+
+void AmpController::setIdleTime(float seconds)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    idleTime_ = (seconds > 0) ? static_cast<uint64_t>(seconds * 1e9) : 0;
+}
+
+
+void AmpController::setWarmupTime(float seconds)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    warmupTime_ = (seconds > 0) ? static_cast<uint64_t>(seconds * 1e9) : 0;
+}
+
+
+// A sound starts playing, never blocks
+void AmpController::soundStarted()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    uint64_t now = now_();
+
+    playing_ = true;
+
+    if(state_ == STATE_OFF)
+    {
+        commands_.push_back(true);
+        setState(STATE_WARMING);
+        deadline_ = now + warmupTime_;
+    }
+    else if(state_ == STATE_COOLDOWN)
+    {
+        setState(STATE_ON);
+    }
+
+    wakeup_ = true;
+    condition_.notify_one();
+}
+
+
+// No sound is playing anymore, the amp goes off after the idle time unless
+// another sound starts meanwhile
+void AmpController::soundFinished()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    uint64_t now = now_();
+
+    playing_ = false;
+
+    // A sound finishing while the amp warms up is handled when it is warm
+    if(state_ == STATE_ON)
+    {
+        setState(STATE_COOLDOWN);
+        deadline_ = now + idleTime_;
+    }
+
+    wakeup_ = true;
+    condition_.notify_one();
+}
+
+
+// Forgets the amp state and any pending command, when a game drives the amp
+// itself. Commands already handed to the sink were issued before this returns.
+void AmpController::reset()
+{
+    std::unique_lock<std::mutex> issueLock(issueMutex_);
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    commands_.clear();
+    playing_ = false;
+    setState(STATE_OFF);
+}
+
+
+// Advances the state machine and issues the commands it produced. Returns the
+// time of the next transition, 0 if none is due.
+uint64_t AmpController::update()
+{
+    std::unique_lock<std::mutex> issueLock(issueMutex_);
+    std::vector<bool> commands;
+    uint64_t deadline = 0;
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        advance(now_());
+        commands.swap(commands_);
+        if(state_ == STATE_WARMING || state_ == STATE_COOLDOWN)
+        {
+            deadline = deadline_;
+        }
+    }
+
+    for(unsigned int i = 0; i < commands.size(); i++)
+    {
+        sink_(commands[i]);
+    }
+
+    return deadline;
+}
+
+
+AmpController::State AmpController::getState()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    return state_;
+}
+
+
+uint64_t AmpController::monotonicTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+
+void AmpController::runHelper(bool on)
+{
+    HelperExecutor::getInstance().run(on ? SHELL_CMD_AUDIO_AMP_ON : SHELL_CMD_AUDIO_AMP_OFF);
+}
+
+
+// Called with mutex_ held
+void AmpController::advance(uint64_t now)
+{
+    if(state_ == STATE_WARMING && now >= deadline_)
+    {
+        if(playing_)
+        {
+            setState(STATE_ON);
+        }
+        else
+        {
+            setState(STATE_COOLDOWN);
+            deadline_ = now + idleTime_;
+        }
+    }
+
+    if(state_ == STATE_COOLDOWN && now >= deadline_)
+    {
+        commands_.push_back(false);
+        setState(STATE_OFF);
+    }
+}
+
+
+// Called with mutex_ held
+void AmpController::setState(State state)
+{
+    state_ = state;
+    if(state == STATE_OFF || state == STATE_ON)
+    {
+        deadline_ = 0;
+    }
+}
+
+
+void AmpController::threadLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while(!stopping_)
+    {
+        wakeup_ = false;
+        lock.unlock();
+        uint64_t deadline = update();
+        lock.lock();
+
+        if(deadline)
+        {
+            uint64_t now = now_();
+            std::chrono::nanoseconds timeout((deadline > now) ? deadline - now : 0);
+            condition_.wait_for(lock, timeout, [this] { return stopping_ || wakeup_; });
+        }
+        else
+        {
+            condition_.wait(lock, [this] { return stopping_ || wakeup_; });
+        }
+    }
+}
@@ -0,0 +1,86 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+// Powers the audio amplifier on for the UI sounds and off again once they have
+// been idle for a while:
+//
+//   off --sound--> warming --warmup elapsed--> on --sounds finished--> cooldown
+//                                                 <------sound------
+//   cooldown --idle time elapsed--> off
+//
+// The on command is only issued when leaving off, so scrolling through a list
+// does not run a helper per click. Commands are issued from update(), which a
+// background thread calls once start()ed. The clock (nanoseconds) and the
+// command sink can be replaced.
+class AmpController
+{
+public:
+    enum State
+    {
+        STATE_OFF,
+        STATE_WARMING,
+        STATE_ON,
+        STATE_COOLDOWN
+    };
+
+    typedef uint64_t (*NowFunction)();
+    typedef std::function<void (bool on)> CommandSink;
+
+    AmpController(NowFunction now = monotonicTime, CommandSink sink = runHelper);
+    virtual ~AmpController();
+    static AmpController &getInstance();
+
+    void     start();
+    void     stop();
+    void     setIdleTime(float seconds);
+    void     setWarmupTime(float seconds);
+    void     soundStarted();
+    void     soundFinished();
+    void     reset();
+    uint64_t update();
+    State    getState();
+
+    static uint64_t monotonicTime();
+    static void     runHelper(bool on);
+
+private:
+    void advance(uint64_t now);
+    void setState(State state);
+    void threadLoop();
+
+    NowFunction             now_;
+    CommandSink             sink_;
+    std::mutex              mutex_;
+    std::mutex              issueMutex_;      // held while commands are handed to the sink
+    std::condition_variable condition_;
+    std::thread             thread_;
+    bool                    stopping_;
+    bool                    wakeup_;
+    State                   state_;
+    bool                    playing_;
+    uint64_t                warmupTime_;
+    uint64_t                idleTime_;
+    uint64_t                deadline_;        // end of the warmup or of the cooldown
+    std::vector<bool>       commands_;        // waiting to be issued, true for on
+};
@@ -18,19 +18,21 @@
 
 #include "../Utility/Log.h"
 #include "../Utility/Utils.h"
-
-SDL_TimerID Sound::idTimer = 0;
-int Sound::ampliStarted = 0;
+#include "AmpController.h"
+#include "SoundBank.h"
 
 Sound::Sound(std::string file, std::string altfile)
     : file_(file)
-    , chunk_(NULL)
+    , loaded_(false)
     , channel_(-1)
 {
-    if(!allocate())
+    /* Samples are shared with the other pages using the same file */
+    loaded_ = SoundBank::getInstance().load(file_);
+    if(!loaded_)
     {
         file_ = altfile;
-        if (!allocate())
+        loaded_ = SoundBank::getInstance().load(file_);
+        if (!loaded_)
         {
             Logger::write(Logger::ZONE_ERROR, "Sound", "Cannot load " + file_);
         }
@@ -39,65 +41,39 @@ Sound::Sound(std::string file, std::string altfile)
 
 Sound::~Sound()
 {
-    if(chunk_)
+    if(loaded_)
     {
-        Mix_FreeChunk(chunk_);
-        chunk_ = NULL;
+        SoundBank::getInstance().unload(file_);
+        loaded_ = false;
     }
 }
 
 void Sound::play()
 {
-    FILE *fp;
-
     //printf("%s\n", __func__);
-    SDL_RemoveTimer(idTimer);
-    if(!ampliStarted){
-        fp = popen(SHELL_CMD_AUDIO_AMP_ON, "r");
-    	if (fp != NULL) {
-    	    ampliStarted = 1;
-    	    //pclose(fp);  // --> regression, to investigate 
-    	}
-    }
-    
-    if(chunk_)
+    if(loaded_)
     {
-        channel_ = Mix_PlayChannel(-1, chunk_, 0);
         Mix_ChannelFinished(finished);
+        channel_ = SoundBank::getInstance().play(file_);
     }
-}
 
-uint32_t Sound::turnOffAmpli(uint32_t interval, void *param)
-{
-    FILE *fp;
-
-    //printf("%s\n", __func__);
-    fp = popen(SHELL_CMD_AUDIO_AMP_OFF, "r");
-    if (fp != NULL) {
-        ampliStarted = 0;
-	   //pclose(fp);  // --> regression, to investigate
-    }
-    return 0;
+    /* After play, which may have stopped an older copy of this sound */
+    AmpController::getInstance().soundStarted();
 }
 
 void Sound::finished(int channel)
 {
     //printf("%s\n", __func__);
     if((channel == -1) || !Mix_Playing(channel)){
-        SDL_RemoveTimer(idTimer);
-        idTimer = SDL_AddTimer(500, turnOffAmpli, NULL);
+        AmpController::getInstance().soundFinished();
     }
 }
 
+/* The decoded samples stay in the SoundBank, whose chunks are freed with the audio device */
 bool Sound::free()
 {
     //printf("%s\n", __func__);
-    if(chunk_)
-    {
-        Mix_FreeChunk(chunk_);
-        chunk_   = NULL;
-        channel_ = -1;
-    }
+    channel_ = -1;
 
     return true;
 }
@@ -105,17 +81,14 @@ bool Sound::free()
 bool Sound::allocate()
 {
     //printf("%s\n", __func__);
-    if(!chunk_)
-    {
-        chunk_ = Mix_LoadWAV(file_.c_str());
-    }
-
-    return (chunk_ != NULL);
+    return loaded_ && (SoundBank::getInstance().getChunk(file_) != NULL);
 }
 
 
 bool Sound::isPlaying()
 {
     //printf("%s\n", __func__);
-    return (channel_ != -1) && Mix_Playing(channel_);
+    /* The channel may have been taken over by another sound since */
+    return (channel_ != -1) && Mix_Playing(channel_) &&
+           Mix_GetChunk(channel_) == SoundBank::getInstance().getChunk(file_);
 }
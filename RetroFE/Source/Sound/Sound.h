@@ -29,10 +29,7 @@ public:
     bool isPlaying();
 private:
     static void finished(int channel);
-    static uint32_t turnOffAmpli(uint32_t interval, void *param);
-    static int ampliStarted;
-    static SDL_TimerID idTimer;
     std::string file_;
-    Mix_Chunk  *chunk_;
+    bool        loaded_;
     int         channel_;
 };
@@ -0,0 +1,215 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "SoundBank.h"
+#include "../Utility/Log.h"
+
+SoundBank::Entry::Entry()
+    : frequency(0)
+    , format(0)
+    , channels(0)
+    , chunk(NULL)
+    , users(0)
+{
+}
+
+
+SoundBank::SoundBank()
+    : maxInstances_(SOUND_MAX_INSTANCES)
+    , decodeCount_(0)
+{
+}
+
+
+SoundBank::~SoundBank()
+{
+    closeAudio();
+}
+
+
+SoundBank &SoundBank::getInstance()
+{
+    static SoundBank instance;
+    return instance;
+}
+
+
+// Adds a user of the sound, decoding it the first time
+bool SoundBank::load(std::string path)
+{
+    std::map<std::string, Entry>::iterator it = entries_.find(path);
+
+    if(it == entries_.end())
+    {
+        Entry entry;
+        if(!decode(path, entry))
+        {
+            return false;
+        }
+        it = entries_.insert(std::make_pair(path, entry)).first;
+    }
+
+    it->second.users++;
+    return true;
+}
+
+
+// Removes a user of the sound, the samples are freed with the last one
+void SoundBank::unload(std::string path)
+{
+    std::map<std::string, Entry>::iterator it = entries_.find(path);
+
+    if(it == entries_.end()) return;
+
+    if(it->second.users > 1)
+    {
+        it->second.users--;
+        return;
+    }
+
+    freeChunk(it->second);
+    entries_.erase(it);
+}
+
+
+// Chunk playable on the current audio device, NULL if the sound is not loaded
+// or the audio is closed
+Mix_Chunk *SoundBank::getChunk(std::string path)
+{
+    std::map<std::string, Entry>::iterator it = entries_.find(path);
+
+    if(it == entries_.end()) return NULL;
+
+    Entry &entry = it->second;
+    if(entry.chunk) return entry.chunk;
+
+    int frequency;
+    Uint16 format;
+    int channels;
+    if(!Mix_QuerySpec(&frequency, &format, &channels)) return NULL;
+
+    // Decoded for another output format, the samples must be converted again
+    if(frequency != entry.frequency || format != entry.format || channels != entry.channels)
+    {
+        if(!decode(path, entry)) return NULL;
+    }
+
+    entry.chunk = Mix_QuickLoad_RAW(entry.pcm.data(), static_cast<Uint32>(entry.pcm.size()));
+    return entry.chunk;
+}
+
+
+// Returns the mixer channel playing the sound, -1 if it could not be played
+int SoundBank::play(std::string path)
+{
+    Mix_Chunk *chunk = getChunk(path);
+
+    if(!chunk) return -1;
+
+    std::deque<int> &playing = entries_[path].playing;
+
+    // Forget the channels that finished or now play another sound
+    for(std::deque<int>::iterator it = playing.begin(); it != playing.end(); )
+    {
+        if(!Mix_Playing(*it) || Mix_GetChunk(*it) != chunk)
+        {
+            it = playing.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    int channel = -1;
+    if(playing.size() < maxInstances_)
+    {
+        channel = Mix_PlayChannel(-1, chunk, 0);
+    }
+
+    if(channel < 0 && !playing.empty())
+    {
+        channel = playing.front();
+        playing.pop_front();
+        Mix_HaltChannel(channel);
+        channel = Mix_PlayChannel(channel, chunk, 0);
+    }
+
+    if(channel >= 0)
+    {
+        playing.push_back(channel);
+    }
+
+    return channel;
+}
+
+
+// Frees the chunks before the audio device closes, the samples are kept
+void SoundBank::closeAudio()
+{
+    for(std::map<std::string, Entry>::iterator it = entries_.begin(); it != entries_.end(); ++it)
+    {
+        freeChunk(it->second);
+    }
+}
+
+
+void SoundBank::setMaxInstances(unsigned int maxInstances)
+{
+    maxInstances_ = (maxInstances > 0) ? maxInstances : 1;
+}
+
+
+// Number of times a file was decoded, for the tests
+unsigned int SoundBank::getDecodeCount()
+{
+    return decodeCount_;
+}
+
+
+// Loads the file converted to the current audio format, and keeps its samples
+bool SoundBank::decode(std::string path, Entry &entry)
+{
+    if(!Mix_QuerySpec(&entry.frequency, &entry.format, &entry.channels))
+    {
+        return false;
+    }
+
+    Mix_Chunk *loaded = Mix_LoadWAV(path.c_str());
+    if(!loaded)
+    {
+        return false;
+    }
+
+    freeChunk(entry);
+    entry.pcm.assign(loaded->abuf, loaded->abuf + loaded->alen);
+    Mix_FreeChunk(loaded);
+    decodeCount_++;
+
+    Logger::write(Logger::ZONE_DEBUG, "SoundBank", "Decoded " + path);
+    return true;
+}
+
+
+// Halts the channels still playing the chunk, which does not own the samples
+void SoundBank::freeChunk(Entry &entry)
+{
+    if(entry.chunk)
+    {
+        Mix_FreeChunk(entry.chunk);
+        entry.chunk = NULL;
+    }
+    entry.playing.clear();
+}
@@ -0,0 +1,67 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <SDL/SDL_mixer.h>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#define SOUND_MAX_INSTANCES  2   // copies of one sound playing at the same time
+
+// Owns the decoded samples of every UI sound, keyed by path. The PCM data is
+// decoded once and kept across audio reinitialisation (unloadSDL): only the
+// Mix_Chunk wrappers are freed with the audio device, and they are rebuilt
+// with Mix_QuickLoad_RAW once it is open again.
+//
+// Playing a sound that already has SOUND_MAX_INSTANCES copies playing, or
+// when no mixer channel is free, stops its oldest copy and reuses the channel.
+class SoundBank
+{
+public:
+    SoundBank();
+    virtual ~SoundBank();
+    static SoundBank &getInstance();
+
+    bool load(std::string path);
+    void unload(std::string path);
+    Mix_Chunk *getChunk(std::string path);
+    int play(std::string path);
+    void closeAudio();
+    void setMaxInstances(unsigned int maxInstances);
+    unsigned int getDecodeCount();
+
+private:
+    struct Entry
+    {
+        Entry();
+        std::vector<Uint8> pcm;
+        int                frequency;   // audio spec the samples were decoded for
+        Uint16             format;
+        int                channels;
+        Mix_Chunk         *chunk;
+        unsigned int       users;
+        std::deque<int>    playing;     // mixer channels, oldest first
+    };
+
+    bool decode(std::string path, Entry &entry);
+    void freeChunk(Entry &entry);
+
+    std::map<std::string, Entry> entries_;
+    unsigned int maxInstances_;
+    unsigned int decodeCount_;
+};
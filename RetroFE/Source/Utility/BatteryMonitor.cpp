@@ -0,0 +1,201 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "BatteryMonitor.h"
+#include "Log.h"
+#include <cstdlib>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+BatterySnapshot::BatterySnapshot()
+    : valid(false)
+    , percentage(0)
+    , batteryConnected(false)
+    , usbConnected(false)
+{
+}
+
+
+BatteryMonitor::BatteryMonitor(std::string root)
+    : root_(root)
+    , polled_(false)
+    , snapshot_(std::make_shared<BatterySnapshot>())
+{
+    files_[FILE_CAPACITY]        = "axp20x-battery/capacity";
+    files_[FILE_BATTERY_PRESENT] = "axp20x-battery/present";
+    files_[FILE_USB_PRESENT]     = "axp20x-usb/present";
+
+    for(int i = 0; i < FILE_COUNT; i++)
+    {
+        fds_[i]        = -1;
+        openFailed_[i] = false;
+    }
+}
+
+
+BatteryMonitor::~BatteryMonitor()
+{
+    closeFiles();
+}
+
+
+BatteryMonitor &BatteryMonitor::getInstance()
+{
+    static BatteryMonitor instance;
+    return instance;
+}
+
+
+void BatteryMonitor::setRoot(std::string root)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if(root == root_) return;
+
+    root_ = root;
+    closeFiles();
+}
+
+
+void BatteryMonitor::setFile(File file, std::string path)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if(path == files_[file]) return;
+
+    files_[file] = path;
+    if(fds_[file] >= 0)
+    {
+        close(fds_[file]);
+        fds_[file] = -1;
+    }
+}
+
+
+std::string BatteryMonitor::getPath(File file)
+{
+    if(!files_[file].empty() && files_[file][0] == '/')
+    {
+        return files_[file];
+    }
+    return root_ + "/" + files_[file];
+}
+
+
+// Reads every value now, returns true if the published snapshot changed
+bool BatteryMonitor::poll()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::shared_ptr<BatterySnapshot> snapshot = std::make_shared<BatterySnapshot>();
+
+    snapshot->valid            = true;
+    snapshot->percentage       = readValue(FILE_CAPACITY);
+    snapshot->batteryConnected = (readValue(FILE_BATTERY_PRESENT) == 1);
+    snapshot->usbConnected     = (readValue(FILE_USB_PRESENT) == 1);
+
+    polled_   = true;
+    lastPoll_ = std::chrono::steady_clock::now();
+
+    if(snapshot_->valid &&
+       snapshot->percentage       == snapshot_->percentage &&
+       snapshot->batteryConnected == snapshot_->batteryConnected &&
+       snapshot->usbConnected     == snapshot_->usbConnected)
+    {
+        return false;
+    }
+
+    snapshot_ = snapshot;
+    return true;
+}
+
+
+// Polls if the last read is older than period seconds
+bool BatteryMonitor::refresh(float period)
+{
+    if(getNextPollTime(period) > 0) return false;
+
+    return poll();
+}
+
+
+// Seconds until the values are older than period
+float BatteryMonitor::getNextPollTime(float period)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if(!polled_) return 0;
+
+    std::chrono::duration<float> age = std::chrono::steady_clock::now() - lastPoll_;
+    return (age.count() < period) ? period - age.count() : 0;
+}
+
+
+std::shared_ptr<const BatterySnapshot> BatteryMonitor::getSnapshot()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    return snapshot_;
+}
+
+
+// Called with mutex_ held
+void BatteryMonitor::closeFiles()
+{
+    for(int i = 0; i < FILE_COUNT; i++)
+    {
+        if(fds_[i] >= 0)
+        {
+            close(fds_[i]);
+            fds_[i] = -1;
+        }
+        openFailed_[i] = false;
+    }
+}
+
+
+// Called with mutex_ held, returns -1 if the value could not be read
+int BatteryMonitor::readValue(File file)
+{
+    if(fds_[file] < 0)
+    {
+        fds_[file] = open(getPath(file).c_str(), O_RDONLY | O_CLOEXEC);
+        if(fds_[file] < 0)
+        {
+            if(!openFailed_[file])
+            {
+                Logger::write(Logger::ZONE_ERROR, "BatteryMonitor", "Could not open " + getPath(file));
+                openFailed_[file] = true;
+            }
+            return -1;
+        }
+        openFailed_[file] = false;
+    }
+
+    // sysfs regenerates the attribute on every read from offset 0
+    char buffer[32];
+    ssize_t size;
+    do
+    {
+        size = pread(fds_[file], buffer, sizeof(buffer) - 1, 0);
+    } while(size < 0 && errno == EINTR);
+
+    if(size <= 0)
+    {
+        // The device went away, open it again on the next poll
+        close(fds_[file]);
+        fds_[file] = -1;
+        return -1;
+    }
+
+    buffer[size] = '\0';
+    return atoi(buffer);
+}
@@ -0,0 +1,76 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#define BATTERY_SYSFS_ROOT  "/sys/class/power_supply"
+
+// Battery state read at one point in time, never modified once published
+struct BatterySnapshot
+{
+    BatterySnapshot();
+
+    bool valid;              // false until the first read
+    int  percentage;         // -1 if the capacity could not be read
+    bool batteryConnected;
+    bool usbConnected;
+};
+
+// Reads the power supply state from sysfs for every Battery component. The
+// files stay open and each value is read with a single pread(), and a new
+// snapshot is only published when a value changed.
+//
+// File paths are relative to the sysfs root, unless they are absolute.
+class BatteryMonitor
+{
+public:
+    enum File
+    {
+        FILE_CAPACITY,
+        FILE_BATTERY_PRESENT,
+        FILE_USB_PRESENT,
+        FILE_COUNT
+    };
+
+    BatteryMonitor(std::string root = BATTERY_SYSFS_ROOT);
+    virtual ~BatteryMonitor();
+    static BatteryMonitor &getInstance();
+
+    void setRoot(std::string root);
+    void setFile(File file, std::string path);
+    std::string getPath(File file);
+    bool poll();
+    bool refresh(float period);
+    float getNextPollTime(float period);
+    std::shared_ptr<const BatterySnapshot> getSnapshot();
+
+private:
+    void closeFiles();
+    int readValue(File file);
+
+    std::string root_;
+    std::string files_[FILE_COUNT];
+    int fds_[FILE_COUNT];
+    bool openFailed_[FILE_COUNT];    // logged once until the file opens again
+    bool polled_;
+    std::chrono::steady_clock::time_point lastPoll_;
+    std::mutex mutex_;
+    std::shared_ptr<const BatterySnapshot> snapshot_;
+};
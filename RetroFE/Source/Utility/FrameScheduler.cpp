@@ -0,0 +1,185 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FrameScheduler.h"
+#include <sstream>
+#include <cstring>
+#include <errno.h>
+#include <time.h>
+
+#define NSEC_PER_SEC    1000000000ULL
+#define NSEC_PER_MSEC   1000000ULL
+
+FrameScheduler::FrameScheduler(int fps, NowFunction now, SleepUntilFunction sleepUntil)
+    : now_(now)
+    , sleepUntil_(sleepUntil)
+    , period_(NSEC_PER_SEC / 60)
+    , deadline_(0)
+    , lastTick_(0)
+    , resynced_(true)
+    , maxFrameSkip_(3)
+    , skippedFrames_(0)
+    , histogramFrames_(0)
+{
+    setTargetFps(fps);
+    clearHistogram();
+    resync();
+    lastTick_ = deadline_;
+}
+
+
+void FrameScheduler::setTargetFps(int fps)
+{
+    if(fps > 0)
+    {
+        period_ = NSEC_PER_SEC / fps;
+    }
+}
+
+
+void FrameScheduler::setMaxFrameSkip(unsigned int maxFrameSkip)
+{
+    maxFrameSkip_ = maxFrameSkip;
+}
+
+
+// Frame period in seconds
+float FrameScheduler::getPeriod()
+{
+    return static_cast<float>(period_) / NSEC_PER_SEC;
+}
+
+
+// Restart the deadlines from now, e.g. after the loop has been blocked
+void FrameScheduler::resync()
+{
+    deadline_      = now_();
+    skippedFrames_ = 0;
+    resynced_      = true;
+}
+
+
+// Sleep until the next absolute frame deadline
+void FrameScheduler::waitFrame()
+{
+    deadline_ += period_;
+
+    uint64_t now = now_();
+    if(now < deadline_)
+    {
+        sleepUntil_(deadline_);
+    }
+    else if(now - deadline_ > period_ * (maxFrameSkip_ + 1))
+    {
+        // Too far behind to catch up, start over instead of running back to back frames
+        deadline_ = now;
+    }
+}
+
+
+// Start of a frame: returns the time elapsed since the previous one in seconds
+float FrameScheduler::tick()
+{
+    uint64_t now = now_();
+    uint64_t dt  = (now > lastTick_) ? now - lastTick_ : 0;
+
+    if(!resynced_)
+    {
+        unsigned int bucket = static_cast<unsigned int>(dt / (FRAME_HISTOGRAM_BUCKET_MS * NSEC_PER_MSEC));
+        if(bucket >= FRAME_HISTOGRAM_BUCKETS)
+        {
+            bucket = FRAME_HISTOGRAM_BUCKETS - 1;
+        }
+        histogram_[bucket]++;
+        histogramFrames_++;
+    }
+
+    resynced_ = false;
+    lastTick_ = now;
+
+    return static_cast<float>(dt) / NSEC_PER_SEC;
+}
+
+
+// Called once the frame has been updated: false when the next deadline has
+// already passed, so that drawing is skipped to catch up
+bool FrameScheduler::mustDraw()
+{
+    if(now_() >= deadline_ + period_ && skippedFrames_ < maxFrameSkip_)
+    {
+        skippedFrames_++;
+        return false;
+    }
+
+    skippedFrames_ = 0;
+    return true;
+}
+
+
+unsigned int FrameScheduler::getHistogramFrames()
+{
+    return histogramFrames_;
+}
+
+
+std::string FrameScheduler::getHistogram()
+{
+    std::stringstream ss;
+
+    for(unsigned int i = 0; i < FRAME_HISTOGRAM_BUCKETS; i++)
+    {
+        if(i > 0)
+        {
+            ss << " ";
+        }
+        if(i < FRAME_HISTOGRAM_BUCKETS - 1)
+        {
+            ss << i * FRAME_HISTOGRAM_BUCKET_MS << "-" << (i + 1) * FRAME_HISTOGRAM_BUCKET_MS << "ms:" << histogram_[i];
+        }
+        else
+        {
+            ss << i * FRAME_HISTOGRAM_BUCKET_MS << "+ms:" << histogram_[i];
+        }
+    }
+
+    return ss.str();
+}
+
+
+void FrameScheduler::clearHistogram()
+{
+    memset(histogram_, 0, sizeof(histogram_));
+    histogramFrames_ = 0;
+}
+
+
+uint64_t FrameScheduler::monotonicTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+
+void FrameScheduler::monotonicSleepUntil(uint64_t deadline)
+{
+    struct timespec ts;
+    ts.tv_sec  = static_cast<time_t>(deadline / NSEC_PER_SEC);
+    ts.tv_nsec = static_cast<long>(deadline % NSEC_PER_SEC);
+
+    // Restart after signals (e.g. SIGCHLD), the deadline is absolute
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+}
@@ -0,0 +1,59 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+#define FRAME_HISTOGRAM_BUCKET_MS   4
+#define FRAME_HISTOGRAM_BUCKETS     17
+
+// Paces the main loop on absolute frame deadlines taken from CLOCK_MONOTONIC,
+// so that sleep granularity does not accumulate into drift. The clock and the
+// sleep functions can be replaced, times are in nanoseconds.
+class FrameScheduler
+{
+public:
+    typedef uint64_t (*NowFunction)();
+    typedef void     (*SleepUntilFunction)(uint64_t deadline);
+
+    FrameScheduler(int fps = 60, NowFunction now = monotonicTime, SleepUntilFunction sleepUntil = monotonicSleepUntil);
+    void     setTargetFps(int fps);
+    void     setMaxFrameSkip(unsigned int maxFrameSkip);
+    float    getPeriod();
+    void     resync();
+    void     waitFrame();
+    float    tick();
+    bool     mustDraw();
+    unsigned int getHistogramFrames();
+    std::string  getHistogram();
+    void     clearHistogram();
+
+    static uint64_t monotonicTime();
+    static void     monotonicSleepUntil(uint64_t deadline);
+
+private:
+    NowFunction        now_;
+    SleepUntilFunction sleepUntil_;
+    uint64_t           period_;
+    uint64_t           deadline_;
+    uint64_t           lastTick_;
+    bool               resynced_;
+    unsigned int       maxFrameSkip_;
+    unsigned int       skippedFrames_;
+    unsigned int       histogram_[FRAME_HISTOGRAM_BUCKETS];
+    unsigned int       histogramFrames_;
+};
@@ -0,0 +1,366 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "HelperExecutor.h"
+#include "Log.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+HelperResult::HelperResult()
+    : started(false)
+    , status(-1)
+{
+}
+
+
+bool HelperResult::success() const
+{
+    return started && status == 0;
+}
+
+
+HelperExecutor::CacheEntry::CacheEntry()
+    : generation(0)
+    , pending(false)
+    , stale(false)
+{
+}
+
+
+HelperExecutor::HelperExecutor()
+    : generation_(0)
+    , stopping_(false)
+{
+    thread_ = std::thread(&HelperExecutor::worker, this);
+}
+
+
+HelperExecutor::~HelperExecutor()
+{
+    stop();
+}
+
+
+HelperExecutor &HelperExecutor::getInstance()
+{
+    static HelperExecutor instance;
+    return instance;
+}
+
+
+// Queues a command, typically one that changes the system state
+HelperExecutor::Future HelperExecutor::run(std::string command, Callback callback)
+{
+    Job job;
+    job.command       = command;
+    job.captureOutput = false;
+    job.generation    = 0;
+    if(callback) job.callbacks.push_back(callback);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    return enqueue(job);
+}
+
+
+// Runs an idempotent query and captures its output. Identical queries share the
+// pending process, and a result younger than maxAge seconds is reused.
+HelperExecutor::Future HelperExecutor::query(std::string command, float maxAge, Callback callback)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::map<std::string, CacheEntry>::iterator it = cache_.find(command);
+
+    if(it != cache_.end())
+    {
+        CacheEntry &entry = it->second;
+
+        if(entry.pending && !entry.stale)
+        {
+            if(callback) entry.callbacks.push_back(callback);
+            return entry.future;
+        }
+
+        // An invalidated run still going is a miss, its result is already out of date
+        std::chrono::duration<float> age = std::chrono::steady_clock::now() - entry.time;
+        if(!entry.pending && age.count() <= maxAge)
+        {
+            Future future = entry.future;
+            lock.unlock();
+            if(callback) callback(future.get());
+            return future;
+        }
+    }
+
+    Job job;
+    job.command       = command;
+    job.captureOutput = true;
+    job.generation    = ++generation_;
+
+    CacheEntry &entry = cache_[command];
+    // Callers still waiting on an invalidated run get this newer result instead
+    if(!entry.pending) entry.callbacks.clear();
+    entry.generation = job.generation;
+    entry.pending    = true;
+    entry.stale      = false;
+    if(callback) entry.callbacks.push_back(callback);
+    entry.future = enqueue(job);
+
+    return entry.future;
+}
+
+
+// Last completed result of a query, however old
+bool HelperExecutor::getCached(std::string command, HelperResult &result)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::map<std::string, CacheEntry>::iterator it = cache_.find(command);
+
+    if(it == cache_.end() || it->second.pending) return false;
+
+    result = it->second.future.get();
+    return true;
+}
+
+
+// Forgets the cached result of a query, after a command changed what it reports
+void HelperExecutor::invalidate(std::string command)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::map<std::string, CacheEntry>::iterator it = cache_.find(command);
+
+    if(it == cache_.end()) return;
+
+    if(it->second.pending)
+    {
+        it->second.stale = true;
+    }
+    else
+    {
+        cache_.erase(it);
+    }
+}
+
+
+// Finishes the current command and drops the queued ones
+void HelperExecutor::stop()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if(stopping_ && !thread_.joinable()) return;
+        stopping_ = true;
+    }
+    condition_.notify_all();
+
+    if(thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+
+// Called with mutex_ held
+HelperExecutor::Future HelperExecutor::enqueue(Job &job)
+{
+    job.promise = std::make_shared< std::promise<HelperResult> >();
+    Future future = job.promise->get_future().share();
+
+    if(stopping_)
+    {
+        job.promise->set_value(HelperResult());
+        return future;
+    }
+
+    jobs_.push_back(job);
+    condition_.notify_one();
+
+    return future;
+}
+
+
+void HelperExecutor::worker()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while(true)
+    {
+        condition_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+
+        if(stopping_)
+        {
+            // Queued commands are dropped, their futures report a failure
+            for(std::deque<Job>::iterator it = jobs_.begin(); it != jobs_.end(); ++it)
+            {
+                it->promise->set_value(HelperResult());
+            }
+            jobs_.clear();
+            for(std::map<std::string, CacheEntry>::iterator it = cache_.begin(); it != cache_.end(); ++it)
+            {
+                it->second.pending = false;
+            }
+            return;
+        }
+
+        Job job = jobs_.front();
+        jobs_.pop_front();
+
+        lock.unlock();
+        HelperResult result = execute(job.command, job.captureOutput);
+        lock.lock();
+
+        job.promise->set_value(result);
+
+        std::vector<Callback> callbacks = job.callbacks;
+        if(job.generation)
+        {
+            std::map<std::string, CacheEntry>::iterator it = cache_.find(job.command);
+            if(it != cache_.end() && it->second.generation == job.generation)
+            {
+                it->second.pending = false;
+                it->second.time    = std::chrono::steady_clock::now();
+                callbacks.insert(callbacks.end(), it->second.callbacks.begin(), it->second.callbacks.end());
+                it->second.callbacks.clear();
+                if(it->second.stale) cache_.erase(it);
+            }
+        }
+
+        lock.unlock();
+        for(unsigned int i = 0; i < callbacks.size(); i++)
+        {
+            callbacks[i](result);
+        }
+        lock.lock();
+    }
+}
+
+
+// Splits a command into its arguments, falling back to /bin/sh -c when it uses
+// quoting, redirections, variables or any other shell feature
+std::vector<std::string> HelperExecutor::parse(std::string command)
+{
+    std::vector<std::string> argv;
+
+    if(command.find_first_of("|&;<>()$`\\\"'*?[]#~={}%!\n") != std::string::npos)
+    {
+        argv.push_back("/bin/sh");
+        argv.push_back("-c");
+        argv.push_back(command);
+        return argv;
+    }
+
+    std::string::size_type start = command.find_first_not_of(" \t");
+    while(start != std::string::npos)
+    {
+        std::string::size_type end = command.find_first_of(" \t", start);
+        argv.push_back(command.substr(start, end - start));
+        start = command.find_first_not_of(" \t", end);
+    }
+
+    return argv;
+}
+
+
+HelperResult HelperExecutor::execute(std::string command, bool captureOutput)
+{
+    return execute(parse(command), captureOutput);
+}
+
+
+// Spawns argv (looked up in PATH), waits for it and returns its exit status
+HelperResult HelperExecutor::execute(std::vector<std::string> argv, bool captureOutput)
+{
+    HelperResult result;
+    int pipeFd[2] = { -1, -1 };
+    posix_spawn_file_actions_t actions;
+    std::vector<char *> args;
+    pid_t pid;
+
+    if(argv.empty()) return result;
+
+    for(unsigned int i = 0; i < argv.size(); i++)
+    {
+        args.push_back(const_cast<char *>(argv[i].c_str()));
+    }
+    args.push_back(NULL);
+
+    posix_spawn_file_actions_init(&actions);
+
+    if(captureOutput)
+    {
+        // close-on-exec, so helpers spawned meanwhile by other threads do not keep it open
+        if(pipe2(pipeFd, O_CLOEXEC) != 0)
+        {
+            posix_spawn_file_actions_destroy(&actions);
+            return result;
+        }
+        posix_spawn_file_actions_adddup2(&actions, pipeFd[1], STDOUT_FILENO);
+        posix_spawn_file_actions_addclose(&actions, pipeFd[0]);
+        posix_spawn_file_actions_addclose(&actions, pipeFd[1]);
+    }
+
+    int error = posix_spawnp(&pid, args[0], &actions, NULL, &args[0], environ);
+    posix_spawn_file_actions_destroy(&actions);
+
+    if(captureOutput)
+    {
+        close(pipeFd[1]);
+    }
+
+    if(error != 0)
+    {
+        Logger::write(Logger::ZONE_ERROR, "HelperExecutor", "Failed to run: " + argv[0] + " (" + strerror(error) + ")");
+        if(captureOutput) close(pipeFd[0]);
+        return result;
+    }
+
+    result.started = true;
+
+    if(captureOutput)
+    {
+        char buffer[256];
+        ssize_t count;
+
+        while((count = read(pipeFd[0], buffer, sizeof(buffer))) != 0)
+        {
+            if(count < 0)
+            {
+                if(errno == EINTR) continue;
+                break;
+            }
+            result.output.append(buffer, count);
+        }
+        close(pipeFd[0]);
+    }
+
+    int status;
+    while(waitpid(pid, &status, 0) < 0)
+    {
+        if(errno != EINTR)
+        {
+            return result;
+        }
+    }
+
+    if(WIFEXITED(status))
+    {
+        result.status = WEXITSTATUS(status);
+    }
+
+    return result;
+}
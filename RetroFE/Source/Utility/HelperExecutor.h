@@ -0,0 +1,97 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Outcome of a helper command
+struct HelperResult
+{
+    HelperResult();
+    bool success() const;
+
+    bool        started;  // the process could be spawned
+    int         status;   // exit code, -1 if it did not exit normally
+    std::string output;   // standard output, for queries only
+};
+
+// Runs the shell helpers (volume, brightness, audio_amp, share...) in order on a
+// worker thread, so the render thread never waits for a fork and exec. Commands
+// whose arguments need no shell are spawned directly, without /bin/sh.
+//
+// Callbacks are invoked on the worker thread, or right away on the calling
+// thread when a query is answered from the cache.
+class HelperExecutor
+{
+public:
+    typedef std::shared_future<HelperResult> Future;
+    typedef std::function<void (const HelperResult &)> Callback;
+
+    HelperExecutor();
+    virtual ~HelperExecutor();
+    static HelperExecutor &getInstance();
+
+    Future run(std::string command, Callback callback = Callback());
+    Future query(std::string command, float maxAge, Callback callback = Callback());
+    bool getCached(std::string command, HelperResult &result);
+    void invalidate(std::string command);
+    void stop();
+
+    static HelperResult execute(std::string command, bool captureOutput);
+    static HelperResult execute(std::vector<std::string> argv, bool captureOutput);
+    static std::vector<std::string> parse(std::string command);
+
+private:
+    struct Job
+    {
+        std::string command;
+        bool captureOutput;
+        unsigned int generation;   // 0 for jobs that are not cached
+        std::shared_ptr< std::promise<HelperResult> > promise;
+        std::vector<Callback> callbacks;
+    };
+
+    struct CacheEntry
+    {
+        CacheEntry();
+        Future future;
+        unsigned int generation;
+        bool pending;
+        bool stale;      // invalidated while pending, the result is not kept
+        std::chrono::steady_clock::time_point time;
+        std::vector<Callback> callbacks;
+    };
+
+    Future enqueue(Job &job);
+    void worker();
+
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::deque<Job> jobs_;
+    std::map<std::string, CacheEntry> cache_;
+    unsigned int generation_;
+    bool stopping_;
+    std::thread thread_;
+};
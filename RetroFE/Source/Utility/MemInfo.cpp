@@ -0,0 +1,121 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "MemInfo.h"
+#include "Log.h"
+#include <cstdio>
+#include <cstring>
+
+
+MemInfo::MemInfo()
+    : total_(0)
+    , free_(0)
+    , buffers_(0)
+    , cached_(0)
+    , available_(0)
+    , hasAvailable_(false)
+{
+}
+
+
+bool MemInfo::read(std::string path)
+{
+    FILE *fp = fopen(path.c_str(), "r");
+    if(!fp)
+    {
+        Logger::write(Logger::ZONE_WARNING, "MemInfo", "Could not open " + path);
+        return false;
+    }
+
+    total_        = 0;
+    free_         = 0;
+    buffers_      = 0;
+    cached_       = 0;
+    available_    = 0;
+    hasAvailable_ = false;
+
+    char line[256];
+    char key[64];
+    unsigned long value;
+    bool found = false;
+    while(fgets(line, sizeof(line), fp))
+    {
+        if(sscanf(line, "%63s %lu", key, &value) != 2)
+        {
+            continue;
+        }
+
+        found = true;
+        if(!strcmp(key, "MemTotal:"))
+        {
+            total_ = value;
+        }
+        else if(!strcmp(key, "MemFree:"))
+        {
+            free_ = value;
+        }
+        else if(!strcmp(key, "Buffers:"))
+        {
+            buffers_ = value;
+        }
+        else if(!strcmp(key, "Cached:"))
+        {
+            cached_ = value;
+        }
+        else if(!strcmp(key, "MemAvailable:"))
+        {
+            available_    = value;
+            hasAvailable_ = true;
+        }
+    }
+    fclose(fp);
+
+    if(!found)
+    {
+        Logger::write(Logger::ZONE_WARNING, "MemInfo", "Could not parse " + path);
+    }
+
+    return found;
+}
+
+
+unsigned long MemInfo::getTotal()
+{
+    return total_;
+}
+
+
+// Kernels before 3.14 have no MemAvailable, so estimate it from the free
+// memory and the page cache that can be dropped
+unsigned long MemInfo::getAvailable()
+{
+    if(hasAvailable_)
+    {
+        return available_;
+    }
+
+    return free_ + buffers_ + cached_;
+}
+
+
+bool MemInfo::hasAvailable(unsigned long minMegabytes, std::string path)
+{
+    if(!read(path))
+    {
+        return false;
+    }
+
+    return getAvailable() >= minMegabytes * 1024;
+}
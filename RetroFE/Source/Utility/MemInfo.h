@@ -0,0 +1,39 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <string>
+
+#define MEMINFO_PATH  "/proc/meminfo"
+
+// Memory figures from /proc/meminfo, in kB
+class MemInfo
+{
+public:
+    MemInfo();
+    bool read(std::string path = MEMINFO_PATH);
+    unsigned long getTotal();
+    unsigned long getAvailable();
+    bool hasAvailable(unsigned long minMegabytes, std::string path = MEMINFO_PATH);
+
+private:
+    unsigned long total_;
+    unsigned long free_;
+    unsigned long buffers_;
+    unsigned long cached_;
+    unsigned long available_;
+    bool          hasAvailable_;
+};
@@ -287,6 +287,74 @@ std::string Utils::trimEnds(std::string str)
 
     return str;
 }
+
+
+// Returns the code point starting at position and moves position past it.
+// Bytes that are not valid UTF-8 are taken as Latin-1, so lists written in
+// that encoding still show their accented letters.
+unsigned int Utils::decodeUtf8(const std::string &str, size_t &position)
+{
+    unsigned char lead = static_cast<unsigned char>(str[position]);
+    size_t        length;
+    unsigned int  codepoint;
+    unsigned int  minimum;
+
+    if(lead < 0x80)
+    {
+        position++;
+        return lead;
+    }
+    else if((lead & 0xe0) == 0xc0)
+    {
+        length    = 2;
+        codepoint = lead & 0x1f;
+        minimum   = 0x80;
+    }
+    else if((lead & 0xf0) == 0xe0)
+    {
+        length    = 3;
+        codepoint = lead & 0x0f;
+        minimum   = 0x800;
+    }
+    else if((lead & 0xf8) == 0xf0)
+    {
+        length    = 4;
+        codepoint = lead & 0x07;
+        minimum   = 0x10000;
+    }
+    else
+    {
+        position++;
+        return lead;
+    }
+
+    if(position + length > str.size())
+    {
+        position++;
+        return lead;
+    }
+
+    for(size_t i = 1; i < length; i++)
+    {
+        unsigned char next = static_cast<unsigned char>(str[position + i]);
+        if((next & 0xc0) != 0x80)
+        {
+            position++;
+            return lead;
+        }
+        codepoint = (codepoint << 6) | (next & 0x3f);
+    }
+
+    // Overlong forms, surrogates and values past Unicode are not UTF-8 either
+    if(codepoint < minimum || codepoint > 0x10ffff || (codepoint >= 0xd800 && codepoint <= 0xdfff))
+    {
+        position++;
+        return lead;
+    }
+
+    position += length;
+    return codepoint;
+}
  
 bool Utils::IsPathExist(const std::string &s)
 {
@@ -294,6 +362,35 @@ bool Utils::IsPathExist(const std::string &s)
     return (stat (s.c_str(), &buffer) == 0);
 }
 
+// Creates the directory and its missing parents
+bool Utils::createDirectories(std::string directory)
+{
+    struct stat info;
+    if(stat(directory.c_str(), &info) == 0)
+    {
+        if(!S_ISDIR(info.st_mode))
+        {
+            Logger::write(Logger::ZONE_WARNING, "Utils", directory + " exists, but is not a directory.");
+            return false;
+        }
+        return true;
+    }
+
+    size_t position = directory.find_last_of("/");
+    if(position != std::string::npos && position > 0 && !Utils::createDirectories(directory.substr(0, position)))
+    {
+        return false;
+    }
+
+    if(mkdir(directory.c_str(), 0755) == -1 && errno != EEXIST)
+    {
+        Logger::write(Logger::ZONE_WARNING, "Utils", "Could not create directory " + directory);
+        return false;
+    }
+
+    return true;
+}
+
 bool Utils::executeRawPath(const char *shellCmd)
 {
     bool retVal = false;
@@ -46,6 +46,7 @@ public:
     static std::string uppercaseFirst(std::string str);
     static std::string filterComments(std::string line);
     static std::string trimEnds(std::string str);
+    static unsigned int decodeUtf8(const std::string &str, size_t &position);
 
     //todo: there has to be a better way to do this
     static std::string combinePath(std::list<std::string> &paths);
@@ -55,6 +56,7 @@ public:
     static std::string combinePath(std::string path1, std::string path2, std::string path3, std::string path4, std::string path5);
   
     static bool IsPathExist(const std::string &s);
+    static bool createDirectories(std::string directory);
     static bool executeRawPath(const char *shellCmd);
     static bool rootfsWritable();
     static bool rootfsReadOnly();
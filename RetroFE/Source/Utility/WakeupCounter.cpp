@@ -0,0 +1,69 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "WakeupCounter.h"
+
+WakeupCounter::WakeupCounter(float window)
+    : window_(window)
+    , windowStart_(0)
+    , windowCount_(0)
+    , total_(0)
+    , rate_(0)
+{
+}
+
+
+void WakeupCounter::reset(float now)
+{
+    windowStart_ = now;
+    windowCount_ = 0;
+    total_       = 0;
+    rate_        = 0;
+}
+
+
+// Record a wakeup. Returns true when a window has been closed and a new
+// rate is available through getRate().
+bool WakeupCounter::wakeup(float now)
+{
+    bool windowDone = false;
+    float elapsed   = now - windowStart_;
+
+    if(elapsed >= window_)
+    {
+        rate_        = static_cast<float>(windowCount_) / elapsed;
+        windowStart_ = now;
+        windowCount_ = 0;
+        windowDone   = true;
+    }
+
+    windowCount_++;
+    total_++;
+
+    return windowDone;
+}
+
+
+float WakeupCounter::getRate()
+{
+    return rate_;
+}
+
+
+unsigned int WakeupCounter::getTotal()
+{
+    return total_;
+}
@@ -0,0 +1,35 @@
+/* This file is part of RetroFE.
+ *
+ * RetroFE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RetroFE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RetroFE.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+// Counts how many times the main loop wakes up, averaged over windows of
+// at least one second. Times are expressed in seconds.
+class WakeupCounter
+{
+public:
+    WakeupCounter(float window = 1.0f);
+    void  reset(float now);
+    bool  wakeup(float now);
+    float getRate();
+    unsigned int getTotal();
+
+private:
+    float        window_;
+    float        windowStart_;
+    unsigned int windowCount_;
+    unsigned int total_;
+    float        rate_;
+};
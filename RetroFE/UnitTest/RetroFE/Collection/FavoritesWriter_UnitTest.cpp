@@ -0,0 +1,146 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <Collection/FavoritesWriter.h>
+#include <chrono>
+#include <fstream>
+#include <signal.h>
+#include <sstream>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+class FavoritesWriterTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        char dir[] = "/tmp/FavoritesWriterTest.XXXXXX";
+        ASSERT_TRUE(mkdtemp(dir) != NULL);
+        root = dir;
+    }
+
+    virtual void TearDown()
+    {
+        system(("rm -rf " + root).c_str());
+    }
+
+    std::string read(std::string file)
+    {
+        std::ifstream ifs(file.c_str());
+        std::stringstream ss;
+        ss << ifs.rdbuf();
+        return ss.str();
+    }
+
+    bool exists(std::string file)
+    {
+        return access(file.c_str(), F_OK) == 0;
+    }
+
+    std::string root;
+};
+
+TEST_F(FavoritesWriterTest, PathIsBelowTheDirectory)
+{
+    FavoritesWriter writer;
+    writer.setDirectory(root, false);
+
+    ASSERT_EQ(root + "/Arcade/favorites.txt", writer.getPath("Arcade"));
+}
+
+TEST_F(FavoritesWriterTest, SaveIsWrittenAfterTheDelay)
+{
+    FavoritesWriter writer;
+    writer.setDirectory(root, false);
+    writer.setDelay(0.1f);
+    writer.start();
+
+    writer.save("Arcade", "pacman\n");
+    ASSERT_TRUE(writer.isPending("Arcade"));
+    ASSERT_FALSE(exists(writer.getPath("Arcade")));
+
+    for(int i = 0; i < 200 && writer.isPending("Arcade"); i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    ASSERT_FALSE(writer.isPending("Arcade"));
+    ASSERT_EQ("pacman\n", read(writer.getPath("Arcade")));
+}
+
+TEST_F(FavoritesWriterTest, SavesAreCoalesced)
+{
+    FavoritesWriter writer;
+    writer.setDirectory(root, false);
+    writer.setDelay(60);
+    writer.start();
+
+    writer.save("Arcade", "pacman\n");
+    writer.save("Arcade", "pacman\ngalaga\n");
+    writer.save("NES", "zelda\n");
+    ASSERT_FALSE(exists(writer.getPath("Arcade")));
+
+    ASSERT_TRUE(writer.flush());
+    ASSERT_FALSE(writer.isPending("Arcade"));
+    ASSERT_FALSE(writer.isPending("NES"));
+    ASSERT_EQ("pacman\ngalaga\n", read(writer.getPath("Arcade")));
+    ASSERT_EQ("zelda\n", read(writer.getPath("NES")));
+    ASSERT_FALSE(exists(writer.getPath("Arcade") + ".tmp"));
+}
+
+TEST_F(FavoritesWriterTest, StopWritesPendingSaves)
+{
+    FavoritesWriter writer;
+    writer.setDirectory(root + "/user/favorites", false);
+    writer.setDelay(60);
+    writer.start();
+
+    writer.save("Arcade", "pacman\n");
+    writer.stop();
+
+    ASSERT_EQ("pacman\n", read(writer.getPath("Arcade")));
+}
+
+TEST_F(FavoritesWriterTest, FailedSaveStaysPending)
+{
+    std::ofstream((root + "/Arcade").c_str()) << "not a directory";
+
+    FavoritesWriter writer;
+    writer.setDirectory(root, false);
+
+    writer.save("Arcade", "pacman\n");
+    ASSERT_FALSE(writer.flush());
+    ASSERT_TRUE(writer.isPending("Arcade"));
+}
+
+// A process killed while writing leaves either the previous or the new
+// playlist, never a truncated one
+TEST_F(FavoritesWriterTest, KilledWriterLeavesACompleteFile)
+{
+    std::string file = root + "/favorites.txt";
+    std::string first(256 * 1024, 'a');
+    std::string second(192 * 1024, 'b');
+    ASSERT_TRUE(FavoritesWriter::writeFile(file, first));
+
+    for(int i = 0; i < 20; i++)
+    {
+        pid_t pid = fork();
+        ASSERT_NE(-1, pid);
+
+        if(pid == 0)
+        {
+            for(int n = 0; ; n++)
+            {
+                FavoritesWriter::writeFile(file, (n % 2) ? first : second);
+            }
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(500 + 1500 * i));
+        kill(pid, SIGKILL);
+        waitpid(pid, NULL, 0);
+
+        std::string contents = read(file);
+        ASSERT_TRUE(contents == first || contents == second) << "size " << contents.size();
+    }
+}
@@ -0,0 +1,96 @@
+#include <Graphics/AlphaBlit.h>
+#include <chrono>
+#include <cstring>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#define WIDTH   1000
+#define HEIGHT  1000
+#define RUNS    20
+#define ALPHA   200
+
+typedef void (*BlitFunction)(uint32_t *dst, const uint32_t *src, int count);
+
+static void opaqueCopy(uint32_t *dst, const uint32_t *src, int count)
+{
+    memcpy(dst, src, count * sizeof(uint32_t));
+}
+
+static void keyed(uint32_t *dst, const uint32_t *src, int count)
+{
+    AlphaBlit::blendKeyed(dst, src, count, 4, 0xff00ff, 0xffffff, 255);
+}
+
+static void constant(uint32_t *dst, const uint32_t *src, int count)
+{
+    AlphaBlit::blendConstant(dst, src, count, ALPHA);
+}
+
+// What SDL 1.2 does per pixel for a straight alpha source
+static void straightScalar(uint32_t *dst, const uint32_t *src, int count)
+{
+    for(int i = 0; i < count; ++i)
+    {
+        uint32_t s = src[i];
+        uint32_t d = dst[i];
+        int a = ((s >> 24) * ALPHA) >> 8;
+        uint32_t out = 0;
+        for(int shift = 0; shift < 24; shift += 8)
+        {
+            int sc = (s >> shift) & 0xff;
+            int dc = (d >> shift) & 0xff;
+            out |= static_cast<uint32_t>(dc + (((sc - dc) * a) >> 8)) << shift;
+        }
+        dst[i] = out;
+    }
+}
+
+static void premultipliedScalar(uint32_t *dst, const uint32_t *src, int count)
+{
+    AlphaBlit::blendPremultipliedScalar(dst, src, count, 24, ALPHA);
+}
+
+static void premultiplied(uint32_t *dst, const uint32_t *src, int count)
+{
+    AlphaBlit::blendPremultiplied(dst, src, count, 24, ALPHA);
+}
+
+// Cost of drawing a full screen texture through each path, per megapixel
+int main()
+{
+    const char *names[] = { "opaque copy", "colour key", "constant alpha", "straight scalar",
+                            "premult scalar", "premultiplied" };
+    BlitFunction functions[] = { opaqueCopy, keyed, constant, straightScalar, premultipliedScalar, premultiplied };
+
+    std::vector<uint32_t> source(WIDTH * HEIGHT);
+    std::vector<uint32_t> premultipliedSource(WIDTH * HEIGHT);
+    std::vector<uint32_t> frame(WIDTH * HEIGHT);
+    AlphaBlit::Layout layout = { 16, 8, 0, 24 };
+    for(unsigned int i = 0; i < source.size(); ++i)
+    {
+        source[i] = (static_cast<uint32_t>(rand()) << 16) ^ static_cast<uint32_t>(rand());
+        frame[i] = source[i] & 0xffffff;
+    }
+    AlphaBlit::premultiply(&source[0], layout, &premultipliedSource[0], layout, WIDTH * HEIGHT);
+
+    printf("kernels: %s\n", AlphaBlit::getKernelName());
+    for(unsigned int f = 0; f < 6; ++f)
+    {
+        const uint32_t *src = f >= 4 ? &premultipliedSource[0] : &source[0];
+        double total = 0;
+        for(int run = 0; run < RUNS; ++run)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for(int y = 0; y < HEIGHT; ++y)
+            {
+                functions[f](&frame[y * WIDTH], src + y * WIDTH, WIDTH);
+            }
+            auto end = std::chrono::steady_clock::now();
+            total += std::chrono::duration<double, std::milli>(end - start).count();
+        }
+        printf("%-16s %8.2f ms/Mpx\n", names[f], total / RUNS);
+    }
+
+    return 0;
+}
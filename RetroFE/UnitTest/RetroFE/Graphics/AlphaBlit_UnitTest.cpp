@@ -0,0 +1,238 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <Graphics/AlphaBlit.h>
+#include <cstdlib>
+#include <vector>
+
+#define SCENE_WIDTH   37
+#define SCENE_HEIGHT  23
+
+// A gradient background kept in the window's XRGB layout, and a round
+// translucent sprite as loaded from a PNG (red in the low byte)
+class AlphaBlitTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        srand(4321);
+        for(int y = 0; y < SCENE_HEIGHT; ++y)
+        {
+            for(int x = 0; x < SCENE_WIDTH; ++x)
+            {
+                unsigned int r = x * 255 / (SCENE_WIDTH - 1);
+                unsigned int g = y * 255 / (SCENE_HEIGHT - 1);
+                unsigned int b = (x * y) & 0xff;
+                background.push_back((r << 16) | (g << 8) | b);
+
+                int dx = 2 * x - SCENE_WIDTH;
+                int dy = 2 * y - SCENE_HEIGHT;
+                int distance = dx * dx + dy * dy;
+                int radius = SCENE_HEIGHT * SCENE_HEIGHT;
+                unsigned int a = distance >= radius ? 0 : 255 - distance * 255 / radius;
+                sprite.push_back((a << 24) | ((x * 7 & 0xff) << 16) | (0xc0 << 8) | (y * 11 & 0xff));
+            }
+        }
+    }
+
+    static const AlphaBlit::Layout &png()
+    {
+        static const AlphaBlit::Layout layout = { 0, 8, 16, 24 };
+        return layout;
+    }
+
+    static const AlphaBlit::Layout &window()
+    {
+        static const AlphaBlit::Layout layout = { 16, 8, 0, 24 };
+        return layout;
+    }
+
+    static std::vector<uint32_t> randomPixels(int count)
+    {
+        std::vector<uint32_t> pixels(count);
+        for(int i = 0; i < count; ++i)
+        {
+            pixels[i] = (static_cast<uint32_t>(rand()) << 16) ^ static_cast<uint32_t>(rand());
+        }
+        return pixels;
+    }
+
+    // Valid premultiplied pixels: no channel above the alpha
+    static std::vector<uint32_t> randomPremultiplied(int count, int aShift)
+    {
+        std::vector<uint32_t> pixels = randomPixels(count);
+        for(int i = 0; i < count; ++i)
+        {
+            unsigned int a = (pixels[i] >> aShift) & 0xff;
+            uint32_t p = a << aShift;
+            for(int shift = 0; shift < 32; shift += 8)
+            {
+                if(shift != aShift)
+                {
+                    p |= (((pixels[i] >> shift) & 0xff) * a / 255) << shift;
+                }
+            }
+            pixels[i] = p;
+        }
+        return pixels;
+    }
+
+    std::vector<uint32_t> background;
+    std::vector<uint32_t> sprite;
+};
+
+TEST_F(AlphaBlitTest, Classify)
+{
+    uint32_t pixels[4] = { 0xff102030, 0xff405060, 0xff708090, 0xffa0b0c0 };
+
+    ASSERT_EQ(AlphaBlit::ALPHA_OPAQUE, AlphaBlit::classify(pixels, 2, 2, 8, 24));
+
+    pixels[3] = 0x00a0b0c0;
+    ASSERT_EQ(AlphaBlit::ALPHA_BINARY, AlphaBlit::classify(pixels, 2, 2, 8, 24));
+
+    // Only the given width of each row counts
+    pixels[1] = 0x80405060;
+    ASSERT_EQ(AlphaBlit::ALPHA_OPAQUE, AlphaBlit::classify(pixels, 1, 2, 8, 24));
+    ASSERT_EQ(AlphaBlit::ALPHA_TRANSLUCENT, AlphaBlit::classify(pixels, 2, 2, 8, 24));
+
+    // Alpha in the low byte
+    uint32_t low[2] = { 0x102030ff, 0x40506000 };
+    ASSERT_EQ(AlphaBlit::ALPHA_BINARY, AlphaBlit::classify(low, 2, 1, 8, 0));
+}
+
+TEST_F(AlphaBlitTest, PremultiplyMovesChannels)
+{
+    uint32_t src[3] = { 0xff332211, 0x80ff8000, 0x00ffffff };
+    uint32_t dst[3];
+
+    AlphaBlit::premultiply(src, png(), dst, window(), 3);
+
+    ASSERT_EQ(0xff112233u, dst[0]);
+    ASSERT_EQ(0x80004080u, dst[1]);
+    ASSERT_EQ(0x00000000u, dst[2]);
+}
+
+TEST_F(AlphaBlitTest, ColorKey)
+{
+    uint32_t alpha[4] = { 0xff000000, 0x00000000, 0xff000000, 0x00000000 };
+    uint16_t pixels[4] = { 0x1234, 0x5678, 0xf81f, 0x9abc };
+
+    // A visible pixel already has that color, nothing is written
+    ASSERT_FALSE(AlphaBlit::applyColorKey(alpha, 16, 24, pixels, 8, 2, 4, 1, 0xf81f, 0xffff));
+    ASSERT_EQ(0x5678, pixels[1]);
+
+    ASSERT_TRUE(AlphaBlit::applyColorKey(alpha, 16, 24, pixels, 8, 2, 4, 1, 0xf81e, 0xffff));
+    ASSERT_EQ(0x1234, pixels[0]);
+    ASSERT_EQ(0xf81e, pixels[1]);
+    ASSERT_EQ(0xf81f, pixels[2]);
+    ASSERT_EQ(0xf81e, pixels[3]);
+}
+
+TEST_F(AlphaBlitTest, KeyedSkipsKey)
+{
+    uint16_t src16[5] = { 0xf81f, 0x1234, 0x5678, 0xf81f, 0x9abc };
+    uint16_t dst16[5] = { 0, 0, 0, 0, 0 };
+    AlphaBlit::blendKeyed(dst16, src16, 5, 2, 0xf81f, 0xffff, 255);
+    ASSERT_EQ(0, dst16[0]);
+    ASSERT_EQ(0x1234, dst16[1]);
+    ASSERT_EQ(0x5678, dst16[2]);
+    ASSERT_EQ(0, dst16[3]);
+    ASSERT_EQ(0x9abc, dst16[4]);
+
+    // The unused byte of the window format is not part of the key
+    uint32_t src32[4] = { 0xaaff00ff, 0x00123456, 0x00ff00ff, 0x00808080 };
+    uint32_t dst32[4] = { 0x00404040, 0x00404040, 0x00404040, 0x00404040 };
+    AlphaBlit::blendKeyed(dst32, src32, 4, 4, 0xff00ff, 0xffffff, 255);
+    ASSERT_EQ(0x00404040u, dst32[0]);
+    ASSERT_EQ(0x00123456u, dst32[1]);
+    ASSERT_EQ(0x00404040u, dst32[2]);
+    ASSERT_EQ(0x00808080u, dst32[3]);
+
+    // Visible pixels fade with the global alpha
+    AlphaBlit::blendKeyed(dst32, src32, 4, 4, 0xff00ff, 0xffffff, 0);
+    ASSERT_EQ(0x00808080u, dst32[3]);
+    dst32[3] = 0;
+    AlphaBlit::blendKeyed(dst32, src32, 4, 4, 0xff00ff, 0xffffff, 128);
+    ASSERT_EQ(0x00404040u, dst32[3]);
+    ASSERT_EQ(0x00404040u, dst32[0]);
+}
+
+TEST_F(AlphaBlitTest, VectorKernelsMatchScalar)
+{
+    // Every length around the vector width, from unaligned pointers
+    for(int count = 0; count < 40; ++count)
+    {
+        uint8_t globalAlpha = count % 3 ? static_cast<uint8_t>(rand()) : 255;
+        std::vector<uint32_t> dst = randomPixels(50);
+        std::vector<uint32_t> src = randomPixels(50);
+
+        std::vector<uint32_t> expected = dst;
+        AlphaBlit::blendConstantScalar(&expected[1], &src[3], count, globalAlpha);
+        std::vector<uint32_t> actual = dst;
+        AlphaBlit::blendConstant(&actual[1], &src[3], count, globalAlpha);
+        ASSERT_EQ(expected, actual) << "constant, count " << count << " with " << AlphaBlit::getKernelName();
+
+        for(int aShift = 0; aShift < 32; aShift += 8)
+        {
+            src = randomPremultiplied(50, aShift);
+            expected = dst;
+            AlphaBlit::blendPremultipliedScalar(&expected[1], &src[3], count, aShift, globalAlpha);
+            actual = dst;
+            AlphaBlit::blendPremultiplied(&actual[1], &src[3], count, aShift, globalAlpha);
+            ASSERT_EQ(expected, actual) << "premultiplied, count " << count << ", alpha at " << aShift
+                                        << " with " << AlphaBlit::getKernelName();
+        }
+    }
+}
+
+TEST_F(AlphaBlitTest, PremultipliedMatchesStraightAlpha)
+{
+    uint8_t levels[] = { 255, 200, 64, 0 };
+    std::vector<uint32_t> premultiplied(sprite.size());
+    AlphaBlit::premultiply(&sprite[0], png(), &premultiplied[0], window(), static_cast<int>(sprite.size()));
+
+    for(unsigned int level = 0; level < 4; ++level)
+    {
+        std::vector<uint32_t> frame = background;
+        for(int y = 0; y < SCENE_HEIGHT; ++y)
+        {
+            AlphaBlit::blendPremultiplied(&frame[y * SCENE_WIDTH], &premultiplied[y * SCENE_WIDTH], SCENE_WIDTH, 24, levels[level]);
+        }
+
+        // Against straight alpha in floating point, the channels moving
+        // from the PNG's order to the window's
+        for(unsigned int i = 0; i < frame.size(); ++i)
+        {
+            float a = (sprite[i] >> 24) / 255.0f * levels[level] / 255.0f;
+            for(int c = 0; c < 3; ++c)
+            {
+                float s = (sprite[i] >> (png().rShift + 8 * c)) & 0xff;
+                float d = (background[i] >> (window().rShift - 8 * c)) & 0xff;
+                float out = (frame[i] >> (window().rShift - 8 * c)) & 0xff;
+                ASSERT_NEAR(s * a + d * (1.0f - a), out, 2.0f) << "pixel " << i << ", level " << levels[level];
+            }
+        }
+    }
+}
+
+TEST_F(AlphaBlitTest, ConstantMatchesStraightAlpha)
+{
+    uint8_t levels[] = { 255, 128, 1 };
+
+    for(unsigned int level = 0; level < 3; ++level)
+    {
+        std::vector<uint32_t> frame = background;
+        std::vector<uint32_t> opaque = randomPixels(SCENE_WIDTH * SCENE_HEIGHT);
+        AlphaBlit::blendConstant(&frame[0], &opaque[0], static_cast<int>(frame.size()), levels[level]);
+
+        for(unsigned int i = 0; i < frame.size(); ++i)
+        {
+            float a = levels[level] / 255.0f;
+            for(int shift = 0; shift < 24; shift += 8)
+            {
+                float s = (opaque[i] >> shift) & 0xff;
+                float d = (background[i] >> shift) & 0xff;
+                ASSERT_NEAR(s * a + d * (1.0f - a), (frame[i] >> shift) & 0xff, 0.5f) << "pixel " << i;
+            }
+        }
+    }
+}
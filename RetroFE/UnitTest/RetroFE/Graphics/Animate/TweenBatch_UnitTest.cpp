@@ -0,0 +1,285 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <Graphics/Animate/TweenBatch.h>
+#include <Graphics/Animate/TweenSet.h>
+#include <Graphics/Animate/Tween.h>
+#include <Graphics/ViewInfo.h>
+#include <vector>
+
+// Component::animate as it was before the batch, for the properties used below
+class ReferenceAnimator
+{
+public:
+    ReferenceAnimator(std::vector<TweenSet *> &sets) : sets_(sets), index_(0), elapsed_(0) { store_ = info; }
+
+    bool update(float dt, double scrollPeriod, bool scrollForward)
+    {
+        elapsed_ += dt;
+        if(index_ >= sets_.size()) return true;
+
+        bool currentDone = true;
+        TweenSet *tweens = sets_[index_];
+
+        for(unsigned int i = 0; i < tweens->size(); i++)
+        {
+            Tween *tween = tweens->getTween(i);
+            double elapsedTime = elapsed_;
+            double duration = tween->duration ? tween->duration : scrollPeriod;
+            double direction = static_cast<double>(scrollForward ? -1.0f : 1.0f);
+
+            if(elapsedTime < duration) currentDone = false;
+            else elapsedTime = static_cast<float>(duration);
+
+            switch(tween->property)
+            {
+            case TWEEN_PROPERTY_X:
+                info.X = tween->startDefined ? tween->animate(elapsedTime) : tween->animate(elapsedTime, store_.X);
+                break;
+            case TWEEN_PROPERTY_Y:
+                info.Y = tween->startDefined ? tween->animate(elapsedTime) : tween->animate(elapsedTime, store_.Y);
+                break;
+            case TWEEN_PROPERTY_WIDTH:
+                info.Width = tween->startDefined ? tween->animate(elapsedTime) : tween->animate(elapsedTime, store_.Width);
+                break;
+            case TWEEN_PROPERTY_ALPHA:
+                info.Alpha = tween->startDefined ? tween->animate(elapsedTime) : tween->animate(elapsedTime, store_.Alpha);
+                break;
+            case TWEEN_PROPERTY_LAYER:
+                info.Layer = static_cast<unsigned int>(tween->startDefined ? tween->animate(elapsedTime) : tween->animate(elapsedTime, store_.Layer));
+                break;
+            case TWEEN_PROPERTY_X_OFFSET_SHIFT_MENU_DIRECTION:
+                if(tween->startDefined)
+                    info.XOffset = tween->animate(elapsedTime, tween->getStart(), tween->getStart() + tween->getEnd() * direction, duration);
+                else
+                    info.XOffset = tween->animate(elapsedTime, static_cast<double>(store_.YOffset), static_cast<double>(store_.YOffset) + tween->getEnd() * direction, duration);
+                break;
+            case TWEEN_PROPERTY_Y_OFFSET_SHIFT_MENU_DIRECTION:
+                if(tween->startDefined)
+                    info.YOffset = tween->animate(elapsedTime, tween->getStart(), tween->getStart() + tween->getEnd() * direction, duration);
+                else
+                    info.YOffset = tween->animate(elapsedTime, static_cast<double>(store_.YOffset), static_cast<double>(store_.YOffset) + tween->getEnd() * direction, duration);
+                break;
+            default:
+                break;
+            }
+        }
+
+        if(currentDone)
+        {
+            index_++;
+            elapsed_ = 0;
+            store_ = info;
+        }
+
+        return index_ >= sets_.size();
+    }
+
+    ViewInfo info;
+
+private:
+    std::vector<TweenSet *> &sets_;
+    ViewInfo store_;
+    unsigned int index_;
+    float elapsed_;
+};
+
+// The same animation run through TweenBatch, the way Component and Page drive it
+class BatchAnimator
+{
+public:
+    BatchAnimator(std::vector<TweenSet *> &sets) : sets_(sets), compiledSet_(NULL), index_(0), elapsed_(0) { store_ = info; }
+
+    bool update(float dt, double scrollPeriod, bool scrollForward, TweenBatch *batch)
+    {
+        elapsed_ += dt;
+        if(index_ >= sets_.size()) return true;
+
+        if(compiledSet_ != sets_[index_])
+        {
+            TweenBatch::compile(sets_[index_], store_, info, compiled_);
+            compiledSet_ = sets_[index_];
+        }
+
+        if(TweenBatch::schedule(compiled_, elapsed_, scrollPeriod, scrollForward, batch))
+        {
+            index_++;
+            elapsed_ = 0;
+            store_ = info;
+            compiledSet_ = NULL;
+        }
+
+        return index_ >= sets_.size();
+    }
+
+    ViewInfo info;
+
+private:
+    std::vector<TweenSet *> &sets_;
+    std::vector<CompiledTween> compiled_;
+    TweenSet *compiledSet_;
+    ViewInfo store_;
+    unsigned int index_;
+    float elapsed_;
+};
+
+class TweenBatchTest : public ::testing::Test
+{
+protected:
+    // The double precision easing yields NaN for some clamped end points, both ways
+    template<typename T>
+    static void expectSame(T a, T b, unsigned int layout, unsigned int frame)
+    {
+        if(a != a && b != b) return;
+        EXPECT_EQ(a, b) << "layout " << layout << " frame " << frame;
+    }
+
+    virtual void TearDown()
+    {
+        for(unsigned int i = 0; i < layouts_.size(); i++)
+        {
+            for(unsigned int j = 0; j < layouts_[i].size(); j++) delete layouts_[i][j];
+        }
+    }
+
+    std::vector<TweenSet *> &layout()
+    {
+        layouts_.push_back(std::vector<TweenSet *>());
+        return layouts_.back();
+    }
+
+    static Tween *tween(TweenProperty property, TweenAlgorithm type, double start, double end, double duration, bool startDefined = true)
+    {
+        Tween *t = new Tween(property, type, start, end, duration);
+        t->startDefined = startDefined;
+        return t;
+    }
+
+    // Runs every layout side by side through both animators and compares each frame
+    void expectSameFrames(float dt, unsigned int frames, double scrollPeriod, bool scrollForward)
+    {
+        TweenBatch batch;
+        std::vector<ReferenceAnimator *> reference;
+        std::vector<BatchAnimator *> batched;
+
+        for(unsigned int i = 0; i < layouts_.size(); i++)
+        {
+            reference.push_back(new ReferenceAnimator(layouts_[i]));
+            batched.push_back(new BatchAnimator(layouts_[i]));
+        }
+
+        for(unsigned int frame = 0; frame < frames; frame++)
+        {
+            for(unsigned int i = 0; i < layouts_.size(); i++)
+            {
+                EXPECT_EQ(reference[i]->update(dt, scrollPeriod, scrollForward),
+                          batched[i]->update(dt, scrollPeriod, scrollForward, &batch));
+            }
+
+            batch.evaluate();
+
+            for(unsigned int i = 0; i < layouts_.size(); i++)
+            {
+                ViewInfo &a = reference[i]->info;
+                ViewInfo &b = batched[i]->info;
+                expectSame(a.X, b.X, i, frame);
+                expectSame(a.Y, b.Y, i, frame);
+                expectSame(a.Width, b.Width, i, frame);
+                expectSame(a.Alpha, b.Alpha, i, frame);
+                expectSame(a.Layer, b.Layer, i, frame);
+                expectSame(a.XOffset, b.XOffset, i, frame);
+                expectSame(a.YOffset, b.YOffset, i, frame);
+            }
+        }
+
+        for(unsigned int i = 0; i < layouts_.size(); i++)
+        {
+            delete reference[i];
+            delete batched[i];
+        }
+    }
+
+    std::vector< std::vector<TweenSet *> > layouts_;
+};
+
+TEST_F(TweenBatchTest, OnEnterFadeAndSlide)
+{
+    std::vector<TweenSet *> &sets = layout();
+    TweenSet *set = new TweenSet();
+    set->push(tween(TWEEN_PROPERTY_ALPHA, LINEAR, 0, 1, 0.4));
+    set->push(tween(TWEEN_PROPERTY_X, EASE_OUT_QUADRATIC, -320, 0, 0.6));
+    set->push(tween(TWEEN_PROPERTY_Y, EASE_INOUT_SINE, 0, 120, 0.5));
+    sets.push_back(set);
+
+    expectSameFrames(1.0f / 60, 60, 0.2, false);
+}
+
+TEST_F(TweenBatchTest, ChainedSetsStartFromStoredValues)
+{
+    std::vector<TweenSet *> &sets = layout();
+    TweenSet *first = new TweenSet();
+    first->push(tween(TWEEN_PROPERTY_X, EASE_IN_CUBIC, 10, 200, 0.3));
+    first->push(tween(TWEEN_PROPERTY_WIDTH, EASE_OUT_EXPONENTIAL, 50, 80, 0.25));
+    first->push(tween(TWEEN_PROPERTY_NOP, LINEAR, 0, 0, 0.5));
+    sets.push_back(first);
+
+    TweenSet *second = new TweenSet();
+    second->push(tween(TWEEN_PROPERTY_X, EASE_OUT_CIRCULAR, 0, 40, 0.3, false));
+    second->push(tween(TWEEN_PROPERTY_WIDTH, EASE_INOUT_QUINTIC, 0, 10, 0.2, false));
+    second->push(tween(TWEEN_PROPERTY_LAYER, LINEAR, 0, 7, 0.3));
+    sets.push_back(second);
+
+    expectSameFrames(1.0f / 60, 90, 0.2, false);
+}
+
+TEST_F(TweenBatchTest, MenuScrollUsesScrollPeriodAndDirection)
+{
+    for(int forward = 0; forward < 2; forward++)
+    {
+        std::vector<TweenSet *> &sets = layout();
+        TweenSet *set = new TweenSet();
+        set->push(tween(TWEEN_PROPERTY_Y_OFFSET_SHIFT_MENU_DIRECTION, EASE_OUT_QUARTIC, 0, 24, 0, false));
+        set->push(tween(TWEEN_PROPERTY_X_OFFSET_SHIFT_MENU_DIRECTION, LINEAR, 5, 16, 0));
+        set->push(tween(TWEEN_PROPERTY_ALPHA, EASE_IN_SINE, 1, 0.5, 0));
+        sets.push_back(set);
+
+        expectSameFrames(1.0f / 60, 30, 0.15, forward != 0);
+        TearDown();
+        layouts_.clear();
+    }
+}
+
+TEST_F(TweenBatchTest, ManyComponentsShareOneBatch)
+{
+    TweenAlgorithm algorithms[] = { LINEAR, EASE_OUT_QUADRATIC, EASE_INOUT_CUBIC, EASE_IN_SINE, EASE_INOUT_EXPONENTIAL, EASE_IN_CIRCULAR };
+
+    for(unsigned int i = 0; i < 40; i++)
+    {
+        std::vector<TweenSet *> &sets = layout();
+        TweenSet *set = new TweenSet();
+        set->push(tween(TWEEN_PROPERTY_X, algorithms[i % 6], i, 300 - i, 0.2 + 0.01 * i));
+        set->push(tween(TWEEN_PROPERTY_ALPHA, algorithms[(i + 3) % 6], 0, 1, 0.35));
+        sets.push_back(set);
+
+        TweenSet *idle = new TweenSet();
+        idle->push(tween(TWEEN_PROPERTY_Y, algorithms[(i + 1) % 6], 0, 10, 0.5, false));
+        sets.push_back(idle);
+    }
+
+    expectSameFrames(1.0f / 60, 80, 0.2, true);
+}
+
+TEST_F(TweenBatchTest, BatchIsEmptiedByEvaluate)
+{
+    TweenBatch batch;
+    float a = 0;
+    float b = 0;
+
+    batch.add(LINEAR, 0, 10, 1, 0.5f, &a);
+    batch.add(EASE_IN_QUADRATIC, 0, 10, 1, 0.5f, &b);
+    ASSERT_EQ(2u, batch.size());
+
+    batch.evaluate();
+    ASSERT_EQ(0u, batch.size());
+    ASSERT_FLOAT_EQ(5.0f, a);
+    ASSERT_FLOAT_EQ(2.5f, b);
+}
@@ -0,0 +1,36 @@
+#include <Graphics/Animate/Tween.h>
+#include <chrono>
+#include <stdio.h>
+
+// Time per evaluation of every easing algorithm in double and single precision
+int main()
+{
+    const int iterations = 1000000;
+    volatile float sink = 0;
+
+    printf("%-6s %12s %12s\n", "type", "double ns", "float ns");
+
+    for(int type = LINEAR; type <= EASE_INOUT_CIRCULAR; type++)
+    {
+        TweenAlgorithm algorithm = static_cast<TweenAlgorithm>(type);
+
+        auto start = std::chrono::steady_clock::now();
+        for(int i = 0; i < iterations; i++)
+        {
+            sink = sink + Tween::animateDouble(algorithm, 0, 320, 1, (i % 1024) / 1024.0);
+        }
+        auto middle = std::chrono::steady_clock::now();
+        for(int i = 0; i < iterations; i++)
+        {
+            sink = sink + Tween::animateFloat(algorithm, 0, 320, 1, (i % 1024) / 1024.0f);
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        double doubleNs = std::chrono::duration<double, std::nano>(middle - start).count() / iterations;
+        double floatNs = std::chrono::duration<double, std::nano>(end - middle).count() / iterations;
+
+        printf("%-6d %12.2f %12.2f\n", type, doubleNs, floatNs);
+    }
+
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <Graphics/Animate/Tween.h>
+#include <math.h>
+
+class TweenTest : public ::testing::Test
+{
+};
+
+// Largest difference between the single and double precision easing over [0, 1],
+// relative to the animated range
+static double maxEasingError(TweenAlgorithm type)
+{
+    const int steps = 10000;
+    double maxError = 0;
+
+    for(int i = 0; i <= steps; i++)
+    {
+        double elapsed = static_cast<double>(i) / steps;
+        double expected = Tween::animateDouble(type, 0, 1, 1, elapsed);
+        double actual = Tween::animateFloat(type, 0, 1, 1, static_cast<float>(elapsed));
+        double error = fabs(actual - expected);
+
+        if(error > maxError) maxError = error;
+    }
+
+    return maxError;
+}
+
+TEST_F(TweenTest, FloatEasingMatchesDoubleEasing)
+{
+    for(int type = LINEAR; type <= EASE_INOUT_CIRCULAR; type++)
+    {
+        EXPECT_LT(maxEasingError(static_cast<TweenAlgorithm>(type)), 1e-4) << "algorithm " << type;
+    }
+}
+
+TEST_F(TweenTest, FloatEasingHitsEndpoints)
+{
+    for(int type = LINEAR; type <= EASE_INOUT_CIRCULAR; type++)
+    {
+        TweenAlgorithm algorithm = static_cast<TweenAlgorithm>(type);
+
+        // like the double version, the exponential curves stop 2^-10 short of both ends
+        if(type >= EASE_IN_EXPONENTIAL && type <= EASE_INOUT_EXPONENTIAL) continue;
+
+        EXPECT_NEAR(100.0f, Tween::animateFloat(algorithm, 100, 420, 2, 0), 1e-3f) << "algorithm " << type;
+        EXPECT_NEAR(420.0f, Tween::animateFloat(algorithm, 100, 420, 2, 2), 1e-3f) << "algorithm " << type;
+    }
+}
+
+TEST_F(TweenTest, FloatEasingZeroDuration)
+{
+    ASSERT_EQ(5.0f, Tween::animateFloat(EASE_IN_SINE, 5, 10, 0, 0));
+    ASSERT_EQ(5.0f, Tween::animateFloat(EASE_OUT_CIRCULAR, 5, 10, 0, 1));
+}
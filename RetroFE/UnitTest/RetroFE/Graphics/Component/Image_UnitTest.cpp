@@ -0,0 +1,159 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <SDL.h>
+#include <Database/Configuration.h>
+#include <Graphics/Page.h>
+#include <Graphics/ViewInfo.h>
+#include <Graphics/Animate/Animation.h>
+#include <Graphics/Animate/AnimationEvents.h>
+#include <Graphics/Animate/Tween.h>
+#include <Graphics/Animate/TweenSet.h>
+#include <Graphics/Component/Image.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define WIDTH  64
+#define HEIGHT 48
+
+// Shows the size of the texture as loaded
+class LoadedImage : public Image
+{
+public:
+    LoadedImage(std::string file, Page &p, const ViewInfo *viewInfo = NULL, AnimationEvents *tweens = NULL)
+        : Image(file, "", p, 1, 1, false, NULL, viewInfo, tweens)
+    {
+    }
+
+    int getTextureWidth()
+    {
+        return texture_ ? texture_->w : 0;
+    }
+
+    int getTextureHeight()
+    {
+        return texture_ ? texture_->h : 0;
+    }
+};
+
+// Run with SDL_VIDEODRIVER=dummy, set by ctest. Images are loaded from a
+// BMP in a temporary file, IMG_Load tells the format from the contents.
+class ImageTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        page = new Page(config);
+
+        char name[] = "/tmp/ImageTest.XXXXXX";
+        int fd = mkstemp(name);
+        ASSERT_NE(-1, fd);
+        close(fd);
+        file = name;
+
+        config.setProperty("horizontal", "64");
+        config.setProperty("vertical", "48");
+        config.setProperty("fullscreen", "no");
+        config.setProperty("showFrame", "yes");
+        ASSERT_TRUE(SDL::initialize(config));
+        writeImage(16, 16);
+    }
+
+    // Grown to width and height during its "enter" animation
+    static void addSizeTweens(AnimationEvents &tweens, float width, float height)
+    {
+        TweenSet *set = new TweenSet();
+        set->push(new Tween(TWEEN_PROPERTY_WIDTH, LINEAR, 16, width, 1));
+        set->push(new Tween(TWEEN_PROPERTY_HEIGHT, LINEAR, 16, height, 1));
+        Animation *animation = new Animation();
+        animation->Push(set);
+        tweens.setAnimation("enter", -1, animation);
+    }
+
+    virtual void TearDown()
+    {
+        delete page;
+        SDL::deInitialize();
+        unlink(file.c_str());
+    }
+
+    void writeImage(int width, int height)
+    {
+        SDL_Surface *surface = SDL_CreateRGBSurface(SDL_SWSURFACE, width, height, 32, 0xff0000, 0xff00, 0xff, 0);
+        SDL_FillRect(surface, NULL, SDL_MapRGB(surface->format, 200, 40, 40));
+        SDL_SaveBMP(surface, file.c_str());
+        SDL_FreeSurface(surface);
+    }
+
+    Configuration config;
+    Page *page;
+    std::string file;
+};
+
+TEST_F(ImageTest, ReflectionKeepsOffScreenImageVisible)
+{
+    Image image(file, "", *page, 1, 1, false);
+    image.baseViewInfo.X = -30;
+    image.baseViewInfo.Y = 8;
+    image.baseViewInfo.Width = 16;
+    image.baseViewInfo.Height = 16;
+    ASSERT_FALSE(image.isVisible());
+
+    // Mirrored 4 pixels to the right, from x -10 to 6
+    image.baseViewInfo.Reflection = "right";
+    image.baseViewInfo.ReflectionDistance = 4;
+    image.baseViewInfo.ReflectionScale = 1;
+    ASSERT_TRUE(image.isVisible());
+
+    // Half as wide, ends at x -2
+    image.baseViewInfo.ReflectionScale = 0.5f;
+    ASSERT_FALSE(image.isVisible());
+
+    image.baseViewInfo.Reflection = "left";
+    image.baseViewInfo.ReflectionScale = 1;
+    ASSERT_FALSE(image.isVisible());
+}
+
+TEST_F(ImageTest, ShrinksToTheLargestSizeItIsAnimatedTo)
+{
+    writeImage(64, 64);
+    ViewInfo view;
+    view.Width = 16;
+    view.Height = 16;
+    AnimationEvents tweens;
+    addSizeTweens(tweens, 32, 24);
+
+    LoadedImage image(file, *page, &view, &tweens);
+    ASSERT_EQ(32, image.getTextureWidth());
+    ASSERT_EQ(24, image.getTextureHeight());
+
+    // Loaded again at the same size whatever size it is shown at now
+    image.baseViewInfo.Width = 8;
+    image.baseViewInfo.Height = 8;
+    image.freeGraphicsMemory();
+    image.allocateGraphicsMemory();
+    ASSERT_EQ(32, image.getTextureWidth());
+    ASSERT_EQ(24, image.getTextureHeight());
+}
+
+TEST_F(ImageTest, KeepsItsSizeWithoutAKnownBound)
+{
+    writeImage(64, 64);
+    LoadedImage image(file, *page);
+    ASSERT_EQ(64, image.getTextureWidth());
+
+    image.baseViewInfo.Width = 16;
+    image.baseViewInfo.Height = 16;
+    image.freeGraphicsMemory();
+    image.allocateGraphicsMemory();
+    ASSERT_EQ(64, image.getTextureWidth());
+    ASSERT_EQ(64, image.getTextureHeight());
+
+    // A tween sizes the width the view leaves to the aspect
+    ViewInfo view;
+    view.Height = 16;
+    AnimationEvents tweens;
+    addSizeTweens(tweens, 32, 16);
+    LoadedImage animated(file, *page, &view, &tweens);
+    ASSERT_EQ(64, animated.getTextureWidth());
+    ASSERT_EQ(64, animated.getTextureHeight());
+}
@@ -0,0 +1,142 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <SDL.h>
+#include <Collection/CollectionInfo.h>
+#include <Collection/Item.h>
+#include <Database/Configuration.h>
+#include <Graphics/Page.h>
+#include <Graphics/SurfaceTracker.h>
+#include <Graphics/ViewInfo.h>
+#include <Graphics/Animate/AnimationEvents.h>
+#include <Graphics/Component/ScrollingList.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+
+#define SCROLL_SLOTS 5
+#define SCROLL_STEPS 40
+#define ITEMS        8
+
+// Run with SDL_VIDEODRIVER=dummy, set by ctest. A list of SCROLL_SLOTS
+// points, smaller away from the middle one, showing ITEMS items. Their
+// art is found next to their ROM as a 32x32 BMP in a temporary file,
+// IMG_Load tells the format from the contents.
+class ScrollingListTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        page = new Page(config);
+        collection = new CollectionInfo("Test", "", "", "", "");
+
+        char name[] = "/tmp/ScrollingListTest.XXXXXX.png";
+        int fd = mkstemps(name, 4);
+        ASSERT_NE(-1, fd);
+        close(fd);
+        file = name;
+
+        config.setProperty("horizontal", "64");
+        config.setProperty("vertical", "48");
+        config.setProperty("fullscreen", "no");
+        config.setProperty("showFrame", "yes");
+        ASSERT_TRUE(SDL::initialize(config));
+
+        SDL_Surface *surface = SDL_CreateRGBSurface(SDL_SWSURFACE, 32, 32, 32, 0xff0000, 0xff00, 0xff, 0);
+        SDL_FillRect(surface, NULL, SDL_MapRGB(surface->format, 200, 40, 40));
+        ASSERT_EQ(0, SDL_SaveBMP(surface, file.c_str()));
+        SDL_FreeSurface(surface);
+
+        for(int i = 0; i < SCROLL_SLOTS; i++)
+        {
+            int size = 16 - 4 * abs(i - SCROLL_SLOTS / 2);
+            ViewInfo *point = new ViewInfo();
+            point->X = static_cast<float>(i * 12);
+            point->Y = 16;
+            point->Width = static_cast<float>(size);
+            point->Height = static_cast<float>(size);
+            points.push_back(point);
+            tweenPoints.push_back(new AnimationEvents());
+        }
+
+        for(int i = 0; i < ITEMS; i++)
+        {
+            Item *item = new Item();
+            item->name = "item" + std::to_string(i);
+            item->filepath = "/tmp";
+            item->collectionInfo = collection;
+            items.push_back(item);
+        }
+    }
+
+    virtual void TearDown()
+    {
+        for(unsigned int i = 0; i < items.size(); i++) delete items[i];
+        for(unsigned int i = 0; i < points.size(); i++) delete points[i];
+        for(unsigned int i = 0; i < tweenPoints.size(); i++) delete tweenPoints[i];
+        delete collection;
+        delete page;
+        SDL::deInitialize();
+        unlink(file.c_str());
+    }
+
+    // The image type is the art's file name, without the extension
+    ScrollingList *createList()
+    {
+        std::string imageType = file.substr(5, file.size() - 9);
+        ScrollingList *list = new ScrollingList(config, *page, false, false, 1, 1, NULL, "", imageType, false);
+        list->setItems(&items);
+        list->setPoints(&points, &tweenPoints);
+        return list;
+    }
+
+    Configuration config;
+    Page *page;
+    CollectionInfo *collection;
+    std::string file;
+    std::vector<ViewInfo *> points;
+    std::vector<AnimationEvents *> tweenPoints;
+    std::vector<Item *> items;
+};
+
+// The item leaving frees its surfaces and the one coming in is loaded,
+// shrunk into its slot of the list's atlas, then zoomed while it moves.
+// Once every item shown has moved, a scroll frees as much as it makes,
+// and nothing is left once the list is freed.
+TEST_F(ScrollingListTest, ScrollingReturnsSurfaceBytesToBaseline)
+{
+    size_t baseline      = SurfaceTracker::getLiveBytes();
+    size_t imageBaseline = SurfaceTracker::getLiveBytes("Image");
+
+    ScrollingList *list = createList();
+    list->allocateGraphicsMemory();
+    list->triggerEnterEvent();
+    list->update(0);
+    list->draw(0);
+    ASSERT_LT(baseline, SurfaceTracker::getLiveBytes());
+
+    size_t steady = 0;
+    for(int step = 0; step < SCROLL_STEPS; step++)
+    {
+        list->scroll(true);
+        list->update(list->getScrollPeriod() / 2);
+        list->draw(0);
+        list->update(list->getScrollPeriod());
+        list->draw(0);
+
+        if(step == SCROLL_SLOTS - 1)
+        {
+            steady = SurfaceTracker::getLiveBytes();
+        }
+        if(step >= SCROLL_SLOTS)
+        {
+            ASSERT_EQ(steady, SurfaceTracker::getLiveBytes());
+        }
+    }
+
+    list->freeGraphicsMemory();
+    delete list;
+
+    ASSERT_EQ(baseline, SurfaceTracker::getLiveBytes());
+    ASSERT_EQ(imageBaseline, SurfaceTracker::getLiveBytes("Image"));
+    ASSERT_LE(steady, SurfaceTracker::getPeakBytes());
+}
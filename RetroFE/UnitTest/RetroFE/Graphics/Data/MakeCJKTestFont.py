@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+# Writes CJKTest.ttf, the font of Font_UnitTest for glyphs outside Latin-1.
+# Needs fontTools (pip install fonttools). Each CJK character is a frame
+# with its own pattern of bars, so that they render differently.
+import os
+from fontTools.fontBuilder import FontBuilder
+from fontTools.pens.ttGlyphPen import TTGlyphPen
+
+# U+5FCD U+8005 U+65E5 U+672C, "ninja" and "Japan"
+CHARACTERS = {0x5fcd: 'uni5FCD', 0x8005: 'uni8005', 0x65e5: 'uni65E5', 0x672c: 'uni672C'}
+
+
+def box(pen, x0, y0, x1, y1):
+    pen.moveTo((x0, y0))
+    pen.lineTo((x0, y1))
+    pen.lineTo((x1, y1))
+    pen.lineTo((x1, y0))
+    pen.closePath()
+
+
+def glyph(bars):
+    pen = TTGlyphPen(None)
+    if bars >= 0:
+        # Frame, drawn clockwise outside and counter-clockwise inside
+        box(pen, 100, -40, 900, 760)
+        pen.moveTo((160, 20))
+        pen.lineTo((840, 20))
+        pen.lineTo((840, 700))
+        pen.lineTo((160, 700))
+        pen.closePath()
+        for i in range(bars):
+            y = 80 + i * 620 // max(bars, 1)
+            box(pen, 200, y, 800, y + 60)
+    return pen.glyph()
+
+
+fb = FontBuilder(1000, isTTF=True)
+order = ['.notdef', 'space'] + list(CHARACTERS.values())
+fb.setupGlyphOrder(order)
+cmap = {0x20: 'space'}
+cmap.update(CHARACTERS)
+fb.setupCharacterMap(cmap)
+glyphs = {'.notdef': glyph(0), 'space': glyph(-1)}
+for i, name in enumerate(CHARACTERS.values()):
+    glyphs[name] = glyph(i + 1)
+fb.setupGlyf(glyphs)
+fb.setupHorizontalMetrics({name: (1000 if name != 'space' else 500, 0) for name in order})
+fb.setupHorizontalHeader(ascent=880, descent=-120)
+fb.setupNameTable({'familyName': 'CJKTest', 'styleName': 'Regular'})
+fb.setupOS2(sTypoAscender=880, sTypoDescender=-120, usWinAscent=880, usWinDescent=120)
+fb.setupPost()
+fb.save(os.path.join(os.path.dirname(os.path.abspath(__file__)), 'CJKTest.ttf'))
@@ -0,0 +1,55 @@
+#include <Graphics/Dither.h>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#define WIDTH   1000
+#define HEIGHT  1000
+#define RUNS    20
+
+typedef void (*DitherFunction)(std::vector<uint32_t> &image);
+
+static void diffusion(std::vector<uint32_t> &image)
+{
+    Dither::errorDiffusion(&image[0], WIDTH, HEIGHT, WIDTH * 4);
+}
+
+static void orderedScalar(std::vector<uint32_t> &image)
+{
+    Dither::orderedScalar(&image[0], WIDTH, HEIGHT, WIDTH * 4, 0xff000000);
+}
+
+static void ordered(std::vector<uint32_t> &image)
+{
+    Dither::ordered(&image[0], WIDTH, HEIGHT, WIDTH * 4, 0xff000000);
+}
+
+// Cost of dithering one megapixel, what a 1000x1000 cover takes to load
+int main()
+{
+    const char *names[] = { "error diffusion", "ordered scalar", "ordered" };
+    DitherFunction functions[] = { diffusion, orderedScalar, ordered };
+
+    std::vector<uint32_t> source(WIDTH * HEIGHT);
+    for(unsigned int i = 0; i < source.size(); ++i)
+    {
+        source[i] = (static_cast<uint32_t>(rand()) << 16) ^ static_cast<uint32_t>(rand());
+    }
+
+    for(unsigned int f = 0; f < 3; ++f)
+    {
+        double total = 0;
+        for(int run = 0; run < RUNS; ++run)
+        {
+            std::vector<uint32_t> image = source;
+            auto start = std::chrono::steady_clock::now();
+            functions[f](image);
+            auto end = std::chrono::steady_clock::now();
+            total += std::chrono::duration<double, std::milli>(end - start).count();
+        }
+        printf("%-16s %8.2f ms/Mpx\n", names[f], total / RUNS);
+    }
+
+    return 0;
+}
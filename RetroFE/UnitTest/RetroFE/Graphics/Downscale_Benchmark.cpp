@@ -0,0 +1,66 @@
+#include <Graphics/Downscale.h>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#define SRC_WIDTH   1280
+#define SRC_HEIGHT  960
+#define RUNS        10
+
+// Nearest neighbour sampling as SDL::zoomSurface does it, for comparison
+static void nearest(const uint32_t *src, uint32_t *dst, int dstWidth, int dstHeight)
+{
+    int xRatio = (SRC_WIDTH << 16) / dstWidth;
+    int yRatio = (SRC_HEIGHT << 16) / dstHeight;
+    for(int y = 0; y < dstHeight; ++y)
+    {
+        const uint32_t *row = src + ((y * yRatio) >> 16) * SRC_WIDTH;
+        int x2 = 0;
+        for(int x = 0; x < dstWidth; ++x)
+        {
+            dst[y * dstWidth + x] = row[x2 >> 16];
+            x2 += xRatio;
+        }
+    }
+}
+
+// Source megapixels shrunk per second, for box art shown at a quarter
+// and at a tenth of its size
+int main()
+{
+    const int targets[][2] = { { SRC_WIDTH / 4, SRC_HEIGHT / 4 }, { SRC_WIDTH / 10, SRC_HEIGHT / 10 } };
+    const char *names[] = { "nearest", "box scalar", "box", "box alpha" };
+
+    std::vector<uint32_t> source(SRC_WIDTH * SRC_HEIGHT);
+    for(unsigned int i = 0; i < source.size(); ++i)
+    {
+        source[i] = (static_cast<uint32_t>(rand()) << 16) ^ static_cast<uint32_t>(rand());
+    }
+    double megapixels = SRC_WIDTH * SRC_HEIGHT / 1000000.0;
+
+    printf("kernels: %s, %dx%d source\n", Downscale::getKernelName(), SRC_WIDTH, SRC_HEIGHT);
+    for(unsigned int t = 0; t < 2; ++t)
+    {
+        int width  = targets[t][0];
+        int height = targets[t][1];
+        std::vector<uint32_t> destination(width * height);
+        for(unsigned int f = 0; f < 4; ++f)
+        {
+            double total = 0;
+            for(int run = 0; run < RUNS; ++run)
+            {
+                auto start = std::chrono::steady_clock::now();
+                if(f == 0) nearest(&source[0], &destination[0], width, height);
+                if(f == 1) Downscale::scaleScalar(&source[0], SRC_WIDTH, SRC_HEIGHT, SRC_WIDTH * 4, &destination[0], width, height, width * 4, -1);
+                if(f == 2) Downscale::scale(&source[0], SRC_WIDTH, SRC_HEIGHT, SRC_WIDTH * 4, &destination[0], width, height, width * 4, -1);
+                if(f == 3) Downscale::scale(&source[0], SRC_WIDTH, SRC_HEIGHT, SRC_WIDTH * 4, &destination[0], width, height, width * 4, 24);
+                auto end = std::chrono::steady_clock::now();
+                total += std::chrono::duration<double>(end - start).count();
+            }
+            printf("to %4dx%-4d %-12s %8.1f Mpx/s\n", width, height, names[f], megapixels * RUNS / total);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,173 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <Graphics/Downscale.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <stdint.h>
+#include <vector>
+
+static std::vector<uint32_t> randomImage(int width, int height, bool translucent)
+{
+    std::vector<uint32_t> image(width * height);
+    srand(width * 131 + height);
+    for(unsigned int i = 0; i < image.size(); ++i)
+    {
+        uint32_t p = (static_cast<uint32_t>(rand()) << 16) ^ static_cast<uint32_t>(rand());
+        if(!translucent) p |= 0xff000000;
+        else if(i % 5 == 0) p &= 0x00ffffff;
+        image[i] = p;
+    }
+    return image;
+}
+
+// Area average in doubles, colors weighted by alpha when aShift >= 0
+static std::vector<double> reference(const std::vector<uint32_t> &src, int srcWidth, int srcHeight,
+                                     int dstWidth, int dstHeight, int aShift)
+{
+    std::vector<double> out(dstWidth * dstHeight * 4, 0.0);
+    double sx = static_cast<double>(srcWidth) / dstWidth;
+    double sy = static_cast<double>(srcHeight) / dstHeight;
+    int alpha = aShift / 8;
+
+    for(int y = 0; y < dstHeight; ++y)
+    {
+        for(int x = 0; x < dstWidth; ++x)
+        {
+            double sum[4] = { 0, 0, 0, 0 };
+            double area = 0;
+            for(int j = static_cast<int>(floor(y * sy)); j < std::min(srcHeight, static_cast<int>(ceil((y + 1) * sy))); ++j)
+            {
+                double wy = std::min(j + 1.0, (y + 1) * sy) - std::max(static_cast<double>(j), y * sy);
+                for(int i = static_cast<int>(floor(x * sx)); i < std::min(srcWidth, static_cast<int>(ceil((x + 1) * sx))); ++i)
+                {
+                    double w = wy * (std::min(i + 1.0, (x + 1) * sx) - std::max(static_cast<double>(i), x * sx));
+                    uint32_t p = src[j * srcWidth + i];
+                    double a = aShift < 0 ? 255.0 : ((p >> aShift) & 0xff);
+                    for(int c = 0; c < 4; ++c)
+                    {
+                        double v = (p >> (8 * c)) & 0xff;
+                        sum[c] += w * ((aShift < 0 || c == alpha) ? v : v * a / 255.0);
+                    }
+                    area += w;
+                }
+            }
+            for(int c = 0; c < 4; ++c)
+            {
+                out[(y * dstWidth + x) * 4 + c] = sum[c] / area;
+            }
+        }
+    }
+    return out;
+}
+
+static double channel(uint32_t p, int c)
+{
+    return (p >> (8 * c)) & 0xff;
+}
+
+TEST(DownscaleTest, OpaqueMatchesTheReference)
+{
+    const int sizes[][4] = { { 64, 48, 32, 24 }, { 100, 75, 33, 17 }, { 37, 29, 36, 28 }, { 300, 20, 3, 7 }, { 16, 16, 1, 1 } };
+    for(unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    {
+        int sw = sizes[s][0], sh = sizes[s][1], dw = sizes[s][2], dh = sizes[s][3];
+        std::vector<uint32_t> src = randomImage(sw, sh, false);
+        std::vector<uint32_t> dst(dw * dh);
+        ASSERT_TRUE(Downscale::scale(&src[0], sw, sh, sw * 4, &dst[0], dw, dh, dw * 4, -1));
+
+        std::vector<double> expected = reference(src, sw, sh, dw, dh, -1);
+        double worst = 0;
+        for(int i = 0; i < dw * dh; ++i)
+        {
+            for(int c = 0; c < 4; ++c)
+            {
+                worst = std::max(worst, fabs(channel(dst[i], c) - expected[i * 4 + c]));
+            }
+        }
+        ASSERT_LE(worst, 1.0) << sw << "x" << sh << " to " << dw << "x" << dh;
+    }
+}
+
+// Compared premultiplied: the color of a nearly transparent pixel is
+// free to be far off, its contribution on screen is not
+TEST(DownscaleTest, TranslucentMatchesTheReference)
+{
+    const int sw = 90, sh = 70, dw = 41, dh = 23;
+    std::vector<uint32_t> src = randomImage(sw, sh, true);
+    std::vector<uint32_t> dst(dw * dh);
+    ASSERT_TRUE(Downscale::scale(&src[0], sw, sh, sw * 4, &dst[0], dw, dh, dw * 4, 24));
+
+    std::vector<double> expected = reference(src, sw, sh, dw, dh, 24);
+    double worstAlpha = 0;
+    double worstColor = 0;
+    for(int i = 0; i < dw * dh; ++i)
+    {
+        double a = channel(dst[i], 3);
+        worstAlpha = std::max(worstAlpha, fabs(a - expected[i * 4 + 3]));
+        for(int c = 0; c < 3; ++c)
+        {
+            worstColor = std::max(worstColor, fabs(channel(dst[i], c) * a / 255.0 - expected[i * 4 + c]));
+        }
+    }
+    ASSERT_LE(worstAlpha, 1.0);
+    ASSERT_LE(worstColor, 1.5);
+}
+
+TEST(DownscaleTest, VectorKernelsMatchScalar)
+{
+    const int sizes[][4] = { { 64, 48, 32, 24 }, { 101, 77, 33, 19 }, { 640, 480, 97, 73 }, { 300, 20, 3, 7 } };
+    for(unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    {
+        int sw = sizes[s][0], sh = sizes[s][1], dw = sizes[s][2], dh = sizes[s][3];
+        for(int aShift = -1; aShift <= 24; aShift += (aShift < 0 ? 1 : 8))
+        {
+            std::vector<uint32_t> src = randomImage(sw, sh, aShift >= 0);
+            std::vector<uint32_t> vector(dw * dh);
+            std::vector<uint32_t> scalar(dw * dh);
+            ASSERT_TRUE(Downscale::scale(&src[0], sw, sh, sw * 4, &vector[0], dw, dh, dw * 4, aShift));
+            ASSERT_TRUE(Downscale::scaleScalar(&src[0], sw, sh, sw * 4, &scalar[0], dw, dh, dw * 4, aShift));
+            ASSERT_TRUE(vector == scalar) << Downscale::getKernelName() << ", alpha at " << aShift;
+        }
+    }
+}
+
+TEST(DownscaleTest, SameSizeAndSolidColorsAreExact)
+{
+    std::vector<uint32_t> src = randomImage(23, 11, false);
+    std::vector<uint32_t> dst(23 * 11);
+    ASSERT_TRUE(Downscale::scale(&src[0], 23, 11, 23 * 4, &dst[0], 23, 11, 23 * 4, -1));
+    ASSERT_TRUE(src == dst);
+
+    std::vector<uint32_t> solid(97 * 61, 0xff3c7a11);
+    std::vector<uint32_t> small(13 * 9);
+    ASSERT_TRUE(Downscale::scale(&solid[0], 97, 61, 97 * 4, &small[0], 13, 9, 13 * 4, 24));
+    for(unsigned int i = 0; i < small.size(); ++i)
+    {
+        ASSERT_EQ(0xff3c7a11u, small[i]);
+    }
+}
+
+// Transparent black next to opaque white averages to half transparent
+// white, not grey
+TEST(DownscaleTest, TransparentPixelsDoNotDarken)
+{
+    const uint32_t src[4] = { 0x00000000, 0xffffffff, 0x00000000, 0xffffffff };
+    uint32_t dst[1] = { 0 };
+    ASSERT_TRUE(Downscale::scale(src, 2, 2, 2 * 4, dst, 1, 1, 4, 24));
+    ASSERT_EQ(0x80ffffffu, dst[0]);
+
+    const uint32_t hidden[2] = { 0x00000000, 0x00000000 };
+    ASSERT_TRUE(Downscale::scale(hidden, 2, 1, 2 * 4, dst, 1, 1, 4, 24));
+    ASSERT_EQ(0u, dst[0]);
+}
+
+TEST(DownscaleTest, RejectsWhatItCannotDo)
+{
+    std::vector<uint32_t> src(8 * 8);
+    std::vector<uint32_t> dst(16 * 16);
+    ASSERT_FALSE(Downscale::scale(&src[0], 8, 8, 8 * 4, &dst[0], 16, 4, 16 * 4, -1));
+    ASSERT_FALSE(Downscale::scale(&src[0], 8, 8, 8 * 4, &dst[0], 4, 0, 4 * 4, -1));
+    ASSERT_FALSE(Downscale::scale(&src[0], 8, 8, 8 * 4, &dst[0], 4, 4, 4 * 4, 12));
+    ASSERT_FALSE(Downscale::scale(&src[0], 8, 8, 4, &dst[0], 4, 4, 4 * 4, -1));
+}
@@ -0,0 +1,59 @@
+#include <Graphics/DrawList.h>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#define NUM_LAYERS 20
+#define COMPONENTS 200
+#define FRAMES 10000
+
+struct FakeComponent
+{
+    unsigned int layer;
+};
+
+// Cost per frame of ordering a 200 component layout by layer, scanning every
+// layer as Page::draw used to, and with a DrawList
+int main()
+{
+    std::vector<FakeComponent> components(COMPONENTS);
+    DrawList list(NUM_LAYERS);
+    volatile unsigned long sink = 0;
+
+    for(unsigned int c = 0; c < COMPONENTS; ++c)
+    {
+        components[c].layer = rand() % NUM_LAYERS;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for(int frame = 0; frame < FRAMES; ++frame)
+    {
+        for(unsigned int i = 0; i < NUM_LAYERS; ++i)
+        {
+            for(unsigned int c = 0; c < COMPONENTS; ++c)
+            {
+                if(components[c].layer == i) sink = sink + c;
+            }
+        }
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for(int frame = 0; frame < FRAMES; ++frame)
+    {
+        list.clear();
+        for(unsigned int c = 0; c < COMPONENTS; ++c)
+        {
+            list.add(reinterpret_cast<Component *>(&components[c]), components[c].layer);
+        }
+        for(unsigned int i = 0; i < list.getLayerCount(); ++i)
+        {
+            sink = sink + list.getLayer(i).size();
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    printf("layer scan: %8.2f us/frame\n", std::chrono::duration<double, std::micro>(middle - start).count() / FRAMES);
+    printf("draw list:  %8.2f us/frame\n", std::chrono::duration<double, std::micro>(end - middle).count() / FRAMES);
+
+    return 0;
+}
@@ -0,0 +1,265 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <SDL.h>
+#include <Collection/CollectionInfo.h>
+#include <Collection/Item.h>
+#include <Database/Configuration.h>
+#include <Graphics/DrawList.h>
+#include <Graphics/Page.h>
+#include <Graphics/ViewInfo.h>
+#include <Graphics/Animate/AnimationEvents.h>
+#include <Graphics/Component/Component.h>
+#include <Graphics/Component/ScrollingList.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+
+#define NUM_LAYERS 20
+#define POINTS     3
+
+// A bar of one color, noting when Page::draw draws it
+class BarComponent : public Component
+{
+public:
+    BarComponent(Page &p, unsigned int layer, bool visible, std::vector<Component *> &drawn)
+        : Component(p)
+        , visible_(visible)
+        , drawn_(drawn)
+    {
+        baseViewInfo.Layer = layer;
+    }
+
+    void draw()
+    {
+        drawn_.push_back(this);
+
+        SDL_Surface *window = SDL::getWindow();
+        SDL_Rect rect = { static_cast<Sint16>(baseViewInfo.X), static_cast<Sint16>(baseViewInfo.Y),
+                          static_cast<Uint16>(baseViewInfo.Width), static_cast<Uint16>(baseViewInfo.Height) };
+        SDL_FillRect(window, &rect, SDL_MapRGB(window->format, 40, 200, 40));
+    }
+
+    bool isVisible()
+    {
+        return visible_;
+    }
+
+private:
+    bool visible_;
+    std::vector<Component *> &drawn_;
+};
+
+// Run with SDL_VIDEODRIVER=dummy, set by ctest. Pages of bars in random
+// layers, drawn by Page::draw, and a menu of POINTS items whose art is a
+// red 16x16 BMP in a temporary file, found next to their ROM.
+class DrawListTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        collection = new CollectionInfo("Test", "", "", "", "");
+
+        char name[] = "/tmp/DrawListTest.XXXXXX.png";
+        int fd = mkstemps(name, 4);
+        ASSERT_NE(-1, fd);
+        close(fd);
+        file = name;
+
+        config.setProperty("horizontal", "64");
+        config.setProperty("vertical", "48");
+        config.setProperty("fullscreen", "no");
+        config.setProperty("showFrame", "yes");
+        config.setProperty("flattenLayers", "no");
+        ASSERT_TRUE(SDL::initialize(config));
+
+        SDL_Surface *surface = SDL_CreateRGBSurface(SDL_SWSURFACE, 16, 16, 32, 0xff0000, 0xff00, 0xff, 0);
+        SDL_FillRect(surface, NULL, SDL_MapRGB(surface->format, 200, 40, 40));
+        ASSERT_EQ(0, SDL_SaveBMP(surface, file.c_str()));
+        SDL_FreeSurface(surface);
+
+        // Side by side in layers 2, 4 and 6
+        for(int i = 0; i < POINTS; i++)
+        {
+            ViewInfo *point = new ViewInfo();
+            point->X = static_cast<float>(4 + i * 20);
+            point->Y = 8;
+            point->Width = 16;
+            point->Height = 16;
+            point->Layer = 2 + 2 * i;
+            points.push_back(point);
+            tweenPoints.push_back(new AnimationEvents());
+
+            Item *item = new Item();
+            item->name = "item" + std::to_string(i);
+            item->filepath = "/tmp";
+            item->collectionInfo = collection;
+            items.push_back(item);
+        }
+    }
+
+    virtual void TearDown()
+    {
+        for(unsigned int i = 0; i < items.size(); i++) delete items[i];
+        for(unsigned int i = 0; i < points.size(); i++) delete points[i];
+        for(unsigned int i = 0; i < tweenPoints.size(); i++) delete tweenPoints[i];
+        delete collection;
+        SDL::deInitialize();
+        unlink(file.c_str());
+    }
+
+    // Bars in random layers, some hidden and some past the last layer.
+    // Returns the order Page::draw used to draw them in: every layer scans
+    // the page components.
+    std::vector<Component *> randomPage(Page &page, unsigned int components)
+    {
+        std::vector<BarComponent *> added;
+        for(unsigned int c = 0; c < components; ++c)
+        {
+            BarComponent *bar = new BarComponent(page, rand() % (NUM_LAYERS + 2), (rand() % 8) != 0, drawn);
+            if(page.addComponent(bar))
+            {
+                added.push_back(bar);
+            }
+            else
+            {
+                delete bar;
+            }
+        }
+
+        std::vector<Component *> order;
+        for(unsigned int i = 0; i < NUM_LAYERS; ++i)
+        {
+            for(unsigned int c = 0; c < added.size(); ++c)
+            {
+                if(added[c]->baseViewInfo.Layer == i && added[c]->isVisible()) order.push_back(added[c]);
+            }
+        }
+        return order;
+    }
+
+    // The image type is the art's file name, without the extension
+    ScrollingList *createMenu(Page &page)
+    {
+        std::string imageType = file.substr(5, file.size() - 9);
+        ScrollingList *menu = new ScrollingList(config, page, false, false, 1, 1, NULL, "", imageType, false);
+        menu->setItems(&items);
+        menu->setPoints(&points, &tweenPoints);
+        menu->allocateGraphicsMemory();
+        menu->triggerEnterEvent();
+        menu->update(0);
+        return menu;
+    }
+
+    bool isGreen(int x, int y)
+    {
+        SDL_Surface *window = SDL::getWindow();
+        Uint8 *pixel = static_cast<Uint8 *>(window->pixels) + y * window->pitch + x * window->format->BytesPerPixel;
+        Uint32 value = window->format->BytesPerPixel == 2 ? *reinterpret_cast<Uint16 *>(pixel) : *reinterpret_cast<Uint32 *>(pixel);
+        Uint8 r, g, b;
+        SDL_GetRGB(value, window->format, &r, &g, &b);
+        return g > r;
+    }
+
+    Configuration config;
+    CollectionInfo *collection;
+    std::string file;
+    std::vector<ViewInfo *> points;
+    std::vector<AnimationEvents *> tweenPoints;
+    std::vector<Item *> items;
+    std::vector<Component *> drawn;
+};
+
+TEST_F(DrawListTest, SameOrderAsLayerScan)
+{
+    srand(1234);
+
+    for(int round = 0; round < 50; round++)
+    {
+        Page page(config);
+        std::vector<Component *> order = randomPage(page, 60);
+
+        drawn.clear();
+        page.draw();
+        ASSERT_EQ(order, drawn);
+        page.deInitialize();
+    }
+}
+
+TEST_F(DrawListTest, LayerChangeMovesComponent)
+{
+    Page page(config);
+    std::vector<BarComponent *> bars;
+    for(int c = 0; c < 10; ++c)
+    {
+        bars.push_back(new BarComponent(page, 3, true, drawn));
+        page.addComponent(bars.back());
+    }
+    page.draw();
+    ASSERT_EQ(bars.front(), drawn.front());
+
+    // a layer tween moved the first component on top of the others
+    bars[0]->baseViewInfo.Layer = 4;
+    drawn.clear();
+    page.draw();
+    ASSERT_EQ(10u, drawn.size());
+    ASSERT_EQ(bars[1], drawn.front());
+    ASSERT_EQ(bars[0], drawn.back());
+    page.deInitialize();
+}
+
+TEST_F(DrawListTest, LayersPastTheLastAreNotDrawn)
+{
+    Page page(config);
+    BarComponent bar(page, NUM_LAYERS, true, drawn);
+    DrawList list(NUM_LAYERS);
+
+    ASSERT_FALSE(list.add(&bar, bar.baseViewInfo.Layer));
+    ASSERT_EQ(0u, list.size());
+}
+
+TEST_F(DrawListTest, MenuItemsAreListedByLayerWhenVisible)
+{
+    Page page(config);
+    ScrollingList *menu = createMenu(page);
+    DrawList list(NUM_LAYERS);
+
+    menu->addToDrawList(list);
+    ASSERT_EQ(static_cast<unsigned int>(POINTS), list.size());
+    for(unsigned int i = 0; i < POINTS; ++i)
+    {
+        ASSERT_EQ(1u, list.getLayer(2 + 2 * i).size());
+        ASSERT_EQ(2 + 2 * i, list.getLayer(2 + 2 * i).front()->baseViewInfo.Layer);
+    }
+
+    // A transparent item is left out
+    list.getLayer(4).front()->baseViewInfo.Alpha = 0;
+    list.clear();
+    menu->addToDrawList(list);
+    ASSERT_EQ(static_cast<unsigned int>(POINTS - 1), list.size());
+    ASSERT_EQ(0u, list.getLayer(4).size());
+
+    menu->freeGraphicsMemory();
+    delete menu;
+}
+
+TEST_F(DrawListTest, MenuItemsAreDrawnBetweenPageLayers)
+{
+    Page page(config);
+    page.pushMenu(createMenu(page));
+
+    // Across the three items, over the first one and under the others
+    BarComponent *bar = new BarComponent(page, 3, true, drawn);
+    bar->baseViewInfo.X = 0;
+    bar->baseViewInfo.Y = 12;
+    bar->baseViewInfo.Width = 64;
+    bar->baseViewInfo.Height = 8;
+    page.addComponent(bar);
+
+    page.draw();
+    ASSERT_EQ(1u, drawn.size());
+    ASSERT_TRUE(isGreen(2, 16));
+    ASSERT_TRUE(isGreen(12, 16));
+    ASSERT_FALSE(isGreen(32, 16));
+    ASSERT_FALSE(isGreen(52, 16));
+    page.deInitialize();
+}
@@ -0,0 +1,186 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <Graphics/FontAtlasFile.h>
+#include <cstdio>
+#include <cstring>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Pixels are padded to a wider pitch than the page, like an SDL surface can be
+#define WIDTH   64
+#define HEIGHT  32
+#define PITCH   (WIDTH * 4 + 16)
+
+class FontAtlasFileTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        char dir[] = "/tmp/FontAtlasFileTest.XXXXXX";
+        ASSERT_TRUE(mkdtemp(dir) != NULL);
+        root = dir;
+        file = root + "/font.atlas";
+
+        memset(&key, 0, sizeof(key));
+        key.fontHash   = 0x123456789abcdefULL;
+        key.fontSize   = 16;
+        key.r          = 255;
+        key.g          = 128;
+        key.b          = 0;
+        key.firstGlyph = 32;
+        key.lastGlyph  = 127;
+
+        for(unsigned int page = 0; page < 2; ++page)
+        {
+            pixels[page].resize(PITCH * HEIGHT);
+            for(unsigned int i = 0; i < pixels[page].size(); ++i)
+            {
+                pixels[page][i] = static_cast<unsigned char>(i * 7 + page);
+            }
+        }
+
+        for(unsigned int i = 0; i < 3; ++i)
+        {
+            FontAtlasFile::Entry entry;
+            memset(&entry, 0, sizeof(entry));
+            entry.codepoint      = 'A' + i;
+            entry.glyph.page     = i % 2;
+            entry.glyph.x        = i * 10;
+            entry.glyph.w        = 9;
+            entry.glyph.h        = 20;
+            entry.glyph.advance  = 10;
+            entry.glyph.provided = true;
+            glyphs.push_back(entry);
+        }
+    }
+
+    virtual void TearDown()
+    {
+        system(("rm -rf " + root).c_str());
+    }
+
+    bool write()
+    {
+        std::vector<const void *> pages;
+        pages.push_back(&pixels[0][0]);
+        pages.push_back(&pixels[1][0]);
+        return FontAtlasFile::write(file, key, 22, 17, WIDTH, HEIGHT, PITCH, glyphs, pages);
+    }
+
+    std::string root;
+    std::string file;
+    FontAtlasFile::Key key;
+    std::vector<unsigned char> pixels[2];
+    std::vector<FontAtlasFile::Entry> glyphs;
+};
+
+TEST_F(FontAtlasFileTest, ReadsBackWhatWasWritten)
+{
+    ASSERT_TRUE(write());
+    ASSERT_NE(0, access((file + ".tmp").c_str(), F_OK));
+
+    FontAtlasFile atlas;
+    ASSERT_TRUE(atlas.open(file, key));
+    ASSERT_EQ(22, atlas.getHeight());
+    ASSERT_EQ(17, atlas.getAscent());
+    ASSERT_EQ(WIDTH, atlas.getPageWidth());
+    ASSERT_EQ(HEIGHT, atlas.getPageHeight());
+    ASSERT_EQ(2u, atlas.getPageCount());
+    ASSERT_EQ(3u, atlas.getGlyphCount());
+
+    for(unsigned int i = 0; i < 3; ++i)
+    {
+        ASSERT_EQ(glyphs[i].codepoint, atlas.getGlyphs()[i].codepoint);
+        ASSERT_EQ(glyphs[i].glyph.page, atlas.getGlyphs()[i].glyph.page);
+        ASSERT_EQ(glyphs[i].glyph.x, atlas.getGlyphs()[i].glyph.x);
+        ASSERT_EQ(glyphs[i].glyph.advance, atlas.getGlyphs()[i].glyph.advance);
+    }
+
+    for(unsigned int page = 0; page < 2; ++page)
+    {
+        const unsigned char *mapped = static_cast<const unsigned char *>(atlas.getPage(page));
+        for(int y = 0; y < HEIGHT; ++y)
+        {
+            ASSERT_EQ(0, memcmp(&pixels[page][y * PITCH], mapped + y * WIDTH * 4, WIDTH * 4)) << "page " << page << " row " << y;
+        }
+    }
+}
+
+TEST_F(FontAtlasFileTest, PagesAreCopyOnWrite)
+{
+    ASSERT_TRUE(write());
+
+    FontAtlasFile first;
+    ASSERT_TRUE(first.open(file, key));
+    memset(first.getPage(0), 0, WIDTH * 4);
+
+    FontAtlasFile second;
+    ASSERT_TRUE(second.open(file, key));
+    ASSERT_EQ(0, memcmp(&pixels[0][0], second.getPage(0), WIDTH * 4));
+}
+
+TEST_F(FontAtlasFileTest, RejectsADifferentKey)
+{
+    ASSERT_TRUE(write());
+
+    FontAtlasFile atlas;
+    FontAtlasFile::Key other = key;
+    other.fontHash++;
+    ASSERT_FALSE(atlas.open(file, other));
+    ASSERT_FALSE(atlas.isOpen());
+
+    other = key;
+    other.b = 1;
+    ASSERT_FALSE(atlas.open(file, other));
+
+    other = key;
+    other.fontSize = 17;
+    ASSERT_FALSE(atlas.open(file, other));
+
+    ASSERT_TRUE(atlas.open(file, key));
+}
+
+TEST_F(FontAtlasFileTest, RejectsATruncatedFile)
+{
+    ASSERT_TRUE(write());
+    FILE *f = fopen(file.c_str(), "rb");
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fclose(f);
+    ASSERT_EQ(0, truncate(file.c_str(), size - 1));
+
+    FontAtlasFile atlas;
+    ASSERT_FALSE(atlas.open(file, key));
+    ASSERT_EQ(0, truncate(file.c_str(), 8));
+    ASSERT_FALSE(atlas.open(file, key));
+}
+
+TEST_F(FontAtlasFileTest, RejectsGlyphsOutsideThePages)
+{
+    glyphs[1].glyph.x = WIDTH - 4;
+    ASSERT_TRUE(write());
+
+    FontAtlasFile atlas;
+    ASSERT_FALSE(atlas.open(file, key));
+}
+
+TEST_F(FontAtlasFileTest, MissingFileIsNotAnError)
+{
+    FontAtlasFile atlas;
+    ASSERT_FALSE(atlas.open(root + "/missing.atlas", key));
+    ASSERT_EQ(0u, FontAtlasFile::hashFile(root + "/missing.ttf"));
+}
+
+TEST_F(FontAtlasFileTest, HashFollowsTheContents)
+{
+    std::string a = root + "/a.ttf";
+    std::string b = root + "/b.ttf";
+    FILE *f = fopen(a.c_str(), "wb"); fputs("font one", f); fclose(f);
+    f = fopen(b.c_str(), "wb"); fputs("font two", f); fclose(f);
+
+    ASSERT_NE(0u, FontAtlasFile::hashFile(a));
+    ASSERT_NE(FontAtlasFile::hashFile(a), FontAtlasFile::hashFile(b));
+
+    f = fopen(b.c_str(), "wb"); fputs("font one", f); fclose(f);
+    ASSERT_EQ(FontAtlasFile::hashFile(a), FontAtlasFile::hashFile(b));
+}
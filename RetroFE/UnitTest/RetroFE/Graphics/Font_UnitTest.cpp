@@ -0,0 +1,287 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <Graphics/Font.h>
+#include <SDL.h>
+#include <Utility/Utils.h>
+#include <SDL/SDL_ttf.h>
+#include <cstring>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+// Font only needs the render mutex and its page surfaces from the SDL
+// wrapper, the surfaces are not tracked here
+SDL_mutex *SDL::getMutex( )
+{
+    return NULL;
+}
+
+SDL_Surface *SDL::createSurface( Uint32 flags, int width, int height, int depth,
+                                 Uint32 Rmask, Uint32 Gmask, Uint32 Bmask, Uint32 Amask, const std::string & )
+{
+    return SDL_CreateRGBSurface( flags, width, height, depth, Rmask, Gmask, Bmask, Amask );
+}
+
+SDL_Surface *SDL::createSurfaceFrom( void *pixels, int width, int height, int depth, int pitch,
+                                     Uint32 Rmask, Uint32 Gmask, Uint32 Bmask, Uint32 Amask, const std::string & )
+{
+    return SDL_CreateRGBSurfaceFrom( pixels, width, height, depth, pitch, Rmask, Gmask, Bmask, Amask );
+}
+
+void SDL::freeSurface( SDL_Surface *surface )
+{
+    SDL_FreeSurface( surface );
+}
+
+class FontTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        ASSERT_EQ(0, TTF_Init());
+
+        SDL_Color color = { 255, 255, 255, 0 };
+        font = new Font(fontPath, 16, color);
+        ASSERT_TRUE(font->initialize());
+    }
+
+    virtual void TearDown()
+    {
+        delete font;
+        TTF_Quit();
+    }
+
+    std::vector<unsigned int> decode(std::string text)
+    {
+        std::vector<unsigned int> codepoints;
+        for(size_t i = 0; i < text.size(); )
+        {
+            codepoints.push_back(Utils::decodeUtf8(text, i));
+        }
+        return codepoints;
+    }
+
+    // Draws the text the way Text does, one glyph after the other
+    SDL_Surface *render(Font *f, std::string text)
+    {
+        SDL_Surface *surface = SDL_CreateRGBSurface(0, 400, f->getHeight(), 32, 0xff, 0xff00, 0xff0000, 0xff000000);
+        SDL_FillRect(surface, NULL, 0);
+
+        std::vector<unsigned int> codepoints = decode(text);
+        int x = 0;
+        for(unsigned int i = 0; i < codepoints.size(); i++)
+        {
+            Font::GlyphInfo glyph;
+            if(f->getRect(codepoints[i], glyph))
+            {
+                SDL_Rect dest = { static_cast<Sint16>(x + glyph.minX), 0, 0, 0 };
+                SDL_SetAlpha(glyph.texture, 0, SDL_ALPHA_OPAQUE);
+                SDL_BlitSurface(glyph.texture, &glyph.rect, surface, &dest);
+                x += glyph.advance;
+            }
+        }
+
+        return surface;
+    }
+
+    bool samePixels(SDL_Surface *a, SDL_Surface *b)
+    {
+        for(int y = 0; y < a->h; y++)
+        {
+            if(memcmp(static_cast<char *>(a->pixels) + y * a->pitch,
+                      static_cast<char *>(b->pixels) + y * b->pitch, a->w * 4) != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::string fontPath = std::string(RETROFE_PACKAGE_DIR) + "/Environment/Common/core/OpenSans.ttf";
+    // Four kanji only, see Data/MakeCJKTestFont.py
+    std::string cjkFontPath = std::string(RETROFE_UNITTEST_DIR) + "/RetroFE/Graphics/Data/CJKTest.ttf";
+    Font *font;
+};
+
+TEST_F(FontTest, RendersLatin1OnDemand)
+{
+    // "Pokemon Cafe" with accents, as UTF-8
+    std::vector<unsigned int> text = decode("Pok\xc3\xa9mon Caf\xc3\xa9 \xc3\xb1");
+
+    for(unsigned int i = 0; i < text.size(); i++)
+    {
+        Font::GlyphInfo glyph;
+        ASSERT_TRUE(font->getRect(text[i], glyph)) << "code point " << text[i];
+        ASSERT_TRUE(glyph.texture != NULL);
+        ASSERT_GT(glyph.advance, 0);
+        ASSERT_LE(glyph.rect.x + glyph.rect.w, glyph.texture->w);
+        ASSERT_LE(glyph.rect.y + glyph.rect.h, glyph.texture->h);
+    }
+
+    Font::GlyphInfo e;
+    Font::GlyphInfo eAcute;
+    ASSERT_TRUE(font->getRect('e', e));
+    ASSERT_TRUE(font->getRect(0xe9, eAcute));
+    ASSERT_FALSE(e.texture == eAcute.texture && e.rect.x == eAcute.rect.x && e.rect.y == eAcute.rect.y);
+}
+
+TEST_F(FontTest, SkipsGlyphsTheFontLacks)
+{
+    // OpenSans has no CJK, those are skipped instead of drawn as garbage
+    std::vector<unsigned int> text = decode("Ninja \xe5\xbf\x8d\xe8\x80\x85 Gaiden");
+    unsigned int drawn = 0;
+
+    for(unsigned int i = 0; i < text.size(); i++)
+    {
+        Font::GlyphInfo glyph;
+        if(font->getRect(text[i], glyph))
+        {
+            drawn++;
+        }
+    }
+
+    ASSERT_EQ(text.size() - 2, drawn);
+
+    Font::GlyphInfo glyph;
+    ASSERT_FALSE(font->getRect(0x1d11e, glyph));
+}
+
+TEST_F(FontTest, RendersCJKOnDemand)
+{
+    SDL_Color color = { 255, 255, 255, 0 };
+    Font cjk(cjkFontPath, 16, color);
+    ASSERT_TRUE(cjk.initialize());
+
+    // "Ninja Nippon" as UTF-8
+    std::string utf8 = "\xe5\xbf\x8d\xe8\x80\x85\xe6\x97\xa5\xe6\x9c\xac";
+    std::vector<unsigned int> text = decode(utf8);
+    ASSERT_EQ(4u, text.size());
+    ASSERT_EQ(0x5fcdu, text[0]);
+    ASSERT_EQ(0x8005u, text[1]);
+    ASSERT_EQ(0x65e5u, text[2]);
+    ASSERT_EQ(0x672cu, text[3]);
+
+    // Each glyph gets its own slot in the cache pages, and keeps it
+    std::vector<Font::GlyphInfo> glyphs(text.size());
+    for(unsigned int i = 0; i < text.size(); i++)
+    {
+        ASSERT_TRUE(cjk.getRect(text[i], glyphs[i])) << "code point " << text[i];
+        ASSERT_TRUE(glyphs[i].texture != NULL);
+        ASSERT_EQ(16, glyphs[i].advance);
+        ASSERT_GT(glyphs[i].rect.w, 0);
+        ASSERT_GT(glyphs[i].rect.h, 0);
+        ASSERT_LE(glyphs[i].rect.x + glyphs[i].rect.w, glyphs[i].texture->w);
+        ASSERT_LE(glyphs[i].rect.y + glyphs[i].rect.h, glyphs[i].texture->h);
+
+        for(unsigned int j = 0; j < i; j++)
+        {
+            SDL_Rect &a = glyphs[i].rect;
+            SDL_Rect &b = glyphs[j].rect;
+            bool overlap = glyphs[i].texture == glyphs[j].texture &&
+                           a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+            ASSERT_FALSE(overlap) << "code points " << text[i] << " and " << text[j];
+        }
+    }
+
+    Font::GlyphInfo again;
+    ASSERT_TRUE(cjk.getRect(text[0], again));
+    ASSERT_TRUE(again.texture == glyphs[0].texture);
+    ASSERT_EQ(glyphs[0].rect.x, again.rect.x);
+    ASSERT_EQ(glyphs[0].rect.y, again.rect.y);
+
+    // Each kanji of the font has one more bar than the previous one
+    SDL_Surface *surface = render(&cjk, utf8);
+    std::vector<int> lit(text.size(), 0);
+    for(int y = 0; y < surface->h; y++)
+    {
+        Uint32 *row = reinterpret_cast<Uint32 *>(static_cast<char *>(surface->pixels) + y * surface->pitch);
+        for(int x = 0; x < 16 * static_cast<int>(text.size()); x++)
+        {
+            if((row[x] >> 24) > 128) lit[x / 16]++;
+        }
+    }
+    SDL_FreeSurface(surface);
+
+    ASSERT_GT(lit[0], 0);
+    for(unsigned int i = 1; i < lit.size(); i++)
+    {
+        ASSERT_GT(lit[i], lit[i - 1]);
+    }
+
+    cjk.deInitialize();
+}
+
+TEST_F(FontTest, ReinitializationRendersGlyphsAgain)
+{
+    Font::GlyphInfo before;
+    ASSERT_TRUE(font->getRect(0xfc, before));
+
+    font->deInitialize();
+    Font::GlyphInfo glyph;
+    ASSERT_FALSE(font->getRect('A', glyph));
+
+    ASSERT_TRUE(font->initialize());
+    Font::GlyphInfo after;
+    ASSERT_TRUE(font->getRect(0xfc, after));
+    ASSERT_EQ(before.advance, after.advance);
+    ASSERT_EQ(before.rect.w, after.rect.w);
+}
+
+TEST_F(FontTest, CachedAtlasRendersTheSameText)
+{
+    char dir[] = "/tmp/FontTest.XXXXXX";
+    ASSERT_TRUE(mkdtemp(dir) != NULL);
+    std::string cacheFile = std::string(dir) + "/font.atlas";
+    std::string text = "RetroFE 1.2 - Press [A] to start! Caf\xc3\xa9";
+    SDL_Color color = { 255, 255, 255, 0 };
+
+    SDL_Surface *fresh = render(font, text);
+
+    Font writer(fontPath, 16, color);
+    writer.setCacheFile(cacheFile);
+    ASSERT_TRUE(writer.initialize());
+    ASSERT_EQ(0, access(cacheFile.c_str(), F_OK));
+    writer.deInitialize();
+
+    // Loaded from the file this time, the accent is still rendered on demand
+    Font cached(fontPath, 16, color);
+    cached.setCacheFile(cacheFile);
+    ASSERT_TRUE(cached.initialize());
+    ASSERT_EQ(font->getHeight(), cached.getHeight());
+    ASSERT_EQ(font->getAscent(), cached.getAscent());
+    SDL_Surface *loaded = render(&cached, text);
+
+    ASSERT_TRUE(samePixels(fresh, loaded));
+
+    SDL_FreeSurface(fresh);
+    SDL_FreeSurface(loaded);
+    cached.deInitialize();
+    system((std::string("rm -rf ") + dir).c_str());
+}
+
+TEST_F(FontTest, AtlasOfAnotherColourIsNotUsed)
+{
+    char dir[] = "/tmp/FontTest.XXXXXX";
+    ASSERT_TRUE(mkdtemp(dir) != NULL);
+    std::string cacheFile = std::string(dir) + "/font.atlas";
+    SDL_Color white = { 255, 255, 255, 0 };
+    SDL_Color red = { 255, 0, 0, 0 };
+
+    Font writer(fontPath, 16, red);
+    writer.setCacheFile(cacheFile);
+    ASSERT_TRUE(writer.initialize());
+    writer.deInitialize();
+
+    Font reader(fontPath, 16, white);
+    reader.setCacheFile(cacheFile);
+    ASSERT_TRUE(reader.initialize());
+
+    SDL_Surface *fresh = render(font, "White");
+    SDL_Surface *loaded = render(&reader, "White");
+    ASSERT_TRUE(samePixels(fresh, loaded));
+
+    SDL_FreeSurface(fresh);
+    SDL_FreeSurface(loaded);
+    reader.deInitialize();
+    system((std::string("rm -rf ") + dir).c_str());
+}
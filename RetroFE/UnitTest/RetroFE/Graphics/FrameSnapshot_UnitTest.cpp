@@ -0,0 +1,63 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <Graphics/FrameSnapshot.h>
+#include <vector>
+
+TEST(FrameSnapshotTest, RestoresTheCapturedFrame)
+{
+    std::vector<unsigned int> frame(240 * 240);
+    for(unsigned int i = 0; i < frame.size(); i++)
+    {
+        frame[i] = i * 2654435761u;
+    }
+
+    FrameSnapshot snapshot;
+    ASSERT_FALSE(snapshot.isValid());
+    ASSERT_TRUE(snapshot.capture(&frame[0], 240, 240, 240 * 4, 4));
+    ASSERT_TRUE(snapshot.isValid());
+
+    std::vector<unsigned int> screen(240 * 240, 0);
+    ASSERT_TRUE(snapshot.restore(&screen[0], 240, 240, 240 * 4, 4));
+    ASSERT_TRUE(screen == frame);
+}
+
+TEST(FrameSnapshotTest, HandlesPaddedRows)
+{
+    // 3 pixels wide with one pixel of padding per row
+    unsigned int frame[]  = { 1, 2, 3, 99, 4, 5, 6, 99 };
+    unsigned int screen[] = { 0, 0, 0, 77, 0, 0, 0, 77 };
+
+    FrameSnapshot snapshot;
+    ASSERT_TRUE(snapshot.capture(frame, 3, 2, 16, 4));
+    ASSERT_TRUE(snapshot.restore(screen, 3, 2, 16, 4));
+
+    unsigned int expected[] = { 1, 2, 3, 77, 4, 5, 6, 77 };
+    for(int i = 0; i < 8; i++)
+    {
+        ASSERT_EQ(expected[i], screen[i]);
+    }
+}
+
+TEST(FrameSnapshotTest, RejectsAnotherVideoMode)
+{
+    std::vector<unsigned int> frame(240 * 240, 1);
+    std::vector<unsigned int> screen(320 * 240, 0);
+
+    FrameSnapshot snapshot;
+    ASSERT_TRUE(snapshot.capture(&frame[0], 240, 240, 240 * 4, 4));
+    ASSERT_FALSE(snapshot.restore(&screen[0], 320, 240, 320 * 4, 4));
+    ASSERT_FALSE(snapshot.restore(&screen[0], 240, 240, 240 * 2, 2));
+    ASSERT_EQ(0u, screen[0]);
+}
+
+TEST(FrameSnapshotTest, ClearReleasesTheFrame)
+{
+    std::vector<unsigned int> frame(16, 1);
+
+    FrameSnapshot snapshot;
+    ASSERT_TRUE(snapshot.capture(&frame[0], 4, 4, 16, 4));
+    snapshot.clear();
+    ASSERT_FALSE(snapshot.isValid());
+    ASSERT_FALSE(snapshot.restore(&frame[0], 4, 4, 16, 4));
+    ASSERT_FALSE(snapshot.capture(NULL, 4, 4, 16, 4));
+}
@@ -0,0 +1,142 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <Graphics/GlyphCache.h>
+#include <cstring>
+#include <vector>
+
+static GlyphCache::Glyph makeGlyph(int w, int h)
+{
+    GlyphCache::Glyph glyph;
+    memset(&glyph, 0, sizeof(glyph));
+    glyph.w        = w;
+    glyph.h        = h;
+    glyph.advance  = w;
+    glyph.provided = true;
+    return glyph;
+}
+
+static bool overlaps(const GlyphCache::Glyph &a, const GlyphCache::Glyph &b)
+{
+    return a.page == b.page &&
+           a.x < b.x + b.w && b.x < a.x + a.w &&
+           a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+TEST(GlyphCacheTest, FindsInsertedGlyphs)
+{
+    GlyphCache cache(64, 64, 2);
+    GlyphCache::Glyph glyph = makeGlyph(10, 12);
+    bool pageReset;
+
+    ASSERT_FALSE(cache.find('A', glyph));
+    ASSERT_TRUE(cache.insert('A', glyph, pageReset));
+    ASSERT_FALSE(pageReset);
+
+    GlyphCache::Glyph found;
+    ASSERT_TRUE(cache.find('A', found));
+    ASSERT_EQ(10, found.w);
+    ASSERT_EQ(12, found.h);
+    ASSERT_EQ(0u, found.page);
+    ASSERT_EQ(1u, cache.size());
+}
+
+TEST(GlyphCacheTest, ShelvesDoNotOverlap)
+{
+    GlyphCache cache(64, 64, 1);
+    std::vector<GlyphCache::Glyph> glyphs;
+    bool pageReset;
+
+    // Mixed heights, the way Latin and CJK glyphs come in
+    for(unsigned int i = 0; i < 20; i++)
+    {
+        GlyphCache::Glyph glyph = makeGlyph(7 + i % 5, (i % 3 == 0) ? 14 : 10);
+        ASSERT_TRUE(cache.insert(0x4e00 + i, glyph, pageReset));
+        ASSERT_FALSE(pageReset);
+        ASSERT_LE(glyph.x + glyph.w, 64);
+        ASSERT_LE(glyph.y + glyph.h, 64);
+        glyphs.push_back(glyph);
+    }
+
+    for(unsigned int i = 0; i < glyphs.size(); i++)
+    {
+        for(unsigned int j = i + 1; j < glyphs.size(); j++)
+        {
+            ASSERT_FALSE(overlaps(glyphs[i], glyphs[j])) << i << " and " << j;
+        }
+    }
+}
+
+TEST(GlyphCacheTest, EvictsTheLeastRecentlyUsedPage)
+{
+    // One 16x16 glyph per page
+    GlyphCache cache(16, 16, 2);
+    GlyphCache::Glyph glyph;
+    bool pageReset;
+
+    glyph = makeGlyph(16, 16);
+    ASSERT_TRUE(cache.insert('a', glyph, pageReset));
+    glyph = makeGlyph(16, 16);
+    ASSERT_TRUE(cache.insert('b', glyph, pageReset));
+    ASSERT_EQ(2u, cache.getPageCount());
+
+    // 'a' was drawn last, so the page of 'b' goes
+    ASSERT_TRUE(cache.find('a', glyph));
+    glyph = makeGlyph(16, 16);
+    ASSERT_TRUE(cache.insert('c', glyph, pageReset));
+    ASSERT_TRUE(pageReset);
+    ASSERT_EQ(1u, glyph.page);
+    ASSERT_EQ(2u, cache.getPageCount());
+
+    ASSERT_TRUE(cache.find('a', glyph));
+    ASSERT_FALSE(cache.find('b', glyph));
+    ASSERT_TRUE(cache.find('c', glyph));
+    ASSERT_EQ(2u, cache.size());
+}
+
+TEST(GlyphCacheTest, RejectsGlyphsLargerThanAPage)
+{
+    GlyphCache cache(16, 16, 2);
+    GlyphCache::Glyph glyph = makeGlyph(17, 10);
+    bool pageReset;
+
+    ASSERT_FALSE(cache.insert('W', glyph, pageReset));
+    ASSERT_FALSE(cache.find('W', glyph));
+}
+
+TEST(GlyphCacheTest, RemembersMissingGlyphs)
+{
+    GlyphCache cache(16, 16, 1);
+    GlyphCache::Glyph glyph;
+    memset(&glyph, 0, sizeof(glyph));
+    bool pageReset;
+
+    ASSERT_TRUE(cache.insert(0x1d11e, glyph, pageReset));
+    ASSERT_EQ(0u, cache.getPageCount());
+
+    GlyphCache::Glyph found;
+    ASSERT_TRUE(cache.find(0x1d11e, found));
+    ASSERT_FALSE(found.provided);
+}
+
+TEST(GlyphCacheTest, HashTableGrowsAndSurvivesEvictions)
+{
+    GlyphCache cache(64, 64, 4);
+    bool pageReset;
+
+    // Far more glyphs than fit, so pages are reused over and over
+    for(unsigned int i = 0; i < 5000; i++)
+    {
+        GlyphCache::Glyph glyph = makeGlyph(8, 8);
+        ASSERT_TRUE(cache.insert(0x3000 + i, glyph, pageReset));
+
+        GlyphCache::Glyph found;
+        ASSERT_TRUE(cache.find(0x3000 + i, found));
+        ASSERT_EQ(glyph.page, found.page);
+        ASSERT_EQ(glyph.x, found.x);
+        ASSERT_EQ(glyph.y, found.y);
+    }
+
+    // 4 pages of 64 glyphs at most
+    ASSERT_LE(cache.size(), 256u);
+    ASSERT_GT(cache.size(), 192u);
+}
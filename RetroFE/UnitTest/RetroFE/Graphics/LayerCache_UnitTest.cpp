@@ -0,0 +1,167 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <Graphics/LayerCache.h>
+#include <Graphics/PixelBlend.h>
+#include "PixelHash.h"
+#include <stdint.h>
+#include <vector>
+
+#define SCENE_WIDTH   64
+#define SCENE_HEIGHT  48
+#define GOLDEN_FRAME  0x0dfc77dfu  // FNV-1a of the RGB565 scene at frame 5
+
+// A layout drawn the way Page does in RGB565: an opaque background and a
+// translucent panel that stay put, under a sprite moving every frame
+class LayerCacheTest : public ::testing::Test
+{
+protected:
+    struct Layer
+    {
+        int x;
+        int y;
+        int width;
+        int height;
+        uint8_t alpha;
+        std::vector<uint16_t> rgb;
+        std::vector<uint8_t>  mask;
+    };
+
+    virtual void SetUp()
+    {
+        background = makeLayer(0, 0, SCENE_WIDTH, SCENE_HEIGHT, false, 1);
+        panel      = makeLayer(8, 6, 40, 30, true, 2);
+        sprite     = makeLayer(0, 20, 10, 10, true, 3);
+    }
+
+    static Layer makeLayer(int x, int y, int width, int height, bool translucent, int seed)
+    {
+        Layer layer = { x, y, width, height, 255, std::vector<uint16_t>(), std::vector<uint8_t>() };
+        for(int j = 0; j < height; ++j)
+        {
+            for(int i = 0; i < width; ++i)
+            {
+                unsigned int r = (i * 31 / width + seed * 5) & 0x1f;
+                unsigned int g = (j * 63 / height + seed * 9) & 0x3f;
+                unsigned int b = ((i + j) * seed) & 0x1f;
+                layer.rgb.push_back(static_cast<uint16_t>((r << 11) | (g << 5) | b));
+                layer.mask.push_back(static_cast<uint8_t>(translucent ? (i * 255 / (width - 1)) : 255));
+            }
+        }
+        return layer;
+    }
+
+    static void draw(std::vector<uint16_t> &frame, const Layer &layer)
+    {
+        for(int j = 0; j < layer.height; ++j)
+        {
+            PixelBlend::blendRgb565A8(&frame[(layer.y + j) * SCENE_WIDTH + layer.x], &layer.rgb[j * layer.width],
+                                      &layer.mask[j * layer.width], layer.width, layer.alpha);
+        }
+    }
+
+    static LayerCache::Member member(const Layer &layer, unsigned int stamp, unsigned int index)
+    {
+        LayerCache::Member m = { &layer, stamp, index, layer.x, layer.y, layer.width, layer.height, layer.alpha / 255.0f };
+        return m;
+    }
+
+    std::vector<LayerCache::Member> members()
+    {
+        std::vector<LayerCache::Member> list;
+        list.push_back(member(background, backgroundStamp, 0));
+        list.push_back(member(panel, 1, 1));
+        return list;
+    }
+
+    // Everything drawn, as without the cache
+    std::vector<uint16_t> drawFrame(int t)
+    {
+        std::vector<uint16_t> frame(SCENE_WIDTH * SCENE_HEIGHT, 0);
+        draw(frame, background);
+        draw(frame, panel);
+        sprite.x = t * 5;
+        draw(frame, sprite);
+        return frame;
+    }
+
+    // The static layers copied from the cache, drawn and stored on a miss
+    std::vector<uint16_t> drawCachedFrame(int t)
+    {
+        std::vector<uint16_t> frame(SCENE_WIDTH * SCENE_HEIGHT, 0);
+        std::vector<LayerCache::Member> list = members();
+        if(!cache.restore(list, &frame[0], SCENE_WIDTH, SCENE_HEIGHT, SCENE_WIDTH * 2, 2))
+        {
+            draw(frame, background);
+            draw(frame, panel);
+            cache.store(list, &frame[0], SCENE_WIDTH, SCENE_HEIGHT, SCENE_WIDTH * 2, 2);
+        }
+        sprite.x = t * 5;
+        draw(frame, sprite);
+        return frame;
+    }
+
+    Layer background;
+    Layer panel;
+    Layer sprite;
+    unsigned int backgroundStamp = 1;
+    LayerCache cache;
+};
+
+TEST_F(LayerCacheTest, CachedFramesAreTheDrawnFrames)
+{
+    for(int t = 0; t < 10; ++t)
+    {
+        std::vector<uint16_t> drawn = drawFrame(t);
+        ASSERT_TRUE(drawn == drawCachedFrame(t)) << "frame " << t;
+        if(t == 5)
+        {
+            ASSERT_EQ(GOLDEN_FRAME, pixelHash(drawn));
+        }
+    }
+
+    ASSERT_EQ(9u, cache.getHits());
+    ASSERT_EQ(1u, cache.getMisses());
+}
+
+TEST_F(LayerCacheTest, ChangedMembersAreDrawnAgain)
+{
+    drawCachedFrame(0);
+    drawCachedFrame(1);
+    ASSERT_EQ(1u, cache.getMisses());
+
+    // Faded panel
+    panel.alpha = 128;
+    ASSERT_TRUE(drawFrame(2) == drawCachedFrame(2));
+    ASSERT_EQ(2u, cache.getMisses());
+
+    // Moved panel
+    panel.x = 10;
+    ASSERT_TRUE(drawFrame(3) == drawCachedFrame(3));
+    ASSERT_EQ(3u, cache.getMisses());
+
+    // New pixels, announced by a new change stamp only
+    background = makeLayer(0, 0, SCENE_WIDTH, SCENE_HEIGHT, false, 7);
+    backgroundStamp = 2;
+    ASSERT_TRUE(drawFrame(4) == drawCachedFrame(4));
+    ASSERT_EQ(4u, cache.getMisses());
+
+    ASSERT_TRUE(drawFrame(5) == drawCachedFrame(5));
+    ASSERT_EQ(2u, cache.getHits());
+}
+
+TEST_F(LayerCacheTest, InvalidatedOrResizedCacheMisses)
+{
+    drawCachedFrame(0);
+    ASSERT_TRUE(cache.isValid());
+
+    cache.invalidate();
+    ASSERT_FALSE(cache.isValid());
+    ASSERT_TRUE(drawFrame(1) == drawCachedFrame(1));
+    ASSERT_EQ(0u, cache.getHits());
+    ASSERT_EQ(2u, cache.getMisses());
+
+    // Same members, but a window of another size
+    std::vector<uint16_t> other(SCENE_WIDTH * SCENE_HEIGHT, 0);
+    ASSERT_FALSE(cache.restore(members(), &other[0], SCENE_WIDTH / 2, SCENE_HEIGHT, SCENE_WIDTH * 2, 2));
+    ASSERT_EQ(3u, cache.getMisses());
+}
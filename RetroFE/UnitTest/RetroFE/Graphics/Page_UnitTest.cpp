@@ -0,0 +1,142 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <SDL.h>
+#include <Database/Configuration.h>
+#include <Graphics/Page.h>
+#include <Graphics/Animate/Animation.h>
+#include <Graphics/Animate/AnimationEvents.h>
+#include <Graphics/Animate/Tween.h>
+#include <Graphics/Animate/TweenSet.h>
+#include <Graphics/Component/Image.h>
+#include "PixelHash.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+
+#define FRAMES 8
+
+// Run with SDL_VIDEODRIVER=dummy, set by ctest. A page of real images:
+// a background and a panel that stay put in layer 0, under a sprite
+// moving every frame in layer 1, still moving on the last one. Drawn with and without flattening, the
+// window must show the same frames.
+class PageTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        char dir[] = "/tmp/PageTest.XXXXXX";
+        ASSERT_TRUE(mkdtemp(dir) != NULL);
+        root = dir;
+
+        config.setProperty("horizontal", "64");
+        config.setProperty("vertical", "48");
+        config.setProperty("fullscreen", "no");
+        config.setProperty("showFrame", "yes");
+        ASSERT_TRUE(SDL::initialize(config));
+
+        writeImage(root + "/background.bmp", 64, 48, 20, 60, 120);
+        writeImage(root + "/panel.bmp", 32, 24, 200, 200, 40);
+        writeImage(root + "/sprite.bmp", 8, 8, 240, 20, 20);
+    }
+
+    virtual void TearDown()
+    {
+        for(std::vector<AnimationEvents *>::iterator it = tweens.begin(); it != tweens.end(); ++it)
+        {
+            delete *it;
+        }
+        SDL::deInitialize();
+        unlink((root + "/background.bmp").c_str());
+        unlink((root + "/panel.bmp").c_str());
+        unlink((root + "/sprite.bmp").c_str());
+        rmdir(root.c_str());
+    }
+
+    void writeImage(std::string file, int width, int height, Uint8 r, Uint8 g, Uint8 b)
+    {
+        SDL_Surface *surface = SDL_CreateRGBSurface(SDL_SWSURFACE, width, height, 32, 0xff0000, 0xff00, 0xff, 0);
+        SDL_FillRect(surface, NULL, SDL_MapRGB(surface->format, r, g, b));
+        SDL_SaveBMP(surface, file.c_str());
+        SDL_FreeSurface(surface);
+    }
+
+    // Moved right during its "enter" animation if duration is set
+    Image *addImage(Page &page, std::string name, unsigned int layer, float x, float y, float duration = 0)
+    {
+        Image *component = new Image(root + "/" + name, "", page, 1, 1, false);
+        component->baseViewInfo.X = x;
+        component->baseViewInfo.Y = y;
+        component->baseViewInfo.Layer = layer;
+        AnimationEvents *events = new AnimationEvents();
+        if(duration > 0)
+        {
+            TweenSet *set = new TweenSet();
+            set->push(new Tween(TWEEN_PROPERTY_X, LINEAR, x, x + 48, duration));
+            Animation *animation = new Animation();
+            animation->Push(set);
+            events->setAnimation("enter", -1, animation);
+        }
+        component->setTweens(events);
+        tweens.push_back(events);
+        page.addComponent(component);
+        return component;
+    }
+
+    // Hashes of the window after each frame. Halfway through, the panel
+    // fades, so the flattened layers are drawn again once.
+    std::vector<uint32_t> drawFrames(bool flatten, unsigned int &hits)
+    {
+        config.setProperty("flattenLayers", flatten ? "yes" : "no");
+        Page page(config);
+        addImage(page, "background.bmp", 0, 0, 0);
+        Image *panel = addImage(page, "panel.bmp", 0, 16, 12);
+        addImage(page, "sprite.bmp", 1, 0, 20, FRAMES * 0.2f);
+
+        page.allocateGraphicsMemory();
+        page.start();
+        page.update(0);
+
+        std::vector<uint32_t> frames;
+        SDL_Surface *window = SDL::getWindow();
+        for(int frame = 0; frame < FRAMES; frame++)
+        {
+            if(frame == FRAMES / 2) panel->baseViewInfo.Alpha = 0.5f;
+            page.update(0.1f);
+            page.draw();
+
+            std::vector<Uint8> pixels;
+            for(int y = 0; y < window->h; y++)
+            {
+                Uint8 *row = static_cast<Uint8 *>(window->pixels) + y * window->pitch;
+                pixels.insert(pixels.end(), row, row + window->w * window->format->BytesPerPixel);
+            }
+            frames.push_back(pixelHash(&pixels[0], pixels.size()));
+        }
+
+        hits = page.layerCache_.getHits();
+        page.deInitialize();
+        return frames;
+    }
+
+    Configuration config;
+    std::string root;
+    std::vector<AnimationEvents *> tweens;
+};
+
+TEST_F(PageTest, FlatteningKeepsTheFrames)
+{
+    unsigned int drawnHits;
+    unsigned int flattenedHits;
+    std::vector<uint32_t> drawn = drawFrames(false, drawnHits);
+    std::vector<uint32_t> flattened = drawFrames(true, flattenedHits);
+
+    // Missed on the first frame and when the panel faded
+    ASSERT_EQ(0u, drawnHits);
+    ASSERT_EQ(static_cast<unsigned int>(FRAMES - 2), flattenedHits);
+
+    for(int frame = 1; frame < FRAMES; frame++)
+    {
+        ASSERT_NE(drawn[frame - 1], drawn[frame]);
+    }
+    ASSERT_EQ(drawn, flattened);
+}
@@ -0,0 +1,186 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <Graphics/PixelBlend.h>
+#include "PixelHash.h"
+#include <cstdlib>
+#include <vector>
+
+#define SCENE_WIDTH   37
+#define SCENE_HEIGHT  23
+#define GOLDEN_OPAQUE 0x60a0c29au  // FNV-1a of the scene blended at full alpha
+#define GOLDEN_FADED  0x251566acu  // and faded to half
+
+// A gradient background with a translucent sprite drawn over it, kept
+// in ARGB8888 as loaded from a PNG (red in the low byte)
+class PixelBlendTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        srand(1234);
+        for(int y = 0; y < SCENE_HEIGHT; ++y)
+        {
+            for(int x = 0; x < SCENE_WIDTH; ++x)
+            {
+                unsigned int r = x * 255 / (SCENE_WIDTH - 1);
+                unsigned int g = y * 255 / (SCENE_HEIGHT - 1);
+                unsigned int b = (x * y) & 0xff;
+                background.push_back(0xff000000 | (b << 16) | (g << 8) | r);
+
+                int dx = 2 * x - SCENE_WIDTH;
+                int dy = 2 * y - SCENE_HEIGHT;
+                int distance = dx * dx + dy * dy;
+                int radius = SCENE_HEIGHT * SCENE_HEIGHT;
+                unsigned int a = distance >= radius ? 0 : 255 - distance * 255 / radius;
+                sprite.push_back((a << 24) | (0x20 << 16) | (0xc0 << 8) | 0xf0);
+            }
+        }
+    }
+
+    static uint16_t to565(uint32_t p)
+    {
+        return static_cast<uint16_t>(((p & 0xf8) << 8) | (((p >> 8) & 0xfc) << 3) | ((p >> 19) & 0x1f));
+    }
+
+    // The scene blended in RGB565 with the kernel under test
+    std::vector<uint16_t> compose565(uint8_t globalAlpha, bool scalar)
+    {
+        std::vector<uint16_t> frame;
+        std::vector<uint16_t> rgb(SCENE_WIDTH);
+        std::vector<uint8_t> alpha(SCENE_WIDTH);
+
+        for(int i = 0; i < SCENE_WIDTH * SCENE_HEIGHT; ++i)
+        {
+            frame.push_back(to565(background[i]));
+        }
+
+        for(int y = 0; y < SCENE_HEIGHT; ++y)
+        {
+            PixelBlend::splitArgb8888(&sprite[y * SCENE_WIDTH], &rgb[0], &alpha[0], SCENE_WIDTH, 0, 8, 16, 24);
+            if(scalar)
+            {
+                PixelBlend::blendRgb565A8Scalar(&frame[y * SCENE_WIDTH], &rgb[0], &alpha[0], SCENE_WIDTH, globalAlpha);
+            }
+            else
+            {
+                PixelBlend::blendRgb565A8(&frame[y * SCENE_WIDTH], &rgb[0], &alpha[0], SCENE_WIDTH, globalAlpha);
+            }
+        }
+
+        return frame;
+    }
+
+    // The same scene blended in floating point at 8 bits per channel
+    float reference(int i, int channel, uint8_t globalAlpha)
+    {
+        float a = (sprite[i] >> 24) / 255.0f * globalAlpha / 255.0f;
+        float s = (sprite[i] >> (channel * 8)) & 0xff;
+        float d = (background[i] >> (channel * 8)) & 0xff;
+        return s * a + d * (1.0f - a);
+    }
+
+    std::vector<uint32_t> background;
+    std::vector<uint32_t> sprite;
+};
+
+TEST_F(PixelBlendTest, SplitTruncatesLikeSdl)
+{
+    uint32_t argb[] = { 0x80ffffff, 0x00000000, 0xff0804f8, 0x7f123456 };
+    uint16_t rgb[4];
+    uint8_t alpha[4];
+
+    // Blue in the low byte here
+    PixelBlend::splitArgb8888(argb, rgb, alpha, 4, 16, 8, 0, 24);
+
+    ASSERT_EQ(0xffff, rgb[0]);
+    ASSERT_EQ(0x80, alpha[0]);
+    ASSERT_EQ(0x0000, rgb[1]);
+    ASSERT_EQ(0x00, alpha[1]);
+    ASSERT_EQ((0x08 >> 3 << 11) | (0x04 >> 2 << 5) | (0xf8 >> 3), rgb[2]);
+    ASSERT_EQ(0xff, alpha[2]);
+    ASSERT_EQ((0x12 >> 3 << 11) | (0x34 >> 2 << 5) | (0x56 >> 3), rgb[3]);
+    ASSERT_EQ(0x7f, alpha[3]);
+}
+
+TEST_F(PixelBlendTest, OpaqueAndTransparentEnds)
+{
+    uint16_t src[3] = { 0x1234, 0xffff, 0x0000 };
+    uint8_t alpha[3] = { 255, 0, 255 };
+    uint16_t dst[3] = { 0xabcd, 0xabcd, 0xabcd };
+
+    PixelBlend::blendRgb565A8(dst, src, alpha, 3, 255);
+    ASSERT_EQ(0x1234, dst[0]);
+    ASSERT_EQ(0xabcd, dst[1]);
+    ASSERT_EQ(0x0000, dst[2]);
+
+    PixelBlend::blendRgb565A8(dst, src, NULL, 3, 255);
+    ASSERT_EQ(0x1234, dst[0]);
+    ASSERT_EQ(0xffff, dst[1]);
+
+    uint16_t untouched[3] = { 0xabcd, 0xabcd, 0xabcd };
+    PixelBlend::blendRgb565A8(untouched, src, NULL, 3, 0);
+    PixelBlend::blendRgb565A8(untouched, src, alpha, 3, 0);
+    ASSERT_EQ(0xabcd, untouched[0]);
+    ASSERT_EQ(0xabcd, untouched[2]);
+}
+
+TEST_F(PixelBlendTest, VectorKernelMatchesScalar)
+{
+    // Every length around the vector width, from unaligned pointers
+    std::vector<uint16_t> src(70);
+    std::vector<uint16_t> dst(70);
+    std::vector<uint8_t> alpha(70);
+
+    for(int count = 0; count < 40; ++count)
+    {
+        for(unsigned int i = 0; i < src.size(); ++i)
+        {
+            src[i] = static_cast<uint16_t>(rand());
+            dst[i] = static_cast<uint16_t>(rand());
+            alpha[i] = static_cast<uint8_t>(rand());
+        }
+        uint8_t globalAlpha = static_cast<uint8_t>(rand());
+
+        std::vector<uint16_t> expected = dst;
+        PixelBlend::blendRgb565A8Scalar(&expected[1], &src[3], &alpha[5], count, globalAlpha);
+        std::vector<uint16_t> actual = dst;
+        PixelBlend::blendRgb565A8(&actual[1], &src[3], &alpha[5], count, globalAlpha);
+        ASSERT_EQ(expected, actual) << "count " << count << " with " << PixelBlend::getKernelName();
+
+        expected = dst;
+        PixelBlend::blendRgb565A8Scalar(&expected[1], &src[3], NULL, count, globalAlpha);
+        actual = dst;
+        PixelBlend::blendRgb565A8(&actual[1], &src[3], NULL, count, globalAlpha);
+        ASSERT_EQ(expected, actual) << "opaque, count " << count << " with " << PixelBlend::getKernelName();
+    }
+}
+
+TEST_F(PixelBlendTest, Scene565MatchesArgb8888Reference)
+{
+    uint8_t levels[] = { 255, 200, 64 };
+
+    for(unsigned int level = 0; level < 3; ++level)
+    {
+        std::vector<uint16_t> frame = compose565(levels[level], false);
+
+        for(int i = 0; i < SCENE_WIDTH * SCENE_HEIGHT; ++i)
+        {
+            // One step of alpha and one step of the channel
+            float r = (frame[i] >> 11) * 255.0f / 31;
+            float g = ((frame[i] >> 5) & 0x3f) * 255.0f / 63;
+            float b = (frame[i] & 0x1f) * 255.0f / 31;
+            ASSERT_NEAR(reference(i, 0, levels[level]), r, 2 * 255.0f / 31) << "pixel " << i;
+            ASSERT_NEAR(reference(i, 1, levels[level]), g, 3 * 255.0f / 63) << "pixel " << i;
+            ASSERT_NEAR(reference(i, 2, levels[level]), b, 2 * 255.0f / 31) << "pixel " << i;
+        }
+    }
+}
+
+TEST_F(PixelBlendTest, GoldenScene565)
+{
+    // Any change to the blending math shows up here first
+    ASSERT_EQ(GOLDEN_OPAQUE, pixelHash(compose565(255, true)));
+    ASSERT_EQ(GOLDEN_FADED, pixelHash(compose565(128, true)));
+    ASSERT_EQ(GOLDEN_OPAQUE, pixelHash(compose565(255, false)));
+    ASSERT_EQ(GOLDEN_FADED, pixelHash(compose565(128, false)));
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// FNV-1a of a frame, compared with the golden values of the pixel tests.
+// Frames are made with integer math only, so the golden values hold on
+// every platform.
+inline uint32_t pixelHash(const void *data, size_t size)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    uint32_t h = 2166136261u;
+    for(size_t i = 0; i < size; ++i)
+    {
+        h = (h ^ bytes[i]) * 16777619u;
+    }
+    return h;
+}
+
+// An RGB565 frame, low byte first whatever the byte order
+inline uint32_t pixelHash(const std::vector<uint16_t> &frame)
+{
+    uint32_t h = 2166136261u;
+    for(size_t i = 0; i < frame.size(); ++i)
+    {
+        h = (h ^ (frame[i] & 0xff)) * 16777619u;
+        h = (h ^ (frame[i] >> 8)) * 16777619u;
+    }
+    return h;
+}
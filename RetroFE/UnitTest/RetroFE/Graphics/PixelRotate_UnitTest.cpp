@@ -0,0 +1,145 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <Graphics/PixelRotate.h>
+#include <cstring>
+#include <vector>
+
+// Naive references, one pixel at a time in the destination's own order
+static void rotateNaive(const std::vector<unsigned char> &src, int width, int height, int srcPitch,
+                        std::vector<unsigned char> &dst, int dstPitch, int bpp, int degrees)
+{
+    int dstWidth  = (degrees == 90 || degrees == 270) ? height : width;
+    int dstHeight = (degrees == 90 || degrees == 270) ? width : height;
+
+    for(int y = 0; y < dstHeight; y++)
+    {
+        for(int x = 0; x < dstWidth; x++)
+        {
+            int sx = x;
+            int sy = y;
+            if(degrees == 90)  { sx = y;             sy = height - 1 - x; }
+            if(degrees == 180) { sx = width - 1 - x; sy = height - 1 - y; }
+            if(degrees == 270) { sx = width - 1 - y; sy = x; }
+            memcpy(&dst[y * dstPitch + x * bpp], &src[sy * srcPitch + sx * bpp], bpp);
+        }
+    }
+}
+
+static void flipNaive(const std::vector<unsigned char> &src, int width, int height, int srcPitch,
+                      std::vector<unsigned char> &dst, int dstPitch, int bpp, bool horizontal, bool vertical)
+{
+    for(int y = 0; y < height; y++)
+    {
+        for(int x = 0; x < width; x++)
+        {
+            int sx = horizontal ? width - 1 - x : x;
+            int sy = vertical ? height - 1 - y : y;
+            memcpy(&dst[y * dstPitch + x * bpp], &src[sy * srcPitch + sx * bpp], bpp);
+        }
+    }
+}
+
+// Every byte distinct enough that a misplaced pixel shows
+static std::vector<unsigned char> makeImage(int pitch, int height)
+{
+    std::vector<unsigned char> image(pitch * height);
+    for(unsigned int i = 0; i < image.size(); i++)
+    {
+        image[i] = static_cast<unsigned char>((i * 2654435761u) >> 13);
+    }
+    return image;
+}
+
+static void checkRotation(int width, int height, int bpp, int degrees)
+{
+    // Padded rows on both sides, the padding must be left alone
+    int srcPitch  = width * bpp + 3 * bpp;
+    int dstWidth  = (degrees == 90 || degrees == 270) ? height : width;
+    int dstHeight = (degrees == 90 || degrees == 270) ? width : height;
+    int dstPitch  = dstWidth * bpp + 5 * bpp;
+
+    std::vector<unsigned char> src = makeImage(srcPitch, height);
+    std::vector<unsigned char> expected(dstPitch * dstHeight, 0xee);
+    std::vector<unsigned char> dst(dstPitch * dstHeight, 0xee);
+
+    rotateNaive(src, width, height, srcPitch, expected, dstPitch, bpp, degrees);
+    ASSERT_TRUE(PixelRotate::rotate(&src[0], width, height, srcPitch, &dst[0], dstPitch, bpp, degrees));
+    ASSERT_TRUE(dst == expected) << width << "x" << height << "x" << bpp << " rotated by " << degrees;
+}
+
+static void checkFlip(int width, int height, int bpp, bool horizontal, bool vertical)
+{
+    int srcPitch = width * bpp + bpp;
+    int dstPitch = width * bpp + 2 * bpp;
+
+    std::vector<unsigned char> src = makeImage(srcPitch, height);
+    std::vector<unsigned char> expected(dstPitch * height, 0xee);
+    std::vector<unsigned char> dst(dstPitch * height, 0xee);
+
+    flipNaive(src, width, height, srcPitch, expected, dstPitch, bpp, horizontal, vertical);
+    PixelRotate::flip(&src[0], width, height, srcPitch, &dst[0], dstPitch, bpp, horizontal, vertical);
+    ASSERT_TRUE(dst == expected) << width << "x" << height << "x" << bpp << " flipped " << horizontal << vertical;
+}
+
+static const int sizes[][2] = { { 1, 1 }, { 3, 5 }, { 8, 8 }, { 16, 16 }, { 17, 9 }, { 37, 23 }, { 240, 240 }, { 241, 97 } };
+
+TEST(PixelRotateTest, QuarterTurnsMatchTheNaiveLoop)
+{
+    for(unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        for(int bpp = 1; bpp <= 4; bpp++)
+        {
+            checkRotation(sizes[i][0], sizes[i][1], bpp, 90);
+            checkRotation(sizes[i][0], sizes[i][1], bpp, 270);
+        }
+    }
+}
+
+TEST(PixelRotateTest, HalfTurnMatchesTheNaiveLoop)
+{
+    for(unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        for(int bpp = 1; bpp <= 4; bpp++)
+        {
+            checkRotation(sizes[i][0], sizes[i][1], bpp, 0);
+            checkRotation(sizes[i][0], sizes[i][1], bpp, 180);
+        }
+    }
+}
+
+TEST(PixelRotateTest, FlipsMatchTheNaiveLoop)
+{
+    for(unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        for(int bpp = 1; bpp <= 4; bpp++)
+        {
+            checkFlip(sizes[i][0], sizes[i][1], bpp, true, false);
+            checkFlip(sizes[i][0], sizes[i][1], bpp, false, true);
+            checkFlip(sizes[i][0], sizes[i][1], bpp, true, true);
+        }
+    }
+}
+
+TEST(PixelRotateTest, FourQuarterTurnsGiveTheImageBack)
+{
+    int width  = 45;
+    int height = 29;
+    std::vector<unsigned char> image = makeImage(width * 2, height);
+    std::vector<unsigned char> turned(image.size());
+
+    for(int turn = 0; turn < 4; turn++)
+    {
+        int w = turn % 2 ? height : width;
+        int h = turn % 2 ? width : height;
+        ASSERT_TRUE(PixelRotate::rotate(&image[0], w, h, w * 2, &turned[0], h * 2, 2, 90));
+        image.swap(turned);
+    }
+    ASSERT_TRUE(image == makeImage(width * 2, height));
+}
+
+TEST(PixelRotateTest, RejectsOtherAngles)
+{
+    unsigned int pixel = 0;
+    unsigned int out   = 0;
+    ASSERT_FALSE(PixelRotate::rotate(&pixel, 1, 1, 4, &out, 4, 4, 45));
+}
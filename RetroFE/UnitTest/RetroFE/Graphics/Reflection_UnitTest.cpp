@@ -0,0 +1,298 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <Graphics/Reflection.h>
+#include "PixelHash.h"
+#include <stdint.h>
+#include <vector>
+
+#define SCENE_WIDTH    80
+#define SCENE_HEIGHT   64
+#define SPRITE_WIDTH   20
+#define SPRITE_HEIGHT  12
+#define GOLDEN_TOP         0x804521a1u  // FNV-1a of the RGB565 scene with each reflection
+#define GOLDEN_BOTTOM      0x0fa67995u
+#define GOLDEN_LEFT        0xc96d4603u
+#define GOLDEN_RIGHT       0xe0c568e5u
+#define GOLDEN_BOTTOM_8888 0x83309c20u  // and of the 32-bit scene
+
+// A gradient background and a sprite with a soft edge, in ARGB8888 as
+// loaded from a PNG (red in the low byte)
+class ReflectionTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        for(int y = 0; y < SCENE_HEIGHT; ++y)
+        {
+            for(int x = 0; x < SCENE_WIDTH; ++x)
+            {
+                unsigned int r = x * 255 / (SCENE_WIDTH - 1);
+                unsigned int g = y * 255 / (SCENE_HEIGHT - 1);
+                unsigned int b = (x * y) & 0xff;
+                background.push_back(0xff000000 | (b << 16) | (g << 8) | r);
+            }
+        }
+
+        for(int y = 0; y < SPRITE_HEIGHT; ++y)
+        {
+            for(int x = 0; x < SPRITE_WIDTH; ++x)
+            {
+                unsigned int a = x < 3 ? 80 * x : 255;
+                unsigned int r = 40 + y * 15;
+                unsigned int g = 200 - x * 7;
+                unsigned int b = (x + y) % 2 ? 0xff : 0x30;
+                sprite.push_back((a << 24) | (b << 16) | (g << 8) | r);
+            }
+        }
+    }
+
+    static Reflection::Surface describe(void *pixels, int width, int height, int bytesPerPixel, bool alpha)
+    {
+        Reflection::Surface s;
+        s.pixels        = pixels;
+        s.width         = width;
+        s.height        = height;
+        s.pitch         = width * bytesPerPixel;
+        s.bytesPerPixel = bytesPerPixel;
+        s.rShift        = 0;
+        s.gShift        = 8;
+        s.bShift        = 16;
+        s.aShift        = alpha ? 24 : -1;
+        s.premultiplied = false;
+        s.keyed         = false;
+        s.key           = 0;
+        return s;
+    }
+
+    static uint16_t to565(uint32_t p)
+    {
+        return static_cast<uint16_t>(((p & 0xf8) << 8) | (((p >> 8) & 0xfc) << 3) | ((p >> 19) & 0x1f));
+    }
+
+    // The sprite's reflection over the background, in RGB565
+    std::vector<uint16_t> scene565(Reflection::Side side, bool keep)
+    {
+        std::vector<uint16_t> frame;
+        for(unsigned int i = 0; i < background.size(); ++i)
+        {
+            frame.push_back(to565(background[i]));
+        }
+
+        Reflection::Rect area  = { 0, 0, SPRITE_WIDTH, SPRITE_HEIGHT };
+        Reflection::Rect image = { 30, 24, SPRITE_WIDTH * 2, SPRITE_HEIGHT * 2 };
+        Reflection::Rect placement = Reflection::place(side, image, 0.5f, 2);
+        reflection.draw(describe(&sprite[0], SPRITE_WIDTH, SPRITE_HEIGHT, 4, true), area, side, placement, 0.8f,
+                        describe(&frame[0], SCENE_WIDTH, SCENE_HEIGHT, 2, false), 230, keep);
+        return frame;
+    }
+
+    std::vector<uint32_t> background;
+    std::vector<uint32_t> sprite;
+    Reflection reflection;
+};
+
+TEST_F(ReflectionTest, PlacesTheReflectionNextToTheImage)
+{
+    Reflection::Rect image = { 10, 20, 40, 30 };
+
+    Reflection::Rect top = Reflection::place(Reflection::SIDE_TOP, image, 0.5f, 3);
+    ASSERT_EQ(10, top.x);
+    ASSERT_EQ(20 - 15 - 3, top.y);
+    ASSERT_EQ(40, top.w);
+    ASSERT_EQ(15, top.h);
+
+    Reflection::Rect bottom = Reflection::place(Reflection::SIDE_BOTTOM, image, 0.5f, 3);
+    ASSERT_EQ(20 + 30 + 3, bottom.y);
+    ASSERT_EQ(15, bottom.h);
+
+    Reflection::Rect left = Reflection::place(Reflection::SIDE_LEFT, image, 0.25f, 0);
+    ASSERT_EQ(0, left.x);
+    ASSERT_EQ(10, left.w);
+    ASSERT_EQ(30, left.h);
+
+    Reflection::Rect right = Reflection::place(Reflection::SIDE_RIGHT, image, 0.25f, 0);
+    ASSERT_EQ(50, right.x);
+    ASSERT_EQ(10, right.w);
+
+    ASSERT_EQ(Reflection::SIDE_NONE, Reflection::parseSide(""));
+    ASSERT_EQ(Reflection::SIDE_RIGHT, Reflection::parseSide("right"));
+}
+
+TEST_F(ReflectionTest, MatchesTheGoldenImages)
+{
+    std::vector<uint16_t> top    = scene565(Reflection::SIDE_TOP, false);
+    std::vector<uint16_t> bottom = scene565(Reflection::SIDE_BOTTOM, false);
+    std::vector<uint16_t> left   = scene565(Reflection::SIDE_LEFT, false);
+    std::vector<uint16_t> right  = scene565(Reflection::SIDE_RIGHT, false);
+
+    ASSERT_EQ(GOLDEN_TOP,    pixelHash(&top[0],    top.size() * 2));
+    ASSERT_EQ(GOLDEN_BOTTOM, pixelHash(&bottom[0], bottom.size() * 2));
+    ASSERT_EQ(GOLDEN_LEFT,   pixelHash(&left[0],   left.size() * 2));
+    ASSERT_EQ(GOLDEN_RIGHT,  pixelHash(&right[0],  right.size() * 2));
+}
+
+TEST_F(ReflectionTest, MatchesTheGoldenImageIn32Bits)
+{
+    std::vector<uint32_t> frame(background);
+    Reflection::Rect area  = { 0, 0, SPRITE_WIDTH, SPRITE_HEIGHT };
+    Reflection::Rect image = { 30, 24, SPRITE_WIDTH * 2, SPRITE_HEIGHT * 2 };
+    Reflection::Rect placement = Reflection::place(Reflection::SIDE_BOTTOM, image, 0.5f, 2);
+
+    reflection.draw(describe(&sprite[0], SPRITE_WIDTH, SPRITE_HEIGHT, 4, true), area, Reflection::SIDE_BOTTOM, placement,
+                    0.8f, describe(&frame[0], SCENE_WIDTH, SCENE_HEIGHT, 4, false), 230, false);
+
+    ASSERT_EQ(GOLDEN_BOTTOM_8888, pixelHash(&frame[0], frame.size() * 4));
+}
+
+TEST_F(ReflectionTest, MirrorsAndFadesAwayFromTheImage)
+{
+    // Opaque sprite at its own size over black, reflected at full alpha
+    for(unsigned int i = 0; i < sprite.size(); ++i)
+    {
+        sprite[i] |= 0xff000000;
+    }
+    std::vector<uint32_t> frame(SCENE_WIDTH * SCENE_HEIGHT, 0);
+    Reflection::Rect area  = { 0, 0, SPRITE_WIDTH, SPRITE_HEIGHT };
+    Reflection::Rect image = { 4, 4, SPRITE_WIDTH, SPRITE_HEIGHT };
+    Reflection::Rect placement = Reflection::place(Reflection::SIDE_BOTTOM, image, 1.0f, 0);
+
+    reflection.draw(describe(&sprite[0], SPRITE_WIDTH, SPRITE_HEIGHT, 4, false), area, Reflection::SIDE_BOTTOM, placement,
+                    1.0f, describe(&frame[0], SCENE_WIDTH, SCENE_HEIGHT, 4, false), 255, false);
+
+    // The row next to the image is its last row, untouched
+    for(int x = 0; x < SPRITE_WIDTH; ++x)
+    {
+        ASSERT_EQ(sprite[(SPRITE_HEIGHT - 1) * SPRITE_WIDTH + x] & 0xffffff, frame[16 * SCENE_WIDTH + 4 + x]);
+    }
+
+    // Each row further is dimmer, the far one nearly black
+    for(int y = 17; y < 16 + SPRITE_HEIGHT; ++y)
+    {
+        unsigned int far  = frame[y * SCENE_WIDTH + 4 + 5] & 0xff;
+        unsigned int near = sprite[(SPRITE_HEIGHT - 1 - (y - 16)) * SPRITE_WIDTH + 5] & 0xff;
+        ASSERT_LT(far, near);
+    }
+    ASSERT_LE(frame[(15 + SPRITE_HEIGHT) * SCENE_WIDTH + 9] & 0xff, 0x20u);
+
+    // Nothing drawn outside the reflection
+    ASSERT_EQ(0u, frame[15 * SCENE_WIDTH + 9]);
+    ASSERT_EQ(0u, frame[(16 + SPRITE_HEIGHT) * SCENE_WIDTH + 9]);
+    ASSERT_EQ(0u, frame[20 * SCENE_WIDTH + 3]);
+    ASSERT_EQ(0u, frame[20 * SCENE_WIDTH + 4 + SPRITE_WIDTH]);
+}
+
+TEST_F(ReflectionTest, KeptRowsGiveTheSameImage)
+{
+    Reflection::Side sides[] = { Reflection::SIDE_TOP, Reflection::SIDE_BOTTOM, Reflection::SIDE_LEFT, Reflection::SIDE_RIGHT };
+    for(int i = 0; i < 4; ++i)
+    {
+        std::vector<uint16_t> sampled = scene565(sides[i], false);
+        ASSERT_TRUE(sampled == scene565(sides[i], true));
+        ASSERT_TRUE(sampled == scene565(sides[i], true));
+    }
+}
+
+TEST_F(ReflectionTest, KeptRowsAreReusedUntilCleared)
+{
+    std::vector<uint16_t> first = scene565(Reflection::SIDE_BOTTOM, true);
+
+    // Same texture and geometry: the kept rows are drawn, not the new pixels
+    for(unsigned int i = 0; i < sprite.size(); ++i)
+    {
+        sprite[i] ^= 0x00ffffff;
+    }
+    ASSERT_TRUE(first == scene565(Reflection::SIDE_BOTTOM, true));
+
+    reflection.clear();
+    ASSERT_FALSE(first == scene565(Reflection::SIDE_BOTTOM, true));
+}
+
+TEST_F(ReflectionTest, ReadsPremultipliedAndKeyedTextures)
+{
+    Reflection::Rect area  = { 0, 0, SPRITE_WIDTH, SPRITE_HEIGHT };
+    Reflection::Rect image = { 30, 24, SPRITE_WIDTH * 2, SPRITE_HEIGHT * 2 };
+    Reflection::Rect placement = Reflection::place(Reflection::SIDE_BOTTOM, image, 0.5f, 2);
+
+    // The sprite stored premultiplied reflects like the straight one
+    std::vector<uint32_t> premultiplied;
+    for(unsigned int i = 0; i < sprite.size(); ++i)
+    {
+        uint32_t a = sprite[i] >> 24;
+        uint32_t p = a << 24;
+        for(int shift = 0; shift < 24; shift += 8)
+        {
+            p |= (((sprite[i] >> shift) & 0xff) * a / 255) << shift;
+        }
+        premultiplied.push_back(p);
+    }
+    Reflection::Surface texture = describe(&premultiplied[0], SPRITE_WIDTH, SPRITE_HEIGHT, 4, true);
+    texture.premultiplied = true;
+
+    std::vector<uint32_t> straight(background);
+    std::vector<uint32_t> frame(background);
+    reflection.draw(describe(&sprite[0], SPRITE_WIDTH, SPRITE_HEIGHT, 4, true), area, Reflection::SIDE_BOTTOM, placement,
+                    0.8f, describe(&straight[0], SCENE_WIDTH, SCENE_HEIGHT, 4, false), 230, false);
+    reflection.draw(texture, area, Reflection::SIDE_BOTTOM, placement,
+                    0.8f, describe(&frame[0], SCENE_WIDTH, SCENE_HEIGHT, 4, false), 230, false);
+    for(unsigned int i = 0; i < frame.size(); ++i)
+    {
+        for(int shift = 0; shift < 24; shift += 8)
+        {
+            ASSERT_NEAR((straight[i] >> shift) & 0xff, (frame[i] >> shift) & 0xff, 2) << "pixel " << i;
+        }
+    }
+
+    // The key color of an RGB565 texture is not reflected
+    std::vector<uint16_t> keyed(SPRITE_WIDTH * SPRITE_HEIGHT, 0xffff);
+    for(int y = 0; y < SPRITE_HEIGHT; ++y)
+    {
+        for(int x = 0; x < SPRITE_WIDTH / 2; ++x)
+        {
+            keyed[y * SPRITE_WIDTH + x] = 0xf81f;
+        }
+    }
+    texture = describe(&keyed[0], SPRITE_WIDTH, SPRITE_HEIGHT, 2, false);
+    texture.keyed = true;
+    texture.key   = 0xf81f;
+
+    std::vector<uint16_t> black(SCENE_WIDTH * SCENE_HEIGHT, 0);
+    image.w = SPRITE_WIDTH;
+    image.h = SPRITE_HEIGHT;
+    placement = Reflection::place(Reflection::SIDE_BOTTOM, image, 1.0f, 0);
+    reflection.draw(texture, area, Reflection::SIDE_BOTTOM, placement,
+                    1.0f, describe(&black[0], SCENE_WIDTH, SCENE_HEIGHT, 2, false), 255, false);
+    for(int x = 0; x < SPRITE_WIDTH; ++x)
+    {
+        uint16_t p = black[placement.y * SCENE_WIDTH + placement.x + x];
+        if(x < SPRITE_WIDTH / 2)
+        {
+            ASSERT_EQ(0, p) << "column " << x;
+        }
+        else
+        {
+            ASSERT_EQ(0xffff, p) << "column " << x;
+        }
+    }
+}
+
+TEST_F(ReflectionTest, ClipsToTheTarget)
+{
+    std::vector<uint16_t> frame(SCENE_WIDTH * SCENE_HEIGHT, 0);
+    std::vector<uint16_t> texture(SPRITE_WIDTH * SPRITE_HEIGHT, 0xffff);
+    Reflection::Rect area  = { 0, 0, SPRITE_WIDTH, SPRITE_HEIGHT };
+    Reflection::Rect image = { SCENE_WIDTH - 10, SCENE_HEIGHT - 8, SPRITE_WIDTH, SPRITE_HEIGHT };
+
+    Reflection::Rect placement = Reflection::place(Reflection::SIDE_BOTTOM, image, 1.0f, 0);
+    reflection.draw(describe(&texture[0], SPRITE_WIDTH, SPRITE_HEIGHT, 2, false), area, Reflection::SIDE_BOTTOM,
+                    placement, 1.0f, describe(&frame[0], SCENE_WIDTH, SCENE_HEIGHT, 2, false), 255, true);
+
+    Reflection::Rect left = { -15, -5, SPRITE_WIDTH, SPRITE_HEIGHT };
+    placement = Reflection::place(Reflection::SIDE_LEFT, left, 1.0f, 0);
+    reflection.draw(describe(&texture[0], SPRITE_WIDTH, SPRITE_HEIGHT, 2, false), area, Reflection::SIDE_LEFT,
+                    placement, 1.0f, describe(&frame[0], SCENE_WIDTH, SCENE_HEIGHT, 2, false), 255, false);
+
+    for(unsigned int i = 0; i < frame.size(); ++i)
+    {
+        ASSERT_EQ(0, frame[i]);
+    }
+}
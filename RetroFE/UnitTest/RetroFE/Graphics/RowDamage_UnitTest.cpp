@@ -0,0 +1,93 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <Graphics/RowDamage.h>
+#include <vector>
+
+#define WIDTH  8
+#define HEIGHT 10
+
+TEST(RowDamageTest, SameFramesHaveNoDamage)
+{
+    std::vector<unsigned short> back(WIDTH * HEIGHT, 7);
+    std::vector<unsigned short> front(WIDTH * HEIGHT, 7);
+    std::vector<RowDamage::Span> spans(1);
+
+    RowDamage::collect(&back[0], WIDTH * 2, &front[0], WIDTH * 2, WIDTH * 2, HEIGHT, spans);
+    ASSERT_TRUE(spans.empty());
+}
+
+TEST(RowDamageTest, MergesAdjacentRows)
+{
+    std::vector<unsigned short> back(WIDTH * HEIGHT, 0);
+    std::vector<unsigned short> front(WIDTH * HEIGHT, 0);
+    back[0 * WIDTH + 3] = 1;
+    back[2 * WIDTH + 0] = 1;
+    back[3 * WIDTH + 7] = 1;
+    back[4 * WIDTH + 5] = 1;
+    back[9 * WIDTH + 1] = 1;
+
+    std::vector<RowDamage::Span> spans;
+    RowDamage::collect(&back[0], WIDTH * 2, &front[0], WIDTH * 2, WIDTH * 2, HEIGHT, spans);
+
+    ASSERT_EQ(3u, spans.size());
+    ASSERT_EQ(0, spans[0].first);
+    ASSERT_EQ(1, spans[0].count);
+    ASSERT_EQ(2, spans[1].first);
+    ASSERT_EQ(3, spans[1].count);
+    ASSERT_EQ(9, spans[2].first);
+    ASSERT_EQ(1, spans[2].count);
+}
+
+TEST(RowDamageTest, IgnoresPadding)
+{
+    // One pixel of padding per row in the back buffer only
+    std::vector<unsigned short> back((WIDTH + 1) * HEIGHT, 0);
+    std::vector<unsigned short> front(WIDTH * HEIGHT, 0);
+    for(int y = 0; y < HEIGHT; y++)
+    {
+        back[y * (WIDTH + 1) + WIDTH] = 0xffff;
+    }
+    back[5 * (WIDTH + 1) + 2] = 3;
+
+    std::vector<RowDamage::Span> spans;
+    RowDamage::collect(&back[0], (WIDTH + 1) * 2, &front[0], WIDTH * 2, WIDTH * 2, HEIGHT, spans);
+
+    ASSERT_EQ(1u, spans.size());
+    ASSERT_EQ(5, spans[0].first);
+    ASSERT_EQ(1, spans[0].count);
+}
+
+TEST(RowDamageTest, CopyMakesTheFramesEqual)
+{
+    std::vector<unsigned int> back(WIDTH * HEIGHT);
+    std::vector<unsigned int> front(WIDTH * HEIGHT, 0);
+    for(unsigned int i = 0; i < back.size(); i++)
+    {
+        back[i] = (i / WIDTH) % 3 ? 0 : i * 2654435761u;
+    }
+
+    std::vector<RowDamage::Span> spans;
+    RowDamage::collect(&back[0], WIDTH * 4, &front[0], WIDTH * 4, WIDTH * 4, HEIGHT, spans);
+    RowDamage::copy(&back[0], WIDTH * 4, &front[0], WIDTH * 4, WIDTH * 4, spans);
+    ASSERT_TRUE(back == front);
+
+    RowDamage::collect(&back[0], WIDTH * 4, &front[0], WIDTH * 4, WIDTH * 4, HEIGHT, spans);
+    ASSERT_TRUE(spans.empty());
+}
+
+TEST(RowDamageTest, CopyKeepsTheDestinationPadding)
+{
+    unsigned int back[]   = { 1, 2, 3, 4, 5, 6 };
+    unsigned int screen[] = { 0, 0, 0, 77, 0, 0, 0, 77 };
+    std::vector<RowDamage::Span> spans(1);
+    spans[0].first = 0;
+    spans[0].count = 2;
+
+    RowDamage::copy(back, 12, screen, 16, 12, spans);
+
+    unsigned int expected[] = { 1, 2, 3, 77, 4, 5, 6, 77 };
+    for(int i = 0; i < 8; i++)
+    {
+        ASSERT_EQ(expected[i], screen[i]);
+    }
+}
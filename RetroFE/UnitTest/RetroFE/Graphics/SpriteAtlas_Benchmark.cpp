@@ -0,0 +1,133 @@
+#include <Graphics/SpriteAtlas.h>
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#define SCROLLS     10000
+#define POINTS      10
+#define SLOT_WIDTH  120
+#define SLOT_HEIGHT 90
+
+// mallinfo() is deprecated from glibc 2.33 on, its fields overflow past 2 GB
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#define HEAP_INFO mallinfo2
+#else
+#define HEAP_INFO mallinfo
+#endif
+
+// Resident set size from /proc/self/statm, in kB
+static long residentKilobytes()
+{
+    long size = 0;
+    long resident = 0;
+    FILE *file = fopen("/proc/self/statm", "r");
+    if(!file) return 0;
+    if(fscanf(file, "%ld %ld", &size, &resident) != 2) resident = 0;
+    fclose(file);
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+// Scrolled in art of varying size, the way item images come off the disk
+static void artSize(int n, int &width, int &height)
+{
+    width  = 60 + (n * 37) % 100;
+    height = 40 + (n * 53) % 70;
+}
+
+static void fill(void *pixels, size_t bytes, int n)
+{
+    memset(pixels, n & 0xff, bytes);
+}
+
+// One surface per visible item, freed when it scrolls out. The small
+// allocation stands for the item component, made in between.
+static void scrollSurfaces()
+{
+    std::vector<void *> surfaces(POINTS, static_cast<void *>(NULL));
+    std::vector<void *> components(POINTS, static_cast<void *>(NULL));
+    for(int n = 0; n < SCROLLS; ++n)
+    {
+        int slot = n % POINTS;
+        int width;
+        int height;
+        artSize(n, width, height);
+        free(surfaces[slot]);
+        free(components[slot]);
+        components[slot] = malloc(96 + n % 64);
+        surfaces[slot] = malloc(static_cast<size_t>(width) * height * 4);
+        fill(surfaces[slot], static_cast<size_t>(width) * height * 4, n);
+    }
+    for(int i = 0; i < POINTS; ++i)
+    {
+        free(surfaces[i]);
+        free(components[i]);
+    }
+}
+
+// The same art copied into the slot released by the item scrolled out
+static void scrollAtlas()
+{
+    SpriteAtlas atlas;
+    atlas.create(SLOT_WIDTH, SLOT_HEIGHT, POINTS, 4);
+    std::vector<int> slots(POINTS, -1);
+    std::vector<void *> components(POINTS, static_cast<void *>(NULL));
+    std::vector<unsigned char> decoded;
+    for(int n = 0; n < SCROLLS; ++n)
+    {
+        int item = n % POINTS;
+        int width;
+        int height;
+        int storedWidth;
+        int storedHeight;
+        artSize(n, width, height);
+        atlas.release(slots[item]);
+        free(components[item]);
+        components[item] = malloc(96 + n % 64);
+        decoded.resize(static_cast<size_t>(width) * height * 4);
+        fill(&decoded[0], decoded.size(), n);
+        slots[item] = atlas.allocate();
+        atlas.store(slots[item], &decoded[0], width, height, width * 4, 4, storedWidth, storedHeight);
+    }
+    for(int i = 0; i < POINTS; ++i)
+    {
+        free(components[i]);
+    }
+}
+
+// Each way runs in its own process, so neither inherits the other's heap
+static void measure(const char *name, void (*scroll)())
+{
+    fflush(stdout);
+    pid_t pid = fork();
+    if(pid == 0)
+    {
+        long before = residentKilobytes();
+        struct HEAP_INFO start = HEAP_INFO();
+        scroll();
+        struct HEAP_INFO end = HEAP_INFO();
+        long after = residentKilobytes();
+
+        // Heap kept by malloc without anything allocated in it
+        double heap = end.arena / 1024.0;
+        double grown = heap - start.arena / 1024.0;
+        double unused = heap - end.uordblks / 1024.0;
+        printf("%-10s RSS %+6ld kB, heap %+8.1f kB, heap unused after %8.1f kB (%5.1f%%)\n", name,
+               after - before, grown, unused, heap > 0 ? 100.0 * unused / heap : 0.0);
+        fflush(stdout);
+        _exit(0);
+    }
+    waitpid(pid, NULL, 0);
+}
+
+// Memory left behind by 10k scroll steps of a ten item list
+int main()
+{
+    printf("%d scrolls of %d items, art 60x40 to 159x109\n", SCROLLS, POINTS);
+    measure("surfaces", scrollSurfaces);
+    measure("atlas", scrollAtlas);
+    return 0;
+}
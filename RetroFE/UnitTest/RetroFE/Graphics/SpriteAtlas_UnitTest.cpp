@@ -0,0 +1,182 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <Graphics/SpriteAtlas.h>
+#include <stdint.h>
+#include <vector>
+
+#define SLOT_WIDTH   32
+#define SLOT_HEIGHT  16
+#define SCROLLS      10000
+
+// Every pixel tells where it came from
+static std::vector<uint32_t> makeImage(int width, int height, uint32_t tag)
+{
+    std::vector<uint32_t> image(width * height);
+    for(int y = 0; y < height; ++y)
+    {
+        for(int x = 0; x < width; ++x)
+        {
+            image[y * width + x] = (tag << 16) | (y << 8) | x;
+        }
+    }
+    return image;
+}
+
+static uint32_t pixelAt(SpriteAtlas &atlas, int slot, int x, int y)
+{
+    const uint8_t *row = static_cast<const uint8_t *>(atlas.getSlotPixels(slot)) + y * atlas.getPitch();
+    return reinterpret_cast<const uint32_t *>(row)[x];
+}
+
+TEST(SpriteAtlasTest, AllocatesEverySlotOnce)
+{
+    SpriteAtlas atlas;
+    ASSERT_FALSE(atlas.isValid());
+    ASSERT_EQ(-1, atlas.allocate());
+
+    ASSERT_TRUE(atlas.create(SLOT_WIDTH, SLOT_HEIGHT, 3, 4));
+    ASSERT_EQ(static_cast<size_t>(SLOT_WIDTH * SLOT_HEIGHT * 3 * 4), atlas.getBytes());
+    ASSERT_EQ(0, atlas.allocate());
+    ASSERT_EQ(1, atlas.allocate());
+    ASSERT_EQ(2, atlas.allocate());
+    ASSERT_EQ(-1, atlas.allocate());
+    ASSERT_EQ(3u, atlas.getUsedSlots());
+
+    atlas.release(1);
+    atlas.release(1);
+    atlas.release(-1);
+    atlas.release(3);
+    ASSERT_EQ(2u, atlas.getUsedSlots());
+    ASSERT_EQ(1, atlas.allocate());
+    ASSERT_EQ(-1, atlas.allocate());
+
+    atlas.destroy();
+    ASSERT_FALSE(atlas.isValid());
+    ASSERT_EQ(0u, atlas.getSlotCount());
+}
+
+TEST(SpriteAtlasTest, StoresSmallImagesAsTheyAre)
+{
+    SpriteAtlas atlas;
+    ASSERT_TRUE(atlas.create(SLOT_WIDTH, SLOT_HEIGHT, 2, 4));
+    atlas.allocate();
+    int slot = atlas.allocate();
+
+    std::vector<uint32_t> image = makeImage(10, 5, 7);
+    int width = 0;
+    int height = 0;
+    ASSERT_TRUE(atlas.store(slot, &image[0], 10, 5, 10 * 4, 4, width, height));
+    ASSERT_EQ(10, width);
+    ASSERT_EQ(5, height);
+    for(int y = 0; y < 5; ++y)
+    {
+        for(int x = 0; x < 10; ++x)
+        {
+            ASSERT_EQ(image[y * 10 + x], pixelAt(atlas, slot, x, y));
+        }
+    }
+    ASSERT_EQ(0u, pixelAt(atlas, 0, 0, 0));
+}
+
+TEST(SpriteAtlasTest, ScalesLargeImagesDownToFit)
+{
+    SpriteAtlas atlas;
+    ASSERT_TRUE(atlas.create(SLOT_WIDTH, SLOT_HEIGHT, 1, 4));
+    int slot = atlas.allocate();
+    int width = 0;
+    int height = 0;
+
+    // Wide: limited by the slot width
+    std::vector<uint32_t> wide = makeImage(64, 16, 1);
+    ASSERT_TRUE(atlas.store(slot, &wide[0], 64, 16, 64 * 4, 4, width, height));
+    ASSERT_EQ(32, width);
+    ASSERT_EQ(8, height);
+    for(int y = 0; y < height; ++y)
+    {
+        for(int x = 0; x < width; ++x)
+        {
+            ASSERT_EQ(wide[(y * 2) * 64 + x * 2], pixelAt(atlas, slot, x, y));
+        }
+    }
+
+    // Tall: limited by the slot height
+    std::vector<uint32_t> tall = makeImage(8, 64, 2);
+    ASSERT_TRUE(atlas.store(slot, &tall[0], 8, 64, 8 * 4, 4, width, height));
+    ASSERT_EQ(2, width);
+    ASSERT_EQ(16, height);
+    ASSERT_EQ(tall[4 * 8 + 4], pixelAt(atlas, slot, 1, 1));
+}
+
+TEST(SpriteAtlasTest, StoresShallowerPixels)
+{
+    SpriteAtlas atlas;
+    ASSERT_TRUE(atlas.create(SLOT_WIDTH, SLOT_HEIGHT, 1, 4));
+    int slot = atlas.allocate();
+
+    std::vector<uint16_t> image(4 * 3, 0xf81f);
+    int width = 0;
+    int height = 0;
+    ASSERT_TRUE(atlas.store(slot, &image[0], 4, 3, 4 * 2, 2, width, height));
+    const uint16_t *row = reinterpret_cast<const uint16_t *>(static_cast<const uint8_t *>(atlas.getSlotPixels(slot)) +
+                                                             2 * atlas.getPitch());
+    ASSERT_EQ(0xf81f, row[3]);
+    ASSERT_EQ(0, row[4]);
+}
+
+TEST(SpriteAtlasTest, RejectsWhatItCannotHold)
+{
+    SpriteAtlas atlas;
+    ASSERT_FALSE(atlas.create(0, SLOT_HEIGHT, 1, 4));
+    ASSERT_FALSE(atlas.create(SLOT_WIDTH, SLOT_HEIGHT, 0, 4));
+    ASSERT_TRUE(atlas.create(SLOT_WIDTH, SLOT_HEIGHT, 2, 2));
+
+    std::vector<uint32_t> image = makeImage(4, 4, 3);
+    int width = 0;
+    int height = 0;
+    int slot = atlas.allocate();
+    ASSERT_FALSE(atlas.store(slot, &image[0], 4, 4, 4 * 4, 4, width, height));
+    ASSERT_FALSE(atlas.store(slot, &image[0], 4, 4, 2, 2, width, height));
+    ASSERT_FALSE(atlas.store(1, &image[0], 4, 4, 4 * 2, 2, width, height));
+    ASSERT_TRUE(atlas.store(slot, &image[0], 4, 4, 4 * 2, 2, width, height));
+}
+
+// A list of ten items scrolled back and forth: every item lands in the
+// slot its predecessor released, in the same pixel buffer throughout
+TEST(SpriteAtlasTest, ScrollingReusesTheSameBuffer)
+{
+    const int points = 10;
+    SpriteAtlas atlas;
+    ASSERT_TRUE(atlas.create(SLOT_WIDTH, SLOT_HEIGHT, points, 4));
+    void *pixels = atlas.getSlotPixels(0);
+    size_t bytes = atlas.getBytes();
+
+    std::vector<int> slots;
+    for(int i = 0; i < points; ++i)
+    {
+        slots.push_back(atlas.allocate());
+    }
+
+    int width = 0;
+    int height = 0;
+    for(int n = 0; n < SCROLLS; ++n)
+    {
+        bool forward = (n / 37) % 2 == 0;
+        int leaving = forward ? 0 : points - 1;
+        atlas.release(slots[leaving]);
+        slots.erase(slots.begin() + leaving);
+
+        int slot = atlas.allocate();
+        ASSERT_GE(slot, 0);
+        int w = 8 + n % 40;
+        int h = 4 + n % 20;
+        std::vector<uint32_t> image = makeImage(w, h, n & 0xffff);
+        ASSERT_TRUE(atlas.store(slot, &image[0], w, h, w * 4, 4, width, height));
+        ASSERT_EQ(static_cast<uint32_t>(n & 0xffff), pixelAt(atlas, slot, width - 1, height - 1) >> 16);
+        slots.insert(forward ? slots.end() : slots.begin(), slot);
+    }
+
+    ASSERT_EQ(static_cast<unsigned int>(points), atlas.getUsedSlots());
+    ASSERT_EQ(-1, atlas.allocate());
+    ASSERT_EQ(pixels, atlas.getSlotPixels(0));
+    ASSERT_EQ(bytes, atlas.getBytes());
+}
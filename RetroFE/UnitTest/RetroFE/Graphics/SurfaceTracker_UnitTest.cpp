@@ -0,0 +1,111 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <Graphics/SurfaceTracker.h>
+#include <vector>
+
+// The tracker is shared by the whole process, every test checks what
+// changes from the totals it starts with and removes what it adds
+class SurfaceTrackerTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        liveBytes  = SurfaceTracker::getLiveBytes();
+        liveCount  = SurfaceTracker::getLiveCount();
+        imageBytes = SurfaceTracker::getLiveBytes("Image");
+    }
+
+    virtual void TearDown()
+    {
+        for(unsigned int i = 0; i < sizeof(surfaces); i++)
+        {
+            SurfaceTracker::remove(&surfaces[i]);
+        }
+        ASSERT_EQ(liveBytes, SurfaceTracker::getLiveBytes());
+        ASSERT_EQ(liveCount, SurfaceTracker::getLiveCount());
+    }
+
+    // Only their addresses are used, as the surfaces
+    char surfaces[4];
+    size_t liveBytes;
+    unsigned int liveCount;
+    size_t imageBytes;
+};
+
+TEST_F(SurfaceTrackerTest, CountsBytesByTag)
+{
+    SurfaceTracker::add(&surfaces[0], 1000, "Image");
+    SurfaceTracker::add(&surfaces[1], 200, "Image");
+    SurfaceTracker::add(&surfaces[2], 30, "Font");
+    ASSERT_EQ(liveBytes + 1230, SurfaceTracker::getLiveBytes());
+    ASSERT_EQ(liveCount + 3, SurfaceTracker::getLiveCount());
+    ASSERT_EQ(imageBytes + 1200, SurfaceTracker::getLiveBytes("Image"));
+    ASSERT_EQ(0u, SurfaceTracker::getLiveBytes("Nothing"));
+    ASSERT_EQ("Image", SurfaceTracker::getTag(&surfaces[1]));
+    ASSERT_EQ("", SurfaceTracker::getTag(&surfaces[3]));
+
+    ASSERT_TRUE(SurfaceTracker::remove(&surfaces[0]));
+    ASSERT_EQ(imageBytes + 200, SurfaceTracker::getLiveBytes("Image"));
+    ASSERT_EQ(liveBytes + 230, SurfaceTracker::getLiveBytes());
+}
+
+TEST_F(SurfaceTrackerTest, UnknownSurfacesAreNotRemoved)
+{
+    SurfaceTracker::add(&surfaces[0], 64, "Image");
+    ASSERT_FALSE(SurfaceTracker::remove(&surfaces[1]));
+    ASSERT_TRUE(SurfaceTracker::remove(&surfaces[0]));
+    ASSERT_FALSE(SurfaceTracker::remove(&surfaces[0]));
+    ASSERT_FALSE(SurfaceTracker::remove(NULL));
+
+    SurfaceTracker::add(NULL, 64, "Image");
+    ASSERT_EQ(liveCount, SurfaceTracker::getLiveCount());
+}
+
+// A surface freed without the tracker knowing, then made again at the
+// same address, is counted once
+TEST_F(SurfaceTrackerTest, StaleEntriesAreReplaced)
+{
+    SurfaceTracker::add(&surfaces[0], 500, "Image");
+    SurfaceTracker::add(&surfaces[0], 80, "Battery");
+    ASSERT_EQ(liveBytes + 80, SurfaceTracker::getLiveBytes());
+    ASSERT_EQ(imageBytes, SurfaceTracker::getLiveBytes("Image"));
+    ASSERT_EQ("Battery", SurfaceTracker::getTag(&surfaces[0]));
+}
+
+TEST_F(SurfaceTrackerTest, PeakKeepsTheHighestTotal)
+{
+    SurfaceTracker::add(&surfaces[0], 4000, "Image");
+    SurfaceTracker::add(&surfaces[1], 3000, "Image");
+    size_t peak = SurfaceTracker::getPeakBytes();
+    ASSERT_LE(liveBytes + 7000, peak);
+
+    SurfaceTracker::remove(&surfaces[0]);
+    SurfaceTracker::add(&surfaces[2], 1000, "Image");
+    ASSERT_EQ(peak, SurfaceTracker::getPeakBytes());
+}
+
+TEST_F(SurfaceTrackerTest, ListsWhatIsLeft)
+{
+    SurfaceTracker::add(&surfaces[0], 10, "Image");
+    SurfaceTracker::add(&surfaces[3], 0, "Font");
+
+    std::vector<SurfaceTracker::Allocation> allocations = SurfaceTracker::getAllocations();
+    ASSERT_EQ(liveCount + 2, allocations.size());
+    int found = 0;
+    for(unsigned int i = 0; i < allocations.size(); i++)
+    {
+        if(allocations[i].surface == &surfaces[0])
+        {
+            ASSERT_EQ(10u, allocations[i].bytes);
+            ASSERT_EQ("Image", allocations[i].tag);
+            found++;
+        }
+        if(allocations[i].surface == &surfaces[3])
+        {
+            ASSERT_EQ(0u, allocations[i].bytes);
+            ASSERT_EQ("Font", allocations[i].tag);
+            found++;
+        }
+    }
+    ASSERT_EQ(2, found);
+}
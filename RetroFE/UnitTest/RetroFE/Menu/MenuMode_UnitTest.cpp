@@ -0,0 +1,177 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <Menu/MenuMode.h>
+#include <SDL.h>
+#include <Database/Configuration.h>
+#include <SDL/SDL_ttf.h>
+#include <chrono>
+#include <fstream>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define WIDTH  240
+#define HEIGHT 240
+
+// Run with SDL_VIDEODRIVER=dummy, set by ctest. MENU_RESOURCES_DIR is set
+// by the build and filled here, the system helpers are shell stubs found
+// first in PATH and as slow as the real ones on the device.
+class MenuModeTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        char dir[] = "/tmp/MenuModeTest.XXXXXX";
+        ASSERT_TRUE(mkdtemp(dir) != NULL);
+        stubs = dir;
+        writeStub("volume", "sleep 0.2; echo 70");
+        writeStub("brightness", "sleep 0.2; echo 30");
+        writeStub("share", "sleep 0.2; false");
+        path = getenv("PATH");
+        setenv("PATH", (stubs + ":" + path).c_str(), 1);
+
+        config.setProperty("horizontal", "240");
+        config.setProperty("vertical", "240");
+        config.setProperty("fullscreen", "no");
+        config.setProperty("showFrame", "yes");
+        ASSERT_TRUE(SDL::initialize(config));
+        TTF_Init();
+
+        mkdir(MENU_RESOURCES_DIR, 0755);
+        copyFile(RETROFE_PACKAGE_DIR "/Environment/Common/core/OpenSans.ttf", MENU_RESOURCES_DIR "OpenSans-Bold.ttf");
+        copyFile(RETROFE_PACKAGE_DIR "/Environment/Common/core/OpenSans.ttf", MENU_RESOURCES_DIR "OpenSans-Regular.ttf");
+        writeImage(MENU_RESOURCES_DIR "zone_bg.png", WIDTH, HEIGHT);
+        writeImage(MENU_RESOURCES_DIR "arrow_top.png", 16, 8);
+        writeImage(MENU_RESOURCES_DIR "arrow_bottom.png", 16, 8);
+    }
+
+    virtual void TearDown()
+    {
+        setenv("PATH", path.c_str(), 1);
+        unlink((stubs + "/volume").c_str());
+        unlink((stubs + "/brightness").c_str());
+        unlink((stubs + "/share").c_str());
+        rmdir(stubs.c_str());
+        TTF_Quit();
+        SDL::deInitialize();
+    }
+
+    void writeStub(std::string name, std::string body)
+    {
+        std::string file = stubs + "/" + name;
+        std::ofstream ofs(file.c_str());
+        ofs << "#!/bin/sh\n" << body << "\n";
+        ofs.close();
+        chmod(file.c_str(), 0755);
+    }
+
+    void copyFile(const char *from, const char *to)
+    {
+        std::ifstream ifs(from, std::ios::binary);
+        std::ofstream ofs(to, std::ios::binary);
+        ofs << ifs.rdbuf();
+    }
+
+    // IMG_Load tells the format from the contents, a BMP is fine
+    void writeImage(const char *file, int width, int height)
+    {
+        SDL_Surface *surface = SDL_CreateRGBSurface(SDL_SWSURFACE, width, height, 32, 0xff0000, 0xff00, 0xff, 0);
+        SDL_FillRect(surface, NULL, SDL_MapRGB(surface->format, 40, 40, 40));
+        SDL_SaveBMP(surface, file);
+        SDL_FreeSurface(surface);
+    }
+
+    int countLitPixels()
+    {
+        SDL_Surface *window = SDL::getWindow();
+        int lit = 0;
+        SDL_LockSurface(window);
+        for(int y = 0; y < window->h; y++)
+        {
+            Uint8 *row = static_cast<Uint8 *>(window->pixels) + y * window->pitch;
+            for(int x = 0; x < window->w; x++)
+            {
+                Uint32 pixel = window->format->BytesPerPixel == 2 ?
+                               reinterpret_cast<Uint16 *>(row)[x] : reinterpret_cast<Uint32 *>(row)[x];
+                if(pixel != SDL_MapRGB(window->format, 0, 0, 0)) lit++;
+            }
+        }
+        SDL_UnlockSurface(window);
+        return lit;
+    }
+
+    // Pixels of the given color in a band of rows
+    int countPixels(Uint8 r, Uint8 g, Uint8 b, int firstRow, int rows)
+    {
+        SDL_Surface *window = SDL::getWindow();
+        Uint32 color = SDL_MapRGB(window->format, r, g, b);
+        int count = 0;
+        SDL_LockSurface(window);
+        for(int y = firstRow; y < firstRow + rows; y++)
+        {
+            Uint8 *row = static_cast<Uint8 *>(window->pixels) + y * window->pitch;
+            for(int x = 0; x < window->w; x++)
+            {
+                Uint32 pixel = window->format->BytesPerPixel == 2 ?
+                               reinterpret_cast<Uint16 *>(row)[x] : reinterpret_cast<Uint32 *>(row)[x];
+                if(pixel == color) count++;
+            }
+        }
+        SDL_UnlockSurface(window);
+        return count;
+    }
+
+    // Redraws the volume bar over the current window, in front of a black background
+    void refreshVolumeBar(int &firstRow, int &rows)
+    {
+        SDL_FillRect(MenuMode::backup_hw_screen, NULL, SDL_MapRGB(MenuMode::backup_hw_screen->format, 0, 0, 0));
+        for(int item = 0; item < MenuMode::nb_menu_zones; item++)
+        {
+            if(MenuMode::idx_menus[item] == MENU_TYPE_VOLUME) MenuMode::menu_value_refresh(item);
+        }
+        firstRow = MenuMode::y_volume_bar;
+        rows     = MenuMode::height_progress_bar;
+    }
+
+    Configuration config;
+    std::string stubs;
+    std::string path;
+};
+
+TEST_F(MenuModeTest, FirstFrameDoesNotWaitForHelpers)
+{
+    MenuMode::init(config);
+    SDL_FillRect(SDL::getWindow(), NULL, SDL_MapRGB(SDL::getWindow()->format, 0, 0, 0));
+
+    // Closes the menu right after its first frame
+    SDL_Event e;
+    e.type = SDL_KEYDOWN;
+    e.key.keysym.sym = SDLK_q;
+    SDL_PushEvent(&e);
+
+    // Time to first menu frame, the four helpers take 0.8s in a row
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    MenuMode::launch();
+    std::chrono::duration<float> firstFrame = std::chrono::steady_clock::now() - start;
+
+    ASSERT_LT(firstFrame.count(), 0.1f);
+    ASSERT_GT(countLitPixels(), 0);
+
+    MenuMode::end();
+}
+
+TEST_F(MenuModeTest, ValueChangeOnlyRedrawsItsBar)
+{
+    MenuMode::init(config);
+    SDL_FillRect(SDL::getWindow(), NULL, SDL_MapRGB(SDL::getWindow()->format, 0, 0, 255));
+
+    int firstRow, rows;
+    refreshVolumeBar(firstRow, rows);
+
+    // The rows of the bar are drawn again, the others are left alone
+    ASSERT_EQ(0, countPixels(0, 0, 255, firstRow, rows));
+    ASSERT_EQ(WIDTH * firstRow, countPixels(0, 0, 255, 0, firstRow));
+    ASSERT_EQ(WIDTH * (HEIGHT - firstRow - rows), countPixels(0, 0, 255, firstRow + rows, HEIGHT - firstRow - rows));
+
+    MenuMode::end();
+}
@@ -0,0 +1,115 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <Menu/MenuSystemValues.h>
+#include <Utility/HelperExecutor.h>
+#include <chrono>
+#include <thread>
+
+// Stub helpers, as slow as the real ones on the device
+#define STUB_VOLUME_GET       "sleep 0.2; echo 70"
+#define STUB_BRIGHTNESS_GET   "sleep 0.2; echo 30"
+#define STUB_USB_CONNECTED    "sleep 0.2; true"
+#define STUB_USB_SHARING      "sleep 0.2; false"
+
+class MenuSystemValuesTest : public ::testing::Test
+{
+protected:
+    // Calls update() once per 60 FPS frame, as the menu loop does
+    unsigned int waitForUpdate(MenuSystemValues &values, MenuSystemState &state, unsigned int fields)
+    {
+        unsigned int changed = 0;
+
+        for(int frame = 0; frame < 5 * 60 && (changed & fields) != fields; frame++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(16));
+            changed |= values.update(state);
+        }
+        return changed;
+    }
+};
+
+TEST_F(MenuSystemValuesTest, FirstFrameDoesNotWaitForHelpers)
+{
+    HelperExecutor helpers;
+    MenuSystemValues values(helpers, 1.0f, STUB_VOLUME_GET, STUB_BRIGHTNESS_GET, STUB_USB_CONNECTED, STUB_USB_SHARING);
+    MenuSystemState state;
+
+    // Time to first menu frame: refresh and draw with the last known values
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    values.refresh();
+    unsigned int changed = values.update(state);
+    std::chrono::duration<float> firstFrame = std::chrono::steady_clock::now() - start;
+
+    // The four helpers take 0.8s in a row
+    ASSERT_LT(firstFrame.count(), 0.05f);
+    ASSERT_EQ(0u, changed);
+    ASSERT_EQ(50, state.volume);
+    ASSERT_EQ(50, state.brightness);
+
+    unsigned int all = MenuSystemValues::VOLUME | MenuSystemValues::BRIGHTNESS | MenuSystemValues::USB_DATA_CONNECTED;
+    ASSERT_EQ(all, waitForUpdate(values, state, all));
+    ASSERT_EQ(70, state.volume);
+    ASSERT_EQ(30, state.brightness);
+    ASSERT_TRUE(state.usbDataConnected);
+    ASSERT_FALSE(state.usbSharing);
+}
+
+TEST_F(MenuSystemValuesTest, UnchangedValuesAreNotReported)
+{
+    HelperExecutor helpers;
+    MenuSystemValues values(helpers, 0.0f, "echo 50", "echo 50", "false", "false");
+    MenuSystemState state;
+
+    values.refresh();
+    helpers.run("true").wait();
+
+    ASSERT_EQ(0u, values.update(state));
+}
+
+TEST_F(MenuSystemValuesTest, ValueSetByTheMenuIsNotOverwritten)
+{
+    HelperExecutor helpers;
+    MenuSystemValues values(helpers, 1.0f, STUB_VOLUME_GET, "echo 30", "false", "false");
+    MenuSystemState state;
+
+    values.refresh();
+
+    // The user turns the volume up while the old reading is in flight
+    state.volume = 60;
+    values.changed(MenuSystemValues::VOLUME);
+    helpers.run("true").wait();
+
+    ASSERT_EQ(MenuSystemValues::BRIGHTNESS, values.update(state));
+    ASSERT_EQ(60, state.volume);
+}
+
+TEST_F(MenuSystemValuesTest, UnreadableValueKeepsTheLastKnownOne)
+{
+    HelperExecutor helpers;
+    MenuSystemValues values(helpers, 0.0f, "echo 80", "echo error", "false", "false");
+    MenuSystemState state;
+    state.brightness = 40;
+
+    values.refresh();
+    helpers.run("true").wait();
+
+    ASSERT_EQ(MenuSystemValues::VOLUME, values.update(state));
+    ASSERT_EQ(80, state.volume);
+    ASSERT_EQ(40, state.brightness);
+}
+
+TEST_F(MenuSystemValuesTest, CachedValuesAreAppliedOnTheNextRefresh)
+{
+    HelperExecutor helpers;
+    MenuSystemValues values(helpers, 60.0f, "echo 20", "echo 50", "false", "false");
+    MenuSystemState state;
+
+    values.refresh();
+    helpers.run("true").wait();
+
+    // Another menu opening reads the cache on the calling thread
+    MenuSystemState reopened;
+    values.refresh();
+    ASSERT_EQ(MenuSystemValues::VOLUME, values.update(reopened));
+    ASSERT_EQ(20, reopened.volume);
+}
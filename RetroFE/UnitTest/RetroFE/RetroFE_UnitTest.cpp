@@ -0,0 +1,345 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <RetroFE.h>
+#include <SDL.h>
+#include <Database/Configuration.h>
+#include <Graphics/Page.h>
+#include <Graphics/Animate/Animation.h>
+#include <Graphics/Animate/AnimationEvents.h>
+#include <Graphics/Animate/Tween.h>
+#include <Graphics/Animate/TweenSet.h>
+#include <Graphics/Component/Battery.h>
+#include <Graphics/Component/Component.h>
+#include <Graphics/Component/Image.h>
+#include <Utility/WakeupCounter.h>
+#include <chrono>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// Fills the top left corner red. When loaded, notes the time and whether
+// the window shows that red frame again.
+class ProbeComponent : public Component
+{
+public:
+    ProbeComponent(Page &p)
+        : Component(p)
+        , frameShown(false)
+    {
+    }
+
+    void allocateGraphicsMemory()
+    {
+        Component::allocateGraphicsMemory();
+        loaded = std::chrono::steady_clock::now();
+
+        SDL_Surface *window = SDL::getWindow();
+        Uint8 *pixel = static_cast<Uint8 *>(window->pixels) + 8 * window->pitch + 8 * window->format->BytesPerPixel;
+        Uint32 value = window->format->BytesPerPixel == 2 ? *reinterpret_cast<Uint16 *>(pixel) : *reinterpret_cast<Uint32 *>(pixel);
+        Uint8 r, g, b;
+        SDL_GetRGB(value, window->format, &r, &g, &b);
+        frameShown = r > g;
+    }
+
+    void draw()
+    {
+        SDL_Surface *window = SDL::getWindow();
+        SDL_Rect rect = { 0, 0, 16, 16 };
+        SDL_FillRect(window, &rect, SDL_MapRGB(window->format, 200, 40, 40));
+    }
+
+    std::chrono::steady_clock::time_point loaded;
+    bool frameShown;
+};
+
+// Run with SDL_VIDEODRIVER=dummy, set by ctest. Shows pages of real
+// components in RetroFE, then checks how long its main loop may sleep
+// and how fast a page comes back from a launch.
+class RetroFETest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        retrofe = new RetroFE(config);
+        page = new Page(config);
+
+        char dir[] = "/tmp/RetroFETest.XXXXXX";
+        ASSERT_TRUE(mkdtemp(dir) != NULL);
+        root = dir;
+
+        config.setProperty("horizontal", "64");
+        config.setProperty("vertical", "48");
+        config.setProperty("fullscreen", "no");
+        config.setProperty("showFrame", "yes");
+        config.setProperty("batterySysfsRoot", root);
+        ASSERT_TRUE(SDL::initialize(config));
+
+        image = root + "/image.bmp";
+        writeImage(image, 16, 16);
+    }
+
+    virtual void TearDown()
+    {
+        // Deletes the page and its components
+        retrofe->currentPage_ = page;
+        delete retrofe;
+        for(std::vector<AnimationEvents *>::iterator it = tweens.begin(); it != tweens.end(); ++it)
+        {
+            delete *it;
+        }
+        SDL::deInitialize();
+        unlink(image.c_str());
+        rmdir(root.c_str());
+    }
+
+    void writeImage(std::string file, int width, int height)
+    {
+        SDL_Surface *surface = SDL_CreateRGBSurface(SDL_SWSURFACE, width, height, 32, 0xff0000, 0xff00, 0xff, 0);
+        SDL_FillRect(surface, NULL, SDL_MapRGB(surface->format, 200, 40, 40));
+        SDL_SaveBMP(surface, file.c_str());
+        SDL_FreeSurface(surface);
+    }
+
+    // A 16x16 image, moved right during its "enter" animation if duration is set
+    Image *addImage(float duration = 0)
+    {
+        return addImage(image, duration);
+    }
+
+    Image *addImage(std::string file, float duration = 0)
+    {
+        Image *component = new Image(file, "", *page, 1, 1, false);
+        AnimationEvents *events = new AnimationEvents();
+        if(duration > 0)
+        {
+            TweenSet *set = new TweenSet();
+            set->push(new Tween(TWEEN_PROPERTY_X, LINEAR, 0, 32, duration));
+            Animation *animation = new Animation();
+            animation->Push(set);
+            events->setAnimation("enter", -1, animation);
+        }
+        component->setTweens(events);
+        tweens.push_back(events);
+        page->addComponent(component);
+        return component;
+    }
+
+    Battery *addBattery(float reloadPeriod)
+    {
+        SDL_Color color = { 255, 255, 255, 0 };
+        Battery *component = new Battery(*page, config, reloadPeriod, color, 1, 1);
+        AnimationEvents *events = new AnimationEvents();
+        component->setTweens(events);
+        tweens.push_back(events);
+        page->addComponent(component);
+        return component;
+    }
+
+    // Makes the page current the way RetroFE enters it, up to its first frame
+    void show()
+    {
+        retrofe->currentPage_ = page;
+        page->allocateGraphicsMemory();
+        page->start();
+        page->update(0);
+        retrofe->mustRender_ = false;
+    }
+
+    void forceRender()
+    {
+        retrofe->forceRender(true);
+    }
+
+    float idleWaitTime()
+    {
+        return retrofe->idleWaitTime(RetroFE::RETROFE_IDLE, false);
+    }
+
+    void idleWait(float waitTime)
+    {
+        retrofe->idleWait(waitTime);
+    }
+
+    unsigned int idlePolls()
+    {
+        return retrofe->idlePolls_.getTotal();
+    }
+
+    // Seconds launchExit takes to get the page back, best of three launches
+    float launchReturnTime(bool keepResident)
+    {
+        config.setProperty("keepGraphicsMinFreeRam", keepResident ? "0" : "-1");
+
+        float best = 0;
+        for(int launch = 0; launch < 3; launch++)
+        {
+            retrofe->launchEnter();
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            retrofe->launchExit();
+            std::chrono::duration<float> elapsed = std::chrono::steady_clock::now() - start;
+            if(launch == 0 || elapsed.count() < best) best = elapsed.count();
+        }
+        return best;
+    }
+
+    // The probe must be the first component of the page
+    ProbeComponent *addProbe()
+    {
+        ProbeComponent *component = new ProbeComponent(*page);
+        AnimationEvents *events = new AnimationEvents();
+        component->setTweens(events);
+        tweens.push_back(events);
+        page->addComponent(component);
+        return component;
+    }
+
+    // Seconds from launchExit until the page starts loading again, best of
+    // three launches. The game leaves the window black, the frame from
+    // before the launch must be back by the time the probe is loaded.
+    float firstFrameTime(ProbeComponent *probe)
+    {
+        config.setProperty("keepGraphicsMinFreeRam", "-1");
+
+        float best = 0;
+        for(int launch = 0; launch < 3; launch++)
+        {
+            retrofe->launchEnter();
+            SDL_FillRect(SDL::getWindow(), NULL, 0);
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            retrofe->launchExit();
+            EXPECT_TRUE(probe->frameShown);
+            std::chrono::duration<float> elapsed = probe->loaded - start;
+            if(launch == 0 || elapsed.count() < best) best = elapsed.count();
+        }
+        return best;
+    }
+
+    Configuration config;
+    std::string root;
+    std::string image;
+    RetroFE *retrofe;
+    Page *page;
+    std::vector<AnimationEvents *> tweens;
+};
+
+TEST_F(RetroFETest, StaticPageWaitsForInput)
+{
+    addImage();
+    addImage();
+    show();
+
+    ASSERT_LT(idleWaitTime(), 0);
+}
+
+TEST_F(RetroFETest, AnimatingPageRendersEveryFrame)
+{
+    addImage();
+    addImage(1);
+    show();
+
+    ASSERT_EQ(0, idleWaitTime());
+
+    page->update(0.5f);
+    ASSERT_EQ(0, idleWaitTime());
+
+    // The idle animation is empty, nothing moves once "enter" is over
+    page->update(0.6f);
+    ASSERT_LT(idleWaitTime(), 0);
+}
+
+TEST_F(RetroFETest, StaticPageWakesOnlyForDeadlines)
+{
+    addImage();
+    addBattery(0.25f);
+    show();
+
+    WakeupCounter wakeups;
+    wakeups.reset(0);
+
+    // Idle page: the loop only wakes up for a battery refresh every 0.25
+    // seconds, and polls the input every IDLE_INPUT_POLL_MS in between
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::duration<float> elapsed(0);
+    float last = 0;
+    for(int deadline = 1; deadline <= 4; deadline++)
+    {
+        float waitTime = idleWaitTime();
+        ASSERT_GT(waitTime, 0.2f);
+        ASSERT_LE(waitTime, 0.25f);
+
+        idleWait(waitTime);
+        elapsed = std::chrono::steady_clock::now() - start;
+        wakeups.wakeup(elapsed.count());
+        page->update(elapsed.count() - last);
+        last = elapsed.count();
+    }
+
+    ASSERT_EQ(4u, wakeups.getTotal());
+    ASSERT_GE(elapsed.count(), 0.9f);
+    ASSERT_LE(idlePolls(), static_cast<unsigned int>(elapsed.count() * 1000 / IDLE_INPUT_POLL_MS) + 4);
+}
+
+TEST_F(RetroFETest, PendingRenderIsNotSkipped)
+{
+    addImage();
+    show();
+    forceRender();
+
+    ASSERT_EQ(0, idleWaitTime());
+}
+
+TEST_F(RetroFETest, ResumeAfterLaunchIsFasterThanReload)
+{
+    std::string art = root + "/art.bmp";
+    writeImage(art, 640, 480);
+    for(int i = 0; i < 20; i++)
+    {
+        addImage(art);
+    }
+    show();
+
+    float reload = launchReturnTime(false);
+    float resume = launchReturnTime(true);
+    unlink(art.c_str());
+
+    ASSERT_LT(resume, reload);
+}
+
+TEST_F(RetroFETest, LaunchWaitsReturnTheResult)
+{
+    int status = RetroFE::runProcess("sleep 0.1; exit 3");
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(3, WEXITSTATUS(status));
+
+    ASSERT_EQ("10\n", RetroFE::runHelper("/bin/echo 10").output);
+}
+
+TEST_F(RetroFETest, FirstFrameAfterLaunchDoesNotWaitForThePage)
+{
+    std::string art = root + "/art.bmp";
+    writeImage(art, 640, 480);
+    ProbeComponent *probe = addProbe();
+    show();
+
+    // Pages of 1, 8 and 32 images: the frame is back before any is loaded,
+    // sooner than even the smallest page takes to load
+    int counts[] = { 1, 8, 32 };
+    std::vector<float> firstFrame;
+    float smallestPage = 0;
+    for(int c = 0, images = 0; c < 3; c++)
+    {
+        for(; images < counts[c]; images++)
+        {
+            addImage(art);
+        }
+        firstFrame.push_back(firstFrameTime(probe));
+        if(c == 0) smallestPage = launchReturnTime(false);
+    }
+    unlink(art.c_str());
+
+    for(unsigned int c = 0; c < firstFrame.size(); c++)
+    {
+        ASSERT_LT(firstFrame[c], smallestPage);
+    }
+}
@@ -0,0 +1,346 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <SDL.h>
+#include <Database/Configuration.h>
+#include <Graphics/SpriteAtlas.h>
+#include <Graphics/ViewInfo.h>
+#include <algorithm>
+#include <cstdlib>
+#include <stdint.h>
+#include <vector>
+
+#define WIDTH  64
+#define HEIGHT 48
+
+// Run with SDL_VIDEODRIVER=dummy, set by ctest. Draws frames the way
+// RetroFE does, clearing the window each time, and checks the screen
+// shows exactly the last one in every present mode.
+class SDLPresentTest : public ::testing::Test
+{
+protected:
+    virtual void TearDown()
+    {
+        SDL::deInitialize();
+    }
+
+    bool initialize(const std::string &presentMode, const std::string &pixelFormat = "rgb888",
+                    const std::string &screenRotation = "0")
+    {
+        Configuration config;
+        config.setProperty("horizontal", "64");
+        config.setProperty("vertical", "48");
+        config.setProperty("fullscreen", "no");
+        config.setProperty("showFrame", "yes");
+        config.setProperty("pixelFormat", pixelFormat);
+        config.setProperty("presentMode", presentMode);
+        config.setProperty("screenRotation", screenRotation);
+        return SDL::initialize(config);
+    }
+
+    // A black frame with one colored bar, kept as the expected screen
+    void drawFrame(int barY, Uint8 r, Uint8 g, Uint8 b)
+    {
+        SDL_Surface *window = SDL::getWindow();
+        SDL_Rect bar = { 8, static_cast<Sint16>(barY), 40, 6 };
+        SDL_FillRect(window, NULL, SDL_MapRGB(window->format, 0, 0, 0));
+        SDL_FillRect(window, &bar, SDL_MapRGB(window->format, r, g, b));
+
+        expected.assign(WIDTH * HEIGHT, 0);
+        for(int y = barY; y < barY + 6; y++)
+        {
+            for(int x = 8; x < 48; x++)
+            {
+                expected[y * WIDTH + x] = SDL_MapRGB(window->format, r, g, b);
+            }
+        }
+    }
+
+    void expectScreen()
+    {
+        SDL_Surface *screen = SDL_GetVideoSurface();
+        ASSERT_TRUE(screen != NULL);
+        if(SDL_MUSTLOCK(screen)) SDL_LockSurface(screen);
+        int mismatches = 0;
+        for(int y = 0; y < HEIGHT; y++)
+        {
+            Uint8 *row = static_cast<Uint8 *>(screen->pixels) + y * screen->pitch;
+            for(int x = 0; x < WIDTH; x++)
+            {
+                Uint32 pixel = screen->format->BytesPerPixel == 2 ?
+                               reinterpret_cast<Uint16 *>(row)[x] : reinterpret_cast<Uint32 *>(row)[x];
+                if(pixel != expected[y * WIDTH + x]) mismatches++;
+            }
+        }
+        if(SDL_MUSTLOCK(screen)) SDL_UnlockSurface(screen);
+        ASSERT_EQ(0, mismatches);
+    }
+
+    void checkFrames()
+    {
+        drawFrame(4, 255, 0, 0);
+        SDL::renderAndFlipWindow();
+        expectScreen();
+
+        // The bar moves, the rows it left must be cleared on screen too
+        drawFrame(30, 0, 255, 0);
+        SDL::renderAndFlipWindow();
+        expectScreen();
+
+        drawFrame(30, 0, 255, 0);
+        SDL::renderAndFlipWindow();
+        expectScreen();
+
+        drawFrame(10, 0, 0, 255);
+        SDL::renderAndFlipWindow();
+        expectScreen();
+    }
+
+    std::vector<Uint32> expected;
+};
+
+TEST_F(SDLPresentTest, Direct)
+{
+    ASSERT_TRUE(initialize("direct"));
+    ASSERT_EQ(SDL::PRESENT_DIRECT, SDL::getPresentMode());
+    ASSERT_TRUE(SDL::getWindow() == SDL_GetVideoSurface());
+    checkFrames();
+}
+
+TEST_F(SDLPresentTest, Swap)
+{
+    ASSERT_TRUE(initialize("swap"));
+    ASSERT_EQ(SDL::PRESENT_SWAP, SDL::getPresentMode());
+
+    SDL_Surface *first = SDL::getWindow();
+    drawFrame(4, 255, 0, 0);
+    SDL::renderAndFlipWindow();
+    ASSERT_TRUE(SDL::getWindow() != first);
+    ASSERT_TRUE(SDL::getWindow() != SDL_GetVideoSurface());
+    checkFrames();
+}
+
+TEST_F(SDLPresentTest, Copy)
+{
+    ASSERT_TRUE(initialize("copy"));
+    ASSERT_EQ(SDL::PRESENT_COPY, SDL::getPresentMode());
+    ASSERT_TRUE(SDL::getWindow() != SDL_GetVideoSurface());
+    checkFrames();
+}
+
+TEST_F(SDLPresentTest, SwapInRgb565)
+{
+    ASSERT_TRUE(initialize("swap", "rgb565"));
+    ASSERT_EQ(16, SDL::getWindow()->format->BitsPerPixel);
+    ASSERT_EQ(SDL::PRESENT_SWAP, SDL::getPresentMode());
+    checkFrames();
+}
+
+TEST_F(SDLPresentTest, RotatedScreen)
+{
+    ASSERT_TRUE(initialize("auto", "rgb565", "90"));
+    ASSERT_EQ(SDL::PRESENT_COPY, SDL::getPresentMode());
+    ASSERT_EQ(WIDTH, SDL::getWindow()->w);
+    ASSERT_EQ(HEIGHT, SDL_GetVideoSurface()->w);
+    ASSERT_EQ(WIDTH, SDL_GetVideoSurface()->h);
+
+    // The layout's top left corner ends up at the screen's top right
+    SDL_Surface *window = SDL::getWindow();
+    SDL_Rect corner = { 0, 0, 1, 1 };
+    SDL_FillRect(window, NULL, SDL_MapRGB(window->format, 0, 0, 0));
+    SDL_FillRect(window, &corner, SDL_MapRGB(window->format, 255, 255, 255));
+    SDL::renderAndFlipWindow();
+
+    SDL_Surface *screen = SDL_GetVideoSurface();
+    Uint16 *topRow = static_cast<Uint16 *>(screen->pixels);
+    ASSERT_EQ(0xffff, topRow[HEIGHT - 1]);
+    ASSERT_EQ(0, topRow[0]);
+}
+
+TEST_F(SDLPresentTest, AutoSwapsWithoutHardwareDoubleBuffer)
+{
+    // The dummy driver only gives a single buffered software window
+    ASSERT_TRUE(initialize("auto"));
+    ASSERT_EQ(SDL::PRESENT_SWAP, SDL::getPresentMode());
+    checkFrames();
+}
+
+#define TEXTURE_WIDTH  24
+#define TEXTURE_HEIGHT 16
+
+// Textures go through prepareTexture and renderCopy, and must look like
+// SDL's own blitter drawing the PNG as loaded over the same background
+class SDLBlitTest : public SDLPresentTest
+{
+protected:
+    enum Kind
+    {
+        KIND_OPAQUE,
+        KIND_BINARY,
+        KIND_TRANSLUCENT
+    };
+
+    // RGBA as loaded from a PNG, red in the low byte on little endian
+    static SDL_Surface *createTexture(Kind kind)
+    {
+        SDL_Surface *texture = SDL_CreateRGBSurface(SDL_SWSURFACE, TEXTURE_WIDTH, TEXTURE_HEIGHT, 32,
+                                                    0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000);
+        for(int y = 0; y < TEXTURE_HEIGHT; y++)
+        {
+            Uint32 *row = reinterpret_cast<Uint32 *>(static_cast<Uint8 *>(texture->pixels) + y * texture->pitch);
+            for(int x = 0; x < TEXTURE_WIDTH; x++)
+            {
+                Uint32 a = 255;
+                if(kind == KIND_BINARY) a = (x + y) % 3 ? 255 : 0;
+                if(kind == KIND_TRANSLUCENT) a = x * 255 / (TEXTURE_WIDTH - 1);
+                row[x] = (a << 24) | ((y * 16) << 16) | (0x80 << 8) | (x * 10);
+            }
+        }
+        return texture;
+    }
+
+    static void fillBackground(SDL_Surface *surface)
+    {
+        for(int y = 0; y < HEIGHT; y++)
+        {
+            SDL_Rect line = { 0, static_cast<Sint16>(y), WIDTH, 1 };
+            SDL_FillRect(surface, &line, SDL_MapRGB(surface->format, y * 5, 255 - y * 5, 0x40));
+        }
+    }
+
+    void compareWithSdl(const std::string &pixelFormat, Kind kind, float alpha, int tolerance, bool packed = false)
+    {
+        ASSERT_TRUE(initialize("copy", pixelFormat));
+        SDL_Surface *window = SDL::getWindow();
+        fillBackground(window);
+
+        SDL_Surface *expected = SDL_ConvertSurface(window, window->format, SDL_SWSURFACE);
+        // SDL only applies the global alpha to a surface without an alpha channel
+        SDL_Surface *original = createTexture(kind);
+        if(kind == KIND_OPAQUE)
+        {
+            SDL_Surface *converted = SDL_ConvertSurface(original, window->format, SDL_SWSURFACE);
+            SDL_FreeSurface(original);
+            original = converted;
+        }
+        SDL_Rect at = { 20, 10, TEXTURE_WIDTH, TEXTURE_HEIGHT };
+        SDL_SetAlpha(original, SDL_SRCALPHA, static_cast<Uint8>(alpha * 255));
+        SDL_BlitSurface(original, NULL, expected, &at);
+        SDL_FreeSurface(original);
+
+        SDL_Surface *texture = createTexture(kind);
+        SDL::prepareTexture(texture);
+        if(kind == KIND_OPAQUE)
+        {
+            ASSERT_EQ(0u, texture->format->Amask);
+            ASSERT_EQ(0u, texture->flags & SDL_SRCCOLORKEY);
+        }
+        if(kind == KIND_BINARY)
+        {
+            ASSERT_EQ(static_cast<Uint32>(SDL_SRCCOLORKEY), texture->flags & SDL_SRCCOLORKEY);
+        }
+        if(kind == KIND_TRANSLUCENT && window->format->BitsPerPixel == 32)
+        {
+            ASSERT_EQ(static_cast<Uint32>(SURFACE_PREMULTIPLIED), texture->flags & SURFACE_PREMULTIPLIED);
+        }
+
+        // Drawn from the second slot of an atlas wider than the texture
+        SpriteAtlas atlas;
+        if(packed)
+        {
+            Uint32 flags = texture->flags & (SDL_SRCCOLORKEY | SURFACE_PREMULTIPLIED);
+            int slot = -1;
+            ASSERT_TRUE(atlas.create(TEXTURE_WIDTH + 8, TEXTURE_HEIGHT + 4, 2, 4));
+            ASSERT_EQ(0, atlas.allocate());
+            ASSERT_TRUE(SDL::packTexture(texture, atlas, slot));
+            ASSERT_EQ(1, slot);
+            ASSERT_EQ(atlas.getSlotPixels(1), texture->pixels);
+            ASSERT_EQ(atlas.getPitch(), texture->pitch);
+            ASSERT_EQ(flags, texture->flags & (SDL_SRCCOLORKEY | SURFACE_PREMULTIPLIED));
+        }
+
+        ViewInfo viewInfo;
+        SDL_Rect dest = { 20, 10, TEXTURE_WIDTH, TEXTURE_HEIGHT };
+        ASSERT_TRUE(SDL::renderCopy(texture, alpha, NULL, &dest, viewInfo));
+        SDL::freeSurface(texture);
+
+        int worst = 0;
+        for(int y = 0; y < HEIGHT; y++)
+        {
+            for(int x = 0; x < WIDTH; x++)
+            {
+                Uint8 *a = static_cast<Uint8 *>(window->pixels) + y * window->pitch + x * window->format->BytesPerPixel;
+                Uint8 *b = static_cast<Uint8 *>(expected->pixels) + y * expected->pitch + x * expected->format->BytesPerPixel;
+                Uint32 pa = window->format->BytesPerPixel == 2 ? *reinterpret_cast<Uint16 *>(a) : *reinterpret_cast<Uint32 *>(a);
+                Uint32 pb = window->format->BytesPerPixel == 2 ? *reinterpret_cast<Uint16 *>(b) : *reinterpret_cast<Uint32 *>(b);
+                Uint8 ca[3];
+                Uint8 cb[3];
+                SDL_GetRGB(pa, window->format, &ca[0], &ca[1], &ca[2]);
+                SDL_GetRGB(pb, window->format, &cb[0], &cb[1], &cb[2]);
+                for(int c = 0; c < 3; c++)
+                {
+                    worst = std::max(worst, std::abs(ca[c] - cb[c]));
+                }
+            }
+        }
+        SDL_FreeSurface(expected);
+        ASSERT_LE(worst, tolerance);
+    }
+};
+
+TEST_F(SDLBlitTest, OpaqueMatchesSdl)
+{
+    compareWithSdl("rgb888", KIND_OPAQUE, 1.0f, 0);
+}
+
+TEST_F(SDLBlitTest, FadedOpaqueMatchesSdl)
+{
+    compareWithSdl("rgb888", KIND_OPAQUE, 0.5f, 2);
+}
+
+TEST_F(SDLBlitTest, BinaryAlphaMatchesSdl)
+{
+    compareWithSdl("rgb888", KIND_BINARY, 1.0f, 0);
+}
+
+TEST_F(SDLBlitTest, PremultipliedMatchesSdl)
+{
+    compareWithSdl("rgb888", KIND_TRANSLUCENT, 1.0f, 3);
+}
+
+TEST_F(SDLBlitTest, Rgb565MatchesSdl)
+{
+    compareWithSdl("rgb565", KIND_OPAQUE, 1.0f, 0);
+    SDL::deInitialize();
+    compareWithSdl("rgb565", KIND_BINARY, 1.0f, 0);
+    SDL::deInitialize();
+    // Blended at 5-bit alpha, two steps of the 5-bit channels
+    compareWithSdl("rgb565", KIND_TRANSLUCENT, 1.0f, 16);
+}
+
+TEST_F(SDLBlitTest, DownscaledTexturesKeepTheirFormat)
+{
+    SDL_Surface *texture = createTexture(KIND_TRANSLUCENT);
+    Uint32 amask = texture->format->Amask;
+    ASSERT_FALSE(SDL::downscaleTexture(texture, TEXTURE_WIDTH * 2, TEXTURE_HEIGHT));
+    ASSERT_FALSE(SDL::downscaleTexture(texture, TEXTURE_WIDTH, TEXTURE_HEIGHT));
+    ASSERT_TRUE(SDL::downscaleTexture(texture, TEXTURE_WIDTH / 2, TEXTURE_HEIGHT / 4));
+    ASSERT_EQ(TEXTURE_WIDTH / 2, texture->w);
+    ASSERT_EQ(TEXTURE_HEIGHT / 4, texture->h);
+    ASSERT_EQ(amask, texture->format->Amask);
+
+    // First pixel averages columns 0 and 1 of rows 0 to 3, alpha 0 and 11
+    Uint32 p = *static_cast<Uint32 *>(texture->pixels);
+    ASSERT_EQ(6u, p >> 24);
+    SDL::freeSurface(texture);
+}
+
+TEST_F(SDLBlitTest, PackedTexturesMatchSdl)
+{
+    compareWithSdl("rgb888", KIND_OPAQUE, 1.0f, 0, true);
+    SDL::deInitialize();
+    compareWithSdl("rgb888", KIND_BINARY, 1.0f, 0, true);
+    SDL::deInitialize();
+    compareWithSdl("rgb888", KIND_TRANSLUCENT, 1.0f, 3, true);
+    SDL::deInitialize();
+    compareWithSdl("rgb565", KIND_BINARY, 1.0f, 0, true);
+}
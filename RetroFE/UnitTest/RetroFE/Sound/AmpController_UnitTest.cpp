@@ -0,0 +1,171 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <Sound/AmpController.h>
+#include <chrono>
+#include <thread>
+
+#define MS 1000000ULL
+
+static uint64_t fakeTime = 0;
+
+static uint64_t fakeNow()
+{
+    return fakeTime;
+}
+
+class AmpControllerTest : public ::testing::Test
+{
+protected:
+    AmpControllerTest()
+        : amp(fakeNow, [this](bool on) { (on ? onCount : offCount)++; })
+        , onCount(0)
+        , offCount(0)
+    {
+        fakeTime = 1000 * MS;
+        amp.setWarmupTime(0.05f);
+        amp.setIdleTime(0.5f);
+    }
+
+    // One click of a scroll sound lasting the given time
+    void click(uint64_t length)
+    {
+        amp.soundStarted();
+        amp.update();
+        fakeTime += length;
+        amp.update();
+        amp.soundFinished();
+        amp.update();
+    }
+
+    AmpController amp;
+    int onCount;
+    int offCount;
+};
+
+TEST_F(AmpControllerTest, SoundWarmsThenPowersOn)
+{
+    ASSERT_EQ(AmpController::STATE_OFF, amp.getState());
+
+    amp.soundStarted();
+    ASSERT_EQ(AmpController::STATE_WARMING, amp.getState());
+    ASSERT_EQ(0, onCount);
+
+    // The command is issued by update(), not by the caller
+    ASSERT_EQ(fakeTime + 50 * MS, amp.update());
+    ASSERT_EQ(1, onCount);
+
+    fakeTime += 50 * MS;
+    ASSERT_EQ(0u, amp.update());
+    ASSERT_EQ(AmpController::STATE_ON, amp.getState());
+    ASSERT_EQ(1, onCount);
+    ASSERT_EQ(0, offCount);
+}
+
+TEST_F(AmpControllerTest, RapidClicksIssueOneOnCommand)
+{
+    for(int i = 0; i < 20; i++)
+    {
+        click(60 * MS);
+        fakeTime += 100 * MS;
+        amp.update();
+    }
+
+    ASSERT_EQ(1, onCount);
+    ASSERT_EQ(0, offCount);
+    ASSERT_EQ(AmpController::STATE_COOLDOWN, amp.getState());
+}
+
+TEST_F(AmpControllerTest, IdleTimePowersOff)
+{
+    click(60 * MS);
+    ASSERT_EQ(AmpController::STATE_COOLDOWN, amp.getState());
+
+    fakeTime += 499 * MS;
+    amp.update();
+    ASSERT_EQ(0, offCount);
+
+    fakeTime += 1 * MS;
+    ASSERT_EQ(0u, amp.update());
+    ASSERT_EQ(1, offCount);
+    ASSERT_EQ(AmpController::STATE_OFF, amp.getState());
+
+    // Next sound powers it on again
+    click(60 * MS);
+    ASSERT_EQ(2, onCount);
+}
+
+TEST_F(AmpControllerTest, NewSoundExtendsCooldown)
+{
+    click(60 * MS);
+    fakeTime += 400 * MS;
+    amp.update();
+
+    click(60 * MS);
+    ASSERT_EQ(AmpController::STATE_COOLDOWN, amp.getState());
+
+    // 400ms after the first cooldown would have ended, the amp is still on
+    fakeTime += 400 * MS;
+    amp.update();
+    ASSERT_EQ(0, offCount);
+
+    fakeTime += 100 * MS;
+    amp.update();
+    ASSERT_EQ(1, offCount);
+    ASSERT_EQ(1, onCount);
+}
+
+TEST_F(AmpControllerTest, ShortSoundFinishingWhileWarmingCoolsDown)
+{
+    click(10 * MS);
+    ASSERT_EQ(AmpController::STATE_WARMING, amp.getState());
+
+    fakeTime += 40 * MS;
+    amp.update();
+    ASSERT_EQ(AmpController::STATE_COOLDOWN, amp.getState());
+
+    fakeTime += 500 * MS;
+    amp.update();
+    ASSERT_EQ(1, onCount);
+    ASSERT_EQ(1, offCount);
+}
+
+TEST_F(AmpControllerTest, ResetDropsPendingCommands)
+{
+    click(60 * MS);
+    fakeTime += 1000 * MS;
+
+    amp.reset();
+    amp.update();
+
+    ASSERT_EQ(AmpController::STATE_OFF, amp.getState());
+    ASSERT_EQ(1, onCount);
+    ASSERT_EQ(0, offCount);
+}
+
+TEST_F(AmpControllerTest, BackgroundThreadIssuesCommands)
+{
+    std::mutex mutex;
+    std::vector<bool> commands;
+    AmpController threaded(AmpController::monotonicTime, [&mutex, &commands](bool on)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        commands.push_back(on);
+    });
+    threaded.setWarmupTime(0.01f);
+    threaded.setIdleTime(0.05f);
+    threaded.start();
+
+    threaded.soundStarted();
+    threaded.soundFinished();
+
+    for(int i = 0; i < 100 && threaded.getState() != AmpController::STATE_OFF; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    threaded.stop();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_EQ(2u, commands.size());
+    ASSERT_TRUE(commands[0]);
+    ASSERT_FALSE(commands[1]);
+}
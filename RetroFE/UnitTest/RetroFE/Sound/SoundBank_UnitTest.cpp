@@ -0,0 +1,153 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <Sound/SoundBank.h>
+#include <SDL/SDL.h>
+#include <fstream>
+#include <stdint.h>
+#include <unistd.h>
+
+#define TEST_RATE     22050
+#define TEST_SOUND_A  "/tmp/SoundBankTest_a.wav"
+#define TEST_SOUND_B  "/tmp/SoundBankTest_b.wav"
+
+// Run with SDL_AUDIODRIVER=dummy, set by ctest
+class SoundBankTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        ASSERT_EQ(0, SDL_Init(SDL_INIT_AUDIO));
+        ASSERT_EQ(0, Mix_OpenAudio(TEST_RATE, AUDIO_S16SYS, 1, 1024));
+        Mix_AllocateChannels(8);
+        writeWav(TEST_SOUND_A, 2);
+        writeWav(TEST_SOUND_B, 2);
+    }
+
+    virtual void TearDown()
+    {
+        bank.closeAudio();
+        Mix_CloseAudio();
+        SDL_Quit();
+        unlink(TEST_SOUND_A);
+        unlink(TEST_SOUND_B);
+    }
+
+    // Mono 16 bit square wave lasting the given seconds
+    static void writeWav(const char *path, int seconds)
+    {
+        uint32_t samples = TEST_RATE * seconds;
+        uint32_t dataSize = samples * 2;
+        std::ofstream ofs(path, std::ofstream::binary);
+
+        ofs.write("RIFF", 4);
+        writeInt(ofs, 36 + dataSize, 4);
+        ofs.write("WAVEfmt ", 8);
+        writeInt(ofs, 16, 4);
+        writeInt(ofs, 1, 2);               // PCM
+        writeInt(ofs, 1, 2);               // mono
+        writeInt(ofs, TEST_RATE, 4);
+        writeInt(ofs, TEST_RATE * 2, 4);
+        writeInt(ofs, 2, 2);
+        writeInt(ofs, 16, 2);
+        ofs.write("data", 4);
+        writeInt(ofs, dataSize, 4);
+        for(uint32_t i = 0; i < samples; i++)
+        {
+            writeInt(ofs, ((i / 50) % 2) ? 8000 : -8000, 2);
+        }
+    }
+
+    static void writeInt(std::ofstream &ofs, uint32_t value, int bytes)
+    {
+        for(int i = 0; i < bytes; i++)
+        {
+            ofs.put(static_cast<char>((value >> (8 * i)) & 0xff));
+        }
+    }
+
+    SoundBank bank;
+};
+
+TEST_F(SoundBankTest, FileIsDecodedOnce)
+{
+    ASSERT_TRUE(bank.load(TEST_SOUND_A));
+    ASSERT_TRUE(bank.load(TEST_SOUND_A));
+    ASSERT_EQ(1u, bank.getDecodeCount());
+    ASSERT_TRUE(bank.getChunk(TEST_SOUND_A) != NULL);
+
+    ASSERT_FALSE(bank.load("/nonexistent.wav"));
+    ASSERT_TRUE(bank.getChunk("/nonexistent.wav") == NULL);
+}
+
+TEST_F(SoundBankTest, SamplesSurviveAudioReinitialisation)
+{
+    ASSERT_TRUE(bank.load(TEST_SOUND_A));
+
+    bank.closeAudio();
+    Mix_CloseAudio();
+    ASSERT_TRUE(bank.getChunk(TEST_SOUND_A) == NULL);
+
+    ASSERT_EQ(0, Mix_OpenAudio(TEST_RATE, AUDIO_S16SYS, 1, 1024));
+    ASSERT_TRUE(bank.getChunk(TEST_SOUND_A) != NULL);
+    ASSERT_GE(bank.play(TEST_SOUND_A), 0);
+    ASSERT_EQ(1u, bank.getDecodeCount());
+}
+
+TEST_F(SoundBankTest, NewAudioFormatDecodesAgain)
+{
+    ASSERT_TRUE(bank.load(TEST_SOUND_A));
+
+    bank.closeAudio();
+    Mix_CloseAudio();
+    ASSERT_EQ(0, Mix_OpenAudio(TEST_RATE * 2, AUDIO_S16SYS, 2, 1024));
+
+    ASSERT_TRUE(bank.getChunk(TEST_SOUND_A) != NULL);
+    ASSERT_EQ(2u, bank.getDecodeCount());
+}
+
+TEST_F(SoundBankTest, OldestCopyOfTheSoundIsStopped)
+{
+    ASSERT_TRUE(bank.load(TEST_SOUND_A));
+    ASSERT_TRUE(bank.load(TEST_SOUND_B));
+    bank.setMaxInstances(2);
+
+    int first  = bank.play(TEST_SOUND_A);
+    int second = bank.play(TEST_SOUND_A);
+    int other  = bank.play(TEST_SOUND_B);
+    ASSERT_GE(first, 0);
+    ASSERT_GE(second, 0);
+    ASSERT_NE(first, second);
+
+    // The third copy takes the channel of the first one
+    ASSERT_EQ(first, bank.play(TEST_SOUND_A));
+    ASSERT_EQ(3, Mix_Playing(-1));
+    ASSERT_TRUE(Mix_Playing(other));
+    ASSERT_EQ(bank.getChunk(TEST_SOUND_B), Mix_GetChunk(other));
+}
+
+TEST_F(SoundBankTest, BusyMixerReusesTheOldestCopy)
+{
+    Mix_AllocateChannels(2);
+    ASSERT_TRUE(bank.load(TEST_SOUND_A));
+    bank.setMaxInstances(4);
+
+    int first  = bank.play(TEST_SOUND_A);
+    int second = bank.play(TEST_SOUND_A);
+    ASSERT_GE(first, 0);
+    ASSERT_GE(second, 0);
+
+    ASSERT_EQ(first, bank.play(TEST_SOUND_A));
+    ASSERT_EQ(second, bank.play(TEST_SOUND_A));
+}
+
+TEST_F(SoundBankTest, LastUserFreesTheSamples)
+{
+    ASSERT_TRUE(bank.load(TEST_SOUND_A));
+    ASSERT_TRUE(bank.load(TEST_SOUND_A));
+
+    bank.unload(TEST_SOUND_A);
+    ASSERT_TRUE(bank.getChunk(TEST_SOUND_A) != NULL);
+
+    bank.unload(TEST_SOUND_A);
+    ASSERT_TRUE(bank.getChunk(TEST_SOUND_A) == NULL);
+}
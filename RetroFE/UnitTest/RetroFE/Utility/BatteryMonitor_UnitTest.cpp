@@ -0,0 +1,143 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <Utility/BatteryMonitor.h>
+#include <fstream>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+class BatteryMonitorTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        char dir[] = "/tmp/BatteryMonitorTest.XXXXXX";
+        ASSERT_TRUE(mkdtemp(dir) != NULL);
+        root = dir;
+        mkdir((root + "/axp20x-battery").c_str(), 0755);
+        mkdir((root + "/axp20x-usb").c_str(), 0755);
+    }
+
+    virtual void TearDown()
+    {
+        unlink((root + "/axp20x-battery/capacity").c_str());
+        unlink((root + "/axp20x-battery/present").c_str());
+        unlink((root + "/axp20x-usb/present").c_str());
+        unlink((root + "/capacity").c_str());
+        rmdir((root + "/axp20x-battery").c_str());
+        rmdir((root + "/axp20x-usb").c_str());
+        rmdir(root.c_str());
+    }
+
+    // Rewrites the file in place, the monitor keeps its descriptor open
+    void write(std::string file, std::string value)
+    {
+        std::ofstream ofs((root + "/" + file).c_str(), std::ofstream::trunc);
+        ofs << value << "\n";
+    }
+
+    void writeAll(std::string capacity, std::string battery, std::string usb)
+    {
+        write("axp20x-battery/capacity", capacity);
+        write("axp20x-battery/present", battery);
+        write("axp20x-usb/present", usb);
+    }
+
+    std::string root;
+};
+
+TEST_F(BatteryMonitorTest, SnapshotIsInvalidBeforeFirstPoll)
+{
+    BatteryMonitor monitor(root);
+
+    ASSERT_FALSE(monitor.getSnapshot()->valid);
+    ASSERT_EQ(0, monitor.getNextPollTime(5));
+}
+
+TEST_F(BatteryMonitorTest, PollReadsTheValues)
+{
+    BatteryMonitor monitor(root);
+    writeAll("87", "1", "0");
+
+    ASSERT_TRUE(monitor.poll());
+
+    std::shared_ptr<const BatterySnapshot> snapshot = monitor.getSnapshot();
+    ASSERT_TRUE(snapshot->valid);
+    ASSERT_EQ(87, snapshot->percentage);
+    ASSERT_TRUE(snapshot->batteryConnected);
+    ASSERT_FALSE(snapshot->usbConnected);
+}
+
+TEST_F(BatteryMonitorTest, SnapshotIsOnlyPublishedOnChange)
+{
+    BatteryMonitor monitor(root);
+    writeAll("50", "1", "0");
+    monitor.poll();
+    std::shared_ptr<const BatterySnapshot> first = monitor.getSnapshot();
+
+    ASSERT_FALSE(monitor.poll());
+    ASSERT_EQ(first.get(), monitor.getSnapshot().get());
+
+    write("axp20x-usb/present", "1");
+    ASSERT_TRUE(monitor.poll());
+
+    // The snapshot held by a component is left untouched
+    ASSERT_FALSE(first->usbConnected);
+    ASSERT_TRUE(monitor.getSnapshot()->usbConnected);
+}
+
+TEST_F(BatteryMonitorTest, OpenFilesAreReadAgain)
+{
+    BatteryMonitor monitor(root);
+    writeAll("50", "1", "0");
+    monitor.poll();
+
+    write("axp20x-battery/capacity", "49");
+    ASSERT_TRUE(monitor.poll());
+    ASSERT_EQ(49, monitor.getSnapshot()->percentage);
+}
+
+TEST_F(BatteryMonitorTest, MissingFilesReadAsDisconnected)
+{
+    BatteryMonitor monitor(root);
+    write("axp20x-battery/capacity", "30");
+
+    ASSERT_TRUE(monitor.poll());
+    ASSERT_EQ(30, monitor.getSnapshot()->percentage);
+    ASSERT_FALSE(monitor.getSnapshot()->batteryConnected);
+    ASSERT_FALSE(monitor.getSnapshot()->usbConnected);
+
+    // Files appearing later are picked up
+    write("axp20x-battery/present", "1");
+    ASSERT_TRUE(monitor.poll());
+    ASSERT_TRUE(monitor.getSnapshot()->batteryConnected);
+}
+
+TEST_F(BatteryMonitorTest, AbsolutePathsIgnoreTheRoot)
+{
+    BatteryMonitor monitor("/nonexistent");
+    write("capacity", "12");
+
+    monitor.setFile(BatteryMonitor::FILE_CAPACITY, root + "/capacity");
+    ASSERT_EQ(root + "/capacity", monitor.getPath(BatteryMonitor::FILE_CAPACITY));
+    ASSERT_EQ("/nonexistent/axp20x-usb/present", monitor.getPath(BatteryMonitor::FILE_USB_PRESENT));
+
+    monitor.poll();
+    ASSERT_EQ(12, monitor.getSnapshot()->percentage);
+}
+
+TEST_F(BatteryMonitorTest, RefreshWaitsForThePeriod)
+{
+    BatteryMonitor monitor(root);
+    writeAll("50", "1", "0");
+
+    ASSERT_TRUE(monitor.refresh(60));
+    write("axp20x-battery/capacity", "40");
+
+    ASSERT_FALSE(monitor.refresh(60));
+    ASSERT_EQ(50, monitor.getSnapshot()->percentage);
+    ASSERT_GT(monitor.getNextPollTime(60), 59);
+
+    ASSERT_TRUE(monitor.refresh(0));
+    ASSERT_EQ(40, monitor.getSnapshot()->percentage);
+}
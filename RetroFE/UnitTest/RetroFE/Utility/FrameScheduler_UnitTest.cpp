@@ -0,0 +1,123 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <Utility/FrameScheduler.h>
+
+static uint64_t fakeNow = 0;
+static unsigned int fakeSleeps = 0;
+
+static uint64_t fakeTime()
+{
+    return fakeNow;
+}
+
+static void fakeSleepUntil(uint64_t deadline)
+{
+    fakeSleeps++;
+    if(deadline > fakeNow)
+    {
+        fakeNow = deadline;
+    }
+}
+
+class FrameSchedulerTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        fakeNow    = 1000000000ULL;
+        fakeSleeps = 0;
+    }
+};
+
+TEST_F(FrameSchedulerTest, AbsoluteDeadlinesDoNotDrift)
+{
+    FrameScheduler scheduler(60, fakeTime, fakeSleepUntil);
+
+    // 3 ms of work per frame for 10 seconds
+    for(int frame = 0; frame < 600; frame++)
+    {
+        scheduler.waitFrame();
+        float dt = scheduler.tick();
+        ASSERT_NEAR(1.0f / 60, dt, 0.0001f);
+        fakeNow += 3000000ULL;
+        ASSERT_TRUE(scheduler.mustDraw());
+    }
+
+    ASSERT_NEAR(10.0, (fakeNow - 1000000000ULL - 3000000ULL) / 1e9, 0.001);
+    ASSERT_EQ(600u, fakeSleeps);
+}
+
+TEST_F(FrameSchedulerTest, ConfigurableTargetFps)
+{
+    FrameScheduler scheduler(60, fakeTime, fakeSleepUntil);
+    scheduler.setTargetFps(30);
+
+    ASSERT_NEAR(1.0f / 30, scheduler.getPeriod(), 0.00001f);
+
+    scheduler.waitFrame();
+    ASSERT_NEAR(1.0f / 30, scheduler.tick(), 0.0001f);
+}
+
+TEST_F(FrameSchedulerTest, SkipsDrawButNotUpdateWhenLate)
+{
+    FrameScheduler scheduler(60, fakeTime, fakeSleepUntil);
+    scheduler.setMaxFrameSkip(2);
+
+    scheduler.waitFrame();
+    scheduler.tick();
+
+    // A 40 ms frame: the following deadline is already gone
+    fakeNow += 40000000ULL;
+    ASSERT_FALSE(scheduler.mustDraw());
+
+    // The next update starts without sleeping and reports the real elapsed time
+    scheduler.waitFrame();
+    ASSERT_NEAR(0.040f, scheduler.tick(), 0.0001f);
+    ASSERT_FALSE(scheduler.mustDraw());
+
+    // Back on schedule
+    scheduler.waitFrame();
+    ASSERT_NEAR(0.0f, scheduler.tick(), 0.0001f);
+    ASSERT_TRUE(scheduler.mustDraw());
+    ASSERT_EQ(1u, fakeSleeps);
+}
+
+TEST_F(FrameSchedulerTest, FrameSkipIsBounded)
+{
+    FrameScheduler scheduler(60, fakeTime, fakeSleepUntil);
+    scheduler.setMaxFrameSkip(2);
+
+    unsigned int drawn = 0;
+    for(int frame = 0; frame < 9; frame++)
+    {
+        scheduler.waitFrame();
+        scheduler.tick();
+        fakeNow += 50000000ULL;
+        if(scheduler.mustDraw()) drawn++;
+    }
+
+    ASSERT_EQ(3u, drawn);
+}
+
+TEST_F(FrameSchedulerTest, HistogramCountsFrameTimes)
+{
+    FrameScheduler scheduler(60, fakeTime, fakeSleepUntil);
+
+    for(int frame = 0; frame < 10; frame++)
+    {
+        scheduler.waitFrame();
+        scheduler.tick();
+    }
+
+    // Resynchronisation does not count the blocked time as a frame
+    fakeNow += 5000000000ULL;
+    scheduler.resync();
+    scheduler.tick();
+
+    // The first tick only sets the time base
+    ASSERT_EQ(9u, scheduler.getHistogramFrames());
+    ASSERT_NE(std::string::npos, scheduler.getHistogram().find("16-20ms:9"));
+
+    scheduler.clearHistogram();
+    ASSERT_EQ(0u, scheduler.getHistogramFrames());
+}
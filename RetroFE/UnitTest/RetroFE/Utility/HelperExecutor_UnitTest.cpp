@@ -0,0 +1,156 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <Utility/HelperExecutor.h>
+#include <atomic>
+
+class HelperExecutorTest : public ::testing::Test
+{
+};
+
+TEST_F(HelperExecutorTest, ExecuteReportsExitStatus)
+{
+    HelperResult ok = HelperExecutor::execute("/bin/true", false);
+    ASSERT_TRUE(ok.started);
+    ASSERT_EQ(0, ok.status);
+    ASSERT_TRUE(ok.success());
+
+    HelperResult failed = HelperExecutor::execute("/bin/false", false);
+    ASSERT_TRUE(failed.started);
+    ASSERT_NE(0, failed.status);
+    ASSERT_FALSE(failed.success());
+
+    HelperResult missing = HelperExecutor::execute("/nonexistent/helper", false);
+    ASSERT_FALSE(missing.success());
+}
+
+TEST_F(HelperExecutorTest, ExecuteCapturesOutput)
+{
+    HelperResult result = HelperExecutor::execute("/bin/echo 42", true);
+    ASSERT_TRUE(result.success());
+    ASSERT_EQ("42\n", result.output);
+
+    HelperResult silent = HelperExecutor::execute("/bin/echo 42", false);
+    ASSERT_EQ("", silent.output);
+}
+
+TEST_F(HelperExecutorTest, ParseSplitsPlainArguments)
+{
+    std::vector<std::string> argv = HelperExecutor::parse("volume  set 40");
+    ASSERT_EQ(3u, argv.size());
+    ASSERT_EQ("volume", argv[0]);
+    ASSERT_EQ("set", argv[1]);
+    ASSERT_EQ("40", argv[2]);
+}
+
+TEST_F(HelperExecutorTest, ParseFallsBackToShell)
+{
+    std::vector<std::string> argv = HelperExecutor::parse("keymap rom '/roms/a b.gba'");
+    ASSERT_EQ(3u, argv.size());
+    ASSERT_EQ("/bin/sh", argv[0]);
+    ASSERT_EQ("-c", argv[1]);
+    ASSERT_EQ("keymap rom '/roms/a b.gba'", argv[2]);
+
+    HelperResult result = HelperExecutor::execute("/bin/echo 'a b' | /bin/cat", true);
+    ASSERT_EQ("a b\n", result.output);
+}
+
+TEST_F(HelperExecutorTest, RunDeliversResultAndCallback)
+{
+    HelperExecutor helpers;
+    std::atomic<int> calls(0);
+
+    HelperExecutor::Future future = helpers.run("/bin/false", [&calls](const HelperResult &result)
+    {
+        if(!result.success()) calls++;
+    });
+
+    ASSERT_FALSE(future.get().success());
+    helpers.stop();
+    ASSERT_EQ(1, calls.load());
+}
+
+TEST_F(HelperExecutorTest, RunKeepsOrder)
+{
+    HelperExecutor helpers;
+    std::vector<int> order;
+
+    for(int i = 0; i < 5; i++)
+    {
+        helpers.run("/bin/true", [&order, i](const HelperResult &) { order.push_back(i); });
+    }
+    helpers.run("/bin/true").wait();
+
+    ASSERT_EQ(5u, order.size());
+    for(int i = 0; i < 5; i++)
+    {
+        ASSERT_EQ(i, order[i]);
+    }
+}
+
+TEST_F(HelperExecutorTest, QueryIsCoalescedAndCached)
+{
+    HelperExecutor helpers;
+
+    HelperExecutor::Future first = helpers.query("/bin/echo 50", 60);
+    HelperExecutor::Future second = helpers.query("/bin/echo 50", 60);
+    ASSERT_EQ(&first.get(), &second.get());
+    ASSERT_EQ("50\n", first.get().output);
+
+    HelperResult cached;
+    ASSERT_TRUE(helpers.getCached("/bin/echo 50", cached));
+    ASSERT_EQ("50\n", cached.output);
+
+    // Answered from the cache, the callback runs right away
+    bool called = false;
+    HelperExecutor::Future third = helpers.query("/bin/echo 50", 60, [&called](const HelperResult &) { called = true; });
+    ASSERT_TRUE(called);
+    ASSERT_EQ(&first.get(), &third.get());
+}
+
+TEST_F(HelperExecutorTest, QueryRunsAgainWhenStaleOrInvalidated)
+{
+    HelperExecutor helpers;
+
+    HelperExecutor::Future first = helpers.query("/bin/echo 10", 60);
+    first.wait();
+
+    helpers.invalidate("/bin/echo 10");
+    HelperResult cached;
+    ASSERT_FALSE(helpers.getCached("/bin/echo 10", cached));
+
+    HelperExecutor::Future second = helpers.query("/bin/echo 10", 60);
+    ASSERT_NE(&first.get(), &second.get());
+    second.wait();
+
+    HelperExecutor::Future third = helpers.query("/bin/echo 10", 0);
+    ASSERT_NE(&second.get(), &third.get());
+    ASSERT_EQ("10\n", third.get().output);
+}
+
+TEST_F(HelperExecutorTest, QueryInvalidatedWhilePendingIsNotCached)
+{
+    HelperExecutor helpers;
+
+    HelperExecutor::Future pending = helpers.query("sleep 0.1; echo 10", 60);
+    helpers.invalidate("sleep 0.1; echo 10");
+    pending.wait();
+    helpers.run("true").wait();
+
+    HelperResult cached;
+    ASSERT_FALSE(helpers.getCached("sleep 0.1; echo 10", cached));
+}
+
+TEST_F(HelperExecutorTest, QueryInvalidatedWhilePendingDoesNotWait)
+{
+    HelperExecutor helpers;
+
+    helpers.query("sleep 0.2; echo 10", 60).wait();
+    HelperExecutor::Future pending = helpers.query("sleep 0.2; echo 10", 0);
+    helpers.invalidate("sleep 0.2; echo 10");
+
+    // The last result is recent, but the invalidated run must not be waited for
+    HelperExecutor::Future fresh = helpers.query("sleep 0.2; echo 10", 60);
+    ASSERT_EQ(std::future_status::timeout, pending.wait_for(std::chrono::seconds(0)));
+    ASSERT_NE(&pending.get(), &fresh.get());
+    ASSERT_EQ("10\n", fresh.get().output);
+}
@@ -0,0 +1,83 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <Utility/MemInfo.h>
+#include <fstream>
+#include <stdlib.h>
+#include <unistd.h>
+
+class MemInfoTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        char file[] = "/tmp/MemInfoTest.XXXXXX";
+        int fd = mkstemp(file);
+        ASSERT_NE(-1, fd);
+        close(fd);
+        path = file;
+    }
+
+    virtual void TearDown()
+    {
+        unlink(path.c_str());
+    }
+
+    void write(std::string contents)
+    {
+        std::ofstream ofs(path.c_str(), std::ofstream::trunc);
+        ofs << contents;
+    }
+
+    std::string path;
+};
+
+TEST_F(MemInfoTest, ReadsMemAvailable)
+{
+    write("MemTotal:          59864 kB\n"
+          "MemFree:            8120 kB\n"
+          "MemAvailable:      40960 kB\n"
+          "Buffers:            1024 kB\n"
+          "Cached:            20480 kB\n"
+          "HugePages_Total:       0\n");
+
+    MemInfo memInfo;
+    ASSERT_TRUE(memInfo.read(path));
+    ASSERT_EQ(59864u, memInfo.getTotal());
+    ASSERT_EQ(40960u, memInfo.getAvailable());
+}
+
+TEST_F(MemInfoTest, EstimatesAvailableOnOldKernels)
+{
+    write("MemTotal:          59864 kB\n"
+          "MemFree:            8120 kB\n"
+          "Buffers:            1024 kB\n"
+          "Cached:            20480 kB\n");
+
+    MemInfo memInfo;
+    ASSERT_TRUE(memInfo.read(path));
+    ASSERT_EQ(8120u + 1024u + 20480u, memInfo.getAvailable());
+}
+
+TEST_F(MemInfoTest, ThresholdIsInMegabytes)
+{
+    write("MemAvailable:      32768 kB\n");
+
+    MemInfo memInfo;
+    ASSERT_TRUE(memInfo.hasAvailable(32, path));
+    ASSERT_FALSE(memInfo.hasAvailable(33, path));
+}
+
+TEST_F(MemInfoTest, MissingFileKeepsNothing)
+{
+    MemInfo memInfo;
+    ASSERT_FALSE(memInfo.read(path + ".missing"));
+    ASSERT_FALSE(memInfo.hasAvailable(0, path + ".missing"));
+}
+
+TEST_F(MemInfoTest, ReadsProcMeminfo)
+{
+    MemInfo memInfo;
+    ASSERT_TRUE(memInfo.read());
+    ASSERT_GT(memInfo.getTotal(), 0u);
+    ASSERT_LE(memInfo.getAvailable(), memInfo.getTotal());
+}
@@ -1,6 +1,7 @@
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 #include <Utility/Utils.h>
+#include <vector>
 
 class UtilsTest : public ::testing::Test
 {
@@ -8,5 +9,41 @@ class UtilsTest : public ::testing::Test
 
 TEST_F(UtilsTest, ConvertsStringToInt)
 {
-    ASSERT_EQ(5, Utils::ConvertInt("5"));
+    ASSERT_EQ(5, Utils::convertInt("5"));
+}
+
+static std::vector<unsigned int> decodeAll(std::string text)
+{
+    std::vector<unsigned int> codepoints;
+    for(size_t i = 0; i < text.size(); )
+    {
+        codepoints.push_back(Utils::decodeUtf8(text, i));
+    }
+    return codepoints;
+}
+
+TEST_F(UtilsTest, DecodesUtf8)
+{
+    // ASCII, Latin-1, CJK and a character outside the BMP
+    std::vector<unsigned int> codepoints = decodeAll("A\xc3\xa9\xe6\x97\xa5\xf0\x9d\x84\x9e");
+
+    ASSERT_EQ(4u, codepoints.size());
+    ASSERT_EQ(0x41u, codepoints[0]);
+    ASSERT_EQ(0xe9u, codepoints[1]);
+    ASSERT_EQ(0x65e5u, codepoints[2]);
+    ASSERT_EQ(0x1d11eu, codepoints[3]);
+}
+
+TEST_F(UtilsTest, DecodesInvalidUtf8AsLatin1)
+{
+    // "Pokemon" with an accent saved as Latin-1, then a truncated sequence,
+    // an overlong slash and an encoded surrogate
+    std::vector<unsigned int> codepoints = decodeAll("Pok\xe9mon\xe6\x97");
+    ASSERT_EQ(9u, codepoints.size());
+    ASSERT_EQ(0xe9u, codepoints[3]);
+    ASSERT_EQ(0xe6u, codepoints[7]);
+    ASSERT_EQ(0x97u, codepoints[8]);
+
+    ASSERT_EQ(2u, decodeAll("\xc0\xaf").size());
+    ASSERT_EQ(3u, decodeAll("\xed\xa0\x80").size());
 }
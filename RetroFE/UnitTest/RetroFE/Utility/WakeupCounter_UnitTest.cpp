@@ -0,0 +1,33 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <Utility/WakeupCounter.h>
+
+class WakeupCounterTest : public ::testing::Test
+{
+};
+
+TEST_F(WakeupCounterTest, CountsEveryFrameWhenAnimating)
+{
+    WakeupCounter counter;
+    counter.reset(0);
+
+    // 60 FPS main loop for 3 seconds
+    for(int frame = 1; frame <= 180; frame++)
+    {
+        counter.wakeup(frame / 60.0f);
+    }
+
+    ASSERT_NEAR(60.0f, counter.getRate(), 1.5f);
+    ASSERT_EQ(180u, counter.getTotal());
+}
+
+TEST_F(WakeupCounterTest, RateIsOnlyPublishedOncePerWindow)
+{
+    WakeupCounter counter;
+    counter.reset(0);
+
+    ASSERT_FALSE(counter.wakeup(0.5f));
+    ASSERT_TRUE(counter.wakeup(1.0f));
+    ASSERT_FALSE(counter.wakeup(1.5f));
+    ASSERT_FLOAT_EQ(1.0f, counter.getRate());
+}